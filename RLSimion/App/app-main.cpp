@@ -4,16 +4,15 @@
 #include "../Lib/app.h"
 #include "../Lib/logger.h"
 #include "../Lib/config.h"
+#include "../Lib/CNTKWrapperClient.h"
 #include "../../tools/System/FileUtils.h"
+#include "../../tools/System/ForkServer.h"
+#include <cstring>
 
-int main(int argc, char* argv[])
+int runExperiment(int argc, char* argv[])
 {
 	try
 	{
-		//set the executable's directory as the current directory. This is required under Linux to be able to pass a relative path
-		string dir= getDirectory(string(argv[0]));
-		changeWorkingDirectory(dir);
-
 		ConfigFile configXMLFile;
 		SimionApp* pApp = 0;
 		//initialisation required for all apps: create the comm pipe and load the xml configuration file, ....
@@ -53,6 +52,13 @@ int main(int argc, char* argv[])
 				pApp->setExecutedRemotely(false);
 			else pApp->setExecutedRemotely(true);
 
+			//render the scene offscreen and save the frames: -offscreen [-frame-decimation=<n>]
+			if (SimionApp::flagPassed(argc, argv, "offscreen"))
+			{
+				const char* pFrameDecimation = SimionApp::getArgValue(argc, argv, "frame-decimation");
+				pApp->setOffscreenRendering(true, pFrameDecimation ? (unsigned int) atoi(pFrameDecimation) : 1);
+			}
+
 			//CPU is used by default.
 			//tests so far seem to run faster on multi-core cpus than using gpus O_o
 			if (SimionApp::flagPassed(argc, argv, "gpu"))
@@ -73,4 +79,43 @@ int main(int argc, char* argv[])
 	}
 
 	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	//set the executable's directory as the current directory. This is required under Linux to be able to pass a relative path
+	string dir= getDirectory(string(argv[0]));
+	changeWorkingDirectory(dir);
+
+	ForkServer forkServer;
+
+	//launcher daemon: -launcher-daemon=<socket>
+	//the libraries are loaded once and every experiment requested is run in a child process forked from this one
+	const char* pDaemonSocket = SimionApp::getArgValue(argc, argv, "launcher-daemon");
+	if (pDaemonSocket)
+	{
+		CNTK::WrapperClient::Preload();
+		if (!forkServer.serve(pDaemonSocket, runExperiment))
+			printf("ERROR: Failed to open the launcher socket: %s\n", pDaemonSocket);
+		return 1;
+	}
+
+	//run the experiment in a launcher daemon: <config-file> ... -launcher=<socket>
+	//the rest of the arguments are passed to the daemon, and the progress is reported through the pipe as usual
+	const char* pLauncherSocket = SimionApp::getArgValue(argc, argv, "launcher");
+	if (pLauncherSocket)
+	{
+		vector<const char*> args;
+		for (int i = 0; i < argc; ++i)
+		{
+			if (strncmp(argv[i], "-launcher=", strlen("-launcher=")) != 0)
+				args.push_back(argv[i]);
+		}
+		int exitCode = forkServer.request(pLauncherSocket, (int)args.size(), args.data());
+		if (exitCode < 0)
+			printf("ERROR: Failed to connect to the launcher daemon: %s\n", pLauncherSocket);
+		return exitCode;
+	}
+
+	return runExperiment(argc, argv);
 }
\ No newline at end of file
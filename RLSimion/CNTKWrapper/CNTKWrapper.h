@@ -73,6 +73,11 @@ public:
 	virtual void gradientWrtAction(const State* s, const Action* a, vector<double>& outputValues) = 0;
 	virtual void applyGradient(IMinibatch* pMinibatch) = 0;
 
+	//Batched versions of evaluate() and gradientWrtAction(): inputs and outputs are [numTuples x size] vectors laid out
+	//like the buffers of a minibatch, so that the whole minibatch is processed with a single call to the network
+	virtual void evaluate(const vector<double>& s, const vector<double>& a, vector<double>& outputValues) = 0;
+	virtual void gradientWrtAction(const vector<double>& s, const vector<double>& a, vector<double>& outputValues) = 0;
+
 	//StateActionFunction interface
 	virtual unsigned int getNumOutputs() = 0;
 	virtual vector<double>& evaluate(const State* s, const Action* a) = 0;
@@ -88,10 +93,15 @@ public:
 	virtual void clear() = 0;
 	virtual void addTuple(const State* s, const Action* a, const vector<double>& targetValues) = 0;
 	virtual void addTuple(const State* s, const Action* a, double targetValue) = 0;
+	//stores the whole transition, leaving the target undefined: it can be calculated once the minibatch is full
+	virtual void addTuple(const State* s, const Action* a, const State* s_p, double r) = 0;
 	virtual vector<double>& getInputState() = 0;
 	virtual vector<double>& getInputAction() = 0;
+	virtual vector<double>& getInputNextState() = 0;
+	virtual vector<double>& getReward() = 0;
 	virtual vector<double>& getOutput() = 0;
 	virtual bool isFull() const = 0;
+	virtual size_t numTuples() const = 0;
 	virtual size_t size() const = 0;
 	virtual size_t outputSize() const = 0;
 };
@@ -9,6 +9,8 @@ Minibatch::Minibatch(size_t size, NetworkDefinition* pNetworkDefinition, size_t
 	m_size = size;
 	m_inputState = vector<double>(size*pNetworkDefinition->getInputStateVariables().size());
 	m_inputAction = vector<double>(size*pNetworkDefinition->getInputActionVariables().size());
+	m_inputNextState = vector<double>(size*pNetworkDefinition->getInputStateVariables().size());
+	m_reward = vector<double>(size);
 
 	if (outputSize == 0)
 		//if not overriden, use the network's output size. This is the general case
@@ -40,6 +42,17 @@ void Minibatch::addTuple(const State* s, const Action* a, double targetValue)
 	addTuple(s, a, targetValues);
 }
 
+void Minibatch::copyInputs(const State* s, const Action* a)
+{
+	//copy state input
+	const vector<string>& stateVars= m_pNetworkDefinition->getInputStateVariables();
+	m_statePacker.pack(s, stateVars, m_inputState.data() + m_numTuples*stateVars.size());
+
+	//copy action input
+	const vector<string>& actionVars = m_pNetworkDefinition->getInputActionVariables();
+	m_actionPacker.pack(a, actionVars, m_inputAction.data() + m_numTuples*actionVars.size());
+}
+
 void Minibatch::addTuple(const State* s, const Action* a, const vector<double>& targetValues)
 {
 	if (m_numTuples >= m_size)
@@ -48,17 +61,7 @@ void Minibatch::addTuple(const State* s, const Action* a, const vector<double>&
 	if (targetValues.size() != m_outputSize)
 		throw std::runtime_error("Missmatched tuple output size and minibatch output size");
 
-	//copy state input
-	const vector<string>& stateVars= m_pNetworkDefinition->getInputStateVariables();
-	size_t stateInputSize = stateVars.size();
-	for (size_t i= 0; i<stateInputSize; i++)
-		m_inputState[m_numTuples*stateInputSize + i] = s->getNormalized(stateVars[i].c_str());
-
-	//copy action input
-	const vector<string>& actionVars = m_pNetworkDefinition->getInputActionVariables();
-	size_t actionInputSize = actionVars.size();
-	for (size_t i = 0; i<actionInputSize; i++)
-		m_inputAction[m_numTuples*actionInputSize + i] = a->getNormalized(actionVars[i].c_str());
+	copyInputs(s, a);
 
 	//copy target values
 	for (size_t i = 0; i < targetValues.size(); i++)
@@ -67,6 +70,22 @@ void Minibatch::addTuple(const State* s, const Action* a, const vector<double>&
 	m_numTuples++;
 }
 
+void Minibatch::addTuple(const State* s, const Action* a, const State* s_p, double r)
+{
+	if (m_numTuples >= m_size)
+		return;
+
+	copyInputs(s, a);
+
+	//copy next state
+	const vector<string>& stateVars = m_pNetworkDefinition->getInputStateVariables();
+	m_statePacker.pack(s_p, stateVars, m_inputNextState.data() + m_numTuples*stateVars.size());
+
+	m_reward[m_numTuples] = r;
+
+	m_numTuples++;
+}
+
 vector<double>& Minibatch::getInputState()
 {
 	return m_inputState;
@@ -77,6 +96,16 @@ vector<double>& Minibatch::getInputAction()
 	return m_inputAction;
 }
 
+vector<double>& Minibatch::getInputNextState()
+{
+	return m_inputNextState;
+}
+
+vector<double>& Minibatch::getReward()
+{
+	return m_reward;
+}
+
 vector<double>& Minibatch::getOutput()
 {
 	return m_output;
@@ -92,6 +121,11 @@ bool Minibatch::isFull() const
 	return m_numTuples == m_size;
 }
 
+size_t Minibatch::numTuples() const
+{
+	return m_numTuples;
+}
+
 size_t Minibatch::size() const
 {
 	return m_size;
@@ -13,9 +13,16 @@ class Minibatch: public IMinibatch
 	size_t m_size = 0;
 	vector<double> m_inputState;
 	vector<double> m_inputAction;
+	vector<double> m_inputNextState;
+	vector<double> m_reward;
 
 	size_t m_outputSize = 0;
 	vector<double> m_output;
+
+	NamedVarSetPacker m_statePacker;
+	NamedVarSetPacker m_actionPacker;
+
+	void copyInputs(const State* s, const Action* a);
 public:
 	Minibatch(size_t size, NetworkDefinition* pNetworkDefinition, size_t outputSize= 0);
 	virtual ~Minibatch();
@@ -23,11 +30,15 @@ public:
 	void clear();
 	void addTuple(const State* s, const Action* a, const vector<double>& targetValues);
 	void addTuple(const State* s, const Action* a, double targetValue);
+	void addTuple(const State* s, const Action* a, const State* s_p, double r);
 	vector<double>& getInputState();
 	vector<double>& getInputAction();
+	vector<double>& getInputNextState();
+	vector<double>& getReward();
 	vector<double>& getOutput();
 	void destroy();
 	bool isFull() const;
+	size_t numTuples() const;
 	size_t size() const;
 	size_t outputSize() const;
 };
\ No newline at end of file
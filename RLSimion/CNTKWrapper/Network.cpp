@@ -195,17 +195,49 @@ void Network::setOutputLayer(CNTK::FunctionPtr outputLayer)
 void Network::stateToVector(const State* s, vector<double>& stateVector)
 {
 	const vector<string>& stateVars = m_pNetworkDefinition->getInputStateVariables();
-	stateVector = vector<double>(stateVars.size());
-	for (size_t i = 0; i< stateVars.size(); i++)
-		stateVector[i] = s->getNormalized(stateVars[i].c_str());
+	stateVector.resize(stateVars.size());
+	m_statePacker.pack(s, stateVars, stateVector.data());
 }
 
 void Network::actionToVector(const Action* a, vector<double>& actionVector)
 {
 	const vector<string>& actionVars = m_pNetworkDefinition->getInputActionVariables();
-	actionVector = vector<double>(actionVars.size());
-	for (size_t i = 0; i < actionVars.size(); i++)
-		actionVector[i] = a->getNormalized(actionVars[i].c_str());
+	actionVector.resize(actionVars.size());
+	m_actionPacker.pack(a, actionVars, actionVector.data());
+}
+
+void Network::setTupleInputs(const State* s, const Action* a, unordered_map<CNTK::Variable, CNTK::ValuePtr>& inputs)
+{
+	bool bCPUDevice = CNTK::DeviceDescriptor::UseDefaultDevice().Type() == CNTK::DeviceKind::CPU;
+
+	if (m_bInputStateUsed)
+	{
+		stateToVector(s, m_stateInput);
+		if (!bCPUDevice)
+			inputs[m_inputState] = CNTK::Value::CreateBatch(m_inputState.Shape()
+				, m_stateInput, CNTK::DeviceDescriptor::UseDefaultDevice());
+		else
+		{
+			if (!m_stateInputValue)
+				m_stateInputValue = CNTK::MakeSharedObject<CNTK::Value>(CNTK::MakeSharedObject<CNTK::NDArrayView>(
+					m_inputState.Shape().AppendShape({ 1, 1 }), m_stateInput, false));
+			inputs[m_inputState] = m_stateInputValue;
+		}
+	}
+	if (m_bInputActionUsed)
+	{
+		actionToVector(a, m_actionInput);
+		if (!bCPUDevice)
+			inputs[m_inputAction] = CNTK::Value::CreateBatch(m_inputAction.Shape()
+				, m_actionInput, CNTK::DeviceDescriptor::UseDefaultDevice());
+		else
+		{
+			if (!m_actionInputValue)
+				m_actionInputValue = CNTK::MakeSharedObject<CNTK::Value>(CNTK::MakeSharedObject<CNTK::NDArrayView>(
+					m_inputAction.Shape().AppendShape({ 1, 1 }), m_actionInput, false));
+			inputs[m_inputAction] = m_actionInputValue;
+		}
+	}
 }
 
 vector<double>& Network::evaluate(const State* s, const Action* a)
@@ -219,37 +251,91 @@ vector<double>& Network::evaluate(const State* s, const Action* a)
 		{ { m_FunctionPtr->Output(), outputValue } };
 
 	unordered_map<CNTK::Variable, CNTK::ValuePtr> inputs = {};
+	setTupleInputs(s, a, inputs);
+
+	m_FunctionPtr->Evaluate(inputs, outputs, CNTK::DeviceDescriptor::UseDefaultDevice());
+
+	outputValue = outputs[m_FunctionPtr];
+
+	if (!m_outputView)
+	{
+		CNTK::NDShape outputShape = m_FunctionPtr->Output().Shape().AppendShape({ 1
+			, m_output.size() / m_FunctionPtr->Output().Shape().TotalSize() });
+		m_outputView = CNTK::MakeSharedObject<CNTK::NDArrayView>(outputShape, m_output, false);
+	}
+	m_outputView->CopyFrom(*outputValue->Data());
 
-	vector<double> inputState;
+	return m_output;
+}
+
+void Network::gradientWrtAction(const State* s, const Action* a, vector<double>& outputGradient)
+{
+	unordered_map<Variable, ValuePtr> arguments = {};
+	unordered_map<Variable, ValuePtr> gradients = {};
+
+	if (!m_bInputStateUsed || !m_bInputActionUsed)
+		throw std::runtime_error("Can only use gradient() with f(s,a)-form functions");
+
+	setTupleInputs(s, a, arguments);
+
+	gradients[m_inputAction] = nullptr;
+
+	m_FunctionPtr->Gradients(arguments, gradients);
+
+	//copy gradient to cpu vector
+	ValuePtr gradient = gradients[m_inputAction];
+	if (gradient->Shape().TotalSize() != outputGradient.size())
+		throw std::runtime_error("Missmatched length for output vector in gradients()");
+
+	NDArrayViewPtr qParameterGradientCpuArrayView =
+		MakeSharedObject<NDArrayView>(gradient->Shape(), outputGradient, false);
+	qParameterGradientCpuArrayView->CopyFrom(*gradient->Data());
+}
+
+size_t Network::getNumTuples(const vector<double>& s, const vector<double>& a) const
+{
+	size_t numStateVars = m_pNetworkDefinition->getInputStateVariables().size();
+	if (m_bInputStateUsed && numStateVars > 0)
+		return s.size() / numStateVars;
+	size_t numActionVars = m_pNetworkDefinition->getInputActionVariables().size();
+	if (m_bInputActionUsed && numActionVars > 0)
+		return a.size() / numActionVars;
+	return 0;
+}
+
+void Network::evaluate(const vector<double>& s, const vector<double>& a, vector<double>& outputValues)
+{
+	unordered_map<CNTK::Variable, CNTK::ValuePtr> inputs = {};
 	if (m_bInputStateUsed)
 	{
-		stateToVector(s, inputState);
 		inputs[m_inputState] = CNTK::Value::CreateBatch(m_inputState.Shape()
-			, inputState, CNTK::DeviceDescriptor::UseDefaultDevice());
+			, s, CNTK::DeviceDescriptor::UseDefaultDevice());
 	}
-	vector<double> inputAction;
 	if (m_bInputActionUsed)
 	{
-		actionToVector(a, inputAction);
 		inputs[m_inputAction] = CNTK::Value::CreateBatch(m_inputAction.Shape()
-			, inputAction, CNTK::DeviceDescriptor::UseDefaultDevice());
+			, a, CNTK::DeviceDescriptor::UseDefaultDevice());
 	}
 
+	ValuePtr outputValue;
+	unordered_map<CNTK::Variable, CNTK::ValuePtr> outputs =
+		{ { m_FunctionPtr->Output(), outputValue } };
+
 	m_FunctionPtr->Evaluate(inputs, outputs, CNTK::DeviceDescriptor::UseDefaultDevice());
 
 	outputValue = outputs[m_FunctionPtr];
 
-	CNTK::NDShape outputShape = m_FunctionPtr->Output().Shape().AppendShape({ 1
-		, m_output.size() / m_FunctionPtr->Output().Shape().TotalSize() });
+	//copy all the outputs at once
+	size_t numTuples = getNumTuples(s, a);
+	outputValues.resize(numTuples * m_FunctionPtr->Output().Shape().TotalSize());
+	CNTK::NDShape outputShape = m_FunctionPtr->Output().Shape().AppendShape({ 1, numTuples });
 
 	CNTK::NDArrayViewPtr cpuArrayOutput = CNTK::MakeSharedObject<CNTK::NDArrayView>(outputShape
-		, m_output, false);
+		, outputValues, false);
 	cpuArrayOutput->CopyFrom(*outputValue->Data());
-
-	return m_output;
 }
 
-void Network::gradientWrtAction(const State* s, const Action* a, vector<double>& outputGradient)
+void Network::gradientWrtAction(const vector<double>& s, const vector<double>& a, vector<double>& outputGradient)
 {
 	unordered_map<Variable, ValuePtr> arguments = {};
 	unordered_map<Variable, ValuePtr> gradients = {};
@@ -257,21 +343,19 @@ void Network::gradientWrtAction(const State* s, const Action* a, vector<double>&
 	if (!m_bInputStateUsed || !m_bInputActionUsed)
 		throw std::runtime_error("Can only use gradient() with f(s,a)-form functions");
 
-	vector<double> inputState;
-	stateToVector(s, inputState);
 	arguments[m_inputState] = CNTK::Value::CreateBatch(m_inputState.Shape()
-		, inputState, CNTK::DeviceDescriptor::UseDefaultDevice());
-	vector<double> inputAction;
-	actionToVector(a, inputAction);
+		, s, CNTK::DeviceDescriptor::UseDefaultDevice());
 	arguments[m_inputAction] = CNTK::Value::CreateBatch(m_inputAction.Shape()
-		, inputAction, CNTK::DeviceDescriptor::UseDefaultDevice());
+		, a, CNTK::DeviceDescriptor::UseDefaultDevice());
 
 	gradients[m_inputAction] = nullptr;
 
+	//the samples are independent, so the gradient of the sum of the outputs is the gradient of each sample's output
 	m_FunctionPtr->Gradients(arguments, gradients);
 
 	//copy gradient to cpu vector
 	ValuePtr gradient = gradients[m_inputAction];
+	outputGradient.resize(a.size());
 	if (gradient->Shape().TotalSize() != outputGradient.size())
 		throw std::runtime_error("Missmatched length for output vector in gradients()");
 
@@ -2,6 +2,7 @@
 #include <vector>
 #include "CNTKWrapper.h"
 #include "CNTKLibrary.h"
+#include "../Common/named-var-set.h"
 
 using namespace std;
 
@@ -35,8 +36,20 @@ protected:
 
 	unordered_map<CNTK::Parameter, CNTK::FunctionPtr> m_weightTransitions;
 
+	//staging buffers for single-tuple calls. When running on the CPU, the values fed to the network wrap these buffers,
+	//so they are created only once
+	vector<double> m_stateInput;
+	vector<double> m_actionInput;
+	CNTK::ValuePtr m_stateInputValue;
+	CNTK::ValuePtr m_actionInputValue;
+	CNTK::NDArrayViewPtr m_outputView;
+	NamedVarSetPacker m_statePacker;
+	NamedVarSetPacker m_actionPacker;
+
 	void stateToVector(const State* s, vector<double>& stateVector);
 	void actionToVector(const Action* a, vector<double>& actionVector);
+	void setTupleInputs(const State* s, const Action* a, unordered_map<CNTK::Variable, CNTK::ValuePtr>& inputs);
+	size_t getNumTuples(const vector<double>& s, const vector<double>& a) const;
 public:
 	Network(NetworkDefinition* pNetworkDefinition);
 	~Network();
@@ -58,6 +71,9 @@ public:
 	void gradientWrtAction(const State* s, const Action* a, vector<double>& outputValues);
 	void applyGradient(IMinibatch* pMinibatch);
 
+	void evaluate(const vector<double>& s, const vector<double>& a, vector<double>& outputValues);
+	void gradientWrtAction(const vector<double>& s, const vector<double>& a, vector<double>& outputValues);
+
 	//StateActionFunction interface
 	unsigned int getNumOutputs();
 	vector<double>& evaluate(const State* s, const Action* a);
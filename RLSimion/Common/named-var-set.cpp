@@ -227,4 +227,42 @@ void NamedVarSet::addOffset(double offset)
 	{
 		set(i, this->get(i) + offset);
 	}
-}
\ No newline at end of file
+}
+
+
+void NamedVarSetPacker::resolve(const NamedVarSet* pVarSet, const vector<string>& varNames)
+{
+	const Descriptor& descriptor = pVarSet->getDescriptor();
+	m_pDescriptor = &descriptor;
+	m_indices = vector<int>(varNames.size(), -1);
+	m_mins = vector<double>(varNames.size());
+	m_ranges = vector<double>(varNames.size());
+
+	for (size_t i = 0; i < varNames.size(); i++)
+	{
+		for (size_t j = 0; j < descriptor.size(); j++)
+		{
+			if (!strcmp(descriptor[j].getName(), varNames[i].c_str()))
+			{
+				m_indices[i] = (int)j;
+				m_mins[i] = descriptor[j].getMin();
+				m_ranges[i] = std::max(0.01, descriptor[j].getRangeWidth());
+				break;
+			}
+		}
+	}
+}
+
+void NamedVarSetPacker::pack(const NamedVarSet* pVarSet, const vector<string>& varNames, double* pOutput)
+{
+	if (m_pDescriptor != &pVarSet->getDescriptor() || m_indices.size() != varNames.size())
+		resolve(pVarSet, varNames);
+
+	for (size_t i = 0; i < m_indices.size(); i++)
+	{
+		if (m_indices[i] >= 0)
+			pOutput[i] = (pVarSet->get((size_t)m_indices[i]) - m_mins[i]) / m_ranges[i];
+		else
+			pOutput[i] = pVarSet->getNormalized(varNames[i].c_str());
+	}
+}
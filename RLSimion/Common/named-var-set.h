@@ -2,6 +2,7 @@
 
 constexpr auto VAR_NAME_MAX_LENGTH = 128;
 #include <vector>
+#include <string>
 
 class WireHandler;
 class NamedVarSet;
@@ -90,11 +91,27 @@ public:
 	NamedVarProperties* getProperties(size_t i) const { return &m_descriptor[i]; }
 	NamedVarProperties* getProperties(const char* varName) const;
 	Descriptor& getDescriptor() { return m_descriptor; }
+	const Descriptor& getDescriptor() const { return m_descriptor; }
 	Descriptor* getDescriptorPtr() { return &m_descriptor; }
 
 	void addOffset(double offset);
 };
 
+//Writes the normalized values of a list of variables into an array, as getNormalized() would. The index and range of
+//each variable are resolved the first time a set with a given descriptor is packed, so variables are not searched by
+//name on every call
+class NamedVarSetPacker
+{
+	const Descriptor* m_pDescriptor = nullptr;
+	vector<int> m_indices; //-1 if the variable is not in the descriptor (i.e. a wire)
+	vector<double> m_mins;
+	vector<double> m_ranges;
+
+	void resolve(const NamedVarSet* pVarSet, const vector<string>& varNames);
+public:
+	void pack(const NamedVarSet* pVarSet, const vector<string>& varNames, double* pOutput);
+};
+
 using State= NamedVarSet;
 using Action= NamedVarSet;
 using Reward= NamedVarSet;
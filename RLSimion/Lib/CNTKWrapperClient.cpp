@@ -26,17 +26,26 @@
 
 #include "app.h"
 #include "logger.h"
+#include "parameters.h"
+#include "native-network.h"
 
 
 namespace CNTK
 {
 #if defined(__linux__) || defined(_WIN64)
 	DynamicLib DynamicLibCNTK;
+	DynamicLib PreloadedDynamicLibCNTK;
 #endif
 
 	int NumNetworkInstances = 0;
 	WrapperClient::getNetworkDefinitionDLL WrapperClient::getNetworkDefinition = 0;
 	WrapperClient::setDeviceDLL WrapperClient::setDevice = 0;
+	NeuralNetworkBackend Backend = NeuralNetworkBackend::cntk;
+
+	void WrapperClient::setBackend(NeuralNetworkBackend backend)
+	{
+		Backend = backend;
+	}
 
 	//We want to be able to know the requirements even if we are running Badger on a Win-32 machine
 	//so, the only thing we actually don't do on Win-32 is load the dll and retrieve the access point
@@ -46,6 +55,16 @@ namespace CNTK
 #if defined(__linux__) || defined(_WIN64)
 		NumNetworkInstances++;
 
+		if (Backend == NeuralNetworkBackend::native)
+		{
+			//the native backend is linked in this library: no dependencies or architecture requirements
+			if (getNetworkDefinition != NativeNetworkBackend::getNetworkDefinition)
+				Logger::logMessage(MessageType::Info, "Using the native neural network backend");
+			getNetworkDefinition = NativeNetworkBackend::getNetworkDefinition;
+			setDevice = NativeNetworkBackend::setDevice;
+			return;
+		}
+
 		if (!DynamicLibCNTK.IsLoaded())
 
 		{
@@ -117,6 +136,14 @@ namespace CNTK
 		{
 			DynamicLibCNTK.Unload();
 		}
+#endif
+	}
+
+	void WrapperClient::Preload()
+	{
+#if defined(__linux__) || defined(_WIN64)
+		//a handle of its own: Load()/UnLoad() keep working as usual with DynamicLibCNTK
+		PreloadedDynamicLibCNTK.Load(CNTK_WRAPPER_LIB_PATH);
 #endif
 	}
 }
\ No newline at end of file
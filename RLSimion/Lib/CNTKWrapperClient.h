@@ -3,6 +3,7 @@
 
 class INetwork;
 class INetworkDefinition;
+enum class NeuralNetworkBackend;
 namespace tinyxml2 { class XMLElement; }
 
 #if defined(_WIN64)
@@ -22,7 +23,14 @@ namespace CNTK
 		static getNetworkDefinitionDLL getNetworkDefinition;
 		static setDeviceDLL setDevice;
 
+		//Selects the implementation returned by getNetworkDefinition(). Must be called before Load()
+		static void setBackend(NeuralNetworkBackend backend);
+
 		static void Load();
 		static void UnLoad();
+
+		//Loads the wrapper library without requiring a SimionApp. Processes forked afterwards find it already loaded, so
+		//Load() doesn't need to read it from disk again. Used by the launcher daemon
+		static void Preload();
 	};
 }
\ No newline at end of file
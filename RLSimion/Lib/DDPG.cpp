@@ -7,9 +7,16 @@
 #include "logger.h"
 #include "experiment.h"
 #include "worlds/world.h"
+#include "experience-replay.h"
+#include "checkpoint.h"
+#include <algorithm>
 
 DDPG::~DDPG()
 {
+	//the learner thread must be stopped before destroying the networks
+	if (m_pAsyncLearner != nullptr)
+		delete m_pAsyncLearner;
+
 	m_CriticNetworkDefinition->destroy();
 	if (m_pCriticOnlineNetwork!=nullptr)
 		m_pCriticOnlineNetwork->destroy();
@@ -46,10 +53,15 @@ DDPG::DDPG(ConfigNode * pConfigNode)
 	m_inputState = MULTI_VALUE_VARIABLE<STATE_VARIABLE>(pConfigNode, "Input-State", "Set of state variables used as input");
 	m_outputAction = MULTI_VALUE_VARIABLE<ACTION_VARIABLE>(pConfigNode, "Output-Action", "The output action variable");
 	m_learningRate = DOUBLE_PARAM(pConfigNode, "Learning-Rate", "The learning rate at which the agent learns", 0.000001);
+
+	m_bAsynchronousLearning = BOOL_PARAM(pConfigNode, "Asynchronous-Learning", "Train the networks in a separate thread while the simulation runs", false);
+	m_snapshotUpdateFreq = INT_PARAM(pConfigNode, "Snapshot-Update-Freq", "Training steps between updates of the copies of the networks used by the simulation. Only used if Asynchronous-Learning=true", 10);
 }
 
 void DDPG::deferredLoadStep()
 {
+	SimionApp::get()->pCheckpoints->checkNotUsedBy("DDPG");
+
 	size_t minibatchSize = SimionApp::get()->pSimGod->getExperienceReplayUpdateSize();
 	if (minibatchSize == 0)
 		Logger::logMessage(MessageType::Error, "DDPG requires the use of the Experience Replay Buffer technique");
@@ -68,7 +80,6 @@ void DDPG::deferredLoadStep()
 	{
 		m_CriticNetworkDefinition->addInputActionVar(m_outputAction[actionVarIndex]->get());
 	}
-	m_gradientWrtAction = vector<double>(m_outputAction.size());
 
 	//Set critic networks as single-output
 	m_CriticNetworkDefinition->setScalarOutput();
@@ -77,119 +88,181 @@ void DDPG::deferredLoadStep()
 
 	//Critic initialization
 	m_pCriticOnlineNetwork = m_CriticNetworkDefinition->createNetwork(m_learningRate.get(), true); //true because we are going to need gradient calculations for this network
-	SimionApp::get()->registerStateActionFunction("Q", m_pCriticOnlineNetwork);
 	m_pCriticTargetNetwork = m_pCriticOnlineNetwork->clone(false);
 	m_pCriticTargetNetwork->initSoftUpdate(m_tau.get(), m_pCriticOnlineNetwork);
 	m_pCriticMinibatch = m_CriticNetworkDefinition->createMinibatch(minibatchSize);
 
 	//Actor initialization
 	m_pActorOnlineNetwork = m_ActorNetworkDefinition->createNetwork(m_learningRate.get());
-	SimionApp::get()->registerStateActionFunction("Policy", m_pActorOnlineNetwork);
 	m_pActorTargetNetwork = m_pActorOnlineNetwork->clone(false);
 	m_pActorTargetNetwork->initSoftUpdate(m_tau.get(), m_pActorOnlineNetwork);
 	
 	//The size of the target in the minibatch has to match the number of actions to save the gradient wrt an action
 	m_pActorMinibatch = m_ActorNetworkDefinition->createMinibatch(minibatchSize, m_outputAction.size());
+
+	if (m_bAsynchronousLearning.get())
+	{
+		//the simulation thread only uses the snapshots of the online networks
+		m_criticSnapshot.publish(m_pCriticOnlineNetwork->clone());
+		m_actorSnapshot.publish(m_pActorOnlineNetwork->clone());
+		SimionApp::get()->registerStateActionFunction("Q", &m_criticSnapshot);
+		SimionApp::get()->registerStateActionFunction("Policy", &m_actorSnapshot);
+
+		m_pAsyncLearner = new AsyncLearner(SimionApp::get()->pSimGod->getExperienceReplayBufferSize(), minibatchSize
+			, [this](const ExperienceTuple* pTuple) { addTupleToMinibatches(pTuple->s, pTuple->a, pTuple->s_p, pTuple->r); }
+			, [this]()
+		{
+			size_t trainingStep = m_pAsyncLearner->getNumTrainingSteps();
+			train(trainingStep);
+
+			if (trainingStep % std::max(1, m_snapshotUpdateFreq.get()) == 0)
+			{
+				m_criticSnapshot.publish(m_pCriticOnlineNetwork->clone());
+				m_actorSnapshot.publish(m_pActorOnlineNetwork->clone());
+			}
+		});
+		m_pAsyncLearner->start();
+	}
+	else
+	{
+		SimionApp::get()->registerStateActionFunction("Q", m_pCriticOnlineNetwork);
+		SimionApp::get()->registerStateActionFunction("Policy", m_pActorOnlineNetwork);
+	}
 }
 
 double DDPG::selectAction(const State * s, Action * a)
 {
 	double policyOutput;
-	vector<double>& actionValues = m_pActorOnlineNetwork->evaluate(s, a);
+	vector<double>& actionValues = m_pAsyncLearner != nullptr ? m_actorSnapshot.evaluate(s, a) : m_pActorOnlineNetwork->evaluate(s, a);
+
+	//the noise added to all the action variables is generated at once
+	bool bAddNoise = !SimionApp::get()->pExperiment->isEvaluationEpisode();
+	m_noiseSamples.resize(m_outputAction.size());
+	if (bAddNoise)
+		m_policyNoise->getSamples(m_noiseSamples.data(), m_noiseSamples.size());
+
 	for (size_t i = 0; i < m_outputAction.size(); i++)
 	{
 		policyOutput = actionValues[i];
-		if (!SimionApp::get()->pExperiment->isEvaluationEpisode())
-			policyOutput+= m_policyNoise->getSample();
+		if (bAddNoise)
+			policyOutput+= m_noiseSamples[i];
 		a->set(m_outputAction[i]->get(), policyOutput);
 	}
 	return 1.0;
 }
 
+void DDPG::addTupleToMinibatches(const State* s, const Action* a, const State* s_p, double r)
+{
+	//targets and gradients are calculated for the whole minibatches once they are full
+	if (!m_pCriticMinibatch->isFull())
+		m_pCriticMinibatch->addTuple(s, a, s_p, r);
+	if (!m_pActorMinibatch->isFull())
+		m_pActorMinibatch->addTuple(s, a, s_p, r);
+}
+
+void DDPG::train(size_t trainingStep)
+{
+	//both are calculated with the current networks, as if they had been calculated tuple by tuple while replaying
+	calculateCriticTargets();
+	calculateActorGradients();
+
+	updateCritic(trainingStep);
+	updateActor();
+}
+
 double DDPG::update(const State * s, const Action * a, const State * s_p, double r, double behaviorProb)
 {
-	updateCritic(s, a, s_p, r);
-	updateActor(s, a, s_p, r);
-	
+	if (m_pAsyncLearner != nullptr)
+	{
+		//the learner thread samples its own replay buffer
+		if (!SimionApp::get()->pSimGod->bReplayingExperience())
+			m_pAsyncLearner->push(s, a, s_p, r, behaviorProb);
+	}
+	else if (SimionApp::get()->pSimGod->bReplayingExperience())
+		addTupleToMinibatches(s, a, s_p, r);
+	//We only train the networks in direct-experience updates to simplify mini-batching
+	else if (m_pCriticMinibatch->isFull() && m_pActorMinibatch->isFull())
+		train(SimionApp::get()->pExperiment->getExperimentStep());
 	return 0.0;
 }
 
-void DDPG::updateActor(const State* s, const Action* a, const State* s_p, double r)
+void DDPG::actorOutputToCriticInput(const vector<double>& actorOutput, vector<double>& criticInput)
 {
-	if (SimionApp::get()->pSimGod->bReplayingExperience())
+	//the actor outputs absolute values and the critic takes them normalized. Setting them in the action object
+	//clamps them the same way it did when the tuples were processed one by one
+	size_t numActions = m_outputAction.size();
+	criticInput.resize(actorOutput.size());
+	for (size_t tuple = 0; tuple < actorOutput.size() / numActions; tuple++)
 	{
-		double gamma = SimionApp::get()->pSimGod->getGamma();
+		for (size_t i = 0; i < numActions; i++)
+		{
+			m_pActorOutput->set(m_outputAction[i]->get(), actorOutput[tuple * numActions + i]);
+			criticInput[tuple * numActions + i] = m_pActorOutput->getNormalized(m_outputAction[i]->get());
+		}
+	}
+}
 
-		//get pi(s)
-		vector<double>& actionValues = m_pActorTargetNetwork->evaluate(s, a);
+void DDPG::calculateActorGradients()
+{
+	//a = pi(s)
+	m_pActorTargetNetwork->evaluate(m_pActorMinibatch->getInputState(), m_pActorMinibatch->getInputAction(), m_actorOutput);
+	actorOutputToCriticInput(m_actorOutput, m_criticActionInput);
 
-		//a' = pi(s)
-		for (size_t i = 0; i < m_outputAction.size(); i++)
-			m_pActorOutput->set(m_outputAction[i]->get(), actionValues[i]);
+	//gradient = critic->gradient(s, pi(s))
+	vector<double>& gradientWrtAction = m_pActorMinibatch->getOutput();
+	m_pCriticTargetNetwork->gradientWrtAction(m_pActorMinibatch->getInputState(), m_criticActionInput, gradientWrtAction);
 
-		//gradient = critic->gradient(s, pi(s))
-		m_pCriticTargetNetwork->gradientWrtAction(s, m_pActorOutput, m_gradientWrtAction);
+	//gradient = -gradient
+	for (size_t i = 0; i < gradientWrtAction.size(); i++)
+		gradientWrtAction[i] *= -1.0;
+}
 
-		//gradient = -gradient
-		for (size_t i = 0; i < m_outputAction.size(); i++)
-			m_gradientWrtAction[i] *= -1.0;
+void DDPG::calculateCriticTargets()
+{
+	double gamma = SimionApp::get()->pSimGod->getGamma();
+	const vector<double>& nextStates = m_pCriticMinibatch->getInputNextState();
 
-		m_pActorMinibatch->addTuple(s, m_pActorOutput, m_gradientWrtAction);
-	}
-	else if (m_pActorMinibatch->isFull())
-	{
-		m_pActorOnlineNetwork->applyGradient(m_pActorMinibatch);
+	//a' = pi(s_p)
+	m_pActorTargetNetwork->evaluate(nextStates, m_pActorMinibatch->getInputAction(), m_actorOutput);
+	actorOutputToCriticInput(m_actorOutput, m_criticActionInput);
 
-		//if (SimionApp::get()->pExperiment->getExperimentStep() % 10)
-		//{
-		//	m_pActorTargetNetwork->destroy();
-		//	m_pActorTargetNetwork = m_pActorOnlineNetwork->clone();
-		//}
+	//calculate Q'(mu'(s_p))
+	m_pCriticTargetNetwork->evaluate(nextStates, m_criticActionInput, m_criticOutput);
 
-		m_pActorTargetNetwork->softUpdate(m_pActorOnlineNetwork);
-	}
+	//calculate targetvalue= r + gamma*Q(s_p,a). We assume the critic has only one output
+	const vector<double>& rewards = m_pCriticMinibatch->getReward();
+	vector<double>& targetValues = m_pCriticMinibatch->getOutput();
+	for (size_t tuple = 0; tuple < m_pCriticMinibatch->size(); tuple++)
+		targetValues[tuple] = rewards[tuple] + gamma * m_criticOutput[tuple];
 }
 
-void DDPG::updateCritic(const State* s, const Action* a, const State* s_p, double r)
+void DDPG::updateActor()
 {
-	if (SimionApp::get()->pSimGod->bReplayingExperience())
-	{
-		double gamma = SimionApp::get()->pSimGod->getGamma();
-
-		//calculate pi(s_p)
-		vector<double>& actionValues = m_pActorTargetNetwork->evaluate(s_p, a);
+	m_pActorOnlineNetwork->applyGradient(m_pActorMinibatch);
+	m_pActorMinibatch->clear();
 
-		//a' = pi(s_p)
-		for (size_t i = 0; i < m_outputAction.size(); i++)
-			m_pActorOutput->set(m_outputAction[i]->get(), actionValues[i]);
-		
-		//calculate Q'(mu'(s_p))
-		double s_p_value = m_pCriticTargetNetwork->evaluate(s_p, m_pActorOutput)[0]; //we assume only the critic will have only one output
+	//if (SimionApp::get()->pExperiment->getExperimentStep() % 10)
+	//{
+	//	m_pActorTargetNetwork->destroy();
+	//	m_pActorTargetNetwork = m_pActorOnlineNetwork->clone();
+	//}
 
-		//calculate targetvalue= r + gamma*Q(s_p,a)
-		double targetValue = r + gamma * s_p_value;
-
-		//add a new tuple to the minibatch
-		m_pCriticMinibatch->addTuple(s, a, targetValue);
-	}
-	//We only train the network in direct-experience updates to simplify mini-batching
-	else if (m_pCriticMinibatch->isFull())
-	{
-		SimGod* pSimGod = SimionApp::get()->pSimGod.ptr();
+	m_pActorTargetNetwork->softUpdate(m_pActorOnlineNetwork);
+}
 
-		//update the network finally
-		m_pCriticOnlineNetwork->train(m_pCriticMinibatch);
+void DDPG::updateCritic(size_t trainingStep)
+{
+	//update the network finally
+	m_pCriticOnlineNetwork->train(m_pCriticMinibatch);
 
-		//move the target weights toward the online weights
-		//m_pCriticTargetNetwork->softUpdate(m_pCriticOnlineNetwork);
+	//move the target weights toward the online weights
+	//m_pCriticTargetNetwork->softUpdate(m_pCriticOnlineNetwork);
 
-		if (SimionApp::get()->pExperiment->getExperimentStep() % 10)
-		{
-			m_pCriticTargetNetwork->destroy();
-			m_pCriticTargetNetwork = m_pCriticOnlineNetwork->clone();
-		}
+	if (trainingStep % 10)
+	{
+		m_pCriticTargetNetwork->destroy();
+		m_pCriticTargetNetwork = m_pCriticOnlineNetwork->clone();
 	}
-
 }
 
 #endif
@@ -2,6 +2,7 @@
 #if defined(__linux__) || defined(_WIN64)
 #include "simion.h"
 #include "deferred-load.h"
+#include "async-learner.h"
 
 class Noise;
 class INetwork;
@@ -33,19 +34,41 @@ class DDPG : public Simion, DeferredLoad
 	INetwork* m_pActorTargetNetwork= nullptr;
 	IMinibatch* m_pActorMinibatch= nullptr;
 
-	vector<double> m_gradientWrtAction;
+	//buffers used to process the whole minibatch at once
+	vector<double> m_actorOutput;
+	vector<double> m_criticActionInput;
+	vector<double> m_criticOutput;
 
 	CHILD_OBJECT_FACTORY<Noise> m_policyNoise;
+	vector<double> m_noiseSamples;
 	DOUBLE_PARAM m_tau;
 
 	//used to hold the actor's output
 	Action* m_pActorOutput = nullptr;
-	
+
+	//asynchronous learning: the networks are trained in the learner's thread and the simulation uses snapshots of the
+	//online networks
+	BOOL_PARAM m_bAsynchronousLearning;
+	INT_PARAM m_snapshotUpdateFreq;
+	AsyncLearner* m_pAsyncLearner = nullptr;
+	NetworkSnapshot m_actorSnapshot;
+	NetworkSnapshot m_criticSnapshot;
+
+	void addTupleToMinibatches(const State* s, const Action* a, const State* s_p, double r);
+	void train(size_t trainingStep);
+
+	//converts the actions output by the actor into the (normalized) action input of the critic
+	void actorOutputToCriticInput(const vector<double>& actorOutput, vector<double>& criticInput);
+
+	//calculate the targets of the minibatches before any of the networks is updated
+	void calculateActorGradients();
+	void calculateCriticTargets();
+
 	//update policy network
-	void updateActor(const State* s, const Action* a, const State* s_p, double r);
+	void updateActor();
 
 	//update q network
-	void updateCritic(const State* s, const Action* a, const State* s_p, double r);
+	void updateCritic(size_t trainingStep);
 
 public:
 	~DDPG();
@@ -54,11 +77,14 @@ public:
 	//heavy-weight initialization
 	virtual void deferredLoadStep();
 
+
 	//selects an action according to the learned policy's network
 	virtual double selectAction(const State *s, Action *a);
 
 	//updates the critic network and the actor's policy network (both the target and the prediction network)
 	virtual double update(const State *s, const Action *a, const State *s_p, double r, double behaviorProb);
+
+	virtual bool learnsAsynchronously() const { return m_bAsynchronousLearning.get(); }
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #if defined(__linux__) || defined(_WIN64)
 
 #include "simgod.h"
+#include "experience-replay.h"
 #include "logger.h"
 #include "worlds/world.h"
 #include "app.h"
@@ -13,12 +14,16 @@
 #include <algorithm>
 #include "deep-vfa-policy.h"
 #include "config.h"
+#include "checkpoint.h"
 
 #include "../CNTKWrapper/CNTKWrapper.h"
 
 
 DQN::~DQN()
 {
+	//the learner thread must be stopped before destroying the networks
+	if (m_pAsyncLearner) delete m_pAsyncLearner;
+
 	//We need to manually call the NN_DEFINITION destructor
 	m_pNNDefinition->destroy();
 	if (m_pTargetQNetwork) m_pTargetQNetwork->destroy();
@@ -38,12 +43,17 @@ DQN::DQN(ConfigNode* pConfigNode)
 	CNTK::WrapperClient::Load();
 	m_policy = CHILD_OBJECT_FACTORY<DiscreteDeepPolicy>(pConfigNode, "Policy", "The policy");
 	m_pNNDefinition = NN_DEFINITION(pConfigNode, "neural-network", "Neural Network Architecture");
+
+	m_bAsynchronousLearning = BOOL_PARAM(pConfigNode, "Asynchronous-Learning", "Train the networks in a separate thread while the simulation runs", false);
+	m_snapshotUpdateFreq = INT_PARAM(pConfigNode, "Snapshot-Update-Freq", "Training steps between updates of the copy of the network used to select actions. Only used if Asynchronous-Learning=true", 10);
 }
 
 void DQN::deferredLoadStep()
 {
 	//we defer all the heavy-weight initializing stuff and anything that depends on the SimGod
 
+	SimionApp::get()->pCheckpoints->checkNotUsedBy("DQN");
+
 	NamedVarProperties* pProperties = SimionApp::get()->pWorld->getDynamicModel()->getActionDescriptor().getProperties(m_outputAction.get());
 	
 	//set the input-outputs
@@ -53,7 +63,6 @@ void DQN::deferredLoadStep()
 
 	//create the networks
 	m_pOnlineQNetwork = m_pNNDefinition->createNetwork(m_learningRate.get());
-	SimionApp::get()->registerStateActionFunction("Q", m_pOnlineQNetwork);
 	m_pTargetQNetwork = m_pOnlineQNetwork->clone();
 
 	//create the minibatch
@@ -63,11 +72,36 @@ void DQN::deferredLoadStep()
 	if (minibatchSize == 0)
 		Logger::logMessage(MessageType::Error, "Both DQN and Double-DQN require the use of the Experience Replay Buffer technique");
 	m_pMinibatch = m_pNNDefinition->createMinibatch(minibatchSize);
+	m_selectedActionIds = vector<size_t>(minibatchSize);
+
+	if (m_bAsynchronousLearning.get())
+	{
+		//the simulation thread only uses the snapshot of the online network
+		m_onlineQNetworkSnapshot.publish(m_pOnlineQNetwork->clone());
+		SimionApp::get()->registerStateActionFunction("Q", &m_onlineQNetworkSnapshot);
+
+		m_pAsyncLearner = new AsyncLearner(SimionApp::get()->pSimGod->getExperienceReplayBufferSize(), minibatchSize
+			, [this](const ExperienceTuple* pTuple) { addTupleToMinibatch(pTuple->s, pTuple->a, pTuple->s_p, pTuple->r); }
+			, [this]()
+		{
+			train();
+
+			size_t trainingStep = m_pAsyncLearner->getNumTrainingSteps();
+			int targetUpdateFreq = SimionApp::get()->pSimGod->getTargetFunctionUpdateFreq();
+			if (targetUpdateFreq && trainingStep % targetUpdateFreq == 0)
+				updateTargetNetwork();
+			if (trainingStep % std::max(1, m_snapshotUpdateFreq.get()) == 0)
+				m_onlineQNetworkSnapshot.publish(m_pOnlineQNetwork->clone());
+		});
+		m_pAsyncLearner->start();
+	}
+	else
+		SimionApp::get()->registerStateActionFunction("Q", m_pOnlineQNetwork);
 }
 
 double DQN::selectAction(const State * s, Action * a)
 {
-	vector<double>& m_Q_s = m_pOnlineQNetwork->evaluate(s, a);
+	vector<double>& m_Q_s = m_pAsyncLearner ? m_onlineQNetworkSnapshot.evaluate(s, a) : m_pOnlineQNetwork->evaluate(s, a);
 
 	size_t selectedAction = m_policy->selectAction(m_Q_s);
 
@@ -82,54 +116,90 @@ INetwork* DQN::getQNetworkForTargetActionSelection()
 	return m_pTargetQNetwork;
 }
 
-double DQN::update(const State * s, const Action * a, const State * s_p, double r, double behaviorProb)
+void DQN::calculateTargetValues()
 {
-	if (SimionApp::get()->pSimGod->bReplayingExperience())
+	double gamma = SimionApp::get()->pSimGod->getGamma();
+	size_t numOutputs = m_pMinibatch->outputSize();
+	const vector<double>& nextStates = m_pMinibatch->getInputNextState();
+	const vector<double>& actions = m_pMinibatch->getInputAction();
+	const vector<double>& rewards = m_pMinibatch->getReward();
+
+	//get Q(s_p) for all the tuples (target/online-weights)
+	getQNetworkForTargetActionSelection()->evaluate(nextStates, actions, m_Q_s_p);
+
+	//estimate Q(s_p, argMaxQ; target-weights or online-weights)
+	//THIS is the only real difference between DQN and Double-DQN
+	//We do the prediction step again only if using Double-DQN (the prediction network
+	//will be different to the online network)
+	const vector<double>* pTarget_Q_s_p = &m_Q_s_p;
+	if (getQNetworkForTargetActionSelection() != m_pTargetQNetwork)
 	{
-		double gamma = SimionApp::get()->pSimGod->getGamma();
+		m_pTargetQNetwork->evaluate(nextStates, actions, m_target_Q_s_p);
+		pTarget_Q_s_p = &m_target_Q_s_p;
+	}
 
-		//get Q(s_p) for the current tuple (target/online-weights)
-		vector<double> & m_Q_s_p = getQNetworkForTargetActionSelection()->evaluate(s_p, a);
+	//get the current value of Q(s) directly in the minibatch's output
+	vector<double>& Q_s = m_pMinibatch->getOutput();
+	m_pOnlineQNetwork->evaluate(m_pMinibatch->getInputState(), actions, Q_s);
 
+	for (size_t tuple = 0; tuple < m_pMinibatch->size(); tuple++)
+	{
 		//calculate argmaxQ(s_p)
-		size_t argmaxQ = distance(m_Q_s_p.begin(), max_element(m_Q_s_p.begin(), m_Q_s_p.end()));
+		vector<double>::const_iterator first = m_Q_s_p.begin() + tuple * numOutputs;
+		size_t argmaxQ = distance(first, max_element(first, first + numOutputs));
+
+		//change the target value only for the selected action, the rest remain the same
+		//targetvalue= r + gamma*Q(s_p,a)
+		Q_s[tuple * numOutputs + m_selectedActionIds[tuple]] =
+			rewards[tuple] + gamma * (*pTarget_Q_s_p)[tuple * numOutputs + argmaxQ];
+	}
+}
 
-		//estimate Q(s_p, argMaxQ; target-weights or online-weights)
-		//THIS is the only real difference between DQN and Double-DQN
-		//We do the prediction step again only if using Double-DQN (the prediction network
-		//will be different to the online network)
-		if (getQNetworkForTargetActionSelection() != m_pTargetQNetwork)
-			m_Q_s_p= m_pTargetQNetwork->evaluate(s_p, a);
+void DQN::addTupleToMinibatch(const State* s, const Action* a, const State* s_p, double r)
+{
+	//the target values are calculated for the whole minibatch once it is full
+	if (m_pMinibatch->isFull())
+		return;
+
+	//store the index of the action taken
+	m_selectedActionIds[m_pMinibatch->numTuples()] =
+		m_pNNDefinition->getClosestOutputIndex(a->get(m_outputAction.get()));
+	m_pMinibatch->addTuple(s, a, s_p, r);
+}
 
-		//calculate targetvalue= r + gamma*Q(s_p,a)
-		double targetValue = r + gamma * m_Q_s_p[argmaxQ];
+void DQN::train()
+{
+	calculateTargetValues();
 
-		//get the current value of Q(s)
-		vector<double> & m_Q_s = m_pOnlineQNetwork->evaluate(s, a);
+	//update the network finally
+	m_pOnlineQNetwork->train(m_pMinibatch);
+}
 
-		//change the target value only for the selecte action, the rest remain the same
-		//store the index of the action taken
-		size_t selectedActionId =
-			m_pNNDefinition->getClosestOutputIndex(a->get(m_outputAction.get()));
-		m_Q_s[selectedActionId] = targetValue;
+void DQN::updateTargetNetwork()
+{
+	if (m_pTargetQNetwork)
+		m_pTargetQNetwork->destroy();
+	m_pTargetQNetwork = m_pOnlineQNetwork->clone();
+}
 
-		m_pMinibatch->addTuple(s, a, m_Q_s);
+double DQN::update(const State * s, const Action * a, const State * s_p, double r, double behaviorProb)
+{
+	if (m_pAsyncLearner)
+	{
+		//the learner thread samples its own replay buffer
+		if (!SimionApp::get()->pSimGod->bReplayingExperience())
+			m_pAsyncLearner->push(s, a, s_p, r, behaviorProb);
 	}
+	else if (SimionApp::get()->pSimGod->bReplayingExperience())
+		addTupleToMinibatch(s, a, s_p, r);
 	//We only train the network in direct-experience updates to simplify mini-batching
 	else if (m_pMinibatch->isFull())
 	{
-		SimGod* pSimGod = SimionApp::get()->pSimGod.ptr();
-
-		//update the network finally
-		m_pOnlineQNetwork->train(m_pMinibatch);
+		train();
 
 		//update the prediction network
-		if (pSimGod->bUpdateFrozenWeightsNow())
-		{
-			if (m_pTargetQNetwork)
-				m_pTargetQNetwork->destroy();
-			m_pTargetQNetwork = m_pOnlineQNetwork->clone();
-		}
+		if (SimionApp::get()->pSimGod->bUpdateFrozenWeightsNow())
+			updateTargetNetwork();
 	}
 	return 1.0; //TODO: Estimate the TD-error??
 }
@@ -5,6 +5,7 @@
 #include "simion.h"
 #include "parameters.h"
 #include "deferred-load.h"
+#include "async-learner.h"
 
 class INetwork;
 class DiscreteDeepPolicy;
@@ -29,9 +30,29 @@ protected:
 	INetwork* m_pOnlineQNetwork= nullptr;
 	IMinibatch* m_pMinibatch = nullptr;
 
+	//index of the action taken in each tuple of the minibatch
+	vector<size_t> m_selectedActionIds;
+	//Q(s_p) estimated by the network that selects the target action and by the target network
+	vector<double> m_Q_s_p;
+	vector<double> m_target_Q_s_p;
+
 	CHILD_OBJECT_FACTORY<DiscreteDeepPolicy> m_policy;
 
+	//asynchronous learning: the networks are trained in the learner's thread and actions are selected with a snapshot
+	//of the online network
+	BOOL_PARAM m_bAsynchronousLearning;
+	INT_PARAM m_snapshotUpdateFreq;
+	AsyncLearner* m_pAsyncLearner = nullptr;
+	NetworkSnapshot m_onlineQNetworkSnapshot;
+
 	virtual INetwork* getQNetworkForTargetActionSelection();
+
+	//calculates the target values of all the tuples in the minibatch with one call to each network
+	void calculateTargetValues();
+
+	void addTupleToMinibatch(const State* s, const Action* a, const State* s_p, double r);
+	void train();
+	void updateTargetNetwork();
 	
 public:
 	~DQN();
@@ -39,11 +60,14 @@ public:
 
 	virtual void deferredLoadStep();
 
+
 	//selects an according to the learned policy pi(a|s)
 	virtual double selectAction(const State *s, Action *a);
 
 	//updates the critic and the actor
 	virtual double update(const State *s, const Action *a, const State *s_p, double r, double behaviorProb);
+
+	virtual bool learnsAsynchronously() const { return m_bAsynchronousLearning.get(); }
 };
 
 class DoubleDQN : public DQN
@@ -117,7 +117,7 @@ void IncrementalNaturalActorCritic::updateValue(const State *s, const Action *a,
 	m_e_v->addFeatureList(m_s_features);
 
 	//4. v = v + alpha_v*td*e_v
-	m_pVFunction->add(m_e_v.ptr(), alpha_v*m_td);
+	m_pVFunction->add(m_e_v->getFeatures(), alpha_v*m_td);
 }
 
 void IncrementalNaturalActorCritic::updatePolicy(const State* s, const State* a, const State *s_p, double r)
@@ -174,7 +174,7 @@ void IncrementalNaturalActorCritic::updatePolicy(const State* s, const State* a,
 //#endif // DEBUG
 
 		m_w[i]->addFeatureList(m_grad_u, -1.0*alpha_v*innerprod);
-		m_w[i]->addFeatureList(m_e_u[i], alpha_v*m_td);
+		m_w[i]->addFeatureList(m_e_u[i]->getFeatures(), alpha_v*m_td);
 
 //#ifdef _DEBUG
 //		double avg_w = 0;
@@ -120,18 +120,17 @@ void OffPolicyActorCritic::updateValue(const State *s, const Action *a, const St
 	m_e_v->update(gamma);
 	m_e_v->addFeatureList(m_s_features, 1.0);
 //	m_e_v->mult(m_rho);
-	m_e_v->applyThreshold(m_e_v->getTreshold());
 
 	for (unsigned int i = 0; i < m_policies.size(); i++)
 	{
 		if (SimionApp::get()->pExperiment->isFirstStep())
 			m_w[i]->clear();
 
-		m_pVFunction->add(m_e_v.ptr(), m_td*alpha_v);
-		double factor = -alpha_v * gamma * (1.0 - m_e_v->getLambda()) * m_w[i]->innerProduct(m_e_v.ptr());
+		m_pVFunction->add(m_e_v->getFeatures(), m_td*alpha_v);
+		double factor = -alpha_v * gamma * (1.0 - m_e_v->getLambda()) * m_w[i]->innerProduct(m_e_v->getFeatures());
 		m_pVFunction->add(m_s_features, factor);
 
-		m_w[i]->addFeatureList(m_e_v.ptr(), alpha_w * m_td);
+		m_w[i]->addFeatureList(m_e_v->getFeatures(), alpha_w * m_td);
 		factor = -alpha_w * m_w[i]->innerProduct(m_s_features);
 		m_w[i]->addFeatureList(m_s_features, factor);
 	}
@@ -158,7 +157,7 @@ void OffPolicyActorCritic::updatePolicy(const State* s, const State* a, const St
 		m_e_u[i]->update(m_rho*gamma);
 		m_e_u[i]->addFeatureList(m_grad_u, m_rho);
 
-		m_policies[i]->addFeatures(m_e_u[i], alpha_u*m_td);
+		m_policies[i]->addFeatures(m_e_u[i]->getFeatures(), alpha_u*m_td);
 	}
 }
 
@@ -47,7 +47,7 @@ void Actor::deferredLoadStep()
 					{
 						m_policyLearners[actorActionIndex]->getPolicy()->getDetPolicyStateVFA()->getStateFeatureMap()->getFeatureStateAction(i, s, a);
 						m_pInitController->selectAction(s, a);
-						(*pWeights)[i] = a->get(m_pInitController->getOutputAction(actionIndex));
+						pWeights->set(i, a->get(m_pInitController->getOutputAction(actionIndex)));
 					}
 				}
 			}
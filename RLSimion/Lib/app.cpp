@@ -3,6 +3,9 @@
 #include "worlds/world.h"
 #include "experiment.h"
 #include "simgod.h"
+#include "checkpoint.h"
+#include "log-replay.h"
+#include "evaluation-workers.h"
 #include "config.h"
 #include "utils.h"
 #include "function-sampler.h"
@@ -51,6 +54,18 @@ SimionApp::SimionApp(ConfigNode* pConfigNode)
 	//Last, the SimGod was created to create and control all the simions
 	pSimGod = CHILD_OBJECT<SimGod>(pConfigNode, "SimGod"
 		, "The omniscient class that controls all aspects of the simulation process");
+
+	//And it saved its progress every now and then, just in case
+	pCheckpoints = CHILD_OBJECT<CheckpointManager>(pConfigNode, "Checkpoints"
+		, "Periodic checkpoints of the learned state used to resume interrupted experiments", true);
+
+	//Or it learned from the experience of its ancestors
+	pLogReplay = CHILD_OBJECT<LogReplay>(pConfigNode, "Log-Replay"
+		, "Training episodes replayed from the logs of previous experiments instead of simulated", true);
+
+	//And it didn't wait for the evaluations to end
+	pEvaluationWorkers = CHILD_OBJECT<EvaluationWorkers>(pConfigNode, "Evaluation-Workers"
+		, "Worker processes that run evaluation episodes in parallel with training", true);
 }
 
 SimionApp::~SimionApp()
@@ -147,6 +162,12 @@ bool SimionApp::isExecutedRemotely()
 	return m_bRemoteExecution;
 }
 
+void SimionApp::setOffscreenRendering(bool offscreen, unsigned int frameDecimation)
+{
+	m_bOffscreenRendering = offscreen;
+	m_frameDecimation = frameDecimation;
+}
+
 void SimionApp::setConfigFile(string configFile)
 {
 	//we provide the path to the xml configuration file so that the logger saves its log files in the directory
@@ -274,12 +295,25 @@ void SimionApp::run()
 	double probability;
 	pLogger->addVarToStats<double>("reward", "r", r);
 
+	//time spent in each phase of the step
+	StepProfiler& profiler = pLogger->getProfiler();
+	if (pLogger->isStepProfilingEnabled())
+		profiler.init(pLogger.ptr(), pSimGod->getNumSimions());
+
 	//load stuff we don't want to be loaded in the constructors for faster construction
 	pSimGod->deferredLoad();
 	Logger::logMessage(MessageType::Info, "Deferred load step finished");
 
+	//map the logs to be replayed
+	if (pLogReplay->bUsing())
+		pLogReplay->init(pWorld->getDynamicModel()->getStateDescriptor()
+			, pWorld->getDynamicModel()->getActionDescriptor(), pWorld->getRewardVector()->getDescriptor());
+
+	//resume the experiment if it was interrupted
+	pCheckpoints->restore();
+
 	//load the scene and initialize visual objects
-	if (!m_bRemoteExecution)
+	if (!m_bRemoteExecution || m_bOffscreenRendering)
 	{
 		//load the scene
 		string sceneFile = pWorld->getDynamicModel()->getWorldSceneFile();
@@ -293,44 +327,112 @@ void SimionApp::run()
 
 	Logger::logMessage(MessageType::Info, "Simulation begins");
 
-	//episodes
-	for (pExperiment->nextEpisode(); pExperiment->isValidEpisode(); pExperiment->nextEpisode())
+	//evaluation episodes can be run by worker processes, but not if the scene is rendered
+	bool bEvaluationWorkers = pEvaluationWorkers->bUsing() && m_bRemoteExecution && !m_bOffscreenRendering;
+
+	auto runEpisode = [&]()
 	{
 		pWorld->reset(s);
 
 		//steps per episode
 		for (pExperiment->nextStep(); pExperiment->isValidStep(); pExperiment->nextStep())
 		{
-			//a= pi(s)
-			probability = pSimGod->selectAction(s, a);
+			{
+				ProfilerScope stepScope(profiler, StepProfiler::Step);
+
+				//a= pi(s)
+				{
+					ProfilerScope scope(profiler, StepProfiler::SelectAction);
+					probability = pSimGod->selectAction(s, a);
+				}
 
-			//s_p= f(s,a); r= R(s');
-			r = pWorld->executeAction(s, a, s_p);
+				//s_p= f(s,a); r= R(s');
+				{
+					ProfilerScope scope(profiler, StepProfiler::ExecuteAction);
+					r = pWorld->executeAction(s, a, s_p);
+				}
+
+				//update god's policy and value estimation
+				{
+					ProfilerScope scope(profiler, StepProfiler::Update);
+					pSimGod->update(s, a, s_p, r, probability);
+				}
+			}
+			//the profiler stats are logged with the step, so the times measured so far are closed before logging it
+			profiler.endStep();
 
-			//update god's policy and value estimation
-			pSimGod->update(s, a, s_p, r, probability);
+			{
+				ProfilerScope stepScope(profiler, StepProfiler::Step);
 
-			//log tuple <s,a,s',r> and stats
-			pExperiment->timestep(s, a, s_p, pWorld->getRewardVector());
-			//we need the complete reward vector for logging
+				//log tuple <s,a,s',r> and stats
+				//we need the complete reward vector for logging
+				{
+					ProfilerScope scope(profiler, StepProfiler::Log);
+					pExperiment->timestep(s, a, s_p, pWorld->getRewardVector());
+				}
 
-			//do experience replay if enabled
-			pSimGod->postUpdate();
+				//do experience replay if enabled
+				{
+					ProfilerScope scope(profiler, StepProfiler::PostUpdate);
+					pSimGod->postUpdate();
+				}
+			}
 
-			if (!m_bRemoteExecution)
+			if (!m_bRemoteExecution || m_bOffscreenRendering)
 				updateScene(s, a);
 
 			//s= s'
 			s->copy(s_p);
 		}
+	};
+
+	//episodes
+	for (pExperiment->nextEpisode(); pExperiment->isValidEpisode(); pExperiment->nextEpisode())
+	{
+		if (pLogReplay->bUsing() && !pExperiment->isEvaluationEpisode())
+			runReplayedEpisode(s, a, s_p);
+		else if (bEvaluationWorkers && pExperiment->isEvaluationEpisode())
+			pEvaluationWorkers->runEpisode(runEpisode);
+		else
+			runEpisode();
+
+		if (bEvaluationWorkers)
+			pEvaluationWorkers->update();
+		pCheckpoints->episodeFinished();
 	}
+	pEvaluationWorkers->waitAll();
+	pCheckpoints->experimentFinished();
 	Logger::logMessage(MessageType::Info, "Simulation finished");
+	profiler.logSummary();
 
 	delete s;
 	delete s_p;
 	delete a;
 }
 
+void SimionApp::runReplayedEpisode(State* s, Action* a, State* s_p)
+{
+	Reward* pReward = pWorld->getRewardVector();
+	pLogReplay->nextEpisode(s);
+
+	for (pExperiment->nextStep(); pExperiment->isValidStep(); pExperiment->nextStep())
+	{
+		//the episode ends with the log's
+		if (!pLogReplay->nextStep(a, s_p, pReward))
+		{
+			pExperiment->setTerminalState();
+			continue;
+		}
+
+		//the probability with which the logged actions were selected is not logged
+		pSimGod->update(s, a, s_p, pReward->getSumValue(), 1.0);
+		pExperiment->timestep(s, a, s_p, pReward);
+		pSimGod->postUpdate();
+
+		s->copy(s_p);
+	}
+}
+
 void SimionApp::initRenderer(string sceneFile, State* s, Action* a)
 {
 	char arguments[] = "RLSimion";
@@ -342,7 +444,12 @@ void SimionApp::initRenderer(string sceneFile, State* s, Action* a)
 		return;
 
 	m_pRenderer = new Renderer();
-	m_pRenderer->init(1, &argv, 800, 600);
+	m_pRenderer->init(1, &argv, 800, 600, m_bOffscreenRendering);
+	if (m_bOffscreenRendering)
+	{
+		m_pRenderer->setFrameDecimation(m_frameDecimation);
+		m_pRenderer->setFrameCaptureOutputPrefix(removeExtension(m_configFile) + ".frame");
+	}
 
 	//resize the main viewport
 	double mainViewPortMinX = 0.0, mainViewPortMinY = 0.3, mainViewPortMaxX = 0.7, mainViewPortMaxY = 1.0;
@@ -430,7 +537,8 @@ void SimionApp::initRenderer(string sceneFile, State* s, Action* a)
 		objectArranger.tag2DObjects(objects, functionViewPort);
 	}
 
-	m_pInputHandler = new FreeCameraInputHandler();
+	if (!m_bOffscreenRendering)
+		m_pInputHandler = new FreeCameraInputHandler();
 
 	m_timer.start();
 }
@@ -480,6 +588,17 @@ void SimionApp::updateScene(State* s, Action* a)
 	//check the renderer has been initialized
 	if (!m_pRenderer) return;
 
+	//Update the function views each m_functionViewUpdateStepFreq steps
+	if ((pExperiment->getExperimentStep()-1) % m_functionViewUpdateStepFreq == 0)
+		m_bFunctionViewsOutdated = true;
+
+	//frames skipped because of frame decimation don't need the scene to be updated
+	if (!m_pRenderer->isFrameDue())
+	{
+		m_pRenderer->skipFrame();
+		return;
+	}
+
 	//update progress text
 	m_pProgressText->set(string("Episode: ") + std::to_string(pExperiment->getEpisodeIndex())
 		+ string(" Step: ") + std::to_string(pExperiment->getStep()));
@@ -497,17 +616,18 @@ void SimionApp::updateScene(State* s, Action* a)
 		m_pRenderer->updateBinding(varName, value);
 	}
 
-	//Update the function views each m_functionViewUpdateStepFreq steps
-	if ((pExperiment->getExperimentStep()-1) % m_functionViewUpdateStepFreq == 0)
+	if (m_bFunctionViewsOutdated)
 	{
 		for (auto functionIt : m_pFunctionViews)
 		{
 			const vector<double>& sampledValues = functionIt.second->sample();
 			functionIt.first->update(sampledValues);
 		}
+		m_bFunctionViewsOutdated = false;
 	}
 	//render the image
-	m_pInputHandler->handleInput();
+	if (m_pInputHandler)
+		m_pInputHandler->handleInput();
 	m_pRenderer->draw();
 }
 
@@ -26,6 +26,9 @@ class Experiment;
 class SimGod;
 class StateActionFunction;
 class Wire;
+class CheckpointManager;
+class LogReplay;
+class EvaluationWorkers;
 
 enum Device{ CPU, GPU };
 
@@ -57,6 +60,10 @@ private:
 	bool m_bRemoteExecution = true;
 #endif
 
+	//offscreen rendering: the scene is rendered without showing a window (also in remote runs) and frames are saved
+	bool m_bOffscreenRendering = false;
+	unsigned int m_frameDecimation = 1;
+
 	//requirements/support
 	unsigned int m_numCPUCores = 1;
 	string m_architecture = ""; //required architecture. None if not set
@@ -75,6 +82,9 @@ public:
 	CHILD_OBJECT<World> pWorld;
 	CHILD_OBJECT<Experiment> pExperiment;
 	CHILD_OBJECT<SimGod> pSimGod;
+	CHILD_OBJECT<CheckpointManager> pCheckpoints;
+	CHILD_OBJECT<LogReplay> pLogReplay;
+	CHILD_OBJECT<EvaluationWorkers> pEvaluationWorkers;
 
 	//Drawable functions can be added in initialization and drawn if "-local" argument is set
 	void registerStateActionFunction(string name, StateActionFunction* pFunction);
@@ -107,6 +117,9 @@ public:
 	void setExecutedRemotely(bool remote);
 	bool isExecutedRemotely();
 
+	//only one of every frameDecimation steps is rendered and captured
+	void setOffscreenRendering(bool offscreen, unsigned int frameDecimation = 1);
+
 	void setNumCPUCores(unsigned int numCPUCores) { m_numCPUCores = numCPUCores; }
 	unsigned int getNumCPUCores() { return m_numCPUCores; }
 
@@ -127,6 +140,7 @@ private:
 
 	const int m_numSamplesPerDim = 16;
 	const unsigned int m_functionViewUpdateStepFreq = 100;
+	bool m_bFunctionViewsOutdated = false; //set until the next frame rendered
 	unordered_map<FunctionViewer*, FunctionSampler*> m_pFunctionViews;
 	vector<FunctionSampler*> m_pFunctionSamplers;
 	void initFunctionSamplers(State* s, Action* a);
@@ -137,6 +151,9 @@ private:
 
 	void updateScene(State* s, Action* a);
 
+	//training episode replayed from the logs instead of simulated
+	void runReplayedEpisode(State* s, Action* a, State* s_p);
+
 public:
 	vector<FunctionSampler*> getFunctionSamplers() { return m_pFunctionSamplers; }
 };
@@ -0,0 +1,184 @@
+#include "async-learner.h"
+#include "experience-replay.h"
+#include "logger.h"
+#include "app.h"
+#include "evaluation-workers.h"
+#include "../CNTKWrapper/CNTKWrapper.h"
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+ExperienceQueue::ExperienceQueue(size_t capacity)
+{
+	//one slot is always left free to tell a full queue from an empty one
+	m_capacity = capacity + 1;
+	m_pTuples = new ExperienceTuple[m_capacity];
+	m_head = 0;
+	m_tail = 0;
+}
+
+ExperienceQueue::~ExperienceQueue()
+{
+	delete[] m_pTuples;
+}
+
+bool ExperienceQueue::push(const State* s, const Action* a, const State* s_p, double r, double probability)
+{
+	size_t tail = m_tail.load(memory_order_relaxed);
+	size_t nextTail = (tail + 1) % m_capacity;
+	if (nextTail == m_head.load(memory_order_acquire))
+		return false;
+
+	m_pTuples[tail].copy(s, a, s_p, r, probability);
+	m_tail.store(nextTail, memory_order_release);
+	return true;
+}
+
+ExperienceTuple* ExperienceQueue::front()
+{
+	size_t head = m_head.load(memory_order_relaxed);
+	if (head == m_tail.load(memory_order_acquire))
+		return nullptr;
+	return &m_pTuples[head];
+}
+
+void ExperienceQueue::pop()
+{
+	size_t head = m_head.load(memory_order_relaxed);
+	m_head.store((head + 1) % m_capacity, memory_order_release);
+}
+
+
+void NetworkSnapshot::publish(INetwork* pNetwork)
+{
+	shared_ptr<INetwork> pNewNetwork(pNetwork, [](INetwork* pOldNetwork) { pOldNetwork->destroy(); });
+	atomic_store(&m_pNetwork, pNewNetwork);
+}
+
+shared_ptr<INetwork> NetworkSnapshot::get() const
+{
+	return atomic_load(&m_pNetwork);
+}
+
+unsigned int NetworkSnapshot::getNumOutputs()
+{
+	return get()->getNumOutputs();
+}
+
+vector<double>& NetworkSnapshot::evaluate(const State* s, const Action* a)
+{
+	//the output is copied because the snapshot may be destroyed as soon as a new one is published
+	shared_ptr<INetwork> pNetwork = get();
+	m_output = pNetwork->evaluate(s, a);
+	return m_output;
+}
+
+const vector<string>& NetworkSnapshot::getInputStateVariables()
+{
+	return get()->getInputStateVariables();
+}
+
+const vector<string>& NetworkSnapshot::getInputActionVariables()
+{
+	return get()->getInputActionVariables();
+}
+
+
+AsyncLearner::AsyncLearner(size_t bufferSize, size_t minibatchSize, function<void(const ExperienceTuple*)> addTuple
+	, function<void()> train)
+	: m_queue(bufferSize), m_randomGenerator((unsigned int)rand())
+{
+	//the generator is seeded from rand() so that the sampled minibatches depend on the experiment's random seed
+	if (bufferSize == 0 || minibatchSize == 0)
+		throw runtime_error("Asynchronous learning requires the use of the Experience Replay Buffer technique");
+
+	m_bufferSize = bufferSize;
+	m_minibatchSize = minibatchSize;
+	m_pReplayBuffer = new ExperienceTuple[m_bufferSize];
+	m_addTuple = addTuple;
+	m_train = train;
+	m_numTrainingSteps = 0;
+	m_bExit = false;
+	m_bFailed = false;
+}
+
+AsyncLearner::~AsyncLearner()
+{
+	m_bExit = true;
+	if (m_thread.joinable())
+		m_thread.join();
+
+	delete[] m_pReplayBuffer;
+}
+
+void AsyncLearner::start()
+{
+	//a worker forked while the learner thread holds a lock (i.e., in the allocator) would wait for it forever: the
+	//thread isn't copied to the child process
+	SimionApp* pApp = SimionApp::get();
+	if (pApp != nullptr && pApp->pEvaluationWorkers.ptr() != nullptr && pApp->pEvaluationWorkers->bUsing())
+		Logger::logMessage(MessageType::Error, "Evaluation-Workers can't be used with Asynchronous-Learning");
+
+	Logger::logMessage(MessageType::Info, "Starting asynchronous learner thread");
+	m_thread = thread(&AsyncLearner::learnerLoop, this);
+}
+
+void AsyncLearner::push(const State* s, const Action* a, const State* s_p, double r, double probability)
+{
+	if (m_bFailed.load(memory_order_acquire))
+		rethrow_exception(m_pException);
+
+	if (!m_queue.push(s, a, s_p, r, probability) && m_numDroppedTuples++ == 0)
+		Logger::logMessage(MessageType::Warning
+			, "The asynchronous learner can't keep up with the simulation: experience tuples are being dropped");
+}
+
+void AsyncLearner::receiveTuples()
+{
+	ExperienceTuple* pTuple;
+	while ((pTuple = m_queue.front()) != nullptr)
+	{
+		m_pReplayBuffer[m_currentPosition].copy(pTuple->s, pTuple->a, pTuple->s_p, pTuple->r, pTuple->probability);
+		m_queue.pop();
+
+		m_currentPosition = (m_currentPosition + 1) % m_bufferSize;
+		if (m_numTuples < m_bufferSize)
+			++m_numTuples;
+		++m_numReceivedTuples;
+	}
+}
+
+void AsyncLearner::learnerLoop()
+{
+	try
+	{
+		size_t minNumTuplesForUpdate = std::min(m_bufferSize, m_minUpdateSizeTimes * m_minibatchSize);
+
+		while (!m_bExit)
+		{
+			receiveTuples();
+
+			//as in synchronous learning, the first training step is done once the buffer has enough tuples, and then one
+			//for each new tuple
+			if (m_numTuples < minNumTuplesForUpdate
+				|| m_numTrainingSteps + minNumTuplesForUpdate > m_numReceivedTuples)
+			{
+				//wait for the simulation to provide new experience
+				this_thread::sleep_for(chrono::microseconds(100));
+				continue;
+			}
+
+			uniform_int_distribution<size_t> randomIndex(0, m_numTuples - 1);
+			for (size_t i = 0; i < m_minibatchSize; i++)
+				m_addTuple(&m_pReplayBuffer[randomIndex(m_randomGenerator)]);
+
+			++m_numTrainingSteps;
+			m_train();
+		}
+	}
+	catch (...)
+	{
+		m_pException = current_exception();
+		m_bFailed.store(true, memory_order_release);
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <functional>
+#include <exception>
+#include "../Common/state-action-function.h"
+using namespace std;
+
+class ExperienceTuple;
+class INetwork;
+
+//Single-producer/single-consumer queue of experience tuples. Neither push() nor front()/pop() block: if the queue is
+//full, push() drops the tuple and returns false
+class ExperienceQueue
+{
+	ExperienceTuple* m_pTuples = nullptr;
+	size_t m_capacity = 0;
+	atomic<size_t> m_head; //next tuple to be read, only written by the consumer
+	atomic<size_t> m_tail; //next free slot, only written by the producer
+public:
+	ExperienceQueue(size_t capacity);
+	virtual ~ExperienceQueue();
+
+	bool push(const State* s, const Action* a, const State* s_p, double r, double probability);
+
+	//returns the oldest tuple in the queue or nullptr if it is empty. The tuple remains valid until pop() is called
+	ExperienceTuple* front();
+	void pop();
+};
+
+//Copy of a network used by the simulation thread while the learner thread trains the online network. Publishing a new
+//copy only swaps a shared pointer, so neither thread waits for the other. evaluate() must be called from one thread
+class NetworkSnapshot : public StateActionFunction
+{
+	shared_ptr<INetwork> m_pNetwork;
+	vector<double> m_output;
+public:
+	NetworkSnapshot() = default;
+	virtual ~NetworkSnapshot() = default;
+
+	//takes ownership of the network, which is destroyed once no thread is using it
+	void publish(INetwork* pNetwork);
+	shared_ptr<INetwork> get() const;
+
+	//StateActionFunction interface
+	unsigned int getNumOutputs();
+	vector<double>& evaluate(const State* s, const Action* a);
+	const vector<string>& getInputStateVariables();
+	const vector<string>& getInputActionVariables();
+};
+
+//Trains a deep learner in a dedicated thread. The simulation thread pushes its experience tuples with push() and the
+//learner thread moves them to its own replay buffer, fills a minibatch with randomly sampled tuples (calling addTuple
+//for each of them) and then calls train(). The learner does at most one training step per tuple received, the same
+//rate as when training synchronously, but the simulation doesn't have to wait for it
+class AsyncLearner
+{
+	ExperienceQueue m_queue;
+
+	ExperienceTuple* m_pReplayBuffer = nullptr;
+	size_t m_bufferSize = 0;
+	size_t m_numTuples = 0;
+	size_t m_currentPosition = 0;
+	size_t m_minibatchSize = 0;
+	const size_t m_minUpdateSizeTimes = 4; //how many update-size times tuples we need to start updating
+	mt19937 m_randomGenerator;
+
+	function<void(const ExperienceTuple*)> m_addTuple;
+	function<void()> m_train;
+
+	size_t m_numReceivedTuples = 0;
+	atomic<size_t> m_numTrainingSteps;
+	size_t m_numDroppedTuples = 0; //only accessed by the simulation thread
+
+	thread m_thread;
+	atomic<bool> m_bExit;
+	exception_ptr m_pException;
+	atomic<bool> m_bFailed;
+
+	void receiveTuples();
+	void learnerLoop();
+public:
+	AsyncLearner(size_t bufferSize, size_t minibatchSize, function<void(const ExperienceTuple*)> addTuple
+		, function<void()> train);
+	virtual ~AsyncLearner();
+
+	//starts the learner thread. Evaluation workers can't be forked while it runs, so it refuses to start if they are used
+	void start();
+
+	//called from the simulation thread. Exceptions thrown by the learner thread are rethrown here. If the learner falls
+	//so far behind that the queue is full, the tuple is dropped and a warning is given the first time it happens
+	void push(const State* s, const Action* a, const State* s_p, double r, double probability);
+
+	size_t getNumTrainingSteps() const { return m_numTrainingSteps.load(); }
+	size_t getNumDroppedTuples() const { return m_numDroppedTuples; }
+};
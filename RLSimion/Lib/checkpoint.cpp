@@ -0,0 +1,288 @@
+#include "checkpoint.h"
+#include "app.h"
+#include "config.h"
+#include "logger.h"
+#include "experiment.h"
+#include "simgod.h"
+#include "evaluation-workers.h"
+#include "../../tools/System/CrossPlatform.h"
+#include "../../tools/System/FileUtils.h"
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+
+#define CHECKPOINT_MAGIC "SIMCKPT"
+#define CHECKPOINT_VERSION 3
+
+struct CheckpointHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t configHash;
+	uint64_t generation;
+	uint64_t payloadSize;
+	uint64_t checksum;
+};
+
+//FNV-1a hash used to detect incomplete or corrupt files
+static uint64_t checkpointChecksum(const char* pData, size_t numBytes)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < numBytes; i++)
+	{
+		hash ^= (unsigned char)pData[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static uint64_t checkpointChecksum(const vector<char>& data)
+{
+	return checkpointChecksum(data.data(), data.size());
+}
+
+
+void CheckpointWriter::write(const void* pData, size_t numBytes)
+{
+	const char* pBytes = (const char*)pData;
+	m_buffer.insert(m_buffer.end(), pBytes, pBytes + numBytes);
+}
+
+size_t CheckpointWriter::beginChunk()
+{
+	//the size is written when the chunk is finished
+	write((uint64_t)0);
+	return m_buffer.size();
+}
+
+void CheckpointWriter::endChunk(size_t chunkPosition)
+{
+	uint64_t chunkSize = m_buffer.size() - chunkPosition;
+	memcpy(&m_buffer[chunkPosition - sizeof(uint64_t)], &chunkSize, sizeof(uint64_t));
+}
+
+
+CheckpointReader::CheckpointReader(vector<char>& buffer)
+{
+	m_buffer.swap(buffer);
+}
+
+void CheckpointReader::read(void* pData, size_t numBytes)
+{
+	if (m_position + numBytes > m_buffer.size())
+		throw runtime_error("Checkpoint: unexpected end of data");
+	memcpy(pData, &m_buffer[m_position], numBytes);
+	m_position += numBytes;
+}
+
+size_t CheckpointReader::beginChunk()
+{
+	uint64_t chunkSize = read<uint64_t>();
+	return m_position + (size_t)chunkSize;
+}
+
+void CheckpointReader::endChunk(size_t chunkEnd)
+{
+	if (m_position != chunkEnd)
+		throw runtime_error("Checkpoint: the saved state doesn't match the experiment");
+}
+
+
+CheckpointManager::CheckpointManager(ConfigNode* pConfigNode)
+{
+	m_freq = INT_PARAM(pConfigNode, "Freq", "Number of episodes between checkpoints", 10);
+	m_bRestore = BOOL_PARAM(pConfigNode, "Restore", "Restore the last checkpoint saved, if there is one, when the experiment begins", true);
+	m_bUse = m_freq.get() > 0;
+	m_bWriteFailed = false;
+
+	//the whole configuration is hashed: checkpoints saved by any other experiment are not valid
+	tinyxml2::XMLPrinter printer;
+	pConfigNode->GetDocument()->Print(&printer);
+	m_configHash = checkpointChecksum(printer.CStr(), (size_t)printer.CStrSize());
+}
+
+CheckpointManager::CheckpointManager()
+{
+	//default behaviour when checkpoints are not used
+	m_freq.set(0);
+	m_bRestore.set(false);
+	m_bUse = false;
+	m_bWriteFailed = false;
+}
+
+CheckpointManager::~CheckpointManager()
+{
+	waitForWriter();
+}
+
+string CheckpointManager::getFileName(unsigned long long generation)
+{
+	return removeExtension(SimionApp::get()->getConfigFile()) + ".checkpoint." + to_string(generation % 2);
+}
+
+void CheckpointManager::removeFiles()
+{
+	for (unsigned long long slot = 0; slot < 2; slot++)
+	{
+		string fileName = getFileName(slot);
+		if (bFileExists(fileName) && remove(fileName.c_str()) != 0)
+			Logger::logMessage(MessageType::Warning, (string("Checkpoint: couldn't remove ") + fileName).c_str());
+	}
+}
+
+void CheckpointManager::waitForWriter()
+{
+	if (m_writerThread.joinable())
+		m_writerThread.join();
+
+	if (m_bWriteFailed)
+	{
+		Logger::logMessage(MessageType::Warning, "Checkpoint: failed to write the checkpoint file");
+		m_bWriteFailed = false;
+	}
+}
+
+bool CheckpointManager::writeFile(string fileName, unsigned long long generation, const vector<char>& payload) const
+{
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC));
+	header.version = CHECKPOINT_VERSION;
+	header.configHash = m_configHash;
+	header.generation = generation;
+	header.payloadSize = payload.size();
+	header.checksum = checkpointChecksum(payload);
+
+	FILE* pFile;
+	CrossPlatform::Fopen_s(&pFile, fileName.c_str(), "wb");
+	if (!pFile)
+		return false;
+
+	bool bOk = fwrite(&header, sizeof(header), 1, pFile) == 1;
+	if (bOk && !payload.empty())
+		bOk = fwrite(payload.data(), 1, payload.size(), pFile) == payload.size();
+	bOk = (fclose(pFile) == 0) && bOk;
+	return bOk;
+}
+
+bool CheckpointManager::readFile(string fileName, unsigned long long& generation, vector<char>& payload) const
+{
+	FILE* pFile;
+	CrossPlatform::Fopen_s(&pFile, fileName.c_str(), "rb");
+	if (!pFile)
+		return false;
+
+	CheckpointHeader header;
+	bool bOk = CrossPlatform::Fread_s(&header, sizeof(header), sizeof(header), 1, pFile) == 1
+		&& !memcmp(header.magic, CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC))
+		&& header.version == CHECKPOINT_VERSION;
+	if (bOk && header.configHash != m_configHash)
+	{
+		Logger::logMessage(MessageType::Warning, (string("Checkpoint: ") + fileName
+			+ " was saved by a different configuration and is ignored").c_str());
+		bOk = false;
+	}
+	if (bOk)
+	{
+		payload.resize((size_t)header.payloadSize);
+		if (!payload.empty())
+			bOk = CrossPlatform::Fread_s(payload.data(), payload.size(), 1, payload.size(), pFile) == payload.size();
+		bOk = bOk && checkpointChecksum(payload) == header.checksum;
+	}
+	fclose(pFile);
+
+	generation = header.generation;
+	return bOk;
+}
+
+bool CheckpointManager::restore()
+{
+	if (!m_bUse)
+		return false;
+
+	//the checkpoints of a previous run of this experiment must not be mixed with the ones saved in this run
+	if (!m_bRestore.get())
+	{
+		removeFiles();
+		return false;
+	}
+
+	//the latest valid generation is restored
+	vector<char> payload, candidatePayload;
+	unsigned long long generation = 0, candidateGeneration;
+	bool bFound = false;
+	for (unsigned long long slot = 0; slot < 2; slot++)
+	{
+		if (readFile(getFileName(slot), candidateGeneration, candidatePayload)
+			&& (!bFound || candidateGeneration > generation))
+		{
+			generation = candidateGeneration;
+			payload.swap(candidatePayload);
+			bFound = true;
+		}
+	}
+	if (!bFound)
+		return false;
+
+	CheckpointReader reader(payload);
+	SimionApp::get()->pExperiment->loadCheckpoint(reader);
+	SimionApp::get()->pLogger->loadCheckpoint(reader);
+	SimionApp::get()->pSimGod->loadCheckpoint(reader);
+
+	m_generation = generation + 1;
+	Logger::logMessage(MessageType::Info, (string("Checkpoint restored: experiment resumed after episode ")
+		+ to_string(SimionApp::get()->pExperiment->getEpisodeIndex())).c_str());
+	return true;
+}
+
+void CheckpointManager::episodeFinished()
+{
+	if (!m_bUse || SimionApp::get()->pExperiment->isLastEpisode())
+		return;
+
+	if (SimionApp::get()->pExperiment->getEpisodeIndex() % m_freq.get() == 0)
+		save();
+}
+
+void CheckpointManager::checkNotUsedBy(const char* learnerName) const
+{
+	if (m_bUse)
+		Logger::logMessage(MessageType::Error, (string("Checkpoints can't save the state of ") + learnerName
+			+ ": it can't be used with Checkpoints").c_str());
+}
+
+void CheckpointManager::experimentFinished()
+{
+	if (!m_bUse)
+		return;
+
+	//a finished experiment is not resumed: running the same configuration again starts a new experiment
+	waitForWriter();
+	removeFiles();
+}
+
+void CheckpointManager::save()
+{
+	//the evaluation episodes still being run by workers would be lost if the experiment was resumed from this checkpoint
+	SimionApp::get()->pEvaluationWorkers->waitAll();
+
+	//the state is serialized in the simulation thread, so it must be done between episodes
+	m_writer.clear();
+	SimionApp::get()->pExperiment->saveCheckpoint(m_writer);
+	SimionApp::get()->pLogger->saveCheckpoint(m_writer);
+	SimionApp::get()->pSimGod->saveCheckpoint(m_writer);
+
+	//we only wait if the previous checkpoint is still being written
+	waitForWriter();
+	m_fileBuffer.swap(m_writer.getBuffer());
+
+	string fileName = getFileName(m_generation);
+	unsigned long long generation = m_generation++;
+	m_writerThread = thread([this, fileName, generation]()
+	{
+		if (!writeFile(fileName, generation, m_fileBuffer))
+			m_bWriteFailed = true;
+	});
+}
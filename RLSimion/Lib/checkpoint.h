@@ -0,0 +1,95 @@
+#pragma once
+
+#include "parameters.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+using namespace std;
+
+class ConfigNode;
+
+//Binary image of the learned state of an experiment. Objects must restore their state reading exactly what they saved
+//in the same order. Chunks wrap the data of each object so that a mismatch is detected as soon as it happens
+class CheckpointWriter
+{
+	vector<char> m_buffer;
+public:
+	void write(const void* pData, size_t numBytes);
+	template <typename T> void write(const T& value) { write(&value, sizeof(T)); }
+
+	//returns the position of the chunk, which must be passed to endChunk()
+	size_t beginChunk();
+	void endChunk(size_t chunkPosition);
+
+	vector<char>& getBuffer() { return m_buffer; }
+	void clear() { m_buffer.clear(); }
+};
+
+class CheckpointReader
+{
+	vector<char> m_buffer;
+	size_t m_position = 0;
+public:
+	CheckpointReader(vector<char>& buffer);
+
+	//throws a runtime_error if there is not enough data left
+	void read(void* pData, size_t numBytes);
+	template <typename T> T read() { T value; read(&value, sizeof(T)); return value; }
+
+	//returns the end of the chunk, which must be passed to endChunk(). endChunk() throws a runtime_error if the data read
+	//doesn't match the size of the chunk
+	size_t beginChunk();
+	void endChunk(size_t chunkEnd);
+};
+
+//Saves the learned state of the experiment every few episodes and restores it when the experiment is run again: the
+//position in the experiment, the size of the log files (the episodes logged until then are kept), the memory pools
+//(weights of the linear VFAs) and the state of the DeferredLoad objects (i.e. the experience replay buffer).
+//The state is serialized to memory between episodes and a background thread writes it to disk. Two files are used
+//alternatively (generation % 2) so that a failure while writing one never destroys the last valid checkpoint.
+//Files are stamped with a hash of the configuration and those saved by a different configuration are ignored. They
+//are removed when the experiment finishes, and also when it begins if Restore=false, so a new run never resumes from
+//(or competes with) the checkpoints of a previous one
+class CheckpointManager
+{
+	INT_PARAM m_freq;
+	BOOL_PARAM m_bRestore;
+	bool m_bUse = false;
+
+	unsigned long long m_configHash = 0;
+	unsigned long long m_generation = 0;
+	CheckpointWriter m_writer;
+
+	//the writer thread owns m_fileBuffer while it is running
+	vector<char> m_fileBuffer;
+	thread m_writerThread;
+	atomic<bool> m_bWriteFailed;
+
+	string getFileName(unsigned long long generation);
+	void removeFiles();
+	bool writeFile(string fileName, unsigned long long generation, const vector<char>& payload) const;
+	bool readFile(string fileName, unsigned long long& generation, vector<char>& payload) const;
+public:
+	CheckpointManager(ConfigNode* pConfigNode);
+	CheckpointManager();
+	virtual ~CheckpointManager();
+
+	bool isUsed() const { return m_bUse; }
+	//called by the learners whose state can't be saved in a checkpoint (i.e., neural networks): using them with
+	//checkpoints is an error, because a resumed experiment would silently restart them from scratch
+	void checkNotUsedBy(const char* learnerName) const;
+
+	//restores the latest valid checkpoint, if there is one. Must be called after the deferred load step
+	bool restore();
+
+	//called at the end of every episode. Checkpoints are saved every Freq episodes
+	void episodeFinished();
+	//called once the last episode has finished: the checkpoints are removed
+	void experimentFinished();
+
+	void save();
+	//waits until the last checkpoint has been written
+	void waitForWriter();
+};
@@ -44,7 +44,7 @@ double TDLambdaCritic::update(const State *s, const Action *a, const State *s_p,
 	double v_s_p= m_pVFunction->get(m_aux);
 	double td = rho*r + gamma*v_s_p - v_s;
 
-	m_pVFunction->add(m_z.ptr(),td);
+	m_pVFunction->add(m_z->getFeatures(),td);
 
 	return td;
 }
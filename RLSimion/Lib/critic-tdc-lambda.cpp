@@ -64,10 +64,10 @@ double TDCLambdaCritic::update(const State *s, const Action *a, const State *s_p
 	double innerprod1= m_a->innerProduct(m_omega);
 	//innerprod2= z_{t+1}^T*w_t
 	m_a->clear();
-	m_a->copy(m_z.ptr());
+	m_a->copy(m_z->getFeatures());
 	double innerprod2 = m_a->innerProduct(m_omega);
 	//theta_{t+1}=theta_t+alpha(z_t*delta_t)
-	m_pVFunction->add(m_z.ptr(), m_pAlpha->get() *td);
+	m_pVFunction->add(m_z->getFeatures(), m_pAlpha->get() *td);
 	//theta_{t+1}= theta_t - gamma*rho(1-\lambda)*phi_t*innerprod2
 
 	double lambda = m_z->getLambda();
@@ -75,7 +75,7 @@ double TDCLambdaCritic::update(const State *s, const Action *a, const State *s_p
 
 	//omega_{t+1}=omega_t+beta(z_{t+1}*td - phi_{t+1}(phi{t+1}^T * omega_t)
 	double beta = m_pBeta->get();
-	m_omega->addFeatureList(m_z.ptr(), beta*td);
+	m_omega->addFeatureList(m_z->getFeatures(), beta*td);
 	m_omega->addFeatureList(m_s_p_features,- innerprod1);
 	m_omega->applyThreshold(0.0001);
 
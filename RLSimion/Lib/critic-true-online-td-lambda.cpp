@@ -55,7 +55,7 @@ double TrueOnlineTDLambdaCritic::update(const State *s,const  Action *a,const St
 	m_e->addFeatureList(m_aux,alpha *(1-gamma*lambda*e_T_phi_s));
 
 	//theta= theta + delta*e + alpha[v_s - theta^T*phi(s)]* phi(s)
-	m_pVFunction->add(m_e.ptr(),td);
+	m_pVFunction->add(m_e->getFeatures(),td);
 	double theta_T_phi_s= m_pVFunction->get(m_aux);
 	m_pVFunction->add(m_aux,alpha *(m_v_s - theta_T_phi_s));
 	//v_s= v_s_p
@@ -8,4 +8,6 @@ DeferredLoad::DeferredLoad(unsigned int loadOrder)
 }
 
 DeferredLoad::~DeferredLoad()
-{}
\ No newline at end of file
+{
+	SimGod::unregisterDeferredLoadStep(this);
+}
\ No newline at end of file
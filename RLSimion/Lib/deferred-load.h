@@ -8,6 +8,9 @@
 //MOTIVATION: be able to construct quickly the objects needed in an experiment
 //and getSample the input/output files without loading matrices from file or doing any heavy-weight lifting
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class DeferredLoad
 {
 public:
@@ -18,4 +21,9 @@ public:
 	DeferredLoad(unsigned int loadOrder = 5);
 	virtual ~DeferredLoad();
 	virtual void deferredLoadStep() = 0;
+
+	//objects holding learned state save and restore it with these methods (see CheckpointManager). They are called
+	//after the deferred load step and in the same order
+	virtual void saveCheckpoint(CheckpointWriter& writer) {}
+	virtual void loadCheckpoint(CheckpointReader& reader) {}
 };
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "experiment.h"
 #include "config.h"
 #include "app.h"
+#include <algorithm>
+#include <math.h>
 
 ETraces::ETraces(ConfigNode* pConfigNode): FeatureList("ETraces")
 {
@@ -30,26 +32,109 @@ ETraces::~ETraces()
 {}
 
 
+//the scale is kept within [MIN_SCALE, 1/MIN_SCALE] to avoid losing precision in the stored factors
+#define MIN_SCALE 0.000000000001
+
+void ETraces::clear()
+{
+	FeatureList::clear();
+	m_scale = 1.0;
+	m_decay = 1.0;
+	m_featurePositions.clear();
+}
+
+void ETraces::foldScale()
+{
+	if (m_scale != 1.0)
+	{
+		FeatureList::mult(m_scale);
+		m_scale = 1.0;
+	}
+}
+
+void ETraces::renormalize(double threshold)
+{
+	//fold the scale into the factors and remove the traces under the threshold
+	foldScale();
+	m_decay = 1.0;
+	FeatureList::applyThreshold(threshold);
+
+	m_featurePositions.clear();
+	for (size_t i = 0; i < m_numFeatures; i++)
+		m_featurePositions[m_pFeatures[i].m_index] = i;
+}
+
 void ETraces::update(double factor)
 {
 	if (!SimionApp::get()->pExperiment->isFirstStep() && m_bUse)
 	{
-		mult(factor* m_lambda.get());
-		applyThreshold(m_threshold.get());
+		m_scale *= factor* m_lambda.get();
+		m_decay *= factor* m_lambda.get();
+		if (m_scale == 0.0)
+			clear();
+		//once the decay is under the threshold, every trace not updated since the last renormalization is under it too
+		else if (fabs(m_decay) < std::max(MIN_SCALE, m_threshold.get())
+			|| fabs(m_scale) < MIN_SCALE || fabs(m_scale) > 1.0 / MIN_SCALE)
+			renormalize(m_threshold.get());
 	}
 	else
 		clear();
 }
 
-void ETraces::addFeatureList(FeatureList* inList, double factor)
+void ETraces::applyThreshold(double threshold)
+{
+	renormalize(threshold);
+}
+
+const FeatureList* ETraces::getFeatures()
+{
+	foldScale();
+	return this;
+}
+
+double ETraces::getFactor(size_t index) const
+{
+	auto position = m_featurePositions.find(index);
+	if (position == m_featurePositions.end())
+		return 0.0;
+	return m_scale * m_pFeatures[position->second].m_factor;
+}
+
+double ETraces::innerProduct(const FeatureList *inList)
+{
+	return m_scale * FeatureList::innerProduct(inList);
+}
+
+void ETraces::add(size_t index, double value)
+{
+	//the new value is stored relative to the current scale
+	double storedValue = value / m_scale;
+
+	auto position = m_featurePositions.find(index);
+	if (position != m_featurePositions.end())
+	{
+		if (m_overwriteMode == OverwriteMode::Add) m_pFeatures[position->second].m_factor += storedValue;
+		else m_pFeatures[position->second].m_factor = storedValue;
+	}
+	else
+	{
+		m_featurePositions[index] = m_numFeatures;
+		append(index, storedValue);
+	}
+}
+
+void ETraces::addFeatureList(const FeatureList* inList, double factor)
 {
 	if (m_bUse)
 	{
-		FeatureList::addFeatureList(inList, factor);
+		for (size_t i = 0; i < inList->m_numFeatures; i++)
+			add(inList->m_pFeatures[i].m_index, inList->m_pFeatures[i].m_factor * factor);
 	}
 	else
 	{
 		clear();
 		copyMult(factor,inList);
+		for (size_t i = 0; i < m_numFeatures; i++)
+			m_featurePositions[m_pFeatures[i].m_index] = i;
 	}
-}
\ No newline at end of file
+}
@@ -1,15 +1,29 @@
 #pragma once
 #include "parameters.h"
 #include "features.h"
+#include <unordered_map>
 
 class ConfigNode;
 
-class ETraces : public FeatureList
+//Eligibility traces with lazy decay: the stored factors are relative to a common scale, so decaying all the traces only
+//multiplies the scale, and adding a feature finds its position with a hash map instead of searching the list.
+//The factors are only renormalized (and the traces under the threshold removed) when the scale gets too small or too
+//big. The stored factors aren't the actual values of the traces, so the list is only accessible through getFeatures(),
+//which folds the scale into the factors before returning them
+class ETraces : protected FeatureList
 {
 	bool m_bUse;
 	DOUBLE_PARAM m_threshold;
 	DOUBLE_PARAM m_lambda;
 	BOOL_PARAM m_bReplace;
+
+	double m_scale = 1.0;
+	//decay since the traces were last thresholded. Folding the scale into the factors doesn't reset it
+	double m_decay = 1.0;
+	unordered_map<size_t, size_t> m_featurePositions;
+
+	void renormalize(double threshold);
+	void foldScale();
 public:
 	ETraces(ConfigNode* pConfigNode);
 	ETraces();
@@ -19,7 +33,19 @@ public:
 	//traces are automatically cleared if it's the first step of an episode
 	void update(double factor = 1.0);
 
-	void addFeatureList(FeatureList *inList, double factor = 1.0);
+	//these take the scale and the positions of the features into account
+	void addFeatureList(const FeatureList *inList, double factor = 1.0);
+	void add(size_t index, double value);
+	void clear();
+	double innerProduct(const FeatureList *inList);
+	void applyThreshold(double threshold);
+	double getFactor(size_t index) const;
+
+	//the traces as a regular feature list, to be passed to the methods of other lists or the VFAs
+	const FeatureList* getFeatures();
+
+	using FeatureList::setName;
+	using FeatureList::getName;
 
 	double getLambda() { return m_lambda.get(); };
 	void setLambda(double value) { m_lambda.set(value); }
@@ -29,4 +55,4 @@ public:
 
 	bool getReplace() { return m_bReplace.get(); }
 	void setReplace(bool value) { m_bReplace.set(value); }
-};
\ No newline at end of file
+};
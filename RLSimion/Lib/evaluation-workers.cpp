@@ -0,0 +1,244 @@
+#include "evaluation-workers.h"
+#include "config.h"
+#include "app.h"
+#include "experiment.h"
+#include "checkpoint.h"
+#include <stdexcept>
+#include <cstdlib>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+EvaluationWorkers::EvaluationWorkers(ConfigNode* pConfigNode)
+{
+	m_numWorkers = INT_PARAM(pConfigNode, "Num-Workers"
+		, "Number of worker processes running evaluation episodes while training goes on. Zero to run them serially", 0);
+
+#ifndef __linux__
+	if (m_numWorkers.get() > 0)
+		Logger::logMessage(MessageType::Warning
+			, "Evaluation workers are only available under Linux. Evaluation episodes will be run serially");
+#endif
+}
+
+EvaluationWorkers::EvaluationWorkers()
+{
+	//default behaviour when evaluation workers are not used
+	m_numWorkers.set(0);
+}
+
+bool EvaluationWorkers::bUsing() const
+{
+#ifdef __linux__
+	return m_numWorkers.get() > 0;
+#else
+	return false;
+#endif
+}
+
+void EvaluationWorkers::update()
+{
+	collect(false);
+	flush();
+}
+
+void EvaluationWorkers::waitAll()
+{
+	while (m_numRunning > 0)
+		collect(true);
+	flush();
+}
+
+void EvaluationWorkers::flush()
+{
+	Logger::setLogCapture(nullptr);
+	while (!m_segments.empty() && m_segments.front()->bFinished)
+	{
+		unique_ptr<LogSegment> pSegment = move(m_segments.front());
+		m_segments.pop_front();
+
+		Logger::writeLogBuffer(pSegment->log.data(), (int)pSegment->log.size());
+		//errors are thrown here, as if the episode had been run by this process
+		for (auto& message : pSegment->messages)
+			Logger::logMessage(message.first, message.second.c_str());
+	}
+
+	//what is logged while earlier episodes are still running is kept until they have been logged
+	if (!m_segments.empty())
+	{
+		if (m_segments.back()->bWorker)
+		{
+			m_segments.push_back(unique_ptr<LogSegment>(new LogSegment()));
+			m_segments.back()->bFinished = true;
+		}
+		Logger::setLogCapture(&m_segments.back()->log);
+	}
+}
+
+void EvaluationWorkers::readResults(LogSegment& segment)
+{
+	FILE* pResults = segment.pResults;
+	rewind(pResults);
+
+	uint64_t logSize = 0, numMessages = 0;
+	bool bRead = fread(&logSize, sizeof(logSize), 1, pResults) == 1;
+	if (bRead)
+	{
+		segment.log.resize((size_t)logSize);
+		bRead = logSize == 0 || fread(segment.log.data(), 1, (size_t)logSize, pResults) == (size_t)logSize;
+	}
+	bRead = bRead && fread(&numMessages, sizeof(numMessages), 1, pResults) == 1;
+	for (uint64_t i = 0; bRead && i < numMessages; ++i)
+	{
+		int32_t type;
+		uint64_t length;
+		bRead = fread(&type, sizeof(type), 1, pResults) == 1 && fread(&length, sizeof(length), 1, pResults) == 1;
+		if (!bRead) break;
+		string message((size_t)length, ' ');
+		bRead = length == 0 || fread(&message[0], 1, (size_t)length, pResults) == (size_t)length;
+		segment.messages.push_back(make_pair((MessageType)type, message));
+	}
+	if (!bRead)
+	{
+		segment.log.clear();
+		segment.messages.push_back(make_pair(MessageType::Error, string("Evaluation worker: failed to read the results")));
+	}
+}
+
+#ifdef __linux__
+
+void EvaluationWorkers::runEpisode(const function<void()>& runEpisode)
+{
+	while (m_numRunning >= (size_t)m_numWorkers.get())
+		collect(true);
+
+	//the beginning of the experiment and the function samples are logged before the snapshot is taken
+	SimionApp::get()->pLogger->beginWorkerEpisode();
+
+	unique_ptr<LogSegment> pSegment(new LogSegment());
+	pSegment->bWorker = true;
+	pSegment->pResults = tmpfile();
+	if (!pSegment->pResults)
+		Logger::logMessage(MessageType::Error, "Evaluation worker: couldn't create a temporary file");
+
+	//the checkpoint writer thread may hold the lock of the C runtime's heap or of a stream when the worker is forked
+	SimionApp::get()->pCheckpoints->waitForWriter();
+	//whatever is buffered would otherwise be written by the worker too
+	fflush(nullptr);
+	pid_t pid = fork();
+	if (pid == 0)
+		runWorker(runEpisode, pSegment->pResults);
+	if (pid < 0)
+	{
+		fclose(pSegment->pResults);
+		Logger::logMessage(MessageType::Error, "Evaluation worker: fork() failed");
+	}
+
+	pSegment->pid = pid;
+	m_segments.push_back(move(pSegment));
+	++m_numRunning;
+	flush();
+}
+
+void EvaluationWorkers::runWorker(const function<void()>& runEpisode, FILE* pResults)
+{
+	vector<char> log;
+	vector<pair<MessageType, string>> messages;
+	SimionApp::get()->pLogger->setWorkerProcess(&log, &messages);
+
+	//the workers of an evaluation are forked with the same random generator state
+	srand((unsigned int)rand() + SimionApp::get()->pExperiment->getEpisodeIndex());
+
+	try
+	{
+		runEpisode();
+	}
+	catch (std::exception& e)
+	{
+		messages.push_back(make_pair(MessageType::Error, string(e.what())));
+	}
+
+	uint64_t logSize = log.size(), numMessages = messages.size();
+	fwrite(&logSize, sizeof(logSize), 1, pResults);
+	fwrite(log.data(), 1, log.size(), pResults);
+	fwrite(&numMessages, sizeof(numMessages), 1, pResults);
+	for (auto& message : messages)
+	{
+		int32_t type = (int32_t)message.first;
+		uint64_t length = message.second.size();
+		fwrite(&type, sizeof(type), 1, pResults);
+		fwrite(&length, sizeof(length), 1, pResults);
+		fwrite(message.second.data(), 1, message.second.size(), pResults);
+	}
+	bool bWritten = fflush(pResults) == 0 && !ferror(pResults);
+
+	//the worker shares the files opened by the experiment, so nothing else can be flushed or destroyed
+	_exit(bWritten ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+void EvaluationWorkers::collect(bool bWait)
+{
+	bool bWaiting = bWait;
+	for (auto& pSegment : m_segments)
+	{
+		if (!pSegment->bWorker || pSegment->bFinished) continue;
+
+		int status;
+		pid_t pid;
+		do pid = waitpid((pid_t)pSegment->pid, &status, bWaiting ? 0 : WNOHANG);
+		while (pid < 0 && errno == EINTR);
+		if (pid == 0) continue;
+		bWaiting = false;
+
+		if (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+			readResults(*pSegment);
+		else
+			pSegment->messages.push_back(make_pair(MessageType::Error
+				, string("Evaluation worker: the process running the episode failed")));
+		fclose(pSegment->pResults);
+		pSegment->pResults = nullptr;
+		pSegment->bFinished = true;
+		--m_numRunning;
+	}
+}
+
+EvaluationWorkers::~EvaluationWorkers()
+{
+	//only if the experiment was stopped by an error
+	for (auto& pSegment : m_segments)
+	{
+		if (!pSegment->bWorker || pSegment->bFinished) continue;
+		kill((pid_t)pSegment->pid, SIGTERM);
+		waitpid((pid_t)pSegment->pid, nullptr, 0);
+		fclose(pSegment->pResults);
+	}
+	Logger::setLogCapture(nullptr);
+}
+
+#else
+
+void EvaluationWorkers::runEpisode(const function<void()>& runEpisode)
+{
+	runEpisode();
+}
+
+void EvaluationWorkers::runWorker(const function<void()>& runEpisode, FILE* pResults)
+{
+	abort();
+}
+
+void EvaluationWorkers::collect(bool bWait)
+{
+}
+
+EvaluationWorkers::~EvaluationWorkers()
+{
+}
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "parameters.h"
+#include "logger.h"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <functional>
+#include <cstdio>
+using namespace std;
+
+class ConfigNode;
+
+//Evaluation episodes run in parallel with training: each evaluation episode is run by a worker process forked from the
+//experiment. The worker gets its own copy of the world and a frozen snapshot of the policies and the weights of the
+//VFAs, while the experiment goes on with the next episodes. The episodes logged by the workers and their messages are
+//written by the experiment in the same order they would have been run serially.
+//Only available under Linux (fork): otherwise, evaluation episodes are run in the main loop. Not compatible with
+//Asynchronous-Learning: a thread other than the main one may hold a lock when the worker is forked
+class EvaluationWorkers
+{
+	INT_PARAM m_numWorkers;
+
+	//the log is written in segments: either an episode run by a worker or what the experiment logged in the meantime
+	struct LogSegment
+	{
+		bool bWorker = false;
+		bool bFinished = false;
+		long long pid = -1;
+		FILE* pResults = nullptr; //the worker saves its log and messages in this temporary file
+		vector<char> log;
+		vector<pair<MessageType, string>> messages;
+	};
+	deque<unique_ptr<LogSegment>> m_segments;
+	size_t m_numRunning = 0;
+
+	[[noreturn]] static void runWorker(const function<void()>& runEpisode, FILE* pResults);
+	static void readResults(LogSegment& segment);
+	//collects the workers that have finished. If bWait, it waits until the oldest one running has finished
+	void collect(bool bWait);
+	//writes the segments that can be written in order
+	void flush();
+public:
+	EvaluationWorkers(ConfigNode* pConfigNode);
+	EvaluationWorkers();
+	virtual ~EvaluationWorkers();
+
+	bool bUsing() const;
+
+	//runs the current episode of the experiment in a new worker. Blocks while all the workers are busy
+	void runEpisode(const function<void()>& runEpisode);
+
+	//called after every episode to log the episodes finished by the workers
+	void update();
+
+	//waits until all the workers have finished and their episodes have been logged
+	void waitAll();
+};
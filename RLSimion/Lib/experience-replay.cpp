@@ -5,7 +5,9 @@
 #include "../Common/named-var-set.h"
 #include "simgod.h"
 #include "worlds/world.h"
+#include "checkpoint.h"
 #include <algorithm>
+#include <stdexcept>
 
 ExperienceTuple::ExperienceTuple()
 {
@@ -68,6 +70,11 @@ size_t ExperienceReplay::getUpdateBatchSize() const
 	return m_updateBatchSize.get();
 }
 
+size_t ExperienceReplay::getBufferSize() const
+{
+	return m_bufferSize.get();
+}
+
 bool ExperienceReplay::bHaveEnoughTuples() const
 {
 	size_t minNumTuplesForUpdate = 
@@ -95,6 +102,49 @@ void ExperienceReplay::addTuple(const State* s, const  Action* a, const State* s
 	m_currentPosition = ++m_currentPosition % (size_t) m_bufferSize.get();
 }
 
+static void writeVarSet(CheckpointWriter& writer, NamedVarSet* pVarSet)
+{
+	writer.write(pVarSet->getValueVector(), pVarSet->getNumVars() * sizeof(double));
+}
+
+static void readVarSet(CheckpointReader& reader, NamedVarSet* pVarSet)
+{
+	reader.read(pVarSet->getValueVector(), pVarSet->getNumVars() * sizeof(double));
+}
+
+void ExperienceReplay::saveCheckpoint(CheckpointWriter& writer)
+{
+	writer.write((uint64_t)m_numTuples);
+	writer.write((uint64_t)m_currentPosition);
+	for (size_t i = 0; i < m_numTuples; i++)
+	{
+		writeVarSet(writer, m_pTupleBuffer[i].s);
+		writeVarSet(writer, m_pTupleBuffer[i].a);
+		writeVarSet(writer, m_pTupleBuffer[i].s_p);
+		writer.write(m_pTupleBuffer[i].r);
+		writer.write(m_pTupleBuffer[i].probability);
+	}
+}
+
+void ExperienceReplay::loadCheckpoint(CheckpointReader& reader)
+{
+	size_t numTuples = (size_t)reader.read<uint64_t>();
+	size_t currentPosition = (size_t)reader.read<uint64_t>();
+	if (numTuples > (size_t)m_bufferSize.get() || (numTuples > 0 && currentPosition >= (size_t)m_bufferSize.get()))
+		throw std::runtime_error("Checkpoint: the saved experience replay buffer doesn't match the experiment");
+
+	m_numTuples = numTuples;
+	m_currentPosition = currentPosition;
+	for (size_t i = 0; i < m_numTuples; i++)
+	{
+		readVarSet(reader, m_pTupleBuffer[i].s);
+		readVarSet(reader, m_pTupleBuffer[i].a);
+		readVarSet(reader, m_pTupleBuffer[i].s_p);
+		m_pTupleBuffer[i].r = reader.read<double>();
+		m_pTupleBuffer[i].probability = reader.read<double>();
+	}
+}
+
 ExperienceTuple* ExperienceReplay::getRandomTupleFromBuffer()
 {
 	int randomIndex = rand() % (size_t) m_numTuples;
@@ -39,7 +39,11 @@ public:
 
 	void addTuple(const State* s, const Action* a, const State* s_p, double r, double probability);
 	size_t getUpdateBatchSize() const;
+	size_t getBufferSize() const;
 	ExperienceTuple* getRandomTupleFromBuffer();
 
 	void deferredLoadStep();
+
+	void saveCheckpoint(CheckpointWriter& writer);
+	void loadCheckpoint(CheckpointReader& reader);
 };
\ No newline at end of file
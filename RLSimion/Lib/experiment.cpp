@@ -6,6 +6,8 @@
 #include "../../tools/System/Timer.h"
 #include "../../tools/System/CrossPlatform.h"
 #include "app.h"
+#include "checkpoint.h"
+#include <stdexcept>
 
 ExperimentTime& ExperimentTime::operator=(ExperimentTime& exp)
 {
@@ -193,6 +195,24 @@ bool Experiment::isLastEpisode()
 	return m_trainingEpisodeIndex == (unsigned int) m_numTrainingEpisodes.get();
 }
 
+void Experiment::saveCheckpoint(CheckpointWriter& writer)
+{
+	writer.write(m_episodeIndex);
+	writer.write(m_trainingEpisodeIndex);
+	writer.write(m_evalEpisodeIndex);
+	writer.write(m_experimentStep);
+}
+
+void Experiment::loadCheckpoint(CheckpointReader& reader)
+{
+	m_episodeIndex = reader.read<unsigned int>();
+	m_trainingEpisodeIndex = reader.read<unsigned int>();
+	m_evalEpisodeIndex = reader.read<unsigned int>();
+	m_experimentStep = reader.read<unsigned int>();
+	if (m_episodeIndex > m_totalNumEpisodes)
+		throw std::runtime_error("Checkpoint: the saved episode is beyond the end of the experiment");
+}
+
 Experiment::~Experiment()
 {
 	if (m_pProgressTimer)
@@ -234,7 +254,8 @@ void Experiment::timestep(State* s, Action* a, State* s_p, Reward* r)
 		m_pProgressTimer->start();
 	}
 
-	if (isFirstEpisode() && isFirstStep())
+	//not necessarily the first episode of the experiment: it may have been resumed from a checkpoint
+	if (isFirstStep() && !SimionApp::get()->pLogger->isLogStarted())
 		SimionApp::get()->pLogger->firstEpisode();
 
 	if (isFirstStep())
@@ -6,6 +6,8 @@ typedef NamedVarSet Action;
 typedef NamedVarSet Reward;
 class ConfigNode;
 class Timer;
+class CheckpointWriter;
+class CheckpointReader;
 
 #define MAX_PROGRESS_MSG_LEN 1024
 
@@ -103,5 +105,9 @@ public:
 
 	const char* getProgressString();
 
+	//position of the experiment (the last episode finished) saved in checkpoints
+	void saveCheckpoint(CheckpointWriter& writer);
+	void loadCheckpoint(CheckpointReader& reader);
+
 	void timestep(State *s, Action *a,State *s_p, Reward* pReward);
 };
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include "single-dimension-grid.h"
 #include "app.h"
 #include "worlds/world.h"
+#include "simgod.h"
+#include "features.h"
+#include <algorithm>
 
 /////////////////////////////////////////////////////////////////////////////////
 //FeatureMap: common functionality to State/ActionFeatureMap derived classes
@@ -33,14 +36,53 @@ size_t FeatureMap::getMaxNumActiveFeatures() const
 	return m_featureMapper->getMaxNumActiveFeatures();
 }
 
+//tuples replayed from the experience replay buffer are not cached so that they don't evict the states of the current step
+static bool isReplayingExperience()
+{
+	SimionApp* pApp = SimionApp::get();
+	return pApp != nullptr && pApp->pSimGod.ptr() != nullptr && pApp->pSimGod->bReplayingExperience();
+}
+
 void FeatureMap::getFeatures(const State* s, const Action* a, FeatureList* outFeatures)
 {
 	//copy input variable values to the internal buffer
 	for (size_t grid = 0; grid < m_grids.size(); grid++)
 		m_variableValues[grid] = getInputVariableValue(grid, s, a);
 
-	//pass the buffer to the feature mapper
+	if (!m_bCacheFeatures || isReplayingExperience())
+	{
+		//pass the buffer to the feature mapper
+		m_featureMapper->map(m_grids, m_variableValues, outFeatures);
+		return;
+	}
+
+	size_t numValues = m_variableValues.size();
+	for (size_t entry = 0; entry < m_numCachedEntries; entry++)
+	{
+		if (std::equal(m_variableValues.begin(), m_variableValues.end(), m_cachedValues.begin() + entry * numValues))
+		{
+			outFeatures->copy(m_cachedFeatures[entry].get());
+			m_numCacheHits++;
+			return;
+		}
+	}
+
 	m_featureMapper->map(m_grids, m_variableValues, outFeatures);
+
+	//the oldest entry is replaced
+	if (m_cachedFeatures.empty())
+	{
+		m_cachedValues = vector<double>(m_numCacheEntries * numValues);
+		for (size_t entry = 0; entry < m_numCacheEntries; entry++)
+			m_cachedFeatures.push_back(shared_ptr<FeatureList>(new FeatureList("cached-features")));
+	}
+	std::copy(m_variableValues.begin(), m_variableValues.end(), m_cachedValues.begin() + m_nextCacheEntry * numValues);
+	m_cachedFeatures[m_nextCacheEntry]->copy(outFeatures);
+	m_nextCacheEntry = (m_nextCacheEntry + 1) % m_numCacheEntries;
+	if (m_numCachedEntries < m_numCacheEntries)
+		m_numCachedEntries++;
+	else
+		m_numCacheEvictions++;
 }
 
 void FeatureMap::getFeatureStateAction(size_t feature, State* s, Action* a)
@@ -91,6 +133,8 @@ StateFeatureMap::StateFeatureMap(ConfigNode* pConfigNode)
 
 	m_featureMapper = CHILD_OBJECT_FACTORY<FeatureMapper>(pConfigNode, "Feature-Mapper", "The feature calculator used to map/unmap features");
 	m_featureMapper->init(m_grids);
+
+	m_bCacheFeatures = true;
 }
 
 StateFeatureMap::StateFeatureMap(FeatureMapper* pFeatureMapper, Descriptor& stateDescriptor, vector<size_t> variableIds, size_t numFeaturesPerVariable)
@@ -106,6 +150,8 @@ StateFeatureMap::StateFeatureMap(FeatureMapper* pFeatureMapper, Descriptor& stat
 
 	m_featureMapper.set(pFeatureMapper);
 	m_featureMapper->init(m_grids);
+
+	m_bCacheFeatures = true;
 }
 
 double StateFeatureMap::getInputVariableValue(size_t inputIndex, const State* s, const Action* a)
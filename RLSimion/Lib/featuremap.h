@@ -120,6 +120,18 @@ protected:
 	vector<string> m_stateVariableNames;
 	vector<string> m_actionVariableNames;
 
+	//Features of the last inputs mapped. A state is usually mapped several times in a step (i.e., by every learner
+	//sharing this map, and s_p again as s in the next step). Entries are found comparing the input values, so they never
+	//become stale and the copies of a state (s->copy(s_p)) hit the cache too
+	bool m_bCacheFeatures = false;
+	static const size_t m_numCacheEntries = 4;
+	vector<double> m_cachedValues;
+	vector<shared_ptr<FeatureList>> m_cachedFeatures;
+	size_t m_numCachedEntries = 0;
+	size_t m_nextCacheEntry = 0;
+	size_t m_numCacheHits = 0;
+	size_t m_numCacheEvictions = 0;
+
 	//protected constructors to avoid instances of FeatureMap. Subclasses should be used
 	FeatureMap(size_t numFeaturesPerVariable);
 	FeatureMap(ConfigNode* pConfigNode);
@@ -134,11 +146,17 @@ public:
 	void getFeatures(const State* s, const Action* a, FeatureList* outFeatures);
 	void getFeatureStateAction(size_t feature, State* s, Action* a);
 
+	//number of calls to getFeatures() served from the cache and number of cached entries replaced so far
+	size_t getNumCacheHits() const { return m_numCacheHits; }
+	size_t getNumCacheEvictions() const { return m_numCacheEvictions; }
+
 	virtual double getInputVariableValue(size_t inputIndex, const State* s, const Action* a) = 0;
 	virtual void setInputVariableValue(size_t inputIndex, double value, State* s, Action* a) = 0;
 
 	vector<string>& getInputStateVariables() { return m_stateVariableNames; }
 	vector<string>& getInputActionVariables() { return m_actionVariableNames; }
+
+	vector<SingleDimensionGrid*>& getGrids() { return m_grids; }
 };
 
 //We distinguish these two feature maps to make sure that only the right subset of variables (state or action variables)
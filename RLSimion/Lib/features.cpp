@@ -140,7 +140,11 @@ void FeatureList::add(size_t index, double value)
 	}
 	//either we didn't find the index or we didn't look for it
 	//in any case, we have to add the new feature;
+	append(index, value);
+}
 
+void FeatureList::append(size_t index, double value)
+{
 	if (m_numFeatures >= m_numAllocFeatures)
 		resize(m_numAllocFeatures + FEATURE_BLOCK_SIZE);
 
@@ -27,6 +27,9 @@ class FeatureList
 
 protected:
 	OverwriteMode m_overwriteMode;
+
+	//adds the feature at the end of the list without checking whether its index is already in it
+	void append(size_t index, double value);
 public:
 	Feature* m_pFeatures;
 	size_t m_numFeatures;
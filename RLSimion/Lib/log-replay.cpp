@@ -0,0 +1,172 @@
+#include "log-replay.h"
+#include "config.h"
+#include "logger.h"
+#include "app.h"
+#include "../Common/named-var-set.h"
+#include "../../tools/System/FileUtils.h"
+#include "../../tools/System/CrossPlatform.h"
+#include <string>
+
+LogReplay::LogReplay(ConfigNode* pConfigNode)
+{
+	m_logFiles = MULTI_VALUE_SIMPLE_PARAM<FILE_PATH_PARAM, const char*>(pConfigNode, "Log-File"
+		, "Experiment log (.log) whose episodes are replayed", "");
+
+	//the binary data file is saved next to the descriptor
+	for (size_t i = 0; i < m_logFiles.size(); ++i)
+	{
+		SimionApp::get()->registerInputFile(m_logFiles[i]->get());
+		SimionApp::get()->registerInputFile((string(m_logFiles[i]->get()) + ".bin").c_str());
+	}
+}
+
+void LogReplay::init(const Descriptor& stateDescriptor, const Descriptor& actionDescriptor
+	, const Descriptor& rewardDescriptor)
+{
+	for (size_t i = 0; i < m_logFiles.size(); ++i)
+		loadLog(m_logFiles[i]->get(), stateDescriptor, actionDescriptor, rewardDescriptor);
+
+	if (m_episodes.empty())
+		Logger::logMessage(MessageType::Error, "Log replay: no episode can be replayed from the logs given");
+
+	char message[512];
+	CrossPlatform::Sprintf_s(message, 512, "Log replay: %d episodes found in %d logs", (int)m_episodes.size()
+		, (int)m_logs.size());
+	Logger::logMessage(MessageType::Info, message);
+}
+
+//returns the position of each variable of the descriptor in the logged variables
+static vector<size_t> findColumns(const Descriptor& descriptor, const vector<string>& loggedVariables, size_t firstColumn
+	, const char* descriptorFile)
+{
+	vector<size_t> columns;
+	for (size_t i = 0; i < descriptor.size(); ++i)
+	{
+		size_t column = 0;
+		while (column < loggedVariables.size() && loggedVariables[column] != descriptor[i].getName())
+			++column;
+		if (column == loggedVariables.size())
+			Logger::logMessage(MessageType::Error, (string("Log replay: variable ") + descriptor[i].getName()
+				+ " not found in " + descriptorFile).c_str());
+		columns.push_back(firstColumn + column);
+	}
+	return columns;
+}
+
+void LogReplay::loadLog(const char* descriptorFile, const Descriptor& stateDescriptor
+	, const Descriptor& actionDescriptor, const Descriptor& rewardDescriptor)
+{
+	ConfigFile descriptorXML;
+	ConfigNode* pRoot = descriptorXML.loadFile(descriptorFile, "ExperimentLogDescriptor");
+	if (!pRoot || !pRoot->Attribute("BinaryDataFile"))
+		Logger::logMessage(MessageType::Error, (string("Log replay: wrong log descriptor ") + descriptorFile).c_str());
+
+	//steps are saved as: s', a, r and stats
+	vector<string> stateVariables, actionVariables, rewardVariables;
+	size_t numStats = 0;
+	for (ConfigNode* pVariable = pRoot->getChild(); pVariable != nullptr; pVariable = pVariable->getNextSibling())
+	{
+		const char* name = pVariable->GetText() ? pVariable->GetText() : "";
+		if (!strcmp(pVariable->getName(), "State-variable")) stateVariables.push_back(name);
+		else if (!strcmp(pVariable->getName(), "Action-variable")) actionVariables.push_back(name);
+		else if (!strcmp(pVariable->getName(), "Reward-variable")) rewardVariables.push_back(name);
+		else if (!strcmp(pVariable->getName(), "Stat-variable")) ++numStats;
+	}
+	size_t numVariables = stateVariables.size() + actionVariables.size() + rewardVariables.size() + numStats;
+
+	ReplayLog* pLog = new ReplayLog();
+	m_logs.push_back(unique_ptr<ReplayLog>(pLog));
+	pLog->stateColumns = findColumns(stateDescriptor, stateVariables, 0, descriptorFile);
+	pLog->actionColumns = findColumns(actionDescriptor, actionVariables, stateVariables.size(), descriptorFile);
+	pLog->rewardColumns = findColumns(rewardDescriptor, rewardVariables
+		, stateVariables.size() + actionVariables.size(), descriptorFile);
+
+	string binaryFile = getDirectory(descriptorFile) + pRoot->Attribute("BinaryDataFile");
+	if (!pLog->file.open(binaryFile.c_str()) || pLog->file.size() < sizeof(ExperimentHeader))
+		Logger::logMessage(MessageType::Error, (string("Log replay: couldn't open ") + binaryFile).c_str());
+
+	//find the episodes. All the steps of an episode have the same size, so only their headers need to be read
+	const char* pData = pLog->file.data() + sizeof(ExperimentHeader);
+	const char* pEnd = pLog->file.data() + pLog->file.size();
+	size_t numSkippedEpisodes = 0;
+	while (pEnd - pData >= (ptrdiff_t)sizeof(EpisodeHeader)
+		&& ((const EpisodeHeader*)pData)->magicNumber == EPISODE_HEADER)
+	{
+		const EpisodeHeader* pHeader = (const EpisodeHeader*)pData;
+		ReplayEpisode episode;
+		episode.pLog = pLog;
+		episode.pFirstStep = pData + sizeof(EpisodeHeader);
+		episode.stepSize = sizeof(StepHeader) + sizeof(double) * (size_t)pHeader->numVariablesLogged;
+		episode.numSteps = 0;
+
+		const char* pStep = episode.pFirstStep;
+		while (pEnd - pStep >= (ptrdiff_t)episode.stepSize && ((const StepHeader*)pStep)->magicNumber == STEP_HEADER)
+		{
+			pStep += episode.stepSize;
+			++episode.numSteps;
+		}
+		bool bEnded = pEnd - pStep >= (ptrdiff_t)sizeof(StepHeader)
+			&& ((const StepHeader*)pStep)->magicNumber == EPISODE_END_HEADER;
+
+		//an episode can only be replayed if every step was logged
+		const StepHeader* pFirstStepHeader = (const StepHeader*)episode.pFirstStep;
+		const StepHeader* pLastStepHeader = (const StepHeader*)(pStep - episode.stepSize);
+		if ((size_t)pHeader->numVariablesLogged == numVariables && episode.numSteps > 1
+			&& (size_t)(pLastStepHeader->stepIndex - pFirstStepHeader->stepIndex) == episode.numSteps - 1)
+			m_episodes.push_back(episode);
+		else ++numSkippedEpisodes;
+
+		//the log is truncated (i.e., the experiment was interrupted)
+		if (!bEnded)
+			break;
+		pData = pStep + sizeof(StepHeader);
+	}
+
+	if (numSkippedEpisodes > 0)
+	{
+		char message[512];
+		CrossPlatform::Sprintf_s(message, 512, "Log replay: %d episodes of %s skipped. Not every step was logged"
+			, (int)numSkippedEpisodes, descriptorFile);
+		Logger::logMessage(MessageType::Warning, message);
+	}
+}
+
+void LogReplay::prefetch(const ReplayEpisode& episode)
+{
+	const MemoryMappedFile& file = episode.pLog->file;
+	file.prefetch((size_t)(episode.pFirstStep - file.data()), episode.numSteps * episode.stepSize);
+}
+
+static void setLoggedValues(NamedVarSet* pVarSet, const double* pValues, const vector<size_t>& columns)
+{
+	for (size_t i = 0; i < columns.size(); ++i)
+		pVarSet->set(i, pValues[columns[i]]);
+}
+
+void LogReplay::nextEpisode(State* s)
+{
+	m_pEpisode = &m_episodes[m_nextEpisode];
+	m_nextEpisode = (m_nextEpisode + 1) % m_episodes.size();
+
+	//the next episode is read from disk while this one is replayed
+	prefetch(m_episodes[m_nextEpisode]);
+
+	//the first step logged holds the state reached after the first step of the episode. The initial state wasn't logged
+	const double* pValues = (const double*)(m_pEpisode->pFirstStep + sizeof(StepHeader));
+	setLoggedValues(s, pValues, m_pEpisode->pLog->stateColumns);
+	m_nextStep = 1;
+}
+
+bool LogReplay::nextStep(Action* a, State* s_p, Reward* r)
+{
+	if (m_pEpisode == nullptr || m_nextStep >= m_pEpisode->numSteps)
+		return false;
+
+	const double* pValues = (const double*)(m_pEpisode->pFirstStep + m_nextStep * m_pEpisode->stepSize
+		+ sizeof(StepHeader));
+	setLoggedValues(a, pValues, m_pEpisode->pLog->actionColumns);
+	setLoggedValues(s_p, pValues, m_pEpisode->pLog->stateColumns);
+	setLoggedValues(r, pValues, m_pEpisode->pLog->rewardColumns);
+	++m_nextStep;
+	return true;
+}
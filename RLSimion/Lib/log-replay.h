@@ -0,0 +1,64 @@
+#pragma once
+
+#include "parameters.h"
+#include "../../tools/System/MemoryMappedFile.h"
+#include <vector>
+#include <memory>
+using namespace std;
+
+class ConfigNode;
+class Descriptor;
+class NamedVarSet;
+typedef NamedVarSet State;
+typedef NamedVarSet Action;
+typedef NamedVarSet Reward;
+
+//Offline training: training episodes replay the tuples <s,a,s',r> saved in the logs of previous experiments instead of
+//being simulated, so learning is only limited by how fast the logs can be read. Evaluation episodes are still run in the
+//world. Logged variables are matched by name with those of the world and only episodes logged every step can be replayed
+//(Log-Freq not greater than the world's Delta-T). Each training episode replays the next logged episode, and the logs
+//are started over once all their episodes have been replayed
+class LogReplay
+{
+	MULTI_VALUE_SIMPLE_PARAM<FILE_PATH_PARAM, const char*> m_logFiles;
+
+	//a mapped binary log and the position of each variable of the world in its steps
+	struct ReplayLog
+	{
+		MemoryMappedFile file;
+		vector<size_t> stateColumns;
+		vector<size_t> actionColumns;
+		vector<size_t> rewardColumns;
+	};
+	struct ReplayEpisode
+	{
+		const ReplayLog* pLog;
+		const char* pFirstStep;
+		size_t stepSize;
+		size_t numSteps;
+	};
+	vector<unique_ptr<ReplayLog>> m_logs;
+	vector<ReplayEpisode> m_episodes;
+
+	size_t m_nextEpisode = 0;
+	const ReplayEpisode* m_pEpisode = nullptr;
+	size_t m_nextStep = 0;
+
+	void loadLog(const char* descriptorFile, const Descriptor& stateDescriptor, const Descriptor& actionDescriptor
+		, const Descriptor& rewardDescriptor);
+	void prefetch(const ReplayEpisode& episode);
+public:
+	LogReplay(ConfigNode* pConfigNode);
+	LogReplay() = default;
+
+	bool bUsing() const { return m_logFiles.size() > 0; }
+
+	//maps the logs and finds their episodes. The variables of the world must be found in all the logs
+	void init(const Descriptor& stateDescriptor, const Descriptor& actionDescriptor, const Descriptor& rewardDescriptor);
+
+	//begins replaying the next logged episode: s is set to its first state
+	void nextEpisode(State* s);
+	//reads the next tuple of the episode: the action taken, the state reached and the reward received.
+	//Returns false when the episode has no more tuples
+	bool nextStep(Action* a, State* s_p, Reward* r);
+};
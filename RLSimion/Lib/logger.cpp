@@ -9,67 +9,15 @@
 #include "app.h"
 #include "utils.h"
 #include "experiment.h"
+#include "checkpoint.h"
 #include <algorithm>
 
 FILE *Logger::m_logFile = 0;
 MessageOutputMode Logger::m_messageOutputMode = MessageOutputMode::Console;
 NamedPipeClient Logger::m_outputPipe;
 bool Logger::m_bLogMessagesEnabled = true;
-
-#define HEADER_MAX_SIZE 16
-#define EXPERIMENT_HEADER 1
-#define EPISODE_HEADER 2
-#define STEP_HEADER 3
-#define EPISODE_END_HEADER 4
-
-//we pack every int/double as 64bit data to avoid struct-padding issues (the size of the struct might not be the same in C++ and C#
-
-struct ExperimentHeader
-{
-	long long int magicNumber = EXPERIMENT_HEADER;
-	long long int fileVersion = Logger::BIN_FILE_VERSION;
-	long long int numEpisodes = 0;
-
-	long long int padding[HEADER_MAX_SIZE - 3]; //extra space
-	ExperimentHeader()
-	{
-		memset(padding, 0, sizeof(padding));
-	}
-};
-
-struct EpisodeHeader
-{
-	long long int magicNumber = EPISODE_HEADER;
-	long long int episodeType;
-	long long int episodeIndex;
-	long long int numVariablesLogged;
-
-	//Added in version 2: if the episode belongs to an evaluation, the number of episodes per evaluation might be >1
-	//the episodeSubIndex will be in [1..numEpisodesPerEvaluation]
-	long long int episodeSubIndex;
-
-	long long int padding[HEADER_MAX_SIZE - 5]; //extra space
-	EpisodeHeader()
-	{
-		memset(padding, 0, sizeof(padding));
-	}
-};
-
-struct StepHeader
-{
-	long long int magicNumber = STEP_HEADER;
-	long long int stepIndex;
-
-	double experimentRealTime;
-	double episodeSimTime;
-	double episodeRealTime;
-
-	long long int padding[HEADER_MAX_SIZE - 5]; //extra space
-	StepHeader()
-	{
-		memset(padding, 0, sizeof(padding));
-	}
-};
+std::vector<char>* Logger::m_pLogCapture = nullptr;
+std::vector<std::pair<MessageType, std::string>>* Logger::m_pMessageCapture = nullptr;
 
 Logger::Logger(ConfigNode* pConfigNode)
 {
@@ -84,6 +32,8 @@ Logger::Logger(ConfigNode* pConfigNode)
 	m_bLogFunctions = BOOL_PARAM(pConfigNode, "Log-Functions", "Log functions learned?", true);
 	m_numFunctionLogPoints = INT_PARAM(pConfigNode, "Num-Functions-Logged", "How many times per experiment save logged functions", 10);
 
+	m_bProfileSteps = BOOL_PARAM(pConfigNode, "Profile-Steps", "Log the time spent in each phase of the simulation steps and in each simion", false);
+
 	m_pEpisodeTimer = new Timer();
 	m_pExperimentTimer = new Timer();
 	m_lastLogSimulationT = 0.0;
@@ -103,9 +53,6 @@ void Logger::setOutputFilenames()
 	m_outputLogBinary = inputConfigFile + LOG_BINARY_EXTENSION;
 	SimionApp::get()->registerOutputFile(m_outputLogBinary.c_str());
 
-	//open the log file
-	openLogFile(m_outputLogBinary.c_str());
-
 	if (m_bLogFunctions.get())
 	{
 		m_outputFunctionLogBinary = inputConfigFile + FUNCTION_LOG_BINARY_EXTENSION;
@@ -208,17 +155,79 @@ void Logger::writeNamedVarSetDescriptorToBuffer(char* pOutBuffer, const char* id
 
 void Logger::firstEpisode()
 {
+	//logged by the parent process before the worker was forked
+	if (m_bWorkerProcess) return;
+
+	m_bLogStarted = true;
+
 	//set episode start time
 	m_pEpisodeTimer->start();
 
-	//generate the xml descriptor of the log file
+	//generate the xml descriptor of the log file. It is generated again when the experiment is resumed, in case it was
+	//lost
 	writeLogFileXMLDescriptor(m_outputLogDescriptor.c_str());
-	//write the log file header
-	writeExperimentHeader();
+
+	//open the log file and write its header, unless the one the checkpoint was saved with is found
+	if (m_bResumed)
+		m_logFile = resumeFile(m_outputLogBinary.c_str(), m_resumedLogSize);
+	if (!m_logFile)
+	{
+		if (m_bResumed)
+			logMessage(MessageType::Warning, "The log file couldn't be resumed: the episodes logged before the checkpoint are lost");
+		openLogFile(m_outputLogBinary.c_str());
+		writeExperimentHeader();
+	}
 
 	//write the function log header
 	if (areFunctionsLogged())
-		openFunctionLogFile(m_outputFunctionLogBinary.c_str());
+	{
+		if (m_bResumed)
+			m_functionLogFile = resumeFile(m_outputFunctionLogBinary.c_str(), m_resumedFunctionLogSize);
+		if (!m_functionLogFile)
+			openFunctionLogFile(m_outputFunctionLogBinary.c_str());
+	}
+}
+
+FILE* Logger::resumeFile(const char* filename, long long size)
+{
+	if (size <= 0)
+		return nullptr;
+
+	FILE* pFile;
+	CrossPlatform::Fopen_s(&pFile, filename, "r+b");
+	if (!pFile)
+		return nullptr;
+
+	//anything written after the checkpoint was saved is overwritten
+	if (CrossPlatform::Fseek64(pFile, 0, SEEK_END) != 0 || CrossPlatform::Ftell64(pFile) < size
+		|| CrossPlatform::Ftruncate(pFile, size) != 0 || CrossPlatform::Fseek64(pFile, size, SEEK_SET) != 0)
+	{
+		fclose(pFile);
+		return nullptr;
+	}
+	return pFile;
+}
+
+//the size of a file open for writing, with everything written so far flushed to it
+static long long getFileSize(FILE* pFile)
+{
+	if (!pFile)
+		return 0;
+	fflush(pFile);
+	return CrossPlatform::Ftell64(pFile);
+}
+
+void Logger::saveCheckpoint(CheckpointWriter& writer)
+{
+	writer.write(getFileSize(m_logFile));
+	writer.write(getFileSize(m_functionLogFile));
+}
+
+void Logger::loadCheckpoint(CheckpointReader& reader)
+{
+	m_resumedLogSize = reader.read<long long>();
+	m_resumedFunctionLogSize = reader.read<long long>();
+	m_bResumed = true;
 }
 
 void Logger::lastEpisode()
@@ -245,6 +254,12 @@ void Logger::firstStep()
 		writeEpisodeHeader();
 
 	//log all the functions if need to
+	if (!m_bWorkerProcess)
+		sampleFunctions();
+}
+
+void Logger::sampleFunctions()
+{
 	if (areFunctionsLogged())
 	{
 		size_t functionLogFreq = 1;
@@ -261,6 +276,26 @@ void Logger::firstStep()
 	}
 }
 
+void Logger::beginWorkerEpisode()
+{
+	if (!m_bLogStarted)
+		firstEpisode();
+
+	sampleFunctions();
+}
+
+void Logger::setWorkerProcess(std::vector<char>* pLog, std::vector<std::pair<MessageType, std::string>>* pMessages)
+{
+	m_bWorkerProcess = true;
+	m_pLogCapture = pLog;
+	m_pMessageCapture = pMessages;
+}
+
+void Logger::setLogCapture(std::vector<char>* pLog)
+{
+	m_pLogCapture = pLog;
+}
+
 void Logger::lastStep()
 {
 	Experiment* pExperiment = SimionApp::get()->pExperiment.ptr();
@@ -441,11 +476,15 @@ void Logger::closeLogFile()
 {
 	if (m_logFile)
 		fclose(m_logFile);
+	//the file handle is static: another logger mustn't close it again
+	m_logFile = nullptr;
 }
 
 void Logger::writeLogBuffer(const char* pBuffer, int numBytes)
 {
-	if (m_logFile)
+	if (m_pLogCapture)
+		m_pLogCapture->insert(m_pLogCapture->end(), pBuffer, pBuffer + numBytes);
+	else if (m_logFile)
 		fwrite(pBuffer, 1, numBytes, m_logFile);
 }
 
@@ -458,6 +497,16 @@ void Logger::logMessage(MessageType type, const char* message)
 {
 	char messageLine[1024];
 
+	//messages of worker processes are output by the parent. Progress is only reported by the parent
+	if (m_pMessageCapture)
+	{
+		if (type == MessageType::Error)
+			throw std::runtime_error(message);
+		if (type != MessageType::Progress)
+			m_pMessageCapture->push_back(std::make_pair(type, std::string(message)));
+		return;
+	}
+
 	if (m_messageOutputMode == MessageOutputMode::NamedPipe && m_outputPipe.isConnected())
 	{
 		switch (type)
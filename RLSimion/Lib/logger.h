@@ -1,9 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <utility>
+#include <cstring>
 #include "parameters.h"
 #include "../../tools/System/NamedPipe.h"
 #include "stats.h"
+#include "profiler.h"
 
 class NamedVarSet;
 typedef NamedVarSet State;
@@ -13,6 +17,8 @@ class ConfigNode;
 class Descriptor;
 class Timer;
 class FunctionSampler;
+class CheckpointWriter;
+class CheckpointReader;
 
 enum MessageType {Progress,Evaluation,Info,Warning, Error};
 enum MessageOutputMode {Console,NamedPipe};
@@ -52,6 +58,15 @@ class Logger
 	void openLogFile(const char* fullLogFilename);
 	void closeLogFile();
 
+	//the log files are opened when the first episode begins or, if the experiment was resumed from a checkpoint, when
+	//the first episode after the checkpoint begins. Then, the files are truncated to the size they had when the
+	//checkpoint was saved and the episodes logged before it are kept
+	bool m_bLogStarted = false;
+	bool m_bResumed = false;
+	long long m_resumedLogSize = 0;
+	long long m_resumedFunctionLogSize = 0;
+	static FILE* resumeFile(const char* filename, long long size);
+
 private:
 	static void writeLogBuffer(const char* pBuffer, int numBytes);
 	void writeLogFileXMLDescriptor(const char* filename);
@@ -70,6 +85,15 @@ private:
 
 	//stats
 	std::vector<IStats *> m_stats;
+
+	//evaluation episodes run by worker processes (see EvaluationWorkers)
+	bool m_bWorkerProcess = false;
+	static std::vector<char>* m_pLogCapture;
+	static std::vector<std::pair<MessageType, std::string>>* m_pMessageCapture;
+	void sampleFunctions();
+
+	BOOL_PARAM m_bProfileSteps;
+	StepProfiler m_profiler;
 public:
 	static const unsigned int BIN_FILE_VERSION = 2;
 
@@ -94,6 +118,10 @@ public:
 	size_t getNumStats();
 	IStats* getStats(unsigned int i);
 
+	//the step profiler is only enabled if Profile-Steps is set
+	bool isStepProfilingEnabled() { return m_bProfileSteps.get(); }
+	StepProfiler& getProfiler() { return m_profiler; }
+
 	void setOutputFilenames();
 
 	static MessageOutputMode m_messageOutputMode;
@@ -109,11 +137,86 @@ public:
 protected:
 	friend class Experiment;
 	//METHODS CALLED FROM Experiment
-	//called to log episodes
+	//called to log episodes. firstEpisode() is called at the beginning of the first episode run, which is not the first
+	//episode of the experiment if it was resumed from a checkpoint
+	bool isLogStarted() const { return m_bLogStarted; }
 	void firstEpisode();
 	void lastEpisode();
 	//called to log steps
 	void firstStep();
 	void lastStep();
 	void timestep(State* s, Action* a, State* s_p,Reward* r);
-};
\ No newline at end of file
+
+	friend class EvaluationWorkers;
+	//METHODS CALLED FROM EvaluationWorkers
+	//called in the parent before a worker is forked to run an episode: the beginning of the experiment and the function
+	//samples are only logged by the parent
+	void beginWorkerEpisode();
+	//called in the worker: the episode is logged to memory and the messages are kept to be output by the parent
+	void setWorkerProcess(std::vector<char>* pLog, std::vector<std::pair<MessageType, std::string>>* pMessages);
+	//the parent keeps its log in memory while earlier episodes are being run by workers, so that episodes are
+	//written in order. nullptr writes to the log file again
+	static void setLogCapture(std::vector<char>* pLog);
+
+	friend class CheckpointManager;
+	//METHODS CALLED FROM CheckpointManager
+	//the size of the log files when the checkpoint is saved
+	void saveCheckpoint(CheckpointWriter& writer);
+	void loadCheckpoint(CheckpointReader& reader);
+};
+
+//Binary log format. SimionLogViewer and the C# log readers (Herd/Files/LogFile.cs) keep their own copies of these structures
+#define HEADER_MAX_SIZE 16
+#define EXPERIMENT_HEADER 1
+#define EPISODE_HEADER 2
+#define STEP_HEADER 3
+#define EPISODE_END_HEADER 4
+
+//we pack every int/double as 64bit data to avoid struct-padding issues (the size of the struct might not be the same in C++ and C#
+
+struct ExperimentHeader
+{
+	long long int magicNumber = EXPERIMENT_HEADER;
+	long long int fileVersion = Logger::BIN_FILE_VERSION;
+	long long int numEpisodes = 0;
+
+	long long int padding[HEADER_MAX_SIZE - 3]; //extra space
+	ExperimentHeader()
+	{
+		memset(padding, 0, sizeof(padding));
+	}
+};
+
+struct EpisodeHeader
+{
+	long long int magicNumber = EPISODE_HEADER;
+	long long int episodeType;
+	long long int episodeIndex;
+	long long int numVariablesLogged;
+
+	//Added in version 2: if the episode belongs to an evaluation, the number of episodes per evaluation might be >1
+	//the episodeSubIndex will be in [1..numEpisodesPerEvaluation]
+	long long int episodeSubIndex;
+
+	long long int padding[HEADER_MAX_SIZE - 5]; //extra space
+	EpisodeHeader()
+	{
+		memset(padding, 0, sizeof(padding));
+	}
+};
+
+struct StepHeader
+{
+	long long int magicNumber = STEP_HEADER;
+	long long int stepIndex;
+
+	double experimentRealTime;
+	double episodeSimTime;
+	double episodeRealTime;
+
+	long long int padding[HEADER_MAX_SIZE - 5]; //extra space
+	StepHeader()
+	{
+		memset(padding, 0, sizeof(padding));
+	}
+};
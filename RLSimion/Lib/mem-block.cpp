@@ -1,10 +1,9 @@
 #include "mem-block.h"
 #include "mem-pool.h"
 #include "../../tools/System/CrossPlatform.h"
-#include <limits>
 
-MemBlock::MemBlock(SimionMemPool* pPool, int id, size_t blockSize)
-	: m_pPool(pPool), m_blockSize(blockSize), m_id (id)
+MemBlock::MemBlock(SimionMemPool* pPool, int id, size_t blockSize, size_t valueSize)
+	: m_pPool(pPool), m_blockSize(blockSize), m_valueSize(valueSize), m_id (id)
 {
 }
 
@@ -14,19 +13,9 @@ MemBlock::~MemBlock()
 		delete[] m_pBuffer;
 }
 
-double& MemBlock::operator[](size_t index)
+char* MemBlock::deallocate()
 {
-	m_lastAccess = m_pPool->getAccessCounter();
-	if (m_lastAccess == std::numeric_limits<BUFFER_SIZE>::max())
-	{
-		m_pPool->resetAccessCounter();
-	}
-	return m_pBuffer[index];
-}
-
-double* MemBlock::deallocate()
-{
-	double* pBuffer = m_pBuffer;
+	char* pBuffer = m_pBuffer;
 	m_pBuffer = 0;
 	m_bInitialized = true; //must be restored from file
 	return pBuffer;
@@ -44,7 +33,7 @@ void MemBlock::dumpToFile()
 	if (pFile)
 	{
 		m_bDumped = true;
-		fwrite(m_pBuffer, sizeof(double), m_blockSize, pFile);
+		fwrite(m_pBuffer, m_valueSize, m_blockSize, pFile);
 		fclose(pFile);
 	}
 }
@@ -59,12 +48,12 @@ void MemBlock::restoreFromFile()
 	if (pFile)
 	{
 		m_bDumped = false;
-		CrossPlatform::Fread_s(m_pBuffer,sizeof(double)*m_blockSize, sizeof(double), m_blockSize, pFile);
+		CrossPlatform::Fread_s(m_pBuffer, m_valueSize*m_blockSize, m_valueSize, m_blockSize, pFile);
 		fclose(pFile);
 	}
 }
 
-void MemBlock::setBuffer(double *pMemBuffer)
+void MemBlock::setBuffer(char *pMemBuffer)
 {
 	m_pBuffer = pMemBuffer;
 }
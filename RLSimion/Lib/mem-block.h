@@ -7,32 +7,33 @@ class SimionMemPool;
 class MemBlock
 {
 	SimionMemPool* m_pPool;
-	double* m_pBuffer = nullptr;
+	//the values are stored with the precision of the pool: m_blockSize values of m_valueSize bytes each
+	char* m_pBuffer = nullptr;
 	size_t m_blockSize = 0;
+	size_t m_valueSize = 0;
 	bool m_bInitialized = false;
-	BUFFER_SIZE m_lastAccess = 0;
 	int m_id;
 	bool m_bDumped = false;
 
 	string getDumpFileName();
 public:
-	MemBlock(SimionMemPool* pPool,int id, size_t elementCount);
+	MemBlock(SimionMemPool* pPool,int id, size_t elementCount, size_t valueSize);
 	virtual ~MemBlock();
 
 	bool bAllocated() const { return m_pBuffer != nullptr; }
-	double* deallocate();
+	char* deallocate();
 
 	void restoreFromFile();
 	void dumpToFile();
 
-	void setBuffer(double* pBuffer);
+	void setBuffer(char* pBuffer);
 	size_t size() const { return m_blockSize; }
 	bool bInitialized() const { return m_bInitialized; }
 	void setInitialized() { m_bInitialized= true; }
-	BUFFER_SIZE getLastAccess() const { return m_lastAccess; }
-	void setLastAccess(BUFFER_SIZE newValue) { m_lastAccess = newValue; }
 	int getId() const { return m_id; }
 
-	double& operator[](size_t index);
+	char* getData() { return m_pBuffer; }
+	//returns the address of the index-th value of the block
+	char* getValueAddress(size_t index) { return m_pBuffer + index * m_valueSize; }
 };
 
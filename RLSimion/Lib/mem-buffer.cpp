@@ -1,6 +1,7 @@
 #include "mem-pool.h"
 #include "mem-block.h"
 #include "mem-buffer.h"
+#include <stdexcept>
 
 
 SimpleMemBuffer::SimpleMemBuffer(IMemPool* pPool, BUFFER_SIZE elementCount)
@@ -35,10 +36,22 @@ SimionMemBuffer::~SimionMemBuffer()
 
 double& SimionMemBuffer::operator[](BUFFER_SIZE index)
 {
+	if (m_pPool->getPrecision() != WeightPrecision::float64)
+		throw std::runtime_error("SimionMemBuffer: reduced-precision buffers must be accessed using get()/set()");
 	return m_pPool->get((int)index,m_offset);
 }
 
+double SimionMemBuffer::get(BUFFER_SIZE index)
+{
+	return m_pPool->getValue(index, m_offset);
+}
+
+void SimionMemBuffer::set(BUFFER_SIZE index, double value)
+{
+	m_pPool->setValue(index, m_offset, value);
+}
+
 BUFFER_SIZE SimionMemBuffer::getBlockSizeInBytes()
 {
-	return m_pPool->getBlockSize()*sizeof(double);
+	return m_pPool->getBlockSize()*m_pPool->getValueSize();
 }
\ No newline at end of file
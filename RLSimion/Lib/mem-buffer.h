@@ -13,6 +13,8 @@ public:
 	~SimpleMemBuffer();
 
 	double& operator[](BUFFER_SIZE index);
+	double get(BUFFER_SIZE index) { return m_pBuffer[index]; }
+	void set(BUFFER_SIZE index, double value) { m_pBuffer[index] = value; }
 };
 
 class SimionMemBuffer: public IMemBuffer
@@ -35,5 +37,7 @@ public:
 	SimionMemPool* getPool() { return m_pPool; }
 
 	double& operator[](BUFFER_SIZE index);
+	double get(BUFFER_SIZE index);
+	void set(BUFFER_SIZE index, double value);
 };
 
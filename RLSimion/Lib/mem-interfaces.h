@@ -1,6 +1,10 @@
 #pragma once
 #include "mem-manager.h"
+#include "parameters.h"
 class IMemBuffer;
+class CheckpointWriter;
+class CheckpointReader;
+class ThreadPool;
 
 class IMemPool
 {
@@ -12,9 +16,16 @@ public:
 
 	virtual IMemBuffer* getHandler(BUFFER_SIZE elementCount)= 0;
 	virtual void init(BUFFER_SIZE blockSize= 524288) = 0;
-	virtual bool bCanAllocate(BUFFER_SIZE elementCount) const = 0;
+	virtual bool bCanAllocate(BUFFER_SIZE elementCount, WeightPrecision precision) const = 0;
 	virtual void copy(IMemBuffer* pSrc, IMemBuffer* pDst) = 0;
 
+	//save/restore the contents of all the buffers of the pool
+	virtual void saveCheckpoint(CheckpointWriter& writer) = 0;
+	virtual void loadCheckpoint(CheckpointReader& reader) = 0;
+
+	//brings to memory and initializes in parallel all the blocks of the pool that aren't in memory yet
+	virtual void preload(ThreadPool& threadPool) {}
+
 	virtual void setMemLimit(BUFFER_SIZE memLimit) { m_memLimit = memLimit; }
 
 	BUFFER_SIZE getTotalAllocatedMem() const { return m_totalAllocatedMem; }
@@ -32,7 +43,11 @@ public:
 	IMemBuffer(IMemPool* pPool, BUFFER_SIZE numElements) { m_pPool = pPool; m_numElements = numElements; }
 	virtual ~IMemBuffer() {};
 
+	//direct access to the values. It can only be used with double-precision buffers
 	virtual double& operator[](BUFFER_SIZE index)= 0;
+	//these can be used with any precision: values are converted from/to double
+	virtual double get(BUFFER_SIZE index) = 0;
+	virtual void set(BUFFER_SIZE index, double value) = 0;
 	void setInitValue(double value) { m_initValue = value; m_bInitValueSet = true; }
 	bool bInitValueSet() const { return m_bInitValueSet; }
 	double getInitValue() const { return m_initValue; }
@@ -12,6 +12,9 @@ using namespace std;
 #include "mem-buffer.h"
 #include "mem-pool.h"
 #include "deferred-load.h"
+#include "checkpoint.h"
+#include "../../tools/System/ThreadPool.h"
+#include <stdexcept>
 
 template <typename MemPoolType>
 class MemManager: public DeferredLoad
@@ -22,17 +25,18 @@ class MemManager: public DeferredLoad
 	//This should be a short list. Not likely worth using a map instead of a vector
 	vector<IMemPool*>m_memPools;
 	
-	IMemPool* getMemPool(BUFFER_SIZE elementCount)
+	//Buffers stored with different precisions can't be interleaved, so they are kept in different pools
+	IMemPool* getMemPool(BUFFER_SIZE elementCount, WeightPrecision precision)
 	{
 		for (auto it = m_memPools.begin(); it != m_memPools.end(); ++it)
 		{
-			if ((*it)->bCanAllocate(elementCount))
+			if ((*it)->bCanAllocate(elementCount, precision))
 			{
 				return (*it);
 			}
 		}
 
-		m_memPools.push_back(new MemPoolType(elementCount));
+		m_memPools.push_back(new MemPoolType(elementCount, precision));
 		return m_memPools.back();
 	}
 public:
@@ -65,9 +69,11 @@ public:
 		return true;
 	}
 
-	IMemBuffer* getMemBuffer(BUFFER_SIZE elementCount)
+	//precision: the type used to store the values. Reduced precision (float32/float16) buffers use less memory but
+	//their values can only be accessed using IMemBuffer::get()/set()
+	IMemBuffer* getMemBuffer(BUFFER_SIZE elementCount, WeightPrecision precision = WeightPrecision::float64)
 	{
-		IMemPool* pMemPool = getMemPool(elementCount);
+		IMemPool* pMemPool = getMemPool(elementCount, precision);
 		return pMemPool->getHandler(elementCount);
 	}
 
@@ -77,6 +83,16 @@ public:
 			(*it)->init(blockSize);
 	}
 
+	//Blocks are otherwise allocated and initialized on first access, one at a time. Preloading them uses all the cores
+	//and, because each block is first written by the thread that initializes it, their pages are spread across the
+	//NUMA nodes of the machine instead of all being placed in the node of the main thread
+	void preload()
+	{
+		ThreadPool threadPool;
+		for (auto it = m_memPools.begin(); it != m_memPools.end(); ++it)
+			(*it)->preload(threadPool);
+	}
+
 	BUFFER_SIZE getTotalAllocatedMem() const
 	{
 		BUFFER_SIZE total = 0;
@@ -105,6 +121,21 @@ public:
 	{
 		init();
 	}
+
+	void saveCheckpoint(CheckpointWriter& writer)
+	{
+		writer.write((uint64_t)m_memPools.size());
+		for (auto it = m_memPools.begin(); it != m_memPools.end(); ++it)
+			(*it)->saveCheckpoint(writer);
+	}
+
+	void loadCheckpoint(CheckpointReader& reader)
+	{
+		if (reader.read<uint64_t>() != m_memPools.size())
+			throw std::runtime_error("Checkpoint: the saved memory pools don't match the experiment");
+		for (auto it = m_memPools.begin(); it != m_memPools.end(); ++it)
+			(*it)->loadCheckpoint(reader);
+	}
 };
 
 
@@ -2,10 +2,14 @@
 #include "mem-buffer.h"
 #include "mem-block.h"
 #include "mem-manager.h"
+#include "checkpoint.h"
+#include "../../tools/System/ThreadPool.h"
+#include "../CNTKWrapper/HalfConverter.hpp"
 #include <string>
 #include <algorithm>
+#include <stdexcept>
 
-SimpleMemPool::SimpleMemPool(BUFFER_SIZE elementCount) {}
+SimpleMemPool::SimpleMemPool(BUFFER_SIZE elementCount, WeightPrecision precision) {}
 SimpleMemPool::~SimpleMemPool()
 {
 	for (auto it = m_buffers.begin(); it != m_buffers.end(); ++it)
@@ -35,13 +39,44 @@ void SimpleMemPool::copy(IMemBuffer* pSrc, IMemBuffer* pDst)
 }
 
 
+void SimpleMemPool::saveCheckpoint(CheckpointWriter& writer)
+{
+	writer.write((uint64_t)m_buffers.size());
+	for (IMemBuffer* pBuffer : m_buffers)
+	{
+		writer.write((uint64_t)pBuffer->getNumElements());
+		for (BUFFER_SIZE i = 0; i < pBuffer->getNumElements(); ++i)
+			writer.write((*pBuffer)[i]);
+	}
+}
+
+void SimpleMemPool::loadCheckpoint(CheckpointReader& reader)
+{
+	if (reader.read<uint64_t>() != m_buffers.size())
+		throw std::runtime_error("Checkpoint: the saved memory pool doesn't match the experiment");
+	for (IMemBuffer* pBuffer : m_buffers)
+	{
+		if (reader.read<uint64_t>() != pBuffer->getNumElements())
+			throw std::runtime_error("Checkpoint: the saved memory pool doesn't match the experiment");
+		for (BUFFER_SIZE i = 0; i < pBuffer->getNumElements(); ++i)
+			(*pBuffer)[i] = reader.read<double>();
+	}
+}
+
 
 //Interleaved Memory Pool
 //a set arrays with the same size are interleaved to improve cache hits
 
-SimionMemPool::SimionMemPool(BUFFER_SIZE numElements)
+SimionMemPool::SimionMemPool(BUFFER_SIZE numElements, WeightPrecision precision)
 {
 	m_numElements = numElements;
+	m_precision = precision;
+	switch (precision)
+	{
+	case WeightPrecision::float32: m_valueSize = sizeof(float); break;
+	case WeightPrecision::float16: m_valueSize = sizeof(unsigned short); break;
+	default: m_valueSize = sizeof(double);
+	}
 }
 
 
@@ -73,106 +108,132 @@ IMemBuffer* SimionMemPool::getHandler(BUFFER_SIZE elementCount)
 }
 
 
-double& SimionMemPool::get(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
+char* SimionMemPool::loadBlock(size_t blockId)
 {
-	++m_accessCounter;
+	char* pMemBuffer= 0;
+	MemBlock* pBlock = m_memBlocks[blockId];
 
-	BUFFER_SIZE elementStartByte = elementIndex*m_elementSize + bufferOffset;
-	BUFFER_SIZE blockId = elementStartByte / m_memBlockSize;
-	BUFFER_SIZE relBlockAddr = elementStartByte % m_memBlockSize;
-	double* pMemBuffer= 0;
-	MemBlock* pBlock = m_memBlocks[(size_t)blockId];
+	//can we allocate more memory?
+	BUFFER_SIZE allocatedMem = getTotalAllocatedMem();
+	BUFFER_SIZE requestedMem = m_memBlockSize * m_valueSize;
 
-	if (!pBlock->bAllocated())
+	if (m_memLimit == 0 || allocatedMem + requestedMem <= m_memLimit)
 	{
-		//can we allocate more memory?
-		BUFFER_SIZE allocatedMem = getTotalAllocatedMem();
-		BUFFER_SIZE requestedMem = m_memBlockSize * sizeof(double);
-
-		if (m_memLimit == 0 || allocatedMem + requestedMem <= m_memLimit)
-		{
-			//try to allocate the memory buffer
-			pMemBuffer = tryToAllocateMem(pBlock->size());
+		//try to allocate the memory buffer
+		pMemBuffer = tryToAllocateMem(pBlock->size());
 
-			if (pMemBuffer)
-			{
-				//memory block successfully allocated
-				m_allocatedMemBlocks.push_back(pBlock);
-				pBlock->setBuffer(pMemBuffer);
-				m_totalAllocatedMem += m_memBlockSize * sizeof(double);
-			}
-		}
-		if (!pMemBuffer)
+		if (pMemBuffer)
 		{
-			//failed to allocate the memory block: either permission was denied or there is no more available memory
-			//recycle some already allocated memory block after dumping it to a file
-			pBlock->setBuffer(recycleMem());
+			//memory block successfully allocated
 			m_allocatedMemBlocks.push_back(pBlock);
+			pBlock->setBuffer(pMemBuffer);
+			m_totalAllocatedMem += m_memBlockSize * m_valueSize;
 		}
-		//initialization
-		if (!pBlock->bInitialized())
-			initialize(pBlock);
-		else pBlock->restoreFromFile();
 	}
+	if (!pMemBuffer)
+	{
+		//failed to allocate the memory block: either permission was denied or there is no more available memory
+		//recycle some already allocated memory block after dumping it to a file
+		pBlock->setBuffer(recycleMem(pBlock));
+	}
+	m_residentBlockData[blockId] = pBlock->getData();
+	m_referencedBlocks[blockId] = 1;
 
+	//initialization
+	if (!pBlock->bInitialized())
+		initialize(pBlock);
+	else pBlock->restoreFromFile();
 
-	return (*pBlock)[relBlockAddr];
+	return pBlock->getData();
 }
 
-bool compare_lastAccess(MemBlock* pFirst, MemBlock* pSecond)
+double& SimionMemPool::get(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
 {
-	return (pFirst->getLastAccess() > pSecond->getLastAccess());
+	return *(double*)getValueAddress(elementIndex, bufferOffset);
 }
 
-double* SimionMemPool::recycleMem()
+static double readValue(const char* pValue, WeightPrecision precision)
 {
-	std::sort(m_allocatedMemBlocks.begin(),m_allocatedMemBlocks.end(),compare_lastAccess);
+	float value;
+	switch (precision)
+	{
+	case WeightPrecision::float32:
+		return *(const float*)pValue;
+	case WeightPrecision::float16:
+		CNTK::float16ToFloat((const unsigned short*)pValue, &value);
+		return value;
+	default:
+		return *(const double*)pValue;
+	}
+}
 
-	//blocks are sorted from last accest to oldest accest
-	MemBlock* pRecycledMemBlock = m_allocatedMemBlocks.back();
-	pRecycledMemBlock->dumpToFile();
-	double* pBuffer= pRecycledMemBlock->deallocate();
-	m_allocatedMemBlocks.pop_back();
-	
-	return pBuffer;
+static void writeValue(char* pValue, WeightPrecision precision, double value)
+{
+	float floatValue = (float)value;
+	switch (precision)
+	{
+	case WeightPrecision::float32:
+		*(float*)pValue = floatValue; break;
+	case WeightPrecision::float16:
+		CNTK::floatToFloat16(&floatValue, (unsigned short*)pValue); break;
+	default:
+		*(double*)pValue = value;
+	}
 }
 
-void SimionMemPool::resetAccessCounter()
+double SimionMemPool::getValue(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
 {
-	std::sort(m_allocatedMemBlocks.begin(), m_allocatedMemBlocks.end(), compare_lastAccess);
+	return readValue(getValueAddress(elementIndex, bufferOffset), m_precision);
+}
 
-	BUFFER_SIZE oldestAccessCounter = m_allocatedMemBlocks.back()->getLastAccess();
-	for (auto it = m_allocatedMemBlocks.begin(); it != m_allocatedMemBlocks.end(); ++it)
-		(*it)->setLastAccess((*it)->getLastAccess() - oldestAccessCounter);
+void SimionMemPool::setValue(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset, double value)
+{
+	writeValue(getValueAddress(elementIndex, bufferOffset), m_precision, value);
+}
 
-	m_accessCounter = 0;
+char* SimionMemPool::recycleMem(MemBlock* pNewBlock)
+{
+	//clock algorithm: blocks referenced since the hand last passed get a second chance
+	while (m_referencedBlocks[m_allocatedMemBlocks[m_clockHand]->getId()])
+	{
+		m_referencedBlocks[m_allocatedMemBlocks[m_clockHand]->getId()] = 0;
+		m_clockHand = (m_clockHand + 1) % m_allocatedMemBlocks.size();
+	}
+
+	MemBlock* pRecycledMemBlock = m_allocatedMemBlocks[m_clockHand];
+	pRecycledMemBlock->dumpToFile();
+	char* pBuffer= pRecycledMemBlock->deallocate();
+	m_residentBlockData[pRecycledMemBlock->getId()] = nullptr;
+
+	m_allocatedMemBlocks[m_clockHand] = pNewBlock;
+	m_clockHand = (m_clockHand + 1) % m_allocatedMemBlocks.size();
+	return pBuffer;
 }
 
 void SimionMemPool::initialize(MemBlock* pBlock)
 {
-	BUFFER_SIZE blockId = pBlock->getId();
-	size_t firstElement = blockId*pBlock->size();
-	size_t numHandlers = (int)m_memBufferHandlers.size();
-	size_t handler;
-	double initValue;
-	for (int i = 0; i < (int) pBlock->size(); ++i)
+	//blocks begin with the first buffer of an element (the block size is a multiple of the element size), so the
+	//values of each buffer are found at a fixed stride from its offset
+	size_t numHandlers = m_memBufferHandlers.size();
+	size_t blockSize = pBlock->size();
+	for (size_t handler = 0; handler < numHandlers; ++handler)
 	{
-		handler = (firstElement+i) % numHandlers;
-		if (m_memBufferHandlers[handler]->bInitValueSet())
-		{
-			initValue = m_memBufferHandlers[handler]->getInitValue();
-			(*pBlock)[i] = initValue;
-		}
+		if (!m_memBufferHandlers[handler]->bInitValueSet())
+			continue;
+
+		double initValue = m_memBufferHandlers[handler]->getInitValue();
+		for (size_t i = handler; i < blockSize; i += numHandlers)
+			writeValue(pBlock->getValueAddress(i), m_precision, initValue);
 	}
 	pBlock->setInitialized();
 }
 
-double* SimionMemPool::tryToAllocateMem(BUFFER_SIZE blockSize)
+char* SimionMemPool::tryToAllocateMem(BUFFER_SIZE blockSize)
 {
-	double* pNewMemBlock;
+	char* pNewMemBlock;
 	try
 	{
-		pNewMemBlock= new double[blockSize];
+		pNewMemBlock= new char[blockSize * m_valueSize];
 		return pNewMemBlock;
 	}
 	catch(std::exception ex)
@@ -200,13 +261,15 @@ void SimionMemPool::init(BUFFER_SIZE blockSize)
 
 	for (size_t i = 0; i < numBlocks; ++i)
 	{
-		pNewMemBlock = new MemBlock(this,i, m_memBlockSize);
+		pNewMemBlock = new MemBlock(this,i, m_memBlockSize, m_valueSize);
 		m_memBlocks.push_back(pNewMemBlock);
 	}
+	m_residentBlockData = vector<char*>(numBlocks, nullptr);
+	m_referencedBlocks = vector<unsigned char>(numBlocks, 0);
 
 	//we may have to correct the maximum amount of memory allowed to accomodate at least one block
 	if (m_memLimit>0)
-		m_memLimit = std::max(m_memLimit, (BUFFER_SIZE)(m_memBlockSize * sizeof(double)));
+		m_memLimit = std::max(m_memLimit, (BUFFER_SIZE)(m_memBlockSize * m_valueSize));
 }
 
 void SimionMemPool::copy(IMemBuffer* pSrc, IMemBuffer* pDst)
@@ -231,7 +294,7 @@ void SimionMemPool::copy(IMemBuffer* pSrc, IMemBuffer* pDst)
 						++maxRelIndexInBlock;
 
 				for (size_t i= minRelIndexInBlock; i<maxRelIndexInBlock; ++i)
-					(*pDstBuffer)[i] = (*pSrcBuffer)[i];
+					pDstBuffer->set(i, pSrcBuffer->get(i));
 				++numBlocksCopied;
 			}
 			blockAbsOffset += m_memBlockSize;
@@ -240,7 +303,68 @@ void SimionMemPool::copy(IMemBuffer* pSrc, IMemBuffer* pDst)
 	}
 }
 
-BUFFER_SIZE SimionMemPool::getAccessCounter()
+char* SimionMemPool::getBlockData(size_t blockId)
 {
-	return ++m_accessCounter;
-}
\ No newline at end of file
+	//the block size is a multiple of the element size, so the block begins with the first buffer of an element
+	return getValueAddress(blockId * m_memBlockSize / m_elementSize, 0);
+}
+
+void SimionMemPool::saveCheckpoint(CheckpointWriter& writer)
+{
+	writer.write((uint64_t)m_memBlocks.size());
+	writer.write((uint64_t)m_memBlockSize);
+	for (size_t block = 0; block < m_memBlocks.size(); ++block)
+	{
+		bool bInitialized = m_memBlocks[block]->bInitialized();
+		writer.write(bInitialized);
+		if (bInitialized)
+			writer.write(getBlockData(block), m_memBlockSize * m_valueSize);
+	}
+}
+
+void SimionMemPool::loadCheckpoint(CheckpointReader& reader)
+{
+	if (reader.read<uint64_t>() != m_memBlocks.size() || reader.read<uint64_t>() != m_memBlockSize)
+		throw std::runtime_error("Checkpoint: the saved memory pool doesn't match the experiment");
+
+	for (size_t block = 0; block < m_memBlocks.size(); ++block)
+	{
+		if (reader.read<bool>())
+			reader.read(getBlockData(block), m_memBlockSize * m_valueSize);
+	}
+}
+
+void SimionMemPool::preload(ThreadPool& threadPool)
+{
+	BUFFER_SIZE blockBytes = m_memBlockSize * m_valueSize;
+	if (m_memLimit != 0 && m_memBlocks.size() * blockBytes > m_memLimit)
+		return;
+
+	//each task allocates and initializes/restores one block. The pool's bookkeeping isn't touched by the tasks
+	threadPool.parallelFor(m_memBlocks.size(), [this](size_t blockId)
+	{
+		MemBlock* pBlock = m_memBlocks[blockId];
+		if (pBlock->bAllocated())
+			return;
+
+		char* pMemBuffer = tryToAllocateMem(pBlock->size());
+		if (!pMemBuffer)
+			return;
+
+		pBlock->setBuffer(pMemBuffer);
+		if (!pBlock->bInitialized())
+			initialize(pBlock);
+		else pBlock->restoreFromFile();
+	});
+
+	for (size_t blockId = 0; blockId < m_memBlocks.size(); ++blockId)
+	{
+		MemBlock* pBlock = m_memBlocks[blockId];
+		if (m_residentBlockData[blockId] == nullptr && pBlock->bAllocated())
+		{
+			m_residentBlockData[blockId] = pBlock->getData();
+			m_allocatedMemBlocks.push_back(pBlock);
+			m_totalAllocatedMem += blockBytes;
+		}
+	}
+}
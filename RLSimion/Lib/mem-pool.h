@@ -8,19 +8,23 @@ using namespace std;
 
 class MemBlock;
 
+//SimpleMemPool always stores doubles, whatever the requested precision
 class SimpleMemPool : public IMemPool
 {
 	vector<IMemBuffer*> m_buffers;
 
 public:
-	SimpleMemPool(BUFFER_SIZE elementCount);
+	SimpleMemPool(BUFFER_SIZE elementCount, WeightPrecision precision);
 	virtual ~SimpleMemPool();
 	virtual IMemBuffer* getHandler(BUFFER_SIZE elementCount);
-	virtual bool bCanAllocate(BUFFER_SIZE elementCount) const { return true; }
+	virtual bool bCanAllocate(BUFFER_SIZE elementCount, WeightPrecision precision) const { return true; }
 
 	void copy(IMemBuffer* pSrc, IMemBuffer* pDst);
 
 	virtual void init(BUFFER_SIZE blockSize);
+
+	void saveCheckpoint(CheckpointWriter& writer);
+	void loadCheckpoint(CheckpointReader& reader);
 };
 
 class SimionMemPool: public IMemPool
@@ -31,38 +35,81 @@ class SimionMemPool: public IMemPool
 	//Local collection of mem. buffer handlers
 	vector<SimionMemBuffer*> m_memBufferHandlers;
 	vector<MemBlock*> m_memBlocks;
+	//Data of the blocks in memory, indexed by block id (nullptr if the block is not in memory). Accessing a value of a
+	//block in memory only requires reading this vector. Access tracking is only needed to select which block to recycle
+	//and it only happens if the memory is limited: blocks are marked as referenced and recycled using the clock algorithm
+	vector<char*> m_residentBlockData;
+	//set when a block is accessed and cleared by the clock hand when looking for a block to recycle
+	vector<unsigned char> m_referencedBlocks;
+	//blocks in memory, in the order in which the clock hand visits them
 	vector<MemBlock*> m_allocatedMemBlocks;
+	size_t m_clockHand = 0;
 
 	void addMemBufferHandler(SimionMemBuffer* pMemBufferHandler);
-	//This function returns a buffer of size elementCount*sizeof(double)
+	//This function returns a buffer of size elementCount*m_valueSize bytes
 	//or nullptr if "bad_allocation" exception was raised
-	double* tryToAllocateMem(BUFFER_SIZE elementCount);
-	//This function dumpls to a file the memory allocated to some other memory block
-	//marks it as "not allocated" and returns the buffer for recycling
-	double* recycleMem();
+	char* tryToAllocateMem(BUFFER_SIZE elementCount);
+	//This function dumps to a file the memory block pointed by the clock hand that hasn't been referenced since the hand
+	//last passed, marks it as "not allocated" and returns its buffer for recycling. pNewBlock takes its place in the clock
+	char* recycleMem(MemBlock* pNewBlock);
 	void initialize(MemBlock* pBlock);
+	//brings a block to memory: allocates or recycles a buffer and initializes or restores its data
+	char* loadBlock(size_t blockId);
+
+	//returns the address of a value, bringing its block to memory if needed
+	char* getValueAddress(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset)
+	{
+		BUFFER_SIZE elementStartByte = elementIndex*m_elementSize + bufferOffset;
+		BUFFER_SIZE blockId = elementStartByte / m_memBlockSize;
+		BUFFER_SIZE relBlockAddr = elementStartByte % m_memBlockSize;
 
+		char* pBlockData = m_residentBlockData[(size_t)blockId];
+		if (pBlockData == nullptr)
+			pBlockData = loadBlock((size_t)blockId);
+		else if (m_memLimit != 0)
+			m_referencedBlocks[(size_t)blockId] = 1;
+		return pBlockData + relBlockAddr * m_valueSize;
+	}
 	double& get(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset);
+	double getValue(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset);
+	void setValue(BUFFER_SIZE elementIndex, BUFFER_SIZE bufferOffset, double value);
+	//returns the data of a block, bringing it to memory if needed
+	char* getBlockData(size_t blockId);
+
+	//Values are stored with this precision. Reduced precision values are converted from/to double on access, so all
+	//the arithmetic is done in double precision and only the stored result is rounded
+	WeightPrecision m_precision = WeightPrecision::float64;
+	BUFFER_SIZE m_valueSize = sizeof(double);
 
 	BUFFER_SIZE m_elementSize = 0;
 	BUFFER_SIZE m_numElements = 0;
 	BUFFER_SIZE m_memBlockSize = 0;
-	BUFFER_SIZE m_accessCounter = 0;
 public:
-	SimionMemPool(BUFFER_SIZE elementCount);
+	SimionMemPool(BUFFER_SIZE elementCount, WeightPrecision precision);
 	virtual ~SimionMemPool();
 
 	virtual BUFFER_SIZE getNumElements() const { return m_numElements; }
 	BUFFER_SIZE getElementSize() const { return m_elementSize; }
 	BUFFER_SIZE getBlockSize() const { return m_memBlockSize; }
-	virtual bool bCanAllocate(BUFFER_SIZE elementCount) const { return elementCount == m_numElements; }
-	BUFFER_SIZE getAccessCounter();
-	void resetAccessCounter();
+	WeightPrecision getPrecision() const { return m_precision; }
+	//size in bytes of each value
+	BUFFER_SIZE getValueSize() const { return m_valueSize; }
+	virtual bool bCanAllocate(BUFFER_SIZE elementCount, WeightPrecision precision) const
+	{
+		return elementCount == m_numElements && precision == m_precision;
+	}
 
 	virtual IMemBuffer* getHandler(BUFFER_SIZE elementCount);
 	void copy(IMemBuffer* pSrc, IMemBuffer* pDst);
 
 	//This method must be called after all the SimionMemBuffer's are requested
 	void init(BUFFER_SIZE blockSize);
+
+	//only blocks that have been initialized are saved. The rest will be initialized as usual when first accessed
+	void saveCheckpoint(CheckpointWriter& writer);
+	void loadCheckpoint(CheckpointReader& reader);
+
+	//does nothing if all the blocks of the pool don't fit in the memory limit: they will be loaded when accessed
+	void preload(ThreadPool& threadPool);
 };
 
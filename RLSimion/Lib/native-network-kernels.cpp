@@ -0,0 +1,122 @@
+#include "native-network-kernels.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define NATIVE_KERNELS_SSE2
+	#include <emmintrin.h>
+#endif
+
+//Block sizes of the GEMM kernel: a K_BLOCK x N_BLOCK panel of B (128 KB) stays in L2 while it is multiplied by every
+//row of A
+#define K_BLOCK 128
+#define N_BLOCK 128
+
+namespace NativeKernels
+{
+	void axpy(size_t n, double alpha, const double* x, double* y)
+	{
+		size_t i = 0;
+#ifdef NATIVE_KERNELS_SSE2
+		__m128d a = _mm_set1_pd(alpha);
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128d y0 = _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(a, _mm_loadu_pd(x + i)));
+			__m128d y1 = _mm_add_pd(_mm_loadu_pd(y + i + 2), _mm_mul_pd(a, _mm_loadu_pd(x + i + 2)));
+			_mm_storeu_pd(y + i, y0);
+			_mm_storeu_pd(y + i + 2, y1);
+		}
+#endif
+		for (; i < n; i++)
+			y[i] += alpha * x[i];
+	}
+
+	void axpby(size_t n, double alpha, const double* x, double beta, double* y)
+	{
+		size_t i = 0;
+#ifdef NATIVE_KERNELS_SSE2
+		__m128d a = _mm_set1_pd(alpha);
+		__m128d b = _mm_set1_pd(beta);
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(y + i, _mm_add_pd(_mm_mul_pd(a, _mm_loadu_pd(x + i)), _mm_mul_pd(b, _mm_loadu_pd(y + i))));
+#endif
+		for (; i < n; i++)
+			y[i] = alpha * x[i] + beta * y[i];
+	}
+
+	//C[4 x n]+= A[4 x k] * B[k x n]. Four rows of C are updated at once so that each element of B loaded is used 4 times
+	static void gemmRows4(size_t n, size_t k, const double* A, size_t lda, const double* B, size_t ldb, double* C, size_t ldc)
+	{
+		double* c0 = C;
+		double* c1 = C + ldc;
+		double* c2 = C + 2 * ldc;
+		double* c3 = C + 3 * ldc;
+		size_t j = 0;
+#ifdef NATIVE_KERNELS_SSE2
+		for (; j + 2 <= n; j += 2)
+		{
+			__m128d acc0 = _mm_loadu_pd(c0 + j);
+			__m128d acc1 = _mm_loadu_pd(c1 + j);
+			__m128d acc2 = _mm_loadu_pd(c2 + j);
+			__m128d acc3 = _mm_loadu_pd(c3 + j);
+			for (size_t p = 0; p < k; p++)
+			{
+				__m128d b = _mm_loadu_pd(B + p * ldb + j);
+				acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_set1_pd(A[p]), b));
+				acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_set1_pd(A[lda + p]), b));
+				acc2 = _mm_add_pd(acc2, _mm_mul_pd(_mm_set1_pd(A[2 * lda + p]), b));
+				acc3 = _mm_add_pd(acc3, _mm_mul_pd(_mm_set1_pd(A[3 * lda + p]), b));
+			}
+			_mm_storeu_pd(c0 + j, acc0);
+			_mm_storeu_pd(c1 + j, acc1);
+			_mm_storeu_pd(c2 + j, acc2);
+			_mm_storeu_pd(c3 + j, acc3);
+		}
+#endif
+		for (; j < n; j++)
+		{
+			double acc0 = c0[j], acc1 = c1[j], acc2 = c2[j], acc3 = c3[j];
+			for (size_t p = 0; p < k; p++)
+			{
+				double b = B[p * ldb + j];
+				acc0 += A[p] * b;
+				acc1 += A[lda + p] * b;
+				acc2 += A[2 * lda + p] * b;
+				acc3 += A[3 * lda + p] * b;
+			}
+			c0[j] = acc0; c1[j] = acc1; c2[j] = acc2; c3[j] = acc3;
+		}
+	}
+
+	void gemm(size_t M, size_t N, size_t K, const double* A, const double* B, double* C, bool bAccumulate)
+	{
+		if (!bAccumulate)
+			memset(C, 0, M * N * sizeof(double));
+
+		for (size_t kk = 0; kk < K; kk += K_BLOCK)
+		{
+			size_t kBlock = (K - kk < K_BLOCK) ? K - kk : K_BLOCK;
+			for (size_t jj = 0; jj < N; jj += N_BLOCK)
+			{
+				size_t nBlock = (N - jj < N_BLOCK) ? N - jj : N_BLOCK;
+				const double* pB = B + kk * N + jj;
+
+				size_t i = 0;
+				for (; i + 4 <= M; i += 4)
+					gemmRows4(nBlock, kBlock, A + i * K + kk, K, pB, N, C + i * N + jj, N);
+				//remaining rows
+				for (; i < M; i++)
+				{
+					for (size_t p = 0; p < kBlock; p++)
+						axpy(nBlock, A[i * K + kk + p], pB + p * N, C + i * N + jj);
+				}
+			}
+		}
+	}
+
+	void transpose(size_t rows, size_t cols, const double* A, double* B)
+	{
+		for (size_t i = 0; i < rows; i++)
+			for (size_t j = 0; j < cols; j++)
+				B[j * rows + i] = A[i * cols + j];
+	}
+}
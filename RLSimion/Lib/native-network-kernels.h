@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+//Dense linear algebra kernels used by the native neural network backend. All matrices are row-major
+
+namespace NativeKernels
+{
+	//C[M x N] = A[M x K] * B[K x N] (C+= A * B if bAccumulate)
+	void gemm(size_t M, size_t N, size_t K, const double* A, const double* B, double* C, bool bAccumulate);
+
+	//B[cols x rows] = transpose(A[rows x cols])
+	void transpose(size_t rows, size_t cols, const double* A, double* B);
+
+	//y[i]+= alpha * x[i]
+	void axpy(size_t n, double alpha, const double* x, double* y);
+
+	//y[i]= alpha * x[i] + beta * y[i]
+	void axpby(size_t n, double alpha, const double* x, double beta, double* y);
+}
@@ -0,0 +1,885 @@
+#include "native-network.h"
+#include "native-network-kernels.h"
+#include "../Common/named-var-set.h"
+#include "../CNTKWrapper/xmltags.h"
+#include "../../tools/System/CrossPlatform.h"
+#include "logger.h"
+#include <stdexcept>
+#include <algorithm>
+#include <random>
+#include <math.h>
+
+#define SELU_LAMBDA 1.0507009873554804934193349852946
+#define SELU_ALPHA 1.6732632423543772848170429916717
+
+namespace NativeNetworkBackend
+{
+	INetworkDefinition* CNTK_WRAPPER_DLL_API getNetworkDefinition(tinyxml2::XMLElement* pNode)
+	{
+		if (pNode == nullptr || strcmp(pNode->Name(), XML_TAG_Problem))
+			return nullptr;
+		return new NativeNetworkDefinition(pNode);
+	}
+
+	void CNTK_WRAPPER_DLL_API setDevice(bool useGPU)
+	{
+		if (useGPU)
+			Logger::logMessage(MessageType::Warning, "The native network backend only runs on the CPU");
+	}
+}
+
+//NativeNetworkDefinition//////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////
+
+NativeNetworkDefinition::NativeNetworkDefinition(tinyxml2::XMLElement* pProblemNode)
+{
+	//architecture: we only keep the type, parameters and dependencies of each link
+	tinyxml2::XMLElement* pNode = pProblemNode->FirstChildElement(XML_TAG_NETWORK_ARCHITECTURE);
+	if (pNode) pNode = pNode->FirstChildElement(XML_TAG_Chains);
+	if (!pNode)
+		throw std::runtime_error("Native network backend: the network architecture is not defined");
+
+	for (tinyxml2::XMLElement* pChain = pNode->FirstChildElement(XML_TAG_Chain); pChain
+		; pChain = pChain->NextSiblingElement(XML_TAG_Chain))
+	{
+		tinyxml2::XMLElement* pChainLinks = pChain->FirstChildElement(XML_TAG_ChainLinks);
+		if (!pChainLinks) continue;
+
+		string previousLink;
+		for (tinyxml2::XMLElement* pLink = pChainLinks->FirstChildElement(XML_TAG_LinkBase); pLink
+			; pLink = pLink->NextSiblingElement(XML_TAG_LinkBase))
+		{
+			NativeLinkDefinition link;
+			if (!pLink->Attribute(XML_ATTRIBUTE_Type) || !pLink->Attribute(XML_ATTRIBUTE_Id))
+				throw std::runtime_error("Native network backend: links must have a type and an ID");
+			link.type = pLink->Attribute(XML_ATTRIBUTE_Type);
+			link.id = pLink->Attribute(XML_ATTRIBUTE_Id);
+			link.previousLink = previousLink;
+
+			tinyxml2::XMLElement* pParameters = pLink->FirstChildElement(XML_TAG_Parameters);
+			for (tinyxml2::XMLElement* pParameter = pParameters ? pParameters->FirstChildElement(XML_TAG_ParameterBase) : nullptr
+				; pParameter; pParameter = pParameter->NextSiblingElement(XML_TAG_ParameterBase))
+			{
+				tinyxml2::XMLElement* pValue = pParameter->FirstChildElement(XML_TAG_Value);
+				if (!pValue || !pParameter->Attribute(XML_ATTRIBUTE_Name))
+					continue;
+				const char* parameterType = pParameter->Attribute(XML_ATTRIBUTE_Type);
+				if (parameterType && !strcmp(parameterType, XML_ATTRIBUTE_LinkConnectionListParameter))
+				{
+					for (tinyxml2::XMLElement* pConnection = pValue->FirstChildElement(XML_TAG_LinkConnection); pConnection
+						; pConnection = pConnection->NextSiblingElement(XML_TAG_LinkConnection))
+						link.mergedLinks.push_back(pConnection->Attribute(XML_ATTRIBUTE_TargetId));
+				}
+				else if (pValue->GetText())
+					link.parameters[pParameter->Attribute(XML_ATTRIBUTE_Name)] = pValue->GetText();
+			}
+			previousLink = link.id;
+			m_links[link.id] = link;
+		}
+	}
+
+	//output
+	pNode = pProblemNode->FirstChildElement(XML_TAG_Output);
+	if (pNode) pNode = pNode->FirstChildElement(XML_TAG_LinkConnection);
+	if (!pNode || !pNode->Attribute(XML_ATTRIBUTE_TargetId))
+		throw std::runtime_error("Native network backend: the output of the network is not defined");
+	m_outputLinkId = pNode->Attribute(XML_ATTRIBUTE_TargetId);
+
+	//optimizer
+	pNode = pProblemNode->FirstChildElement(XML_TAG_OptimizerSetting);
+	if (pNode) pNode = pNode->FirstChildElement(XML_TAG_Optimizer);
+	if (!pNode || !pNode->Attribute(XML_ATTRIBUTE_Type))
+		throw std::runtime_error("Native network backend: the optimizer is not defined");
+	const char* optimizer = pNode->Attribute(XML_ATTRIBUTE_Type);
+	if (!strcmp(optimizer, "OptimizerSGD"))
+		m_optimizerType = SGD;
+	else if (!strcmp(optimizer, "OptimizerMomentumSGD"))
+		m_optimizerType = MomentumSGD;
+	else if (!strcmp(optimizer, "OptimizerAdam"))
+		m_optimizerType = Adam;
+	else if (!strcmp(optimizer, "OptimizerAdaGrad"))
+		m_optimizerType = AdaGrad;
+	else
+		throw std::runtime_error(string("The native network backend doesn't support ") + optimizer);
+
+	tinyxml2::XMLElement* pParameters = pNode->FirstChildElement(XML_TAG_Parameters);
+	for (tinyxml2::XMLElement* pParameter = pParameters ? pParameters->FirstChildElement(XML_TAG_OptimizerParameter) : nullptr
+		; pParameter; pParameter = pParameter->NextSiblingElement(XML_TAG_OptimizerParameter))
+	{
+		tinyxml2::XMLElement* pKey = pParameter->FirstChildElement(XML_TAG_Key);
+		tinyxml2::XMLElement* pValue = pParameter->FirstChildElement(XML_TAG_Value);
+		if (pKey && pKey->GetText() && pValue && pValue->GetText())
+			m_optimizerParameters[pKey->GetText()] = atof(pValue->GetText());
+	}
+}
+
+void NativeNetworkDefinition::destroy()
+{
+	delete this;
+}
+
+void NativeNetworkDefinition::addInputStateVar(string name)
+{
+	m_inputStateVariables.push_back(name);
+}
+
+const vector<string>& NativeNetworkDefinition::getInputStateVariables()
+{
+	return m_inputStateVariables;
+}
+
+void NativeNetworkDefinition::addInputActionVar(string name)
+{
+	m_inputActionVariables.push_back(name);
+}
+
+const vector<string>& NativeNetworkDefinition::getInputActionVariables()
+{
+	return m_inputActionVariables;
+}
+
+void NativeNetworkDefinition::setScalarOutput()
+{
+	m_bDiscretizedActionOutput = false;
+	m_outputSize = 1;
+}
+
+void NativeNetworkDefinition::setVectorOutput(size_t dimension)
+{
+	m_bDiscretizedActionOutput = false;
+	m_outputSize = dimension;
+}
+
+void NativeNetworkDefinition::setDiscretizedActionVectorOutput(size_t numOutputs, double minvalue, double maxvalue)
+{
+	m_bDiscretizedActionOutput = true;
+	m_outputSize = numOutputs;
+
+	double stepSize = (maxvalue - minvalue) / ((int)numOutputs - 1);
+	m_outputActionValues = vector<double>(numOutputs);
+	for (size_t i = 0; i < numOutputs; i++)
+		m_outputActionValues[i] = minvalue + stepSize * i;
+}
+
+size_t NativeNetworkDefinition::getClosestOutputIndex(double value)
+{
+	if (!m_bDiscretizedActionOutput)
+		throw std::runtime_error("Can only use getClosestOutputIndex() with discretized action vector outputs");
+
+	size_t nearestIndex = 0;
+	double closestDist = abs(value - m_outputActionValues[0]);
+	for (size_t i = 1; i < m_outputActionValues.size(); i++)
+	{
+		double dist = abs(value - m_outputActionValues[i]);
+		if (dist < closestDist)
+		{
+			closestDist = dist;
+			nearestIndex = i;
+		}
+	}
+	return nearestIndex;
+}
+
+double NativeNetworkDefinition::getActionIndexOutput(size_t actionIndex)
+{
+	if (!m_bDiscretizedActionOutput)
+		throw std::runtime_error("Can only use getActionIndexOutput() with discretized action vector outputs");
+
+	actionIndex = std::min(m_outputActionValues.size() - 1, actionIndex);
+	return m_outputActionValues[actionIndex];
+}
+
+IMinibatch* NativeNetworkDefinition::createMinibatch(size_t size, size_t outputSize)
+{
+	return new NativeMinibatch(size, this, outputSize);
+}
+
+INetwork* NativeNetworkDefinition::createNetwork(double learningRate, bool inputsNeedGradient)
+{
+	NativeNetwork* pNetwork = new NativeNetwork(this, inputsNeedGradient);
+	pNetwork->buildNetwork(learningRate);
+	return pNetwork;
+}
+
+string NativeNetworkDefinition::getDeviceName()
+{
+	return "CPU (native)";
+}
+
+double NativeNetworkDefinition::getOptimizerParameter(string key, double defaultValue) const
+{
+	auto it = m_optimizerParameters.find(key);
+	if (it == m_optimizerParameters.end())
+		return defaultValue;
+	return it->second;
+}
+
+//NativeMinibatch//////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////
+
+NativeMinibatch::NativeMinibatch(size_t size, NativeNetworkDefinition* pNetworkDefinition, size_t outputSize)
+{
+	m_pNetworkDefinition = pNetworkDefinition;
+	m_size = size;
+	m_inputState = vector<double>(size*pNetworkDefinition->getInputStateVariables().size());
+	m_inputAction = vector<double>(size*pNetworkDefinition->getInputActionVariables().size());
+	m_inputNextState = vector<double>(size*pNetworkDefinition->getInputStateVariables().size());
+	m_reward = vector<double>(size);
+
+	//if not overriden, use the network's output size
+	m_outputSize = (outputSize == 0) ? pNetworkDefinition->getOutputSize() : outputSize;
+	m_output = vector<double>(size*m_outputSize);
+}
+
+void NativeMinibatch::destroy()
+{
+	delete this;
+}
+
+void NativeMinibatch::clear()
+{
+	m_numTuples = 0;
+}
+
+void NativeMinibatch::addTuple(const State* s, const Action* a, double targetValue)
+{
+	if (m_outputSize != 1)
+		throw std::runtime_error("Cannot use a scalar target value with multiple-output networks");
+
+	addTuple(s, a, vector<double>(1, targetValue));
+}
+
+void NativeMinibatch::copyInputs(const State* s, const Action* a)
+{
+	const vector<string>& stateVars = m_pNetworkDefinition->getInputStateVariables();
+	m_statePacker.pack(s, stateVars, m_inputState.data() + m_numTuples*stateVars.size());
+
+	const vector<string>& actionVars = m_pNetworkDefinition->getInputActionVariables();
+	m_actionPacker.pack(a, actionVars, m_inputAction.data() + m_numTuples*actionVars.size());
+}
+
+void NativeMinibatch::addTuple(const State* s, const Action* a, const vector<double>& targetValues)
+{
+	if (m_numTuples >= m_size)
+		return;
+
+	if (targetValues.size() != m_outputSize)
+		throw std::runtime_error("Missmatched tuple output size and minibatch output size");
+
+	copyInputs(s, a);
+	for (size_t i = 0; i < m_outputSize; i++)
+		m_output[m_numTuples*m_outputSize + i] = targetValues[i];
+
+	m_numTuples++;
+}
+
+void NativeMinibatch::addTuple(const State* s, const Action* a, const State* s_p, double r)
+{
+	if (m_numTuples >= m_size)
+		return;
+
+	copyInputs(s, a);
+	const vector<string>& stateVars = m_pNetworkDefinition->getInputStateVariables();
+	m_statePacker.pack(s_p, stateVars, m_inputNextState.data() + m_numTuples*stateVars.size());
+	m_reward[m_numTuples] = r;
+
+	m_numTuples++;
+}
+
+//NativeNetwork////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	NativeLayer::ActivationFunction parseActivation(const string& name)
+	{
+		if (name == "sigmoid") return NativeLayer::Sigmoid;
+		if (name == "elu") return NativeLayer::Elu;
+		if (name == "selu") return NativeLayer::Selu;
+		if (name == "softplus") return NativeLayer::Softplus;
+		if (name == "softsign") return NativeLayer::Softsign;
+		if (name == "relu") return NativeLayer::Relu;
+		if (name == "tanh") return NativeLayer::Tanh;
+		if (name == "hard_sigmoid") return NativeLayer::HardSigmoid;
+		if (name == "softmax") return NativeLayer::Softmax;
+		if (name == "linear") return NativeLayer::Linear;
+		throw std::runtime_error("Native network backend: unknown activation function " + name);
+	}
+
+	const string& getLinkParameter(const NativeLinkDefinition& link, const string& name)
+	{
+		auto it = link.parameters.find(name);
+		if (it == link.parameters.end())
+			throw std::runtime_error("Native network backend: parameter " + name + " not defined in link " + link.id);
+		return it->second;
+	}
+
+	//y= f(y) for every element of a [rows x cols] matrix
+	void activate(NativeLayer::ActivationFunction activation, double* y, size_t rows, size_t cols)
+	{
+		size_t n = rows * cols;
+		switch (activation)
+		{
+		case NativeLayer::Sigmoid: for (size_t i = 0; i < n; i++) y[i] = 1.0 / (1.0 + exp(-y[i])); break;
+		case NativeLayer::Elu: for (size_t i = 0; i < n; i++) if (y[i] < 0.0) y[i] = exp(y[i]) - 1.0; break;
+		case NativeLayer::Selu:
+			for (size_t i = 0; i < n; i++)
+				y[i] = (y[i] > 0.0) ? SELU_LAMBDA * y[i] : SELU_LAMBDA * SELU_ALPHA * (exp(y[i]) - 1.0);
+			break;
+		case NativeLayer::Softplus:
+			for (size_t i = 0; i < n; i++) y[i] = std::max(y[i], 0.0) + log(1.0 + exp(-fabs(y[i])));
+			break;
+		case NativeLayer::Softsign: for (size_t i = 0; i < n; i++) y[i] = y[i] / (1.0 + fabs(y[i])); break;
+		case NativeLayer::Relu: for (size_t i = 0; i < n; i++) y[i] = std::max(y[i], 0.0); break;
+		case NativeLayer::Tanh: for (size_t i = 0; i < n; i++) y[i] = tanh(y[i]); break;
+		case NativeLayer::HardSigmoid:
+			for (size_t i = 0; i < n; i++) y[i] = std::min(1.0, std::max(0.0, 0.2 * y[i] + 0.5));
+			break;
+		case NativeLayer::Softmax:
+			for (size_t row = 0; row < rows; row++)
+			{
+				double* pRow = y + row * cols;
+				double maxValue = *std::max_element(pRow, pRow + cols);
+				double sum = 0.0;
+				for (size_t i = 0; i < cols; i++)
+				{
+					pRow[i] = exp(pRow[i] - maxValue);
+					sum += pRow[i];
+				}
+				for (size_t i = 0; i < cols; i++)
+					pRow[i] /= sum;
+			}
+			break;
+		case NativeLayer::Linear: break;
+		}
+	}
+
+	//g= g * f'(x), where y= f(x) is the output of the activation function
+	void activationGradient(NativeLayer::ActivationFunction activation, const double* y, double* g, size_t rows, size_t cols)
+	{
+		size_t n = rows * cols;
+		switch (activation)
+		{
+		case NativeLayer::Sigmoid: for (size_t i = 0; i < n; i++) g[i] *= y[i] * (1.0 - y[i]); break;
+		case NativeLayer::Elu: for (size_t i = 0; i < n; i++) if (y[i] < 0.0) g[i] *= y[i] + 1.0; break;
+		case NativeLayer::Selu:
+			for (size_t i = 0; i < n; i++)
+				g[i] *= (y[i] > 0.0) ? SELU_LAMBDA : y[i] + SELU_LAMBDA * SELU_ALPHA;
+			break;
+		case NativeLayer::Softplus: for (size_t i = 0; i < n; i++) g[i] *= 1.0 - exp(-y[i]); break;
+		case NativeLayer::Softsign:
+			for (size_t i = 0; i < n; i++) g[i] *= (1.0 - fabs(y[i])) * (1.0 - fabs(y[i]));
+			break;
+		case NativeLayer::Relu: for (size_t i = 0; i < n; i++) if (y[i] <= 0.0) g[i] = 0.0; break;
+		case NativeLayer::Tanh: for (size_t i = 0; i < n; i++) g[i] *= 1.0 - y[i] * y[i]; break;
+		case NativeLayer::HardSigmoid:
+			for (size_t i = 0; i < n; i++) g[i] = (y[i] > 0.0 && y[i] < 1.0) ? 0.2 * g[i] : 0.0;
+			break;
+		case NativeLayer::Softmax:
+			for (size_t row = 0; row < rows; row++)
+			{
+				const double* pY = y + row * cols;
+				double* pG = g + row * cols;
+				double dot = 0.0;
+				for (size_t i = 0; i < cols; i++)
+					dot += pY[i] * pG[i];
+				for (size_t i = 0; i < cols; i++)
+					pG[i] = pY[i] * (pG[i] - dot);
+			}
+			break;
+		case NativeLayer::Linear: break;
+		}
+	}
+}
+
+NativeNetwork::NativeNetwork(NativeNetworkDefinition* pNetworkDefinition, bool inputsNeedGradient)
+{
+	m_pNetworkDefinition = pNetworkDefinition;
+	m_bInputsNeedGradient = inputsNeedGradient;
+}
+
+void NativeNetwork::destroy()
+{
+	delete this;
+}
+
+size_t NativeNetwork::addLayer(const string& linkId, map<string, size_t>& builtLayers, size_t& numParameters)
+{
+	auto built = builtLayers.find(linkId);
+	if (built != builtLayers.end())
+		return built->second;
+
+	auto linkIt = m_pNetworkDefinition->getLinks().find(linkId);
+	if (linkIt == m_pNetworkDefinition->getLinks().end())
+		throw std::runtime_error("Native network backend: link " + linkId + " not found");
+	const NativeLinkDefinition& link = linkIt->second;
+
+	NativeLayer layer;
+	if (link.type != "InputLayer")
+	{
+		if (link.type == "MergeLayer")
+		{
+			for (const string& mergedLink : link.mergedLinks)
+				layer.inputs.push_back(addLayer(mergedLink, builtLayers, numParameters));
+		}
+		else if (!link.previousLink.empty())
+			layer.inputs.push_back(addLayer(link.previousLink, builtLayers, numParameters));
+
+		if (layer.inputs.empty())
+			throw std::runtime_error("Native network backend: link " + linkId + " has no input");
+	}
+
+	if (link.type == "InputLayer")
+	{
+		layer.type = NativeLayer::Input;
+		layer.bStateInput = (getLinkParameter(link, "Input Data") == "state-input");
+		layer.size = layer.bStateInput ? m_pNetworkDefinition->getInputStateVariables().size()
+			: m_pNetworkDefinition->getInputActionVariables().size();
+	}
+	else if (link.type == "DenseLayer")
+	{
+		layer.type = NativeLayer::Dense;
+		layer.size = (size_t)atoi(getLinkParameter(link, "Units").c_str());
+		layer.activation = parseActivation(getLinkParameter(link, "Activation"));
+		layer.weightOffset = numParameters;
+		numParameters += (m_layers[layer.inputs[0]].size + 1) * layer.size;
+	}
+	else if (link.type == "ActivationLayer")
+	{
+		layer.type = NativeLayer::Activation;
+		layer.size = m_layers[layer.inputs[0]].size;
+		layer.activation = parseActivation(getLinkParameter(link, "Activation"));
+	}
+	else if (link.type == "MergeLayer")
+	{
+		layer.type = NativeLayer::Merge;
+		for (size_t input : layer.inputs)
+			layer.size += m_layers[input].size;
+	}
+	else if (link.type == "LinearTransformationLayer")
+	{
+		layer.type = NativeLayer::LinearTransformation;
+		layer.size = m_layers[layer.inputs[0]].size;
+		layer.scale = atof(getLinkParameter(link, "Scale").c_str());
+		layer.offset = atof(getLinkParameter(link, "Offset").c_str());
+	}
+	else if (link.type == "FlattenLayer" || link.type == "ReshapeLayer" || link.type == "DropoutLayer")
+	{
+		//inputs are 1-dimensional and dropout is not applied, so these layers don't modify their input
+		layer.type = NativeLayer::Identity;
+		layer.size = m_layers[layer.inputs[0]].size;
+	}
+	else
+		throw std::runtime_error("The native network backend doesn't support layers of type " + link.type);
+
+	m_layers.push_back(layer);
+	builtLayers[linkId] = m_layers.size() - 1;
+	return m_layers.size() - 1;
+}
+
+void NativeNetwork::initializeParameters()
+{
+	//Glorot uniform initialization of the weights, biases set to zero. The generator is seeded from rand() so that the
+	//initial weights depend on the experiment's random seed
+	std::mt19937 generator((unsigned int)rand());
+	for (const NativeLayer& layer : m_layers)
+	{
+		if (layer.type != NativeLayer::Dense)
+			continue;
+		size_t inputSize = m_layers[layer.inputs[0]].size;
+		double limit = sqrt(6.0 / (double)(inputSize + layer.size));
+		std::uniform_real_distribution<double> distribution(-limit, limit);
+		double* pWeights = &m_parameters[layer.weightOffset];
+		for (size_t i = 0; i < inputSize * layer.size; i++)
+			pWeights[i] = distribution(generator);
+		std::fill(pWeights + inputSize * layer.size, pWeights + (inputSize + 1) * layer.size, 0.0);
+	}
+}
+
+void NativeNetwork::buildNetwork(double learningRate)
+{
+	m_learningRate = learningRate;
+
+	m_layers.clear();
+	map<string, size_t> builtLayers;
+	size_t numParameters = 0;
+	addLayer(m_pNetworkDefinition->getOutputLinkId(), builtLayers, numParameters);
+
+	if (m_layers.back().size != m_pNetworkDefinition->getOutputSize())
+		throw std::runtime_error("Native network backend: the size of the output layer doesn't match the network's output");
+
+	m_parameters = vector<double>(numParameters);
+	m_gradients = vector<double>(numParameters);
+	m_firstMoments = vector<double>(numParameters, 0.0);
+	m_secondMoments = vector<double>(numParameters, 0.0);
+	initializeParameters();
+
+	m_values = vector<vector<double>>(m_layers.size());
+	m_valueGradients = vector<vector<double>>(m_layers.size());
+	m_output = vector<double>(m_pNetworkDefinition->getOutputSize());
+}
+
+void NativeNetwork::forward(const double* pStateInput, const double* pActionInput, size_t batchSize)
+{
+	m_batchSize = batchSize;
+
+	for (size_t l = 0; l < m_layers.size(); l++)
+	{
+		const NativeLayer& layer = m_layers[l];
+		vector<double>& y = m_values[l];
+		y.resize(batchSize * layer.size);
+
+		switch (layer.type)
+		{
+		case NativeLayer::Input:
+			std::copy(layer.bStateInput ? pStateInput : pActionInput
+				, (layer.bStateInput ? pStateInput : pActionInput) + y.size(), y.begin());
+			break;
+		case NativeLayer::Dense:
+		{
+			size_t inputSize = m_layers[layer.inputs[0]].size;
+			const double* pWeights = &m_parameters[layer.weightOffset];
+			const double* pBiases = pWeights + inputSize * layer.size;
+			NativeKernels::gemm(batchSize, layer.size, inputSize, m_values[layer.inputs[0]].data(), pWeights
+				, y.data(), false);
+			for (size_t row = 0; row < batchSize; row++)
+				NativeKernels::axpy(layer.size, 1.0, pBiases, &y[row * layer.size]);
+			activate(layer.activation, y.data(), batchSize, layer.size);
+			break;
+		}
+		case NativeLayer::Activation:
+			y = m_values[layer.inputs[0]];
+			activate(layer.activation, y.data(), batchSize, layer.size);
+			break;
+		case NativeLayer::Merge:
+		{
+			size_t offset = 0;
+			for (size_t input : layer.inputs)
+			{
+				size_t inputSize = m_layers[input].size;
+				for (size_t row = 0; row < batchSize; row++)
+					std::copy(&m_values[input][row * inputSize], &m_values[input][row * inputSize] + inputSize
+						, &y[row * layer.size + offset]);
+				offset += inputSize;
+			}
+			break;
+		}
+		case NativeLayer::LinearTransformation:
+		{
+			const vector<double>& x = m_values[layer.inputs[0]];
+			for (size_t i = 0; i < y.size(); i++)
+				y[i] = layer.scale * x[i] + layer.offset;
+			break;
+		}
+		case NativeLayer::Identity:
+			y = m_values[layer.inputs[0]];
+			break;
+		}
+	}
+}
+
+//The gradient with respect to the state input is never used, and the one with respect to the action input only if the
+//network was created with inputsNeedGradient=true
+bool NativeNetwork::needsValueGradient(size_t layer) const
+{
+	if (m_layers[layer].type != NativeLayer::Input)
+		return true;
+	return m_bInputsNeedGradient && !m_layers[layer].bStateInput;
+}
+
+void NativeNetwork::backward(const double* pOutputGradient, bool bParameterGradients)
+{
+	for (size_t l = 0; l < m_layers.size(); l++)
+		m_valueGradients[l].assign(m_batchSize * m_layers[l].size, 0.0);
+	std::copy(pOutputGradient, pOutputGradient + m_valueGradients.back().size(), m_valueGradients.back().begin());
+
+	if (bParameterGradients)
+		std::fill(m_gradients.begin(), m_gradients.end(), 0.0);
+
+	for (size_t l = m_layers.size(); l-- > 0;)
+	{
+		const NativeLayer& layer = m_layers[l];
+		vector<double>& g = m_valueGradients[l];
+
+		switch (layer.type)
+		{
+		case NativeLayer::Input:
+			break;
+		case NativeLayer::Dense:
+		{
+			size_t input = layer.inputs[0];
+			size_t inputSize = m_layers[input].size;
+			const double* pWeights = &m_parameters[layer.weightOffset];
+
+			activationGradient(layer.activation, m_values[l].data(), g.data(), m_batchSize, layer.size);
+
+			if (bParameterGradients)
+			{
+				//dW+= x^T * g, db+= sum of the rows of g
+				double* pWeightGradients = &m_gradients[layer.weightOffset];
+				m_transposeBuffer.resize(inputSize * m_batchSize);
+				NativeKernels::transpose(m_batchSize, inputSize, m_values[input].data(), m_transposeBuffer.data());
+				NativeKernels::gemm(inputSize, layer.size, m_batchSize, m_transposeBuffer.data(), g.data()
+					, pWeightGradients, true);
+				for (size_t row = 0; row < m_batchSize; row++)
+					NativeKernels::axpy(layer.size, 1.0, &g[row * layer.size], pWeightGradients + inputSize * layer.size);
+			}
+			//dx+= g * W^T
+			if (needsValueGradient(input))
+			{
+				m_transposeBuffer.resize(layer.size * inputSize);
+				NativeKernels::transpose(inputSize, layer.size, pWeights, m_transposeBuffer.data());
+				NativeKernels::gemm(m_batchSize, inputSize, layer.size, g.data(), m_transposeBuffer.data()
+					, m_valueGradients[input].data(), true);
+			}
+			break;
+		}
+		case NativeLayer::Activation:
+			if (!needsValueGradient(layer.inputs[0])) break;
+			activationGradient(layer.activation, m_values[l].data(), g.data(), m_batchSize, layer.size);
+			NativeKernels::axpy(g.size(), 1.0, g.data(), m_valueGradients[layer.inputs[0]].data());
+			break;
+		case NativeLayer::Merge:
+		{
+			size_t offset = 0;
+			for (size_t input : layer.inputs)
+			{
+				size_t inputSize = m_layers[input].size;
+				if (!needsValueGradient(input))
+				{
+					offset += inputSize;
+					continue;
+				}
+				for (size_t row = 0; row < m_batchSize; row++)
+					NativeKernels::axpy(inputSize, 1.0, &g[row * layer.size + offset], &m_valueGradients[input][row * inputSize]);
+				offset += inputSize;
+			}
+			break;
+		}
+		case NativeLayer::LinearTransformation:
+			if (!needsValueGradient(layer.inputs[0])) break;
+			NativeKernels::axpy(g.size(), layer.scale, g.data(), m_valueGradients[layer.inputs[0]].data());
+			break;
+		case NativeLayer::Identity:
+			if (!needsValueGradient(layer.inputs[0])) break;
+			NativeKernels::axpy(g.size(), 1.0, g.data(), m_valueGradients[layer.inputs[0]].data());
+			break;
+		}
+	}
+}
+
+void NativeNetwork::updateParameters()
+{
+	if (m_bFrozen)
+		throw std::runtime_error("Cannot update the weights of a frozen network");
+
+	size_t n = m_parameters.size();
+	double* p = m_parameters.data();
+	const double* g = m_gradients.data();
+
+	switch (m_pNetworkDefinition->getOptimizerType())
+	{
+	case NativeNetworkDefinition::SGD:
+		NativeKernels::axpy(n, -m_learningRate, g, p);
+		break;
+	case NativeNetworkDefinition::MomentumSGD:
+	{
+		double momentum = m_pNetworkDefinition->getOptimizerParameter("Momentum", 0.9);
+		NativeKernels::axpby(n, 1.0 - momentum, g, momentum, m_firstMoments.data());
+		NativeKernels::axpy(n, -m_learningRate, m_firstMoments.data(), p);
+		break;
+	}
+	case NativeNetworkDefinition::Adam:
+	{
+		double beta1 = m_pNetworkDefinition->getOptimizerParameter("Momentum", 0.9);
+		double beta2 = m_pNetworkDefinition->getOptimizerParameter("Variance momentum", 0.999);
+		double epsilon = m_pNetworkDefinition->getOptimizerParameter("Epsilon", 1e-8);
+		m_numUpdates++;
+		double firstMomentCorrection = 1.0 / (1.0 - pow(beta1, (double)m_numUpdates));
+		double secondMomentCorrection = 1.0 / (1.0 - pow(beta2, (double)m_numUpdates));
+
+		double* m = m_firstMoments.data();
+		double* v = m_secondMoments.data();
+		for (size_t i = 0; i < n; i++)
+		{
+			m[i] = beta1 * m[i] + (1.0 - beta1) * g[i];
+			v[i] = beta2 * v[i] + (1.0 - beta2) * g[i] * g[i];
+			p[i] -= m_learningRate * (m[i] * firstMomentCorrection) / (sqrt(v[i] * secondMomentCorrection) + epsilon);
+		}
+		break;
+	}
+	case NativeNetworkDefinition::AdaGrad:
+	{
+		double* v = m_secondMoments.data();
+		for (size_t i = 0; i < n; i++)
+		{
+			v[i] += g[i] * g[i];
+			p[i] -= m_learningRate * g[i] / (sqrt(v[i]) + 1e-8);
+		}
+		break;
+	}
+	}
+}
+
+void NativeNetwork::save(string fileName)
+{
+	FILE* pFile;
+	CrossPlatform::Fopen_s(&pFile, fileName.c_str(), "wb");
+	if (!pFile)
+		throw std::runtime_error("Couldn't open file to save the network: " + fileName);
+
+	size_t numParameters = m_parameters.size();
+	fwrite(&numParameters, sizeof(size_t), 1, pFile);
+	fwrite(m_parameters.data(), sizeof(double), numParameters, pFile);
+	fclose(pFile);
+}
+
+INetwork* NativeNetwork::clone(bool bFreezeWeights) const
+{
+	NativeNetwork* pClone = new NativeNetwork(*this);
+	pClone->m_bFrozen = bFreezeWeights;
+	return pClone;
+}
+
+void NativeNetwork::initSoftUpdate(double u, INetwork* pTargetNetworkInterface)
+{
+	NativeNetwork* pTargetNetwork = dynamic_cast<NativeNetwork*>(pTargetNetworkInterface);
+	if (!pTargetNetwork)
+		throw std::runtime_error("Incorrect target in NativeNetwork::initSoftUpdate");
+	if (pTargetNetwork->m_parameters.size() != m_parameters.size())
+		throw std::runtime_error("Missmatched number of parameters in NativeNetwork::initSoftUpdate");
+
+	m_softUpdateRate = u;
+}
+
+void NativeNetwork::softUpdate(INetwork* pTargetNetworkInterface)
+{
+	NativeNetwork* pTargetNetwork = dynamic_cast<NativeNetwork*>(pTargetNetworkInterface);
+	if (!pTargetNetwork)
+		throw std::runtime_error("Incorrect target in NativeNetwork::softUpdate");
+	if (pTargetNetwork->m_parameters.size() != m_parameters.size())
+		throw std::runtime_error("Missmatched number of parameters in NativeNetwork::softUpdate");
+
+	//target= u * online + (1-u) * target
+	NativeKernels::axpby(m_parameters.size(), m_softUpdateRate, m_parameters.data(), 1.0 - m_softUpdateRate
+		, pTargetNetwork->m_parameters.data());
+}
+
+void NativeNetwork::train(IMinibatch* pMinibatch)
+{
+	//only the tuples added since the last call are used: the rest of the minibatch's buffers hold stale data
+	forward(pMinibatch->getInputState().data(), pMinibatch->getInputAction().data(), pMinibatch->numTuples());
+
+	//squared error loss: dL/dy= 2 * (y - target), summed over the samples as CNTK does with per-sample learning rates
+	const vector<double>& y = m_values.back();
+	const vector<double>& target = pMinibatch->getOutput();
+	if (pMinibatch->outputSize() != m_layers.back().size)
+		throw std::runtime_error("Missmatched minibatch and network output sizes");
+	m_rootGradient.resize(y.size());
+	for (size_t i = 0; i < y.size(); i++)
+		m_rootGradient[i] = 2.0 * (y[i] - target[i]);
+
+	backward(m_rootGradient.data(), true);
+	updateParameters();
+
+	pMinibatch->clear();
+}
+
+void NativeNetwork::applyGradient(IMinibatch* pMinibatch)
+{
+	//the minibatch's output holds the gradient of the loss with respect to the network's output (-dQ(s,a)/da in DDPG)
+	forward(pMinibatch->getInputState().data(), pMinibatch->getInputAction().data(), pMinibatch->numTuples());
+
+	if (pMinibatch->outputSize() != m_layers.back().size)
+		throw std::runtime_error("Missmatched minibatch and network output sizes");
+	backward(pMinibatch->getOutput().data(), true);
+	updateParameters();
+}
+
+void NativeNetwork::gradientWrtAction(const vector<double>& s, const vector<double>& a, vector<double>& outputGradient)
+{
+	if (!m_bInputsNeedGradient)
+		throw std::runtime_error("The network was created without gradients with respect to the inputs: can't use gradientWrtAction()");
+
+	size_t numTuples = getNumTuples(s, a);
+	forward(s.data(), a.data(), numTuples);
+	m_rootGradient.assign(numTuples * m_layers.back().size, 1.0);
+	backward(m_rootGradient.data(), false);
+
+	bool bActionInputUsed = false;
+	outputGradient.assign(a.size(), 0.0);
+	for (size_t l = 0; l < m_layers.size(); l++)
+	{
+		if (m_layers[l].type == NativeLayer::Input && !m_layers[l].bStateInput)
+		{
+			NativeKernels::axpy(outputGradient.size(), 1.0, m_valueGradients[l].data(), outputGradient.data());
+			bActionInputUsed = true;
+		}
+	}
+	if (!bActionInputUsed)
+		throw std::runtime_error("Can only use gradient() with f(s,a)-form functions");
+}
+
+void NativeNetwork::gradientWrtAction(const State* s, const Action* a, vector<double>& outputGradient)
+{
+	stateToVector(s, m_stateInput);
+	actionToVector(a, m_actionInput);
+	if (outputGradient.size() != m_actionInput.size())
+		throw std::runtime_error("Missmatched length for output vector in gradients()");
+
+	gradientWrtAction(m_stateInput, m_actionInput, outputGradient);
+}
+
+void NativeNetwork::stateToVector(const State* s, vector<double>& stateVector)
+{
+	const vector<string>& stateVars = m_pNetworkDefinition->getInputStateVariables();
+	stateVector.resize(stateVars.size());
+	m_statePacker.pack(s, stateVars, stateVector.data());
+}
+
+void NativeNetwork::actionToVector(const Action* a, vector<double>& actionVector)
+{
+	const vector<string>& actionVars = m_pNetworkDefinition->getInputActionVariables();
+	actionVector.resize(actionVars.size());
+	m_actionPacker.pack(a, actionVars, actionVector.data());
+}
+
+size_t NativeNetwork::getNumTuples(const vector<double>& s, const vector<double>& a) const
+{
+	size_t numStateVars = m_pNetworkDefinition->getInputStateVariables().size();
+	if (numStateVars > 0)
+		return s.size() / numStateVars;
+	size_t numActionVars = m_pNetworkDefinition->getInputActionVariables().size();
+	if (numActionVars > 0)
+		return a.size() / numActionVars;
+	return 0;
+}
+
+void NativeNetwork::evaluate(const vector<double>& s, const vector<double>& a, vector<double>& outputValues)
+{
+	forward(s.data(), a.data(), getNumTuples(s, a));
+	outputValues.assign(m_values.back().begin(), m_values.back().end());
+}
+
+vector<double>& NativeNetwork::evaluate(const State* s, const Action* a)
+{
+	stateToVector(s, m_stateInput);
+	actionToVector(a, m_actionInput);
+	evaluate(m_stateInput, m_actionInput, m_output);
+	return m_output;
+}
+
+unsigned int NativeNetwork::getNumOutputs()
+{
+	return (unsigned int)m_pNetworkDefinition->getOutputSize();
+}
+
+const vector<string>& NativeNetwork::getInputStateVariables()
+{
+	return m_pNetworkDefinition->getInputStateVariables();
+}
+
+const vector<string>& NativeNetwork::getInputActionVariables()
+{
+	return m_pNetworkDefinition->getInputActionVariables();
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "../CNTKWrapper/CNTKWrapper.h"
+#include "CNTKWrapperClient.h"
+#include "../Common/named-var-set.h"
+#include <vector>
+#include <string>
+#include <map>
+using namespace std;
+
+//Self-contained CPU implementation of the neural network interfaces defined in CNTKWrapper.h. It reads the same network
+//definitions (the "Problem" nodes edited in Badger) and supports the layers used by our deep learners: input, dense,
+//activation, merge, linear transformation, flatten/reshape and dropout (identity). Convolutional and batch-normalization
+//layers require the CNTK backend.
+//All the values are stored as row-major [batchSize x layerSize] matrices and the products are computed with the
+//kernels in native-network-kernels.h, so small networks don't pay the cost of loading and calling CNTK
+
+namespace NativeNetworkBackend
+{
+	//same signatures as the entry points of the CNTK wrapper library
+	INetworkDefinition* CNTK_WRAPPER_DLL_API getNetworkDefinition(tinyxml2::XMLElement* pNode);
+	void CNTK_WRAPPER_DLL_API setDevice(bool useGPU);
+}
+
+//a link of the architecture as defined in the configuration file
+struct NativeLinkDefinition
+{
+	string type;
+	string id;
+	map<string, string> parameters;
+	vector<string> mergedLinks; //only for merge layers
+	string previousLink; //empty if it is the first link of its chain
+};
+
+class NativeNetworkDefinition : public INetworkDefinition
+{
+public:
+	enum OptimizerType { SGD, MomentumSGD, Adam, AdaGrad };
+private:
+	vector<string> m_inputStateVariables;
+	vector<string> m_inputActionVariables;
+
+	size_t m_outputSize = 0;
+	bool m_bDiscretizedActionOutput = false;
+	vector<double> m_outputActionValues;
+
+	map<string, NativeLinkDefinition> m_links;
+	string m_outputLinkId;
+
+	OptimizerType m_optimizerType = SGD;
+	map<string, double> m_optimizerParameters;
+public:
+	NativeNetworkDefinition(tinyxml2::XMLElement* pNode);
+	virtual ~NativeNetworkDefinition() = default;
+
+	void destroy();
+
+	void addInputStateVar(string name);
+	const vector<string>& getInputStateVariables();
+
+	void addInputActionVar(string name);
+	const vector<string>& getInputActionVariables();
+
+	void setScalarOutput();
+	void setVectorOutput(size_t dimension);
+	void setDiscretizedActionVectorOutput(size_t numOutputs, double minvalue, double maxvalue);
+	size_t getClosestOutputIndex(double value);
+	double getActionIndexOutput(size_t actionIndex);
+	size_t getOutputSize() const { return m_outputSize; }
+
+	IMinibatch* createMinibatch(size_t size, size_t outputSize = 0);
+	INetwork* createNetwork(double learningRate, bool inputsNeedGradient = false);
+
+	string getDeviceName();
+
+	const map<string, NativeLinkDefinition>& getLinks() const { return m_links; }
+	const string& getOutputLinkId() const { return m_outputLinkId; }
+	OptimizerType getOptimizerType() const { return m_optimizerType; }
+	double getOptimizerParameter(string key, double defaultValue) const;
+};
+
+class NativeMinibatch : public IMinibatch
+{
+	NativeNetworkDefinition* m_pNetworkDefinition;
+	size_t m_numTuples = 0;
+	size_t m_size = 0;
+	vector<double> m_inputState;
+	vector<double> m_inputAction;
+	vector<double> m_inputNextState;
+	vector<double> m_reward;
+
+	size_t m_outputSize = 0;
+	vector<double> m_output;
+
+	NamedVarSetPacker m_statePacker;
+	NamedVarSetPacker m_actionPacker;
+
+	void copyInputs(const State* s, const Action* a);
+public:
+	NativeMinibatch(size_t size, NativeNetworkDefinition* pNetworkDefinition, size_t outputSize = 0);
+	virtual ~NativeMinibatch() = default;
+
+	void destroy();
+
+	void clear();
+	void addTuple(const State* s, const Action* a, const vector<double>& targetValues);
+	void addTuple(const State* s, const Action* a, double targetValue);
+	void addTuple(const State* s, const Action* a, const State* s_p, double r);
+	vector<double>& getInputState() { return m_inputState; }
+	vector<double>& getInputAction() { return m_inputAction; }
+	vector<double>& getInputNextState() { return m_inputNextState; }
+	vector<double>& getReward() { return m_reward; }
+	vector<double>& getOutput() { return m_output; }
+	bool isFull() const { return m_numTuples == m_size; }
+	size_t numTuples() const { return m_numTuples; }
+	size_t size() const { return m_size; }
+	size_t outputSize() const { return m_outputSize; }
+};
+
+struct NativeLayer
+{
+	enum Type { Input, Dense, Activation, Merge, LinearTransformation, Identity };
+	enum ActivationFunction { Sigmoid, Elu, Selu, Softplus, Softsign, Relu, Tanh, HardSigmoid, Softmax, Linear };
+
+	Type type = Identity;
+	vector<size_t> inputs; //indices of the layers this one takes its input from
+	size_t size = 0;
+	ActivationFunction activation = Linear;
+
+	bool bStateInput = true; //only for input layers
+
+	size_t weightOffset = 0; //only for dense layers: weights [inputSize x size] followed by the biases [size]
+
+	double scale = 1.0, offset = 0.0; //only for linear transformation layers
+};
+
+class NativeNetwork : public INetwork
+{
+	NativeNetworkDefinition* m_pNetworkDefinition;
+
+	//layers in topological order: the output layer is the last one
+	vector<NativeLayer> m_layers;
+
+	vector<double> m_parameters;
+	vector<double> m_gradients;
+
+	//gradients with respect to the action inputs are only calculated if requested when the network was created
+	bool m_bInputsNeedGradient = false;
+
+	//optimizer
+	bool m_bFrozen = false;
+	double m_learningRate = 0.0;
+	vector<double> m_firstMoments; //momentum and Adam
+	vector<double> m_secondMoments; //Adam and AdaGrad
+	size_t m_numUpdates = 0;
+
+	//soft updates of a target network
+	double m_softUpdateRate = 0.0;
+
+	//buffers reused across calls
+	size_t m_batchSize = 0;
+	vector<vector<double>> m_values;
+	vector<vector<double>> m_valueGradients;
+	vector<double> m_transposeBuffer;
+	vector<double> m_stateInput, m_actionInput;
+	NamedVarSetPacker m_statePacker, m_actionPacker;
+	vector<double> m_rootGradient;
+	vector<double> m_output;
+
+	size_t addLayer(const string& linkId, map<string, size_t>& builtLayers, size_t& numParameters);
+	void initializeParameters();
+
+	bool needsValueGradient(size_t layer) const;
+	void forward(const double* pStateInput, const double* pActionInput, size_t batchSize);
+	void backward(const double* pOutputGradient, bool bParameterGradients);
+	void updateParameters();
+
+	void stateToVector(const State* s, vector<double>& stateVector);
+	void actionToVector(const Action* a, vector<double>& actionVector);
+	size_t getNumTuples(const vector<double>& s, const vector<double>& a) const;
+public:
+	NativeNetwork(NativeNetworkDefinition* pNetworkDefinition, bool inputsNeedGradient);
+	virtual ~NativeNetwork() = default;
+
+	void destroy();
+
+	void buildNetwork(double learningRate);
+
+	void save(string fileName);
+
+	INetwork* clone(bool bFreezeWeights = true) const;
+
+	void initSoftUpdate(double u, INetwork* pTargetNetwork);
+	void softUpdate(INetwork* pTargetNetwork);
+
+	void train(IMinibatch* pMinibatch);
+
+	void gradientWrtAction(const State* s, const Action* a, vector<double>& outputValues);
+	void applyGradient(IMinibatch* pMinibatch);
+
+	void evaluate(const vector<double>& s, const vector<double>& a, vector<double>& outputValues);
+	void gradientWrtAction(const vector<double>& s, const vector<double>& a, vector<double>& outputValues);
+
+	//StateActionFunction interface
+	unsigned int getNumOutputs();
+	vector<double>& evaluate(const State* s, const Action* a);
+	const vector<string>& getInputStateVariables();
+	const vector<string>& getInputActionVariables();
+};
@@ -6,6 +6,7 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <algorithm>
+#include <cstring>
 
 #define MARGINAL_SIGMA 0.1
 #define MINIMAL_PROBABILITY 0.000001
@@ -28,13 +29,78 @@ int chooseRandomInteger(vector<double>& probability)
 	return index - 1;
 }
 
+NormalSampleBuffer::NormalSampleBuffer()
+{
+	//two calls because RAND_MAX may be as low as 32767
+	seed(((uint64_t)rand() << 32) ^ (uint64_t)rand());
+}
+
+NormalSampleBuffer::NormalSampleBuffer(uint64_t seed)
+{
+	this->seed(seed);
+}
+
+void NormalSampleBuffer::seed(uint64_t seed)
+{
+	//splitmix64 is used to initialize the state of the generator, which must not be all zeros
+	for (int i = 0; i < 2; i++)
+	{
+		uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		m_state[i] = z ^ (z >> 31);
+	}
+	m_nextSample = m_blockSize;
+}
+
+void NormalSampleBuffer::refill()
+{
+	//xorshift128+: the 53 upper bits are used to generate values in (0,1]
+	uint64_t s0 = m_state[0], s1 = m_state[1];
+	for (size_t i = 0; i < m_blockSize; i++)
+	{
+		uint64_t x = s0;
+		const uint64_t y = s1;
+		s0 = y;
+		x ^= x << 23;
+		s1 = x ^ y ^ (x >> 17) ^ (y >> 26);
+		m_uniform[i] = (double)(((s1 + y) >> 11) + 1) * (1.0 / 9007199254740992.0);
+	}
+	m_state[0] = s0;
+	m_state[1] = s1;
+
+	//Box-Muller: each pair of uniform values gives two independent normal samples
+	const size_t numPairs = m_blockSize / 2;
+	for (size_t i = 0; i < numPairs; i++)
+	{
+		double radius = sqrt(-2.0 * log(m_uniform[i]));
+		double angle = 2.0 * M_PI * m_uniform[numPairs + i];
+		m_samples[2 * i] = radius * cos(angle);
+		m_samples[2 * i + 1] = radius * sin(angle);
+	}
+	m_nextSample = 0;
+}
+
+void NormalSampleBuffer::get(double* pOutput, size_t numSamples)
+{
+	while (numSamples > 0)
+	{
+		if (m_nextSample == m_blockSize)
+			refill();
+		size_t numCopied = std::min(numSamples, m_blockSize - m_nextSample);
+		memcpy(pOutput, m_samples + m_nextSample, numCopied * sizeof(double));
+		m_nextSample += numCopied;
+		pOutput += numCopied;
+		numSamples -= numCopied;
+	}
+}
+
 double GaussianNoise::getNormalDistributionSample(double mean, double sigma)
 {
 	if (sigma == 0.0) return mean;
-	double x1 = (double) (rand() + 1) / ((double) RAND_MAX + 1);
-	double x2 = (double) rand() / (double) RAND_MAX;
-	double z = sqrt(- 2 * log(x1)) * cos(2 * M_PI * x2);
-	return z * sigma + mean;
+	//one buffer per thread, seeded the first time it is used
+	static thread_local NormalSampleBuffer normalSamples;
+	return normalSamples.get() * sigma + mean;
 }
 
 double GaussianNoise::getPDF(double mean, double sigma, double value,double scaleFactor)
@@ -70,6 +136,12 @@ Noise::Noise()
 	m_lastValue = 0.0;
 }
 
+void Noise::getSamples(double* pOutput, size_t numSamples)
+{
+	for (size_t i = 0; i < numSamples; i++)
+		pOutput[i] = getSample();
+}
+
 std::shared_ptr<Noise> Noise::getInstance(ConfigNode* pConfigNode)
 {
 	return CHOICE<Noise>(pConfigNode, "Noise", "Noise type",
@@ -104,7 +176,7 @@ double GaussianNoise::getSample()
 	double alpha = m_alpha.get();
 
 	if (sigma > 0.00000000001)
-		randValue = getNormalDistributionSample(0.0,sigma);
+		randValue = m_normalSamples.get()*sigma;
 
 	randValue*= m_scale->get();
 
@@ -115,6 +187,25 @@ double GaussianNoise::getSample()
 	return randValue;
 }
 
+void GaussianNoise::getSamples(double* pOutput, size_t numSamples)
+{
+	double sigma = m_sigma.get();
+	double alpha = m_alpha.get();
+	double scale = m_scale->get();
+
+	if (sigma > 0.00000000001)
+		m_normalSamples.get(pOutput, numSamples);
+	else
+		std::fill(pOutput, pOutput + numSamples, 0.0);
+
+	//the low-pass filter is sequential, so it is applied once the normal samples are generated
+	for (size_t i = 0; i < numSamples; i++)
+	{
+		m_lastValue = alpha*pOutput[i]*sigma*scale + (1.0 - alpha)*m_lastValue;
+		pOutput[i] = m_lastValue;
+	}
+}
+
 
 double GaussianNoise::getVariance()
 {
@@ -210,7 +301,7 @@ double OrnsteinUhlenbeckNoise::getSample()
 	//http://math.stackexchange.com/questions/1287634/implementing-ornstein-uhlenbeck-in-matlab
 	//x(i + 1) = x(i) + th*(mean - x(i))*dt + sig*sqrt(dt)*randn;
 
-	double normalDistSample = GaussianNoise::getNormalDistributionSample(0.0, 1);
+	double normalDistSample = m_normalSamples.get();
 
 	double newNoise = m_lastValue + m_theta.get()*(m_mu.get() - m_lastValue)*m_dt
 		+ m_sigma.get()*sqrt(m_dt) * normalDistSample;
@@ -220,6 +311,20 @@ double OrnsteinUhlenbeckNoise::getSample()
 	return newNoise;
 }
 
+void OrnsteinUhlenbeckNoise::getSamples(double* pOutput, size_t numSamples)
+{
+	m_normalSamples.get(pOutput, numSamples);
+
+	double theta = m_theta.get(), mu = m_mu.get();
+	double shockScale = m_sigma.get()*sqrt(m_dt);
+	double scale = m_scale->get();
+	for (size_t i = 0; i < numSamples; i++)
+	{
+		m_lastValue = m_lastValue + theta*(mu - m_lastValue)*m_dt + shockScale*pOutput[i];
+		pOutput[i] = m_lastValue*scale;
+	}
+}
+
 double OrnsteinUhlenbeckNoise::getSampleProbability(double sample, bool bUseMarginalNoise)
 {
 	double sigma;
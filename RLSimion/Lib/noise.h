@@ -1,5 +1,6 @@
 #pragma once
 #include "parameters.h"
+#include <cstdint>
 
 class ConfigNode;
 class NumericValue;
@@ -7,11 +8,39 @@ class NumericValue;
 double getRandomValue();// returns a random value in range [0,1]
 int chooseRandomInteger(vector<double>& probability); //returns an integer in range [0, probability.size] according to the given probability
 
+//Source of standard normal samples generated in blocks: a xorshift128+ generator fills a block with uniform values and
+//they are transformed with Box-Muller in pairs, using both outputs, in a loop that the compiler can vectorize.
+//The sequence only depends on the seed. If none is given, it is taken from rand(), which is seeded by the experiment
+class NormalSampleBuffer
+{
+	static const size_t m_blockSize = 256;
+	uint64_t m_state[2];
+	double m_uniform[m_blockSize];
+	double m_samples[m_blockSize];
+	size_t m_nextSample = m_blockSize;
+
+	void refill();
+public:
+	NormalSampleBuffer();
+	NormalSampleBuffer(uint64_t seed);
+
+	void seed(uint64_t seed);
+
+	double get()
+	{
+		if (m_nextSample == m_blockSize)
+			refill();
+		return m_samples[m_nextSample++];
+	}
+	void get(double* pOutput, size_t numSamples);
+};
+
 class Noise
 {
 protected:
 	Noise();
 	double m_lastValue;
+	NormalSampleBuffer m_normalSamples;
 public:
 	static std::shared_ptr<Noise> getInstance(ConfigNode* pParameters);
 	virtual ~Noise() {}
@@ -19,6 +48,8 @@ public:
 	virtual double getVariance() = 0;
 	virtual double unscale(double noise) { return noise; }
 	virtual double getSample()= 0;
+	//fills pOutput with the next numSamples samples, the same ones numSamples calls to getSample() would return
+	virtual void getSamples(double* pOutput, size_t numSamples);
 	//bUseMarginal= true means that the internal parameters should be neglected and, instead
 	//, a very thin noise source should be used. This is used to simulate the calculation of
 	//the probability of a sample belonging to a deterministic policy
@@ -39,6 +70,7 @@ public:
 	double getVariance();
 	double unscale(double noise);
 	double getSample();
+	void getSamples(double* pOutput, size_t numSamples);
 	double getSampleProbability(double sample, bool bUseMarginalNoise = false);
 
 	static double getSampleProbability(double mean, double sigma, double value, double scale = 1.0);
@@ -72,5 +104,6 @@ public:
 	double getVariance();
 	double unscale(double noise);
 	double getSample();
+	void getSamples(double* pOutput, size_t numSamples);
 	double getSampleProbability(double sample, bool bUseMarginalNoise = false);
 };
\ No newline at end of file
@@ -13,6 +13,9 @@ using namespace std;
 enum class Distribution { linear, quadratic, cubic };
 enum class Interpolation { linear, quadratic, cubic };
 enum class TimeReference { episode, experiment };
+enum class NeuralNetworkBackend { cntk, native };
+enum class ArgMaxSearch { exhaustive, coarseToFine, coordinateAscent };
+enum class WeightPrecision { float64, float32, float16 };
 
 template<typename DataType>
 class SimpleParam
@@ -89,6 +92,53 @@ protected:
 		}
 		value = m_default;
 	}
+	void initValue(ConfigNode* pConfigNode, NeuralNetworkBackend& value)
+	{
+		const char* strValue = pConfigNode->getConstString(m_name, "cntk");
+		if (!strcmp(strValue, "cntk"))
+		{
+			value = NeuralNetworkBackend::cntk; return;
+		}
+		else if (!strcmp(strValue, "native"))
+		{
+			value = NeuralNetworkBackend::native; return;
+		}
+		value = m_default;
+	}
+	void initValue(ConfigNode* pConfigNode, ArgMaxSearch& value)
+	{
+		const char* strValue = pConfigNode->getConstString(m_name, "exhaustive");
+		if (!strcmp(strValue, "exhaustive"))
+		{
+			value = ArgMaxSearch::exhaustive; return;
+		}
+		else if (!strcmp(strValue, "coarseToFine"))
+		{
+			value = ArgMaxSearch::coarseToFine; return;
+		}
+		else if (!strcmp(strValue, "coordinateAscent"))
+		{
+			value = ArgMaxSearch::coordinateAscent; return;
+		}
+		value = m_default;
+	}
+	void initValue(ConfigNode* pConfigNode, WeightPrecision& value)
+	{
+		const char* strValue = pConfigNode->getConstString(m_name, "float64");
+		if (!strcmp(strValue, "float64"))
+		{
+			value = WeightPrecision::float64; return;
+		}
+		else if (!strcmp(strValue, "float32"))
+		{
+			value = WeightPrecision::float32; return;
+		}
+		else if (!strcmp(strValue, "float16"))
+		{
+			value = WeightPrecision::float16; return;
+		}
+		value = m_default;
+	}
 public:
 	SimpleParam() = default;
 	SimpleParam(ConfigNode* pConfigNode
@@ -0,0 +1,63 @@
+#include "profiler.h"
+#include "logger.h"
+#include "../../tools/System/CrossPlatform.h"
+#include <algorithm>
+
+void StepProfiler::init(Logger* pLogger, size_t numSimions)
+{
+	m_bEnabled = true;
+	m_numSimions = numSimions;
+
+	m_names = { "Select-Action", "Execute-Action", "Update", "Log", "Post-Update", "Step" };
+	for (size_t i = 0; i < numSimions; i++)
+		m_names.push_back("Simion-" + to_string(i));
+
+	m_lastStepTimes = vector<double>(m_names.size(), 0.0);
+	m_currentStepTimes = vector<double>(m_names.size(), 0.0);
+	m_runTotalTimes = vector<double>(m_names.size(), 0.0);
+	m_runMaxTimes = vector<double>(m_names.size(), 0.0);
+
+	for (size_t i = 0; i < m_names.size(); i++)
+		pLogger->addVarToStats<double>("Profiler", m_names[i], m_lastStepTimes[i]);
+}
+
+void StepProfiler::endStep()
+{
+	if (!m_bEnabled) return;
+
+	for (size_t i = 0; i < m_currentStepTimes.size(); i++)
+	{
+		m_lastStepTimes[i] = m_currentStepTimes[i];
+		m_runTotalTimes[i] += m_currentStepTimes[i];
+		m_runMaxTimes[i] = std::max(m_runMaxTimes[i], m_currentStepTimes[i]);
+		m_currentStepTimes[i] = 0.0;
+	}
+	m_numSteps++;
+}
+
+void StepProfiler::logSummary()
+{
+	if (!m_bEnabled) return;
+
+	if (m_numSteps == 0) return;
+
+	//the phases run after the last step was logged haven't been added yet
+	for (size_t i = 0; i < m_currentStepTimes.size(); i++)
+	{
+		m_runTotalTimes[i] += m_currentStepTimes[i];
+		m_runMaxTimes[i] = std::max(m_runMaxTimes[i], m_currentStepTimes[i]);
+		m_currentStepTimes[i] = 0.0;
+	}
+
+	char message[1024];
+	double stepTime = m_runTotalTimes[Step] / (double)m_numSteps;
+	Logger::logMessage(MessageType::Info, "Step profile (average milliseconds per step):");
+	for (size_t i = 0; i < m_names.size(); i++)
+	{
+		double avgTime = m_runTotalTimes[i] / (double)m_numSteps;
+		CrossPlatform::Sprintf_s(message, 1024, "  %-16s %10.4f ms (max: %.4f ms, %5.1f%% of the step)"
+			, m_names[i].c_str(), avgTime, m_runMaxTimes[i]
+			, stepTime > 0.0 ? 100.0 * avgTime / stepTime : 0.0);
+		Logger::logMessage(MessageType::Info, message);
+	}
+}
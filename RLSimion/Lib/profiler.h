@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+using namespace std;
+
+class Logger;
+
+//Measures the time spent in each phase of a simulation step and in each simion. The duration (in milliseconds) of every
+//phase is registered in the logger as a stat variable (Profiler/<phase>), so it is saved in the log like any other stat,
+//and a summary of the whole run is shown when the simulation finishes.
+//endStep() is called right before a step is logged, so the logged values are those of the step being logged. The
+//phases that run after it (Log, Post-Update and the simion updates done by experience replay) can't be known yet: they
+//are added to the values logged in the next step
+class StepProfiler
+{
+public:
+	enum Phase { SelectAction, ExecuteAction, Update, Log, PostUpdate, Step, NumPhases };
+private:
+	bool m_bEnabled = false;
+	size_t m_numSimions = 0;
+
+	//phases are followed by simions
+	vector<string> m_names;
+	vector<double> m_lastStepTimes;
+	vector<double> m_currentStepTimes;
+	vector<double> m_runTotalTimes;
+	vector<double> m_runMaxTimes;
+	size_t m_numSteps = 0;
+public:
+	//registers the stat variables in the logger. It must be called before the experiment begins
+	void init(Logger* pLogger, size_t numSimions);
+
+	bool isEnabled() const { return m_bEnabled; }
+
+	//closes the times of the current step before it is logged. Anything measured afterwards goes to the next step
+	void endStep();
+
+	void addPhaseTime(Phase phase, double milliseconds) { m_currentStepTimes[phase] += milliseconds; }
+	void addSimionTime(size_t simion, double milliseconds) { m_currentStepTimes[NumPhases + simion] += milliseconds; }
+
+	//logs the average time per step of each phase/simion and its share of the step
+	void logSummary();
+};
+
+//Adds the time elapsed between its construction and destruction to a phase or simion of the profiler. It does nothing if
+//the profiler isn't enabled
+class ProfilerScope
+{
+	StepProfiler& m_profiler;
+	int m_phase;
+	int m_simion;
+	chrono::steady_clock::time_point m_start;
+public:
+	ProfilerScope(StepProfiler& profiler, StepProfiler::Phase phase)
+		: m_profiler(profiler), m_phase(phase), m_simion(-1)
+	{
+		if (m_profiler.isEnabled()) m_start = chrono::steady_clock::now();
+	}
+	ProfilerScope(StepProfiler& profiler, size_t simion)
+		: m_profiler(profiler), m_phase(-1), m_simion((int)simion)
+	{
+		if (m_profiler.isEnabled()) m_start = chrono::steady_clock::now();
+	}
+	~ProfilerScope()
+	{
+		if (!m_profiler.isEnabled()) return;
+
+		double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - m_start).count();
+		if (m_simion >= 0)
+			m_profiler.addSimionTime((size_t)m_simion, milliseconds);
+		else
+			m_profiler.addPhaseTime((StepProfiler::Phase)m_phase, milliseconds);
+	}
+};
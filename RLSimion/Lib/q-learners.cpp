@@ -177,7 +177,7 @@ double QLearningCritic::update(const State *s, const Action *a, const State *s_p
 	double s_value = m_pQFunction->get(m_pAux, false); //we use the live weights instead of the frozen ones
 	double td = r + s_p_value - s_value;
 
-	m_pQFunction->add(m_eTraces.ptr(), td*m_pAlpha->get());
+	m_pQFunction->add(m_eTraces->getFeatures(), td*m_pAlpha->get());
 
 	if (m_bUseVFunctionAsBaseline)
 		return r + s_p_value - m_pQFunction->max(s, true);
@@ -286,6 +286,6 @@ double SARSA::update(const State* s, const Action* a, const State* s_p, double r
 	m_eTraces->addFeatureList(m_pAux, gamma);
 
 	double td = r + gamma*m_pQFunction->get(s_p,m_nextA) - m_pQFunction->get(s, a);
-	m_pQFunction->add(m_eTraces.ptr(), td*m_pAlpha->get());
+	m_pQFunction->add(m_eTraces->getFeatures(), td*m_pAlpha->get());
 	return td;
 }
\ No newline at end of file
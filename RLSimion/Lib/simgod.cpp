@@ -10,6 +10,9 @@
 #include "experience-replay.h"
 #include "parameters.h"
 #include "features.h"
+#include "CNTKWrapperClient.h"
+#include "checkpoint.h"
+#include "logger.h"
 #include <algorithm>
 
 std::vector<std::pair<DeferredLoad*, unsigned int>> SimGod::m_deferredLoadSteps;
@@ -20,6 +23,10 @@ SimGod::SimGod(ConfigNode* pConfigNode)
 {
 	if (!pConfigNode) return;
 
+	//the backend must be selected before any simion creates its neural networks
+	m_neuralNetworkBackend = ENUM_PARAM<NeuralNetworkBackend>(pConfigNode, "Neural-Network-Backend", "The implementation used to build and train neural networks", NeuralNetworkBackend::cntk);
+	CNTK::WrapperClient::setBackend(m_neuralNetworkBackend.get());
+
 	//the global parameterizations of the state/action spaces
 	m_pGlobalStateFeatureMap = CHILD_OBJECT<StateFeatureMap>(pConfigNode, "State-Feature-Map", "The state feature map", true);
 	m_pGlobalActionFeatureMap = CHILD_OBJECT<ActionFeatureMap>(pConfigNode, "Action-Feature-Map", "The state feature map", true);
@@ -32,6 +39,7 @@ SimGod::SimGod(ConfigNode* pConfigNode)
 	m_bFreezeTargetFunctions = BOOL_PARAM(pConfigNode, "Freeze-Target-Function", "Defers updates on the V-functions to improve stability", false);
 	m_targetFunctionUpdateFreq = INT_PARAM(pConfigNode, "Target-Function-Update-Freq", "Update frequency at which target functions will be updated. Only used if Freeze-Target-Function=true", 100);
 	m_bUseImportanceWeights = BOOL_PARAM(pConfigNode, "Use-Importance-Weights", "Use sample importance weights to allow off-policy learning -experimental-", false);
+	m_bPreloadWeights = BOOL_PARAM(pConfigNode, "Preload-Weights", "Allocates and initializes all the weights in parallel before the experiment starts instead of on first access", false);
 }
 
 
@@ -44,8 +52,12 @@ double SimGod::selectAction(State* s, Action* a)
 {
 	double probability = 1.0;
 
+	StepProfiler& profiler = SimionApp::get()->pLogger->getProfiler();
 	for (unsigned int i = 0; i < m_simions.size(); i++)
+	{
+		ProfilerScope scope(profiler, (size_t)i);
 		probability*= m_simions[i]->selectAction(s, a);
+	}
 
 	return probability;
 }
@@ -57,32 +69,56 @@ void SimGod::update(State* s, Action* a, State* s_p, double r, double probabilit
 	m_bReplayingExperience = false;
 
 	//update step
+	StepProfiler& profiler = SimionApp::get()->pLogger->getProfiler();
 	for (unsigned int i = 0; i < m_simions.size(); i++)
+	{
+		ProfilerScope scope(profiler, (size_t)i);
 		m_simions[i]->update(s, a, s_p, r, probability);
+	}
 
-	if (m_pExperienceReplay->bUsing())
+	if (m_pExperienceReplay->bUsing() && bReplayNeeded())
 		m_pExperienceReplay->addTuple(s, a, s_p, r, probability);
 }
 
+bool SimGod::bReplayNeeded()
+{
+	for (unsigned int i = 0; i < m_simions.size(); i++)
+	{
+		if (!m_simions[i]->learnsAsynchronously())
+			return true;
+	}
+	return false;
+}
+
 void SimGod::postUpdate()
 {
 	ExperienceTuple* pExperienceTuple;
 
 	//Experience Replay
-	if (m_pExperienceReplay->bUsing() && m_pExperienceReplay->bHaveEnoughTuples())
+	if (m_pExperienceReplay->bUsing() && m_pExperienceReplay->bHaveEnoughTuples() && bReplayNeeded())
 	{
 		m_bReplayingExperience = true;
 
 		size_t updateBatchSize = m_pExperienceReplay->getUpdateBatchSize();
+		StepProfiler& profiler = SimionApp::get()->pLogger->getProfiler();
 		for (size_t tuple = 0; tuple < updateBatchSize; ++tuple)
 		{
 			pExperienceTuple = m_pExperienceReplay->getRandomTupleFromBuffer();
 
 			//update step
 			for (size_t i = 0; i < m_simions.size(); i++)
+			{
+				//asynchronous learners sample their own replay buffer in the learner thread
+				if (m_simions[i]->learnsAsynchronously())
+					continue;
+
+				ProfilerScope scope(profiler, i);
 				m_simions[i]->update(pExperienceTuple->s, pExperienceTuple->a, pExperienceTuple->s_p
 					, pExperienceTuple->r, pExperienceTuple->probability);
+			}
 		}
+
+		m_bReplayingExperience = false;
 	}
 }
 
@@ -91,6 +127,13 @@ void SimGod::registerDeferredLoadStep(DeferredLoad* deferredLoadObject, unsigned
 	m_deferredLoadSteps.push_back(std::pair<DeferredLoad*, unsigned int>(deferredLoadObject, orderLoad));
 }
 
+void SimGod::unregisterDeferredLoadStep(DeferredLoad* deferredLoadObject)
+{
+	m_deferredLoadSteps.erase(std::remove_if(m_deferredLoadSteps.begin(), m_deferredLoadSteps.end()
+		, [deferredLoadObject](const std::pair<DeferredLoad*, unsigned int>& step) { return step.first == deferredLoadObject; })
+		, m_deferredLoadSteps.end());
+}
+
 bool myComparison(const std::pair<DeferredLoad*, unsigned int> &a, const std::pair<DeferredLoad*, unsigned int> &b)
 {
 	return a.second < b.second;
@@ -104,9 +147,40 @@ void SimGod::deferredLoad()
 	{
 		(*it).first->deferredLoadStep();
 	}
+
+	//all the weight buffers have been requested and the memory pools initialized by now
+	if (m_bPreloadWeights.get())
+	{
+		Logger::logMessage(MessageType::Info, "Preloading the weights");
+		SimionApp::get()->pMemManager->preload();
+	}
 }
 
 
+void SimGod::saveCheckpoint(CheckpointWriter& writer)
+{
+	writer.write((uint64_t)m_deferredLoadSteps.size());
+	for (auto it = m_deferredLoadSteps.begin(); it != m_deferredLoadSteps.end(); it++)
+	{
+		size_t chunk = writer.beginChunk();
+		(*it).first->saveCheckpoint(writer);
+		writer.endChunk(chunk);
+	}
+}
+
+void SimGod::loadCheckpoint(CheckpointReader& reader)
+{
+	if (reader.read<uint64_t>() != m_deferredLoadSteps.size())
+		throw std::runtime_error("Checkpoint: the saved state doesn't match the experiment");
+
+	for (auto it = m_deferredLoadSteps.begin(); it != m_deferredLoadSteps.end(); it++)
+	{
+		size_t chunkEnd = reader.beginChunk();
+		(*it).first->loadCheckpoint(reader);
+		reader.endChunk(chunkEnd);
+	}
+}
+
 std::shared_ptr<StateFeatureMap> SimGod::getGlobalStateFeatureMap()
 {
 	return m_pGlobalStateFeatureMap.sharedPtr();
@@ -151,4 +225,9 @@ bool SimGod::useSampleImportanceWeights()
 size_t SimGod::getExperienceReplayUpdateSize()
 {
 	return (size_t)m_pExperienceReplay->getUpdateBatchSize();
+}
+
+size_t SimGod::getExperienceReplayBufferSize()
+{
+	return m_pExperienceReplay->getBufferSize();
 }
\ No newline at end of file
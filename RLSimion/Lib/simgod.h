@@ -14,6 +14,8 @@ class DeferredLoad;
 class StateFeatureMap;
 class ActionFeatureMap;
 class FeatureList;
+class CheckpointWriter;
+class CheckpointReader;
 
 
 //This class is the Simion God: it controls the learning agents and holds global learning parameters
@@ -25,6 +27,10 @@ class SimGod
 
 	bool m_bReplayingExperience= false;
 
+	//true if any simion learns from the experience replayed by the SimGod
+	bool bReplayNeeded();
+
+	ENUM_PARAM<NeuralNetworkBackend> m_neuralNetworkBackend;
 	MULTI_VALUE_FACTORY<Simion> m_simions;
 	
 	DOUBLE_PARAM m_gamma;
@@ -32,6 +38,7 @@ class SimGod
 	BOOL_PARAM m_bFreezeTargetFunctions;
 	INT_PARAM m_targetFunctionUpdateFreq;
 	BOOL_PARAM m_bUseImportanceWeights;
+	BOOL_PARAM m_bPreloadWeights;
 
 	Reward *m_pReward;
 
@@ -46,6 +53,9 @@ public:
 
 	bool bReplayingExperience() const { return m_bReplayingExperience; }
 	size_t getExperienceReplayUpdateSize();
+	size_t getExperienceReplayBufferSize();
+
+	size_t getNumSimions() { return m_simions.size(); }
 
 	double selectAction(State* s,Action* a);
 	//regular update step after a simulation time-step
@@ -57,8 +67,14 @@ public:
 
 	//delayed load
 	static void registerDeferredLoadStep(DeferredLoad* deferredLoadObject,unsigned int orderLoad);
+	//called when the object is destroyed, so that the objects of an app aren't used by the next one created
+	static void unregisterDeferredLoadStep(DeferredLoad* deferredLoadObject);
 	void deferredLoad();
 
+	//checkpoints of the state of all the DeferredLoad objects
+	void saveCheckpoint(CheckpointWriter& writer);
+	void loadCheckpoint(CheckpointReader& reader);
+
 	//global feature maps
 	static std::shared_ptr<StateFeatureMap> getGlobalStateFeatureMap();
 	static std::shared_ptr<ActionFeatureMap> getGlobalActionFeatureMap();
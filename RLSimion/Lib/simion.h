@@ -16,5 +16,9 @@ public:
 	//selectAction sets output in a, and returns the probability under which the simion selected the action
 	virtual double selectAction(const State *s, Action *a) = 0;
 
+	//simions that train in a thread of their own keep their own replay buffer, so the SimGod doesn't replay experience
+	//for them
+	virtual bool learnsAsynchronously() const { return false; }
+
 	static std::shared_ptr<Simion> getInstance(ConfigNode* pParameters);
 };
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "app.h"
 #include "simgod.h"
 #include "experiment.h"
+#include "single-dimension-grid.h"
+#include "noise.h"
 #include <assert.h>
 #include <algorithm>
 #include "mem-manager.h"
@@ -14,6 +16,7 @@ LinearVFA::LinearVFA(MemManager<SimionMemPool>* pMemManager)
 {
 	m_pMemManager = pMemManager;
 	m_pPendingUpdates = new FeatureList("Pending-vfa-updates", OverwriteMode::AllowDuplicates);
+	m_precision.set(WeightPrecision::float64);
 }
 
 LinearVFA::~LinearVFA()
@@ -27,6 +30,11 @@ void LinearVFA::setCanUseDeferredUpdates(bool bCanUseDeferredUpdates)
 	m_bCanBeFrozen = bCanUseDeferredUpdates;
 }
 
+bool LinearVFA::useFrozenWeights(bool bUseFrozenWeights) const
+{
+	return bUseFrozenWeights && m_bCanBeFrozen && SimionApp::get()->pSimGod->getTargetFunctionUpdateFreq() != 0;
+}
+
 double LinearVFA::get(const FeatureList *pFeatures,bool bUseFrozenWeights)
 {
 	double value = 0.0;
@@ -34,7 +42,7 @@ double LinearVFA::get(const FeatureList *pFeatures,bool bUseFrozenWeights)
 
 	IMemBuffer *pWeights;
 
-	if (!bUseFrozenWeights || !m_bCanBeFrozen || SimionApp::get()->pSimGod->getTargetFunctionUpdateFreq() == 0)
+	if (!useFrozenWeights(bUseFrozenWeights))
 		pWeights = m_pWeights;
 	else
 		pWeights = m_pFrozenWeights;
@@ -46,7 +54,7 @@ double LinearVFA::get(const FeatureList *pFeatures,bool bUseFrozenWeights)
 			//offset
 			localIndex = pFeatures->m_pFeatures[i].m_index - m_minIndex;
 
-			value += (*pWeights)[localIndex] * pFeatures->m_pFeatures[i].m_factor;
+			value += pWeights->get(localIndex) * pFeatures->m_pFeatures[i].m_factor;
 		}
 	}
 	return value;
@@ -91,17 +99,20 @@ void LinearVFA::add(const FeatureList* pFeatures, double alpha)
 		//and would still be a valid operation
 		//(for example, in a VFAPolicy with 2 VFAs: StochasticPolicyGaussianNose)
 		double inc;
+		size_t localIndex = pFeatures->m_pFeatures[i].m_index - m_minIndex;
+		double weight = m_pWeights->get(localIndex);
 		if (!m_bSaturateOutput)
 			inc= alpha*pFeatures->m_pFeatures[i].m_factor;
 		else
 		{
-			inc= std::min(m_maxOutput, std::max(m_minOutput, (*m_pWeights)[pFeatures->m_pFeatures[i].m_index - m_minIndex]
-				+ alpha * pFeatures->m_pFeatures[i].m_factor)) - (*m_pWeights)[pFeatures->m_pFeatures[i].m_index - m_minIndex];
+			inc= std::min(m_maxOutput, std::max(m_minOutput, weight
+				+ alpha * pFeatures->m_pFeatures[i].m_factor)) - weight;
 		}
-		(*m_pWeights)[pFeatures->m_pFeatures[i].m_index - m_minIndex] += inc;
+		m_pWeights->set(localIndex, weight + inc);
 		if (bFreezeTarget)
 			m_pPendingUpdates->add(pFeatures->m_pFeatures[i].m_index, inc);
 	}
+	m_weightsVersion++;
 
 	if (bFreezeTarget && !SimionApp::get()->pSimGod->bReplayingExperience())
 	{
@@ -111,17 +122,19 @@ void LinearVFA::add(const FeatureList* pFeatures, double alpha)
 		{
 			for (unsigned int i = 0; i < m_pPendingUpdates->m_numFeatures; ++i)
 			{
-				(*m_pFrozenWeights)[m_pPendingUpdates->m_pFeatures[i].m_index]
-					+= m_pPendingUpdates->m_pFeatures[i].m_factor;
+				size_t index = m_pPendingUpdates->m_pFeatures[i].m_index;
+				m_pFrozenWeights->set(index, m_pFrozenWeights->get(index) + m_pPendingUpdates->m_pFeatures[i].m_factor);
 			}
 			m_pPendingUpdates->clear();
+			m_frozenWeightsVersion++;
 		}
 	}
 }
 
 void LinearVFA::set(size_t feature, double value)
 {
-	(*m_pWeights)[feature] = value;
+	m_pWeights->set(feature, value);
+	m_weightsVersion++;
 }
 
 
@@ -139,6 +152,7 @@ LinearStateVFA::LinearStateVFA(ConfigNode* pConfigNode)
 
 	m_pAux = new FeatureList("LinearStateVFA/aux");
 	m_initValue= DOUBLE_PARAM(pConfigNode, "Init-Value", "The initial value given to the weights on initialization", 0.0);
+	m_precision = ENUM_PARAM<WeightPrecision>(pConfigNode, "Precision", "The precision used to store the weights. Lower precisions need less memory but the weights are rounded", WeightPrecision::float64);
 
 	m_bSaturateOutput = false;
 	m_minOutput = 0.0;
@@ -147,13 +161,13 @@ LinearStateVFA::LinearStateVFA(ConfigNode* pConfigNode)
 void LinearStateVFA::deferredLoadStep()
 {
 	//weights
-	m_pWeights = m_pMemManager->getMemBuffer(m_numWeights);
+	m_pWeights = m_pMemManager->getMemBuffer(m_numWeights, m_precision.get());
 	m_pWeights->setInitValue(m_initValue.get());
 
 	//frozen weights
 	if (m_bCanBeFrozen)
 	{
-		m_pFrozenWeights = m_pMemManager->getMemBuffer(m_numWeights);
+		m_pFrozenWeights = m_pMemManager->getMemBuffer(m_numWeights, m_precision.get());
 		m_pFrozenWeights->setInitValue(m_initValue.get());
 	}
 }
@@ -240,22 +254,33 @@ LinearStateActionVFA::LinearStateActionVFA(MemManager<SimionMemPool>* pMemManage
 	m_pAux = new FeatureList("LinearStateActionVFA/aux");
 	//this is used in "lower-level" methods
 	m_pAux2 = new FeatureList("LinearStateActionVFA/aux2");
+	m_pActionValuesStateFeatures = new FeatureList("LinearStateActionVFA/action-values-state");
 
 	m_bSaturateOutput = false;
 	m_minOutput = 0.0;
 	m_maxOutput = 0.0;
+
+	setArgMaxSearch(ArgMaxSearch::exhaustive);
 }
 
 LinearStateActionVFA::LinearStateActionVFA(ConfigNode* pConfigNode)
 	:LinearStateActionVFA(SimionApp::get()->pMemManager, SimGod::getGlobalStateFeatureMap(),SimGod::getGlobalActionFeatureMap())
 {
 	m_initValue= DOUBLE_PARAM(pConfigNode, "Init-Value","The initial value given to the weights on initialization", 0.0);
+	m_precision = ENUM_PARAM<WeightPrecision>(pConfigNode, "Precision", "The precision used to store the weights. Lower precisions need less memory but the weights are rounded", WeightPrecision::float64);
+	m_argMaxSearch = ENUM_PARAM<ArgMaxSearch>(pConfigNode, "Arg-Max-Search", "The search used to find the action with the highest value. Only the exhaustive search can be used with non-discrete action feature maps", ArgMaxSearch::exhaustive);
+	m_coarseResolution = INT_PARAM(pConfigNode, "Coarse-Resolution", "Number of values of each action variable evaluated in the first level of the coarse-to-fine search", 5);
+	initArgMaxSearch();
 }
 
 LinearStateActionVFA::LinearStateActionVFA(LinearStateActionVFA* pSourceVFA)
 	: LinearStateActionVFA(SimionApp::get()->pMemManager, SimGod::getGlobalStateFeatureMap(), SimGod::getGlobalActionFeatureMap())
 {
 	m_initValue = pSourceVFA->m_initValue;
+	m_precision = pSourceVFA->m_precision;
+	m_argMaxSearch = pSourceVFA->m_argMaxSearch;
+	m_coarseResolution = pSourceVFA->m_coarseResolution;
+	initArgMaxSearch();
 }
 
 LinearStateActionVFA::~LinearStateActionVFA()
@@ -263,6 +288,7 @@ LinearStateActionVFA::~LinearStateActionVFA()
 	//SimGod owns the feature maps -> his responsability to free memory
 	if (m_pAux) delete m_pAux;
 	if (m_pAux2) delete m_pAux2;
+	if (m_pActionValuesStateFeatures) delete m_pActionValuesStateFeatures;
 
 	if (m_pArgMaxTies) delete [] m_pArgMaxTies;
 }
@@ -272,21 +298,59 @@ void LinearStateActionVFA::setInitValue(double initValue)
 	m_initValue.set(initValue);
 }
 
+void LinearStateActionVFA::setArgMaxSearch(ArgMaxSearch search, int coarseResolution)
+{
+	m_argMaxSearch.set(search);
+	m_coarseResolution.set(coarseResolution);
+	initArgMaxSearch();
+}
+
+void LinearStateActionVFA::initArgMaxSearch()
+{
+	vector<SingleDimensionGrid*>& grids = m_pActionFeatureMap->getGrids();
+
+	m_actionGridSizes.clear();
+	m_actionGridStrides.clear();
+	size_t numActions = 1;
+	for (size_t i = 0; i < grids.size(); i++)
+	{
+		m_actionGridSizes.push_back(grids[i]->getValues().size());
+		m_actionGridStrides.push_back(numActions);
+		numActions *= grids[i]->getValues().size();
+	}
+
+	if (m_argMaxSearch.get() != ArgMaxSearch::exhaustive && (grids.empty() || numActions != m_numActionWeights))
+	{
+		Logger::logMessage(MessageType::Warning, "The action feature map doesn't have one feature per action. Exhaustive search will be used to find the greedy action");
+		m_argMaxSearch.set(ArgMaxSearch::exhaustive);
+	}
+	if (m_coarseResolution.get() < 2)
+		m_coarseResolution.set(2);
+
+	m_searchFirst = vector<size_t>(grids.size());
+	m_searchStep = vector<size_t>(grids.size());
+	m_searchCount = vector<size_t>(grids.size());
+	m_searchIndices = vector<size_t>(grids.size());
+}
+
 void LinearStateActionVFA::deferredLoadStep()
 {
 	//weights
-	m_pWeights= m_pMemManager->getMemBuffer(m_numWeights);
+	m_pWeights= m_pMemManager->getMemBuffer(m_numWeights, m_precision.get());
 	m_pWeights->setInitValue(m_initValue.get());
 
 	//frozen weights
 	if (m_bCanBeFrozen)
 	{
-		m_pFrozenWeights = m_pMemManager->getMemBuffer(m_numWeights);
+		m_pFrozenWeights = m_pMemManager->getMemBuffer(m_numWeights, m_precision.get());
 		m_pFrozenWeights->setInitValue(m_initValue.get());
 	}
 
 	//buffer to solve value ties in argMax()
 	m_pArgMaxTies = new int[m_numActionWeights];
+
+	m_actionValues = vector<double>(m_numActionWeights);
+	m_bActionValuesValid = false;
 }
 
 void LinearStateActionVFA::getFeatures(const State* s, const Action* a, FeatureList* outFeatures)
@@ -336,80 +400,252 @@ double LinearStateActionVFA::get(const State *s, const Action* a)
 
 void LinearStateActionVFA::argMax(const State *s, Action* a, bool bSolveTiesRandomly)
 {
-	int numTies = 0;
+	double maxValue;
+	size_t arg = searchArgMax(s, true, bSolveTiesRandomly, maxValue);
+
+	//retrieve action
+	m_pActionFeatureMap->getFeatureStateAction(arg, nullptr, a);
+}
+
+double LinearStateActionVFA::max(const State* s, bool bUseFrozenWeights)
+{
+	double maxValue;
+	searchArgMax(s, bUseFrozenWeights, false, maxValue);
+	return maxValue;
+}
+
+void LinearStateActionVFA::getActionValues(const State* s,double *outActionValues)
+{
+	if (!outActionValues)
+		throw std::runtime_error("LinearStateActionVFA::getAction Values(...) tried to get action values without providing a buffer");
+
+	const vector<double>& actionValues = getAllActionValues(s, true); //frozen weights
+	for (size_t i = 0; i < m_numActionWeights; i++)
+		outActionValues[i] = actionValues[i];
+}
+
+size_t LinearStateActionVFA::searchArgMax(const State* s, bool bUseFrozenWeights, bool bSolveTiesRandomly, double& outMaxValue)
+{
+	if (m_argMaxSearch.get() == ArgMaxSearch::exhaustive)
+		return exhaustiveArgMax(s, bUseFrozenWeights, bSolveTiesRandomly, outMaxValue);
+
 	//state features in aux list
-	getFeatures(s, 0, m_pAux);
+	m_pStateFeatureMap->getFeatures(s, nullptr, m_pAux);
 
-	double value = 0.0;
+	IMemBuffer* pWeights = useFrozenWeights(bUseFrozenWeights) ? m_pFrozenWeights : m_pWeights;
+	if (m_argMaxSearch.get() == ArgMaxSearch::coarseToFine)
+		return coarseToFineArgMax(pWeights, bSolveTiesRandomly, outMaxValue);
+	return coordinateAscentArgMax(pWeights, bSolveTiesRandomly, outMaxValue);
+}
+
+static bool sameFeatures(const FeatureList* pFeatures1, const FeatureList* pFeatures2)
+{
+	if (pFeatures1->m_numFeatures != pFeatures2->m_numFeatures)
+		return false;
+	for (size_t i = 0; i < pFeatures1->m_numFeatures; i++)
+	{
+		if (pFeatures1->m_pFeatures[i].m_index != pFeatures2->m_pFeatures[i].m_index
+			|| pFeatures1->m_pFeatures[i].m_factor != pFeatures2->m_pFeatures[i].m_factor)
+			return false;
+	}
+	return true;
+}
+
+const vector<double>& LinearStateActionVFA::getAllActionValues(const State* s, bool bUseFrozenWeights)
+{
+	//state features in aux list
+	m_pStateFeatureMap->getFeatures(s, nullptr, m_pAux);
+
+	bool bFrozen = useFrozenWeights(bUseFrozenWeights);
+	size_t weightsVersion = bFrozen ? m_frozenWeightsVersion : m_weightsVersion;
+	if (m_bActionValuesValid && m_bActionValuesFrozen == bFrozen && m_actionValuesVersion == weightsVersion
+		&& sameFeatures(m_pAux, m_pActionValuesStateFeatures))
+		return m_actionValues;
+
+	//the weights of action i are those of the state features offset by i*m_numStateWeights
+	IMemBuffer* pWeights = bFrozen ? m_pFrozenWeights : m_pWeights;
+	std::fill(m_actionValues.begin(), m_actionValues.end(), 0.0);
+	for (size_t i = 0; i < m_pAux->m_numFeatures; i++)
+	{
+		size_t index = m_pAux->m_pFeatures[i].m_index;
+		double factor = m_pAux->m_pFeatures[i].m_factor;
+		for (size_t action = 0; action < m_numActionWeights; action++, index += m_numStateWeights)
+		{
+			if (m_minIndex <= index && m_maxIndex > index)
+				m_actionValues[action] += pWeights->get(index - m_minIndex) * factor;
+		}
+	}
+
+	m_pActionValuesStateFeatures->copy(m_pAux);
+	m_bActionValuesFrozen = bFrozen;
+	m_actionValuesVersion = weightsVersion;
+	m_bActionValuesValid = true;
+	return m_actionValues;
+}
+
+size_t LinearStateActionVFA::exhaustiveArgMax(const State* s, bool bUseFrozenWeights, bool bSolveTiesRandomly, double& outMaxValue)
+{
+	const vector<double>& actionValues = getAllActionValues(s, bUseFrozenWeights);
+
+	int numTies = 0;
 	double maxValue = std::numeric_limits<double>::lowest();
-	unsigned int arg = -1;
+	size_t arg;
 
 	//action-value maximization
+	m_pArgMaxTies[0] = 0;
 	for (unsigned int i = 0; i < m_numActionWeights; i++)
 	{
-		value = get(m_pAux);
-		if (value == maxValue)
+		if (actionValues[i] == maxValue)
 		{
 			m_pArgMaxTies[numTies++] = i;
 		}
-		if (value>maxValue)
+		if (actionValues[i] > maxValue)
 		{
-			maxValue = value;
-			arg = i;
+			maxValue = actionValues[i];
 			m_pArgMaxTies[0] = i;
 			numTies = 1;
 		}
-
-		m_pAux->offsetIndices(m_numStateWeights);
 	}
 
-	if (bSolveTiesRandomly)
-	{
-		//any ties?
-		if (numTies > 1)
-			arg = m_pArgMaxTies[rand() % numTies]; //select one randomly
-	}
+	if (bSolveTiesRandomly && numTies > 1)
+		arg = m_pArgMaxTies[rand() % numTies]; //select one randomly
 	else arg = m_pArgMaxTies[0];
 
-	//retrieve action
-	m_pActionFeatureMap->getFeatureStateAction(arg, nullptr, a);
+	outMaxValue = maxValue;
+	return arg;
 }
 
-double LinearStateActionVFA::max(const State* s, bool bUseFrozenWeights)
+double LinearStateActionVFA::getActionValue(IMemBuffer* pWeights, size_t action)
 {
 	//state features in aux list
-	m_pStateFeatureMap->getFeatures(s, nullptr, m_pAux);
-
 	double value = 0.0;
-	double maxValue = std::numeric_limits<double>::lowest();
+	size_t offset = action * m_numStateWeights;
+	for (size_t i = 0; i < m_pAux->m_numFeatures; i++)
+	{
+		size_t index = m_pAux->m_pFeatures[i].m_index + offset;
+		if (m_minIndex <= index && m_maxIndex > index)
+			value += pWeights->get(index - m_minIndex) * m_pAux->m_pFeatures[i].m_factor;
+	}
+	return value;
+}
 
-	//action-value maximization
-	for (unsigned int i = 0; i < m_numActionWeights; i++)
+void LinearStateActionVFA::evaluateActionGrid(IMemBuffer* pWeights, bool bSolveTiesRandomly, size_t& outBest, double& outBestValue)
+{
+	size_t numTies = 0;
+	outBestValue = std::numeric_limits<double>::lowest();
+	std::fill(m_searchIndices.begin(), m_searchIndices.end(), 0);
+
+	while (true)
 	{
-		value = get(m_pAux, bUseFrozenWeights); //if the target is frozen, we use the frozen weights
-		if (value>maxValue)
-			maxValue = value;
+		size_t action = 0;
+		for (size_t i = 0; i < m_searchIndices.size(); i++)
+			action += (m_searchFirst[i] + m_searchIndices[i] * m_searchStep[i]) * m_actionGridStrides[i];
+
+		double value = getActionValue(pWeights, action);
+		if (value > outBestValue)
+		{
+			outBestValue = value;
+			outBest = action;
+			numTies = 1;
+		}
+		else if (value == outBestValue)
+		{
+			//reservoir sampling: each of the tied actions is selected with the same probability
+			numTies++;
+			if (bSolveTiesRandomly && rand() % numTies == 0)
+				outBest = action;
+		}
 
-		m_pAux->offsetIndices((int) m_numStateWeights);
+		//next action in the grid
+		size_t i = 0;
+		while (i < m_searchIndices.size() && ++m_searchIndices[i] == m_searchCount[i])
+			m_searchIndices[i++] = 0;
+		if (i == m_searchIndices.size())
+			return;
 	}
+}
 
-	return maxValue;
+size_t LinearStateActionVFA::coarseToFineArgMax(IMemBuffer* pWeights, bool bSolveTiesRandomly, double& outMaxValue)
+{
+	//the first action evaluated. It is returned if no action value can be compared (i.e., all of them are NaN)
+	size_t best = 0;
+	size_t numValues, resolution = (size_t)m_coarseResolution.get();
+
+	//first level: a coarse grid covering the whole range of each action variable
+	for (size_t i = 0; i < m_actionGridSizes.size(); i++)
+	{
+		numValues = m_actionGridSizes[i];
+		m_searchFirst[i] = 0;
+		m_searchStep[i] = std::max((size_t)1, (numValues - 1) / (resolution - 1));
+		m_searchCount[i] = (numValues - 1) / m_searchStep[i] + 1;
+	}
+	evaluateActionGrid(pWeights, bSolveTiesRandomly, best, outMaxValue);
+
+	//next levels: the spacing is halved and only the actions within two steps of the best one are evaluated, which covers
+	//the interval between the neighbours of the best action in the previous level
+	while (std::any_of(m_searchStep.begin(), m_searchStep.end(), [](size_t step) { return step > 1; }))
+	{
+		for (size_t i = 0; i < m_actionGridSizes.size(); i++)
+		{
+			numValues = m_actionGridSizes[i];
+			size_t center = (best / m_actionGridStrides[i]) % numValues;
+			size_t step = std::max((size_t)1, m_searchStep[i] / 2);
+			size_t numStepsBelow = std::min((size_t)2, center / step);
+			size_t numStepsAbove = std::min((size_t)2, (numValues - 1 - center) / step);
+
+			m_searchFirst[i] = center - numStepsBelow * step;
+			m_searchStep[i] = step;
+			m_searchCount[i] = numStepsBelow + numStepsAbove + 1;
+		}
+		evaluateActionGrid(pWeights, bSolveTiesRandomly, best, outMaxValue);
+	}
+	return best;
 }
 
-void LinearStateActionVFA::getActionValues(const State* s,double *outActionValues)
+size_t LinearStateActionVFA::coordinateAscentArgMax(IMemBuffer* pWeights, bool bSolveTiesRandomly, double& outMaxValue)
 {
-	if (!outActionValues)
-		throw std::runtime_error("LinearStateActionVFA::getAction Values(...) tried to get action values without providing a buffer");
-	//state features in aux list
-	m_pStateFeatureMap->getFeatures(s, nullptr, m_pAux);
+	const size_t maxNumSweeps = 10;
+	size_t best = 0;
 
-	//action-value maximization
-	for (unsigned int i = 0; i < m_numActionWeights; i++)
+	//start from the center of the grid or, if ties are to be solved randomly, from a random action
+	if (bSolveTiesRandomly)
+		best = std::min(m_numActionWeights - 1, (size_t)(getRandomValue() * m_numActionWeights));
+	else
 	{
-		outActionValues[i] = get(m_pAux, true); //frozen weights
+		for (size_t i = 0; i < m_actionGridSizes.size(); i++)
+			best += (m_actionGridSizes[i] / 2) * m_actionGridStrides[i];
+	}
+	outMaxValue = getActionValue(pWeights, best);
 
-		m_pAux->offsetIndices((int) m_numStateWeights);
+	for (size_t sweep = 0; sweep < maxNumSweeps; sweep++)
+	{
+		bool bImproved = false;
+		for (size_t i = 0; i < m_actionGridSizes.size(); i++)
+		{
+			//the action with the i-th variable set to its first value
+			size_t base = best - ((best / m_actionGridStrides[i]) % m_actionGridSizes[i]) * m_actionGridStrides[i];
+			size_t dimBest = best;
+			for (size_t value = 0; value < m_actionGridSizes[i]; value++)
+			{
+				size_t action = base + value * m_actionGridStrides[i];
+				if (action == best) continue;
+
+				double actionValue = getActionValue(pWeights, action);
+				if (actionValue > outMaxValue)
+				{
+					outMaxValue = actionValue;
+					dimBest = action;
+				}
+			}
+			if (dimBest != best)
+			{
+				best = dimBest;
+				bImproved = true;
+			}
+		}
+		if (!bImproved) break;
 	}
+	return best;
 }
 
 
@@ -36,8 +36,17 @@ protected:
 
 	bool m_bCanBeFrozen= false;
 
+	//the precision used to store the weights in the memory pool
+	ENUM_PARAM<WeightPrecision> m_precision;
+
 	size_t m_minIndex;
 	size_t m_maxIndex;
+
+	//incremented every time the live/frozen weights change, so that values calculated from them can be reused
+	size_t m_weightsVersion = 0;
+	size_t m_frozenWeightsVersion = 0;
+
+	bool useFrozenWeights(bool bUseFrozenWeights) const;
 public:
 	LinearVFA() = default;
 	LinearVFA(MemManager<SimionMemPool>* pMemManager);
@@ -54,6 +63,7 @@ public:
 	void saturateOutput(double min, double max);
 
 	void setIndexOffset(unsigned int offset);
+	void setPrecision(WeightPrecision precision) { m_precision.set(precision); }
 
 };
 
@@ -101,6 +111,39 @@ protected:
 	DOUBLE_PARAM m_initValue;
 	int *m_pArgMaxTies= nullptr;
 
+	//Search used to find the greedy action. The exhaustive search evaluates every action. The other two exploit the structure
+	//of action feature maps with one feature per action (i.e., discrete grids), whose features are indexed as a mixed-radix
+	//number with one digit per action variable, so they only evaluate a small subset of the actions:
+	// - coarseToFine: evaluates a coarse grid of actions and then refines it around the best one found
+	// - coordinateAscent: maximizes one action variable at a time. It finds the exact maximum if the action variables are
+	//   independent (separable Q-functions) and a local one otherwise
+	ENUM_PARAM<ArgMaxSearch> m_argMaxSearch;
+	INT_PARAM m_coarseResolution;
+	vector<size_t> m_actionGridSizes;
+	vector<size_t> m_actionGridStrides;
+	//the actions evaluated in each level of the coarse-to-fine search: first[i] + k*step[i], with 0<=k<count[i]
+	vector<size_t> m_searchFirst;
+	vector<size_t> m_searchStep;
+	vector<size_t> m_searchCount;
+	vector<size_t> m_searchIndices;
+
+	//values of all the actions in the last state evaluated by the exhaustive search. Q-Learning evaluates s_p using
+	//the frozen weights in the update and then again as s to select the next action, so they are reused unless the
+	//weights have changed in between
+	vector<double> m_actionValues;
+	FeatureList *m_pActionValuesStateFeatures = nullptr;
+	bool m_bActionValuesValid = false;
+	bool m_bActionValuesFrozen = false;
+	size_t m_actionValuesVersion = 0;
+
+	void initArgMaxSearch();
+	double getActionValue(IMemBuffer* pWeights, size_t action);
+	const vector<double>& getAllActionValues(const State* s, bool bUseFrozenWeights);
+	size_t searchArgMax(const State* s, bool bUseFrozenWeights, bool bSolveTiesRandomly, double& outMaxValue);
+	size_t exhaustiveArgMax(const State* s, bool bUseFrozenWeights, bool bSolveTiesRandomly, double& outMaxValue);
+	size_t coarseToFineArgMax(IMemBuffer* pWeights, bool bSolveTiesRandomly, double& outMaxValue);
+	size_t coordinateAscentArgMax(IMemBuffer* pWeights, bool bSolveTiesRandomly, double& outMaxValue);
+	void evaluateActionGrid(IMemBuffer* pWeights, bool bSolveTiesRandomly, size_t& outBest, double& outBestValue);
 public:
 	size_t getNumStateWeights() const{ return m_numStateWeights; }
 	size_t getNumActionWeights() const { return m_numActionWeights; }
@@ -113,6 +156,7 @@ public:
 	LinearStateActionVFA(MemManager<SimionMemPool>* pMemManager, std::shared_ptr<StateFeatureMap> pStateFeatureMap, std::shared_ptr<ActionFeatureMap> pActionFeatureMap);
 
 	void setInitValue(double initValue);
+	void setArgMaxSearch(ArgMaxSearch search, int coarseResolution= 5);
 
 	virtual ~LinearStateActionVFA();
 	using LinearVFA::get;
@@ -1,6 +1,7 @@
 #include "BulletPhysics.h"
 #include "BulletBody.h"
 #include "Box.h"
+#include "BulletSnapshot.h"
 
 //static public constants
 const double BulletPhysics::MASS_ROBOT = 0.5f;
@@ -76,6 +77,11 @@ BulletPhysics::~BulletPhysics()
 	for (auto it = m_bulletObjects.begin(); it != m_bulletObjects.end(); ++it)
 		delete (*it);
 
+	if (m_pInitialState)
+		delete m_pInitialState;
+	if (m_pInitialStateValues)
+		delete m_pInitialStateValues;
+
 	exitPhysics();
 }
 void BulletPhysics::initPlayground()
@@ -105,8 +111,30 @@ void BulletPhysics::initPlayground()
 
 void BulletPhysics::reset(State* s)
 {
-	for (auto it = m_bulletObjects.begin(); it != m_bulletObjects.end(); ++it)
-		(*it)->reset(s);
+	if (!m_pInitialState)
+	{
+		//first episode: place every object in its origin and keep the resulting state of the world
+		for (auto it = m_bulletObjects.begin(); it != m_bulletObjects.end(); ++it)
+			(*it)->reset(s);
+		m_pInitialState = new BulletSnapshot(m_dynamicsWorld);
+		m_pInitialStateValues = s->getDescriptor().getInstance();
+		m_pInitialStateValues->copy(s);
+	}
+	else
+	{
+		m_pInitialState->restore(m_dynamicsWorld);
+		s->copy(m_pInitialStateValues);
+	}
+}
+
+void BulletPhysics::saveSnapshot(BulletSnapshot& snapshot)
+{
+	snapshot.save(m_dynamicsWorld);
+}
+
+void BulletPhysics::restoreSnapshot(const BulletSnapshot& snapshot)
+{
+	snapshot.restore(m_dynamicsWorld);
 }
 
 void BulletPhysics::updateState(State* s)
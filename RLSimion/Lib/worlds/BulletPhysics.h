@@ -7,6 +7,7 @@
 #include <vector>
 #include <math.h>
 class BulletBody;
+class BulletSnapshot;
 class NamedVarSet;
 typedef NamedVarSet State;
 typedef NamedVarSet Action;
@@ -16,6 +17,11 @@ class BulletPhysics : public BulletCreationInterface
 	std::vector<btSoftBody*> m_pSoftObjects;
 
 	std::vector<BulletBody*> m_bulletObjects;
+
+	//state of the world after the first reset, restored at the beginning of every following episode. The values of the
+	//state variables are restored too: some bodies (i.e. Robot) keep part of their state outside Bullet
+	BulletSnapshot* m_pInitialState = nullptr;
+	State* m_pInitialStateValues = nullptr;
 public:
 	//CONSTANTS
 	static const double MASS_ROBOT;
@@ -61,6 +67,9 @@ public:
 
 	void add(BulletBody* pBulletBody);
 	void reset(State* s);
+	//only the Bullet world is saved/restored: the caller is responsible for restoring the state variables too
+	void saveSnapshot(BulletSnapshot& snapshot);
+	void restoreSnapshot(const BulletSnapshot& snapshot);
 	void updateState(State* s);
 	void updateBulletState(State* s, const Action* a, double dt);
 
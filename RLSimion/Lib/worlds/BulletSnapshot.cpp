@@ -0,0 +1,139 @@
+#include "BulletSnapshot.h"
+#include "../../../3rd-party/bullet3-2.86/src/BulletSoftBody/btSoftRigidDynamicsWorld.h"
+#include <stdexcept>
+
+//btDiscreteDynamicsWorld doesn't expose the time accumulated between fixed substeps, but it is part of the state
+//that determines how many substeps the next call to stepSimulation() will take
+struct LocalTimeAccessor : public btDiscreteDynamicsWorld
+{
+	static btScalar& get(btDiscreteDynamicsWorld* pWorld)
+	{
+		return pWorld->*(&LocalTimeAccessor::m_localTime);
+	}
+};
+
+BulletSnapshot::BulletSnapshot(btDiscreteDynamicsWorld* pWorld)
+{
+	save(pWorld);
+}
+
+void BulletSnapshot::getSoftBodies(btDiscreteDynamicsWorld* pWorld, std::vector<btSoftBody*>& outSoftBodies)
+{
+	outSoftBodies.clear();
+	if (pWorld->getWorldType() != BT_SOFT_RIGID_DYNAMICS_WORLD)
+		return;
+
+	btSoftBodyArray& softBodies = ((btSoftRigidDynamicsWorld*)pWorld)->getSoftBodyArray();
+	for (int i = 0; i < softBodies.size(); i++)
+		outSoftBodies.push_back(softBodies[i]);
+}
+
+void BulletSnapshot::save(btDiscreteDynamicsWorld* pWorld)
+{
+	btCollisionObjectArray& objects = pWorld->getCollisionObjectArray();
+
+	m_collisionObjects.resize(objects.size());
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btCollisionObject* pObject = objects[i];
+		CollisionObjectState& state = m_collisionObjects[i];
+
+		state.worldTransform = pObject->getWorldTransform();
+		state.interpolationWorldTransform = pObject->getInterpolationWorldTransform();
+		state.interpolationLinearVelocity = pObject->getInterpolationLinearVelocity();
+		state.interpolationAngularVelocity = pObject->getInterpolationAngularVelocity();
+		state.deactivationTime = pObject->getDeactivationTime();
+		state.activationState = pObject->getActivationState();
+
+		btRigidBody* pBody = btRigidBody::upcast(pObject);
+		if (pBody)
+		{
+			state.linearVelocity = pBody->getLinearVelocity();
+			state.angularVelocity = pBody->getAngularVelocity();
+		}
+		else
+		{
+			state.linearVelocity.setZero();
+			state.angularVelocity.setZero();
+		}
+	}
+
+	std::vector<btSoftBody*> softBodies;
+	getSoftBodies(pWorld, softBodies);
+	m_softBodyNodes.clear();
+	for (btSoftBody* pSoftBody : softBodies)
+	{
+		for (int i = 0; i < pSoftBody->m_nodes.size(); i++)
+		{
+			const btSoftBody::Node& node = pSoftBody->m_nodes[i];
+			m_softBodyNodes.push_back({ node.m_x, node.m_q, node.m_v, node.m_n });
+		}
+	}
+
+	m_localTime = LocalTimeAccessor::get(pWorld);
+}
+
+void BulletSnapshot::restore(btDiscreteDynamicsWorld* pWorld) const
+{
+	btCollisionObjectArray& objects = pWorld->getCollisionObjectArray();
+
+	if (objects.size() != (int)m_collisionObjects.size())
+		throw std::runtime_error("Can't restore a Bullet snapshot taken from a world with a different number of objects");
+
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btCollisionObject* pObject = objects[i];
+		const CollisionObjectState& state = m_collisionObjects[i];
+
+		pObject->setWorldTransform(state.worldTransform);
+		pObject->setInterpolationWorldTransform(state.interpolationWorldTransform);
+		pObject->setInterpolationLinearVelocity(state.interpolationLinearVelocity);
+		pObject->setInterpolationAngularVelocity(state.interpolationAngularVelocity);
+		pObject->setDeactivationTime(state.deactivationTime);
+		pObject->forceActivationState(state.activationState);
+
+		btRigidBody* pBody = btRigidBody::upcast(pObject);
+		if (pBody)
+		{
+			pBody->setLinearVelocity(state.linearVelocity);
+			pBody->setAngularVelocity(state.angularVelocity);
+			pBody->clearForces();
+			if (pBody->getMotionState())
+				pBody->getMotionState()->setWorldTransform(state.worldTransform);
+		}
+
+		//remove the cached contacts of the object, they belong to the previous state of the world
+		if (pObject->getBroadphaseHandle())
+			pWorld->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(pObject->getBroadphaseHandle()
+				, pWorld->getDispatcher());
+	}
+
+	std::vector<btSoftBody*> softBodies;
+	getSoftBodies(pWorld, softBodies);
+	size_t nodeIndex = 0;
+	for (btSoftBody* pSoftBody : softBodies)
+	{
+		if (nodeIndex + pSoftBody->m_nodes.size() > m_softBodyNodes.size())
+			throw std::runtime_error("Can't restore a Bullet snapshot taken from a world with different soft bodies");
+
+		const btScalar margin = pSoftBody->getCollisionShape()->getMargin();
+		for (int i = 0; i < pSoftBody->m_nodes.size(); i++, nodeIndex++)
+		{
+			btSoftBody::Node& node = pSoftBody->m_nodes[i];
+			const SoftBodyNodeState& state = m_softBodyNodes[nodeIndex];
+			node.m_x = state.x;
+			node.m_q = state.q;
+			node.m_v = state.v;
+			node.m_n = state.n;
+			node.m_f.setZero();
+			ATTRIBUTE_ALIGNED16(btDbvtVolume) volume = btDbvtVolume::FromCR(node.m_x, margin);
+			pSoftBody->m_ndbvt.update(node.m_leaf, volume);
+		}
+		pSoftBody->updateNormals();
+		pSoftBody->updateBounds();
+	}
+
+	pWorld->getBroadphase()->resetPool(pWorld->getDispatcher());
+	pWorld->getConstraintSolver()->reset();
+	LocalTimeAccessor::get(pWorld) = m_localTime;
+}
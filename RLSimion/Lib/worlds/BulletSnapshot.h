@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../../../3rd-party/bullet3-2.86/src/btBulletDynamicsCommon.h"
+#include <vector>
+
+class btSoftBody;
+
+//Flat copy of the dynamic state of a btDiscreteDynamicsWorld: transforms and velocities of every collision object,
+//the node state of the soft bodies and the internal clock of the world. Taking a snapshot right after a world has been
+//initialized allows resetting it at the beginning of each episode by copying the arrays back instead of re-positioning
+//every body. The same snapshot can be restored in any other world built in the same way (i.e., with the same objects
+//added in the same order), which can be used to fork a world state for several rollouts
+class BulletSnapshot
+{
+	struct CollisionObjectState
+	{
+		btTransform worldTransform;
+		btTransform interpolationWorldTransform;
+		btVector3 interpolationLinearVelocity;
+		btVector3 interpolationAngularVelocity;
+		btVector3 linearVelocity;
+		btVector3 angularVelocity;
+		btScalar deactivationTime;
+		int activationState;
+	};
+	struct SoftBodyNodeState
+	{
+		btVector3 x, q, v, n;
+	};
+
+	std::vector<CollisionObjectState> m_collisionObjects;
+	std::vector<SoftBodyNodeState> m_softBodyNodes;
+	btScalar m_localTime = 0.0;
+
+	static void getSoftBodies(btDiscreteDynamicsWorld* pWorld, std::vector<btSoftBody*>& outSoftBodies);
+public:
+	BulletSnapshot() = default;
+	BulletSnapshot(btDiscreteDynamicsWorld* pWorld);
+	virtual ~BulletSnapshot() = default;
+
+	void save(btDiscreteDynamicsWorld* pWorld);
+	void restore(btDiscreteDynamicsWorld* pWorld) const;
+
+	bool isEmpty() const { return m_collisionObjects.empty(); }
+};
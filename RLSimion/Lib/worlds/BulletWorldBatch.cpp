@@ -0,0 +1,185 @@
+#include "BulletWorldBatch.h"
+#include "push-box-1.h"
+#include "push-box-2.h"
+#include "pull-box-1.h"
+#include "pull-box-2.h"
+#include "robot-control.h"
+#include "../config.h"
+#include <stdexcept>
+#include <algorithm>
+
+BulletWorldBatch::BulletWorldBatch(ConfigNode* pConfigNode)
+{
+	METADATA("World", "Bullet-World-Batch");
+
+	m_numWorlds = INT_PARAM(pConfigNode, "Num-Worlds", "Number of instances of the world simulated in parallel", 4);
+	m_numThreads = INT_PARAM(pConfigNode, "Num-Threads", "Number of worker threads used to step the instances (0: one per hardware thread)", 0);
+
+	if (m_numWorlds.get() < 1)
+		throw std::runtime_error("Bullet-World-Batch needs at least one world");
+
+	//all the instances are built from the same configuration node, so their states and actions share the same layout
+	for (int i = 0; i < m_numWorlds.get(); i++)
+	{
+		std::shared_ptr<DynamicModel> pWorld = getBulletWorld(pConfigNode);
+		if (!pWorld)
+			throw std::runtime_error("Bullet-World-Batch couldn't create the Bullet world");
+		m_worlds.push_back(pWorld);
+		m_s.push_back(pWorld->getStateInstance());
+		m_s_p.push_back(pWorld->getStateInstance());
+		m_a.push_back(pWorld->getActionInstance());
+	}
+
+	//the variables of the batch are the variables of every instance, with the index of the instance appended. They are
+	//added through the descriptors because their names are only known at run-time
+	Descriptor& worldStateDescriptor = m_worlds[0]->getStateDescriptor();
+	Descriptor& worldActionDescriptor = m_worlds[0]->getActionDescriptor();
+	m_numStateVarsPerWorld = worldStateDescriptor.size();
+	m_numActionVarsPerWorld = worldActionDescriptor.size();
+	for (size_t i = 0; i < m_worlds.size(); i++)
+	{
+		for (size_t var = 0; var < m_numStateVarsPerWorld; var++)
+		{
+			const NamedVarProperties& properties = worldStateDescriptor[var];
+			getStateDescriptor().addVariable((string(properties.getName()) + "-" + to_string(i)).c_str()
+				, properties.getUnits(), properties.getMin(), properties.getMax(), properties.isCircular());
+		}
+		for (size_t var = 0; var < m_numActionVarsPerWorld; var++)
+		{
+			const NamedVarProperties& properties = worldActionDescriptor[var];
+			getActionDescriptor().addVariable((string(properties.getName()) + "-" + to_string(i)).c_str()
+				, properties.getUnits(), properties.getMin(), properties.getMax(), properties.isCircular());
+		}
+		m_pRewardFunction->addRewardComponent(new BulletWorldBatchReward(this, i));
+	}
+	m_pRewardFunction->initialize();
+
+	m_pThreadPool = std::unique_ptr<ThreadPool>(new ThreadPool((unsigned int)std::max(0, m_numThreads.get())));
+}
+
+BulletWorldBatch::~BulletWorldBatch()
+{
+	//the thread pool must be stopped before the worlds are destroyed
+	m_pThreadPool.reset();
+
+	for (size_t i = 0; i < m_worlds.size(); i++)
+	{
+		delete m_s[i];
+		delete m_s_p[i];
+		delete m_a[i];
+	}
+}
+
+std::shared_ptr<DynamicModel> BulletWorldBatch::getBulletWorld(ConfigNode* pConfigNode)
+{
+	return CHOICE<DynamicModel>(pConfigNode, "Bullet-World", "The Bullet world simulated in each instance",
+	{
+		{"Robot-control",CHOICE_ELEMENT_NEW<RobotControl>},
+		{"Push-Box-1",CHOICE_ELEMENT_NEW<PushBox1>},
+		{"Push-Box-2",CHOICE_ELEMENT_NEW<PushBox2>},
+		{"Pull-Box-1",CHOICE_ELEMENT_NEW<PullBox1>},
+		{"Pull-Box-2",CHOICE_ELEMENT_NEW<PullBox2>}
+	});
+}
+
+void BulletWorldBatch::checkBatchSize(size_t batchSize) const
+{
+	if (batchSize != m_worlds.size())
+		throw std::runtime_error("Bullet-World-Batch: the size of the batch doesn't match the number of worlds");
+}
+
+void BulletWorldBatch::scatter(size_t i, const NamedVarSet* pBatchVars, NamedVarSet* pWorldVars, size_t numVarsPerWorld)
+{
+	for (size_t var = 0; var < numVarsPerWorld; var++)
+		pWorldVars->set(var, pBatchVars->get(i * numVarsPerWorld + var));
+}
+
+void BulletWorldBatch::gather(size_t i, const NamedVarSet* pWorldVars, NamedVarSet* pBatchVars, size_t numVarsPerWorld)
+{
+	for (size_t var = 0; var < numVarsPerWorld; var++)
+		pBatchVars->set(i * numVarsPerWorld + var, pWorldVars->get(var));
+}
+
+void BulletWorldBatch::reset(State *s)
+{
+	vector<State*> worldStates(m_s.begin(), m_s.end());
+	reset(worldStates);
+	for (size_t i = 0; i < m_worlds.size(); i++)
+		gather(i, m_s[i], s, m_numStateVarsPerWorld);
+}
+
+void BulletWorldBatch::executeAction(State *s, const Action *a, double dt)
+{
+	for (size_t i = 0; i < m_worlds.size(); i++)
+	{
+		scatter(i, s, m_s[i], m_numStateVarsPerWorld);
+		scatter(i, a, m_a[i], m_numActionVarsPerWorld);
+	}
+
+	vector<State*> worldStates(m_s.begin(), m_s.end());
+	vector<const Action*> worldActions(m_a.begin(), m_a.end());
+	executeAction(worldStates, worldActions, dt);
+
+	for (size_t i = 0; i < m_worlds.size(); i++)
+		gather(i, m_s[i], s, m_numStateVarsPerWorld);
+}
+
+void BulletWorldBatch::reset(const std::vector<State*>& s)
+{
+	checkBatchSize(s.size());
+
+	//the instances are reset in order: the initial state of some worlds is random, and this keeps the sequence of random
+	//numbers (and thus the experiment) reproducible
+	for (size_t i = 0; i < m_worlds.size(); i++)
+		m_worlds[i]->reset(s[i]);
+}
+
+void BulletWorldBatch::executeAction(const std::vector<State*>& s, const std::vector<const Action*>& a, double dt)
+{
+	checkBatchSize(s.size());
+	checkBatchSize(a.size());
+
+	m_pThreadPool->parallelFor(m_worlds.size(), [&](size_t i)
+	{
+		m_worlds[i]->executeAction(s[i], a[i], dt);
+	});
+}
+
+double BulletWorldBatch::getWorldReward(size_t i, const State *s, const Action *a, const State *s_p)
+{
+	scatter(i, s, m_s[i], m_numStateVarsPerWorld);
+	scatter(i, a, m_a[i], m_numActionVarsPerWorld);
+	scatter(i, s_p, m_s_p[i], m_numStateVarsPerWorld);
+	return m_worlds[i]->getReward(m_s[i], m_a[i], m_s_p[i]);
+}
+
+
+BulletWorldBatchReward::BulletWorldBatchReward(BulletWorldBatch* pBatch, size_t worldIndex)
+{
+	m_pBatch = pBatch;
+	m_worldIndex = worldIndex;
+	m_name = "reward-" + to_string(worldIndex);
+}
+
+double BulletWorldBatchReward::getReward(const State *s, const Action *a, const State *s_p)
+{
+	return m_pBatch->getWorldReward(m_worldIndex, s, a, s_p);
+}
+
+double BulletWorldBatchReward::getMin()
+{
+	Reward* pWorldReward = m_pBatch->getWorld(m_worldIndex)->getRewardVector();
+	double min = 0.0;
+	for (size_t i = 0; i < pWorldReward->getNumVars(); i++)
+		min += pWorldReward->getProperties(i)->getMin();
+	return min;
+}
+
+double BulletWorldBatchReward::getMax()
+{
+	Reward* pWorldReward = m_pBatch->getWorld(m_worldIndex)->getRewardVector();
+	double max = 0.0;
+	for (size_t i = 0; i < pWorldReward->getNumVars(); i++)
+		max += pWorldReward->getProperties(i)->getMax();
+	return max;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "world.h"
+#include "../reward.h"
+#include "../parameters.h"
+#include "../../../tools/System/ThreadPool.h"
+#include <vector>
+#include <memory>
+
+//Hosts several independent instances of a Bullet-based world (Push-Box, Pull-Box, Robot-control...) in the same
+//process and steps all of them in parallel. Each instance owns its own btDiscreteDynamicsWorld, so they can be
+//simulated concurrently.
+//The batch is a DynamicModel itself: its state and action are the concatenation of those of every instance, with
+//the index of the instance appended to the name of each variable (i.e., "robot1-x-0", "robot1-x-1"...), and its
+//reward has one component per instance. This way, a single experiment can train several agents (one Simion per
+//instance) or one agent controlling all the instances at once.
+//Its scene (bullet-world-batch.scene) only draws the target and the first robot of the first instance, the variables
+//all the Bullet worlds share
+class BulletWorldBatch : public DynamicModel
+{
+	INT_PARAM m_numWorlds;
+	INT_PARAM m_numThreads;
+
+	std::vector<std::shared_ptr<DynamicModel>> m_worlds;
+	//the state and action of each instance, copied from/to the state and action of the batch
+	std::vector<State*> m_s;
+	std::vector<State*> m_s_p;
+	std::vector<Action*> m_a;
+	std::unique_ptr<ThreadPool> m_pThreadPool;
+
+	size_t m_numStateVarsPerWorld = 0;
+	size_t m_numActionVarsPerWorld = 0;
+
+	static std::shared_ptr<DynamicModel> getBulletWorld(ConfigNode* pConfigNode);
+
+	void checkBatchSize(size_t batchSize) const;
+	//copy the variables of the i-th instance from/to a set of variables of the batch
+	static void scatter(size_t i, const NamedVarSet* pBatchVars, NamedVarSet* pWorldVars, size_t numVarsPerWorld);
+	static void gather(size_t i, const NamedVarSet* pWorldVars, NamedVarSet* pBatchVars, size_t numVarsPerWorld);
+public:
+	BulletWorldBatch(ConfigNode* pConfigNode);
+	virtual ~BulletWorldBatch();
+
+	size_t getNumWorlds() const { return m_worlds.size(); }
+	DynamicModel* getWorld(size_t i) { return m_worlds[i].get(); }
+
+	//DynamicModel interface: s and a hold the variables of all the instances
+	void reset(State *s);
+	void executeAction(State *s, const Action *a, double dt);
+
+	//Batched interface: one state and action per instance, created from the descriptors of getWorld(i)
+	void reset(const std::vector<State*>& s);
+	void executeAction(const std::vector<State*>& s, const std::vector<const Action*>& a, double dt);
+
+	//the reward of the i-th instance for the transition <s,a,s_p> of the batch
+	double getWorldReward(size_t i, const State *s, const Action *a, const State *s_p);
+};
+
+class BulletWorldBatchReward : public IRewardComponent
+{
+	BulletWorldBatch* m_pBatch;
+	size_t m_worldIndex;
+	string m_name;
+public:
+	BulletWorldBatchReward(BulletWorldBatch* pBatch, size_t worldIndex);
+	double getReward(const State *s, const Action *a, const State *s_p);
+	const char* getName() { return m_name.c_str(); }
+	double getMin();
+	double getMax();
+};
@@ -30,4 +30,6 @@ public:
 
 	void reset(State *s);
 	void executeAction(State *s, const Action *a, double dt);
+
+	BulletPhysics* getBulletPhysics() { return m_pBulletPhysics; }
 };
@@ -14,6 +14,7 @@
 #include "double-pendulum.h"
 #include "raincar.h"
 #include "FAST.h"
+#include "BulletWorldBatch.h"
 #include "../reward.h"
 #include "../config.h"
 #include "../app.h"
@@ -208,7 +209,8 @@ std::shared_ptr<DynamicModel> DynamicModel::getInstance(ConfigNode* pConfigNode)
 		{make_tuple("Mountain-car",CHOICE_ELEMENT_NEW<MountainCar>,"World=Mountain-car") },
 		{make_tuple("Swing-up-pendulum",CHOICE_ELEMENT_NEW<SwingupPendulum>,"World=Swing-up-pendulum") },
 		{make_tuple("Double-pendulum",CHOICE_ELEMENT_NEW<DoublePendulum>,"World=Double-pendulum") },
-		{make_tuple("Rain-car",CHOICE_ELEMENT_NEW<RainCar>,"World=Rain-car") }
+		{make_tuple("Rain-car",CHOICE_ELEMENT_NEW<RainCar>,"World=Rain-car") },
+		{make_tuple("Bullet-World-Batch",CHOICE_ELEMENT_NEW<BulletWorldBatch>,"World=Bullet-World-Batch") }
 	});
 }
 
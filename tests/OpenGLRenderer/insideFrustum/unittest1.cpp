@@ -5,6 +5,26 @@ using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 #include "../../../tools/GeometryLib/frustum.h"
 #include "../../../tools/GeometryLib/matrix44.h"
+#include "../../../tools/OpenGLRenderer/scene-bvh.h"
+#include "../../../tools/OpenGLRenderer/graphic-object-3d.h"
+#include "../../../tools/OpenGLRenderer/bindings.h"
+
+//graphic object without meshes: only its bounding box is given
+class BoxObject : public GraphicObject3D
+{
+public:
+	BoxObject(string name, const BoundingBox3D& box) : GraphicObject3D(name) { m_bb = box; }
+};
+
+void checkVisibleObjects(SceneBVH& bvh, vector<GraphicObject3D*>& objects, Frustum& frustum)
+{
+	vector<bool> visible;
+	bvh.getVisibleObjects(frustum, visible);
+	Assert::AreEqual(objects.size(), visible.size());
+	for (size_t i = 0; i < objects.size(); i++)
+		Assert::AreEqual(frustum.isVisible(objects[i]->hierarchyBoundingBox()), (bool) visible[i]
+			, L"Culling through the BVH differs from testing every object");
+}
 
 
 namespace InsideFrustum
@@ -123,6 +143,67 @@ namespace InsideFrustum
 			frustum.fromCameraMatrix(cameraMatrix);
 			Assert::IsTrue(frustum.isVisible(box));
 		}
+		TEST_METHOD(SceneBVH_CullMovedObjects)
+		{
+			Frustum frustum;
+			Matrix44 projection;
+			projection.setPerspective(1.0, 0.75, 1.0, 10.0);
+			frustum.fromCameraMatrix(projection);
+
+			//a row of unit boxes in front of the camera: only those near the center are visible
+			SceneBVH bvh;
+			vector<GraphicObject3D*> objects;
+			for (int i = 0; i < 20; i++)
+			{
+				double x = -50.0 + 5.0 * i;
+				objects.push_back(new BoxObject("box", BoundingBox3D(Vector3D(x, 0.0, -5.0), Vector3D(x + 1.0, 1.0, -4.0))));
+				bvh.add(objects.back());
+			}
+			//a parent whose child is the only visible part
+			GraphicObject3D* pParent = new BoxObject("parent", BoundingBox3D(Vector3D(-100.0, 0.0, -5.0), Vector3D(-99.0, 1.0, -4.0)));
+			GraphicObject3D* pChild = new BoxObject("child", BoundingBox3D(Vector3D(0.0, 0.0, -5.0), Vector3D(1.0, 1.0, -4.0)));
+			pParent->addChild(pChild);
+			objects.push_back(pParent);
+			bvh.add(pParent);
+
+			Assert::AreEqual(objects.size(), bvh.update(), L"The tree should be built when objects are added");
+			checkVisibleObjects(bvh, objects, frustum);
+			vector<bool> visible;
+			bvh.getVisibleObjects(frustum, visible);
+			Assert::IsTrue(visible[10]);
+			Assert::IsFalse(visible[0]);
+			Assert::IsTrue(visible[20]);
+
+			//nothing moved: no bounding box is calculated
+			Assert::AreEqual((size_t)0, bvh.update());
+
+			//moved with a transform setter
+			objects[0]->getTransform().setTranslation(Vector3D(50.0, 0.0, 0.0));
+			Assert::AreEqual((size_t)1, bvh.update());
+			checkVisibleObjects(bvh, objects, frustum);
+			bvh.getVisibleObjects(frustum, visible);
+			Assert::IsTrue(visible[0], L"An object moved by a transform setter was culled");
+
+			//moved by a binding
+			string internalName = XML_TAG_X;
+			BoundObject<Vector3D> binding(objects[10]->getTransform().translation(), internalName
+				, objects[10]->getTransform().getVersionCounter());
+			binding.update(100.0);
+			Assert::AreEqual((size_t)1, bvh.update());
+			checkVisibleObjects(bvh, objects, frustum);
+			bvh.getVisibleObjects(frustum, visible);
+			Assert::IsFalse(visible[10], L"An object moved by a binding wasn't culled");
+
+			//the child moved next to its parent, out of the view
+			pChild->getTransform().setTranslation(Vector3D(-100.0, 0.0, 0.0));
+			Assert::AreEqual((size_t)1, bvh.update());
+			checkVisibleObjects(bvh, objects, frustum);
+			bvh.getVisibleObjects(frustum, visible);
+			Assert::IsFalse(visible[20], L"An object whose child was moved wasn't culled");
+
+			for (GraphicObject3D* pObject : objects)
+				delete pObject;
+		}
 		TEST_METHOD(Geometry_PointInsideFrustum)
 		{
 			Frustum frustum;
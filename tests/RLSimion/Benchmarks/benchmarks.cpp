@@ -0,0 +1,440 @@
+// benchmarks.cpp : micro-benchmarks of the hot paths of RLSimion
+//
+//Usage: Benchmarks-linux-x64.exe [-iterations=<n>] [-filter=<substring>] [-output=<file.json>]
+//
+//Each benchmark runs a warm-up pass and then times <n> calls with steady_clock. The results are printed as JSON to the
+//standard output (or saved to the output file) so that they can be compared between builds to track regressions
+
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/logger.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../RLSimion/Lib/simgod.h"
+#include "../../../RLSimion/Lib/vfa.h"
+#include "../../../RLSimion/Lib/features.h"
+#include "../../../RLSimion/Lib/featuremap.h"
+#include "../../../RLSimion/Lib/etraces.h"
+#include "../../../RLSimion/Lib/experience-replay.h"
+#include "../../../RLSimion/Lib/worlds/world.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include "../../../tools/System/CrossPlatform.h"
+#include "../../../tools/System/FileUtils.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+struct BenchmarkResult
+{
+	string name;
+	size_t iterations = 0;
+	double seconds = 0.0;
+	string error; //set if the benchmark couldn't be run
+};
+
+vector<BenchmarkResult> g_results;
+size_t g_numIterations = 100000;
+const char* g_pFilter = nullptr;
+
+//results are accumulated here so that the compiler can't optimize the benchmarked calls away
+volatile double g_sink = 0.0;
+
+bool isBenchmarkSelected(const string& name)
+{
+	return !g_pFilter || name.find(g_pFilter) != string::npos;
+}
+
+void runBenchmark(const string& name, size_t iterations, function<void(size_t)> benchmark)
+{
+	if (!isBenchmarkSelected(name))
+		return;
+
+	//warm-up pass: caches, lazy allocations, ...
+	size_t numWarmUpIterations = iterations / 10 + 1;
+	for (size_t i = 0; i < numWarmUpIterations; i++)
+		benchmark(i);
+
+	auto start = chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+		benchmark(i);
+	auto end = chrono::steady_clock::now();
+
+	BenchmarkResult result;
+	result.name = name;
+	result.iterations = iterations;
+	result.seconds = chrono::duration<double>(end - start).count();
+	g_results.push_back(result);
+}
+
+void addFailedBenchmark(const string& name, const char* error)
+{
+	if (!isBenchmarkSelected(name))
+		return;
+
+	BenchmarkResult result;
+	result.name = name;
+	result.error = error;
+	g_results.push_back(result);
+}
+
+string escapeJSON(const string& text)
+{
+	string escaped;
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\') escaped += '\\';
+		if ((unsigned char)c < 0x20) continue;
+		escaped += c;
+	}
+	return escaped;
+}
+
+void saveResults(FILE* pFile)
+{
+	fprintf(pFile, "{\n  \"iterations\": %zu,\n  \"benchmarks\": [\n", g_numIterations);
+	for (size_t i = 0; i < g_results.size(); i++)
+	{
+		const BenchmarkResult& result = g_results[i];
+		if (result.error.empty())
+			fprintf(pFile, "    { \"name\": \"%s\", \"iterations\": %zu, \"seconds\": %.9f, \"ns-per-op\": %.3f }"
+				, escapeJSON(result.name).c_str(), result.iterations, result.seconds
+				, result.seconds * 1e9 / (double)result.iterations);
+		else
+			fprintf(pFile, "    { \"name\": \"%s\", \"error\": \"%s\" }"
+				, escapeJSON(result.name).c_str(), escapeJSON(result.error).c_str());
+		fprintf(pFile, i + 1 < g_results.size() ? ",\n" : "\n");
+	}
+	fprintf(pFile, "  ]\n}\n");
+}
+
+
+//Minimal experiment used to create a SimionApp. Only training episodes are run and every step is logged
+string getExperimentConfig(const char* worldName, size_t numEpisodes, double episodeLength)
+{
+	char config[2048];
+	CrossPlatform::Sprintf_s(config, 2048,
+		"<RLSimion FileVersion=\"1.0.0.0\"><RLSimion>"
+		"<Log><Log-Freq>0.0</Log-Freq><Log-Eval-Episodes>false</Log-Eval-Episodes>"
+		"<Log-Training-Episodes>true</Log-Training-Episodes><Log-Functions>false</Log-Functions></Log>"
+		"<World><Num-Integration-Steps>4</Num-Integration-Steps><Delta-T>0.01</Delta-T>"
+		"<Dynamic-Model><Model><%s/></Model></Dynamic-Model></World>"
+		"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>%zu</Num-Episodes><Eval-Freq>0</Eval-Freq>"
+		"<Progress-Update-Freq>1000000.0</Progress-Update-Freq><Episode-Length>%f</Episode-Length></Experiment>"
+		"<SimGod><Gamma>0.9</Gamma></SimGod>"
+		"</RLSimion></RLSimion>", worldName, numEpisodes, episodeLength);
+	return string(config);
+}
+
+SimionApp* createApp(ConfigFile& configFile, const string& config)
+{
+	configFile.Parse(config.c_str());
+	if (configFile.Error())
+		throw runtime_error(string("Couldn't parse the benchmark configuration: ") + configFile.getError());
+
+	return new SimionApp((ConfigNode*)configFile.FirstChildElement());
+}
+
+ConfigNode* parseNode(ConfigFile& configFile, const char* xml)
+{
+	configFile.Parse(xml);
+	if (configFile.Error())
+		throw runtime_error(string("Couldn't parse the benchmark configuration: ") + configFile.getError());
+	return (ConfigNode*)configFile.FirstChildElement();
+}
+
+
+//Samples of a 2-dimensional state space and a 1-dimensional action space shared by the feature map benchmarks
+struct Samples
+{
+	Descriptor stateDescriptor;
+	Descriptor actionDescriptor;
+	size_t hX, hY, hAction;
+	vector<State*> states;
+	vector<Action*> actions;
+	static const size_t numSamples = 1024;
+
+	Samples()
+	{
+		hX = stateDescriptor.addVariable("x", "m", 0.0, 10.0);
+		hY = stateDescriptor.addVariable("y", "m", -5.0, 5.0);
+		hAction = actionDescriptor.addVariable("force", "N", -1.0, 1.0);
+
+		srand(1);
+		for (size_t i = 0; i < numSamples; i++)
+		{
+			State* s = stateDescriptor.getInstance();
+			s->set(hX, 10.0 * (double)rand() / (double)RAND_MAX);
+			s->set(hY, -5.0 + 10.0 * (double)rand() / (double)RAND_MAX);
+			states.push_back(s);
+
+			Action* a = actionDescriptor.getInstance();
+			a->set(hAction, -1.0 + 2.0 * (double)rand() / (double)RAND_MAX);
+			actions.push_back(a);
+		}
+	}
+	~Samples()
+	{
+		for (State* s : states) delete s;
+		for (Action* a : actions) delete a;
+	}
+};
+
+//Feature maps, linear VFAs, eligibility traces and argMax. A SimionApp must exist because LinearVFA::add()
+//and ETraces::update() ask the SimGod and the Experiment about the current time step
+void benchmarkFeatureMapper(Samples& samples, const string& mapperName, function<FeatureMapper*()> createMapper)
+{
+	const size_t numFeaturesPerVariable = 20;
+	shared_ptr<StateFeatureMap> pStateFeatureMap = shared_ptr<StateFeatureMap>(new StateFeatureMap(createMapper()
+		, samples.stateDescriptor, { samples.hX, samples.hY }, numFeaturesPerVariable));
+	shared_ptr<ActionFeatureMap> pActionFeatureMap = shared_ptr<ActionFeatureMap>(new ActionFeatureMap(createMapper()
+		, samples.actionDescriptor, { samples.hAction }, numFeaturesPerVariable));
+
+	MemManager<SimionMemPool>* pMemManager = new MemManager<SimionMemPool>();
+	LinearStateActionVFA* pVFA = new LinearStateActionVFA(pMemManager, pStateFeatureMap, pActionFeatureMap);
+	pVFA->setInitValue(0.0);
+	pVFA->deferredLoadStep();
+	pMemManager->deferredLoadStep();
+
+	FeatureList* pFeatures = new FeatureList("features");
+	vector<FeatureList*> sampleFeatures;
+	for (size_t i = 0; i < Samples::numSamples; i++)
+	{
+		FeatureList* pSampleFeatures = new FeatureList("sample-features");
+		pVFA->getFeatures(samples.states[i], samples.actions[i], pSampleFeatures);
+		sampleFeatures.push_back(pSampleFeatures);
+	}
+
+	runBenchmark("feature-map/" + mapperName + "/state/getFeatures", g_numIterations, [&](size_t i)
+	{
+		pStateFeatureMap->getFeatures(samples.states[i % Samples::numSamples], nullptr, pFeatures);
+		g_sink = g_sink + (double)pFeatures->m_numFeatures;
+	});
+	runBenchmark("feature-map/" + mapperName + "/state-action/getFeatures", g_numIterations, [&](size_t i)
+	{
+		pVFA->getFeatures(samples.states[i % Samples::numSamples], samples.actions[i % Samples::numSamples], pFeatures);
+		g_sink = g_sink + (double)pFeatures->m_numFeatures;
+	});
+	runBenchmark("linear-vfa/" + mapperName + "/get", g_numIterations, [&](size_t i)
+	{
+		g_sink = g_sink + pVFA->get(sampleFeatures[i % Samples::numSamples], false);
+	});
+	runBenchmark("linear-vfa/" + mapperName + "/add", g_numIterations, [&](size_t i)
+	{
+		pVFA->add(sampleFeatures[i % Samples::numSamples], 0.001);
+	});
+	Action* pArgMax = samples.actionDescriptor.getInstance();
+	runBenchmark("linear-vfa/" + mapperName + "/argMax", g_numIterations / 10, [&](size_t i)
+	{
+		pVFA->argMax(samples.states[i % Samples::numSamples], pArgMax);
+		g_sink = g_sink + pArgMax->get((size_t)0);
+	});
+	delete pArgMax;
+
+	ConfigFile tracesConfig;
+	ETraces* pTraces = new ETraces(parseNode(tracesConfig
+		, "<E-Traces><Threshold>0.001</Threshold><Lambda>0.9</Lambda><Replace>true</Replace></E-Traces>"));
+	runBenchmark("etraces/" + mapperName + "/update-add", g_numIterations, [&](size_t i)
+	{
+		pTraces->update(0.9 * pTraces->getLambda());
+		pTraces->addFeatureList(sampleFeatures[i % Samples::numSamples]);
+	});
+	delete pTraces;
+
+	for (FeatureList* pSampleFeatures : sampleFeatures) delete pSampleFeatures;
+	delete pFeatures;
+	delete pVFA;
+	delete pMemManager;
+}
+
+void benchmarkReplayAndNamedVarSets(SimionApp* pApp)
+{
+	State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+	State* s_p = pApp->pWorld->getDynamicModel()->getStateInstance();
+	Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+	pApp->pWorld->reset(s);
+
+	ConfigFile replayConfig;
+	ExperienceReplay* pReplay = new ExperienceReplay(parseNode(replayConfig
+		, "<Experience-Replay><Buffer-Size>10000</Buffer-Size><Update-Batch-Size>32</Update-Batch-Size></Experience-Replay>"));
+	pReplay->deferredLoadStep();
+
+	runBenchmark("experience-replay/addTuple", g_numIterations, [&](size_t i)
+	{
+		pReplay->addTuple(s, a, s_p, (double)i, 1.0);
+	});
+	runBenchmark("experience-replay/getRandomTupleFromBuffer", g_numIterations, [&](size_t i)
+	{
+		g_sink = g_sink + pReplay->getRandomTupleFromBuffer()->r;
+	});
+	delete pReplay;
+
+	const char* pVarName = s->getProperties(s->getNumVars() - 1)->getName();
+	runBenchmark("named-var-set/get-by-name", g_numIterations, [&](size_t i)
+	{
+		g_sink = g_sink + s->get(pVarName);
+	});
+	runBenchmark("named-var-set/get-by-index", g_numIterations, [&](size_t i)
+	{
+		g_sink = g_sink + s->get(i % s->getNumVars());
+	});
+	runBenchmark("named-var-set/set-by-name", g_numIterations, [&](size_t i)
+	{
+		s_p->set(pVarName, (double)(i % 2));
+	});
+	runBenchmark("named-var-set/copy", g_numIterations, [&](size_t i)
+	{
+		s_p->copy(s);
+	});
+
+	delete s;
+	delete s_p;
+	delete a;
+}
+
+//Throughput of the logger: steps are logged with the state of a world that is never simulated
+void benchmarkLogger(SimionApp* pApp)
+{
+	State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+	State* s_p = pApp->pWorld->getDynamicModel()->getStateInstance();
+	Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+	pApp->pWorld->reset(s);
+	s_p->copy(s);
+
+	size_t numSteps = 0;
+	runBenchmark("logger/timestep", 1, [&](size_t i)
+	{
+		numSteps = 0;
+		for (pApp->pExperiment->nextEpisode(); pApp->pExperiment->isValidEpisode(); pApp->pExperiment->nextEpisode())
+		{
+			for (pApp->pExperiment->nextStep(); pApp->pExperiment->isValidStep(); pApp->pExperiment->nextStep())
+			{
+				pApp->pExperiment->timestep(s, a, s_p, pApp->pWorld->getRewardVector());
+				numSteps++;
+			}
+		}
+	});
+	//the whole experiment is a single iteration, so we report the time per logged step
+	if (!g_results.empty() && g_results.back().name == "logger/timestep")
+		g_results.back().iterations = numSteps;
+
+	delete s;
+	delete s_p;
+	delete a;
+}
+
+void benchmarkWorld(const char* worldName)
+{
+	string name = string("world/") + worldName + "/executeAction";
+	if (!isBenchmarkSelected(name))
+		return;
+
+	ConfigFile configFile;
+	SimionApp* pApp = nullptr;
+	try
+	{
+		pApp = createApp(configFile, getExperimentConfig(worldName, 1, 10.0));
+		State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+		State* s_p = pApp->pWorld->getDynamicModel()->getStateInstance();
+		Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+		pApp->pWorld->reset(s);
+
+		//the world is reset every 1000 steps so that it doesn't stay in a terminal state
+		runBenchmark(name, g_numIterations / 10, [&](size_t i)
+		{
+			if (i % 1000 == 0)
+				pApp->pWorld->reset(s);
+			g_sink = g_sink + pApp->pWorld->executeAction(s, a, s_p);
+			s->copy(s_p);
+		});
+
+		delete s;
+		delete s_p;
+		delete a;
+	}
+	catch (std::exception& e)
+	{
+		addFailedBenchmark(name, e.what());
+	}
+	if (pApp) delete pApp;
+}
+
+
+int main(int argc, char* argv[])
+{
+	const char* pIterations = SimionApp::getArgValue(argc, argv, "iterations");
+	if (pIterations && atoi(pIterations) > 0)
+		g_numIterations = (size_t)atoi(pIterations);
+	g_pFilter = SimionApp::getArgValue(argc, argv, "filter");
+	const char* pOutputFile = SimionApp::getArgValue(argc, argv, "output");
+
+	//the results are printed to the standard output, so we don't want any other message there
+	Logger::enableLogMessages(false);
+
+	try
+	{
+		//the log files of the logger benchmark are saved in the current directory and removed afterwards
+		const string configFileName = "benchmark.simion.exp";
+		ConfigFile configFile;
+		//the logger benchmark logs 10 episodes with iterations/10 steps in total (Delta-T=0.01)
+		const size_t numLoggedEpisodes = 10;
+		double episodeLength = 0.01 * (double)(g_numIterations / 10 / numLoggedEpisodes + 1);
+		SimionApp* pApp = createApp(configFile, getExperimentConfig("Swing-up-pendulum", numLoggedEpisodes, episodeLength));
+		pApp->setConfigFile(configFileName);
+
+		{
+			Samples samples;
+			//ETraces::update() doesn't update the traces in the first step of an episode
+			pApp->pExperiment->nextEpisode();
+			pApp->pExperiment->nextStep();
+			pApp->pExperiment->nextStep();
+
+			benchmarkFeatureMapper(samples, "gaussian-rbf-grid", []() { return new GaussianRBFGridFeatureMap(); });
+			benchmarkFeatureMapper(samples, "tile-coding", []() { return new TileCodingFeatureMap(5, 0.05); });
+			benchmarkFeatureMapper(samples, "discrete-grid", []() { return new DiscreteFeatureMap(); });
+		}
+		benchmarkReplayAndNamedVarSets(pApp);
+
+		pApp->pExperiment->reset();
+		benchmarkLogger(pApp);
+		delete pApp;
+
+		string logFiles = removeExtension(configFileName);
+		remove((logFiles + ".log").c_str());
+		remove((logFiles + ".log.bin").c_str());
+
+		//FAST-Wind-turbine is not included because it requires an external simulator
+		const char* worldNames[] = { "Wind-turbine", "Underwater-vehicle", "Pitch-control", "Balancing-pole"
+			, "Push-Box-1", "Push-Box-2", "Pull-Box-1", "Pull-Box-2", "Robot-control", "Mountain-car"
+			, "Swing-up-pendulum", "Double-pendulum", "Rain-car" };
+		for (const char* worldName : worldNames)
+			benchmarkWorld(worldName);
+	}
+	catch (std::exception& e)
+	{
+		fprintf(stderr, "Benchmarks failed: %s\n", e.what());
+		return 1;
+	}
+
+	if (pOutputFile)
+	{
+		FILE* pFile;
+		CrossPlatform::Fopen_s(&pFile, pOutputFile, "w");
+		if (!pFile)
+		{
+			fprintf(stderr, "Couldn't open the output file: %s\n", pOutputFile);
+			return 1;
+		}
+		saveResults(pFile);
+		fclose(pFile);
+	}
+	else
+		saveResults(stdout);
+	return 0;
+}
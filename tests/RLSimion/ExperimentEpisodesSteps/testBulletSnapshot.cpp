@@ -0,0 +1,150 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/worlds/pull-box-2.h"
+#include "../../../RLSimion/Lib/worlds/BulletPhysics.h"
+#include "../../../RLSimion/Lib/worlds/BulletSnapshot.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include <vector>
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ExperimentEpisodesSteps
+{
+	TEST_CLASS(BulletSnapshotTest)
+	{
+		//These tests check that a Bullet world is restored from a snapshot. Pull-Box-2 is used because it has both rigid
+		//bodies (robots, box, target, walls) and soft bodies (the ropes)
+
+		//transforms and velocities of every body, and positions and velocities of the nodes of the ropes
+		vector<double> getBulletState(PullBox2& world)
+		{
+			vector<double> values;
+			btDiscreteDynamicsWorld* pWorld = world.getBulletPhysics()->getDynamicsWorld();
+			btCollisionObjectArray& objects = pWorld->getCollisionObjectArray();
+			for (int i = 0; i < objects.size(); i++)
+			{
+				const btTransform& transform = objects[i]->getWorldTransform();
+				btQuaternion rotation = transform.getRotation();
+				values.insert(values.end(), { transform.getOrigin().x(), transform.getOrigin().y(), transform.getOrigin().z()
+					, rotation.x(), rotation.y(), rotation.z(), rotation.w() });
+				btRigidBody* pBody = btRigidBody::upcast(objects[i]);
+				if (pBody)
+				{
+					values.insert(values.end(), { pBody->getLinearVelocity().x(), pBody->getLinearVelocity().y()
+						, pBody->getLinearVelocity().z(), pBody->getAngularVelocity().x(), pBody->getAngularVelocity().y()
+						, pBody->getAngularVelocity().z() });
+				}
+			}
+			for (btSoftBody* pRope : *world.getBulletPhysics()->getSoftBodiesArray())
+			{
+				for (int i = 0; i < pRope->m_nodes.size(); i++)
+				{
+					const btSoftBody::Node& node = pRope->m_nodes[i];
+					values.insert(values.end(), { node.m_x.x(), node.m_x.y(), node.m_x.z(), node.m_v.x(), node.m_v.y(), node.m_v.z() });
+				}
+			}
+			return values;
+		}
+
+		vector<double> getValues(const NamedVarSet* pVarSet)
+		{
+			vector<double> values;
+			for (size_t i = 0; i < pVarSet->getNumVars(); i++)
+				values.push_back(pVarSet->get(i));
+			return values;
+		}
+
+		void checkEqual(const vector<double>& expected, const vector<double>& actual, const wchar_t* message)
+		{
+			Assert::AreEqual(expected.size(), actual.size(), message);
+			for (size_t i = 0; i < expected.size(); i++)
+				Assert::AreEqual(expected[i], actual[i], 0.0000001, message);
+		}
+
+		bool areEqual(const vector<double>& a, const vector<double>& b)
+		{
+			for (size_t i = 0; i < a.size(); i++)
+				if (fabs(a[i] - b[i]) > 0.0000001) return false;
+			return true;
+		}
+
+		void run(PullBox2& world, State* s, const Action* a, int numSteps)
+		{
+			for (int i = 0; i < numSteps; i++)
+				world.executeAction(s, a, 0.05);
+		}
+
+		Action* createAction(PullBox2& world)
+		{
+			Action* a = world.getActionInstance();
+			a->set("robot1-v", 1.0);
+			a->set("robot1-omega", 0.5);
+			a->set("robot2-v", -1.0);
+			a->set("robot2-omega", -0.5);
+			return a;
+		}
+	public:
+
+		TEST_METHOD(BulletSnapshot_Reset)
+		{
+			PullBox2 world(nullptr);
+			State* s = world.getStateInstance();
+			Action* a = createAction(world);
+
+			world.reset(s);
+			vector<double> initialState = getValues(s);
+			vector<double> initialBulletState = getBulletState(world);
+
+			run(world, s, a, 20);
+			Assert::IsFalse(areEqual(initialBulletState, getBulletState(world)), L"The world didn't move");
+
+			//the second reset restores the snapshot taken in the first one
+			world.reset(s);
+			checkEqual(initialState, getValues(s), L"The state variables weren't restored by reset()");
+			checkEqual(initialBulletState, getBulletState(world), L"The bodies and ropes weren't restored by reset()");
+
+			//and so does any other
+			run(world, s, a, 35);
+			world.reset(s);
+			checkEqual(initialState, getValues(s), L"The state variables weren't restored by reset()");
+			checkEqual(initialBulletState, getBulletState(world), L"The bodies and ropes weren't restored by reset()");
+
+			delete s;
+			delete a;
+		}
+
+		TEST_METHOD(BulletSnapshot_RestoreInOtherWorld)
+		{
+			PullBox2 world(nullptr), otherWorld(nullptr);
+			State* s = world.getStateInstance();
+			State* otherS = otherWorld.getStateInstance();
+			Action* a = createAction(world);
+
+			world.reset(s);
+			otherWorld.reset(otherS);
+			run(world, s, a, 20);
+
+			//fork the state of the first world into the second one
+			BulletSnapshot snapshot;
+			world.getBulletPhysics()->saveSnapshot(snapshot);
+			Assert::IsFalse(snapshot.isEmpty(), L"The snapshot is empty");
+			vector<double> forkedBulletState = getBulletState(world);
+			Assert::IsFalse(areEqual(forkedBulletState, getBulletState(otherWorld)), L"The worlds are equal before restoring the snapshot");
+
+			otherWorld.getBulletPhysics()->restoreSnapshot(snapshot);
+			checkEqual(forkedBulletState, getBulletState(otherWorld), L"The snapshot wasn't restored in the other world");
+			//the first world is left untouched
+			checkEqual(forkedBulletState, getBulletState(world), L"Saving a snapshot modified the world");
+
+			//the snapshot can be restored again after the first world has moved on
+			run(world, s, a, 10);
+			world.getBulletPhysics()->restoreSnapshot(snapshot);
+			checkEqual(forkedBulletState, getBulletState(world), L"The snapshot wasn't restored in the world it was taken from");
+
+			delete s;
+			delete otherS;
+			delete a;
+		}
+	};
+}
@@ -0,0 +1,111 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/worlds/BulletWorldBatch.h"
+#include "../../../RLSimion/Lib/worlds/pull-box-2.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include <vector>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ExperimentEpisodesSteps
+{
+	TEST_CLASS(BulletWorldBatchTest)
+	{
+		//These tests check that stepping the instances of a batch in parallel gives the same result as stepping as many
+		//independent worlds one after another. Pull-Box-2 is used because it has both rigid and soft bodies
+
+		static const int numWorlds = 3;
+		static const int numSteps = 30;
+
+		//a different action for each instance, changing every few steps
+		void setAction(Action* a, const char* suffix, int world, int step)
+		{
+			double sign = (step / 10) % 2 == 0 ? 1.0 : -1.0;
+			a->set((string("robot1-v") + suffix).c_str(), sign * (0.5 + 0.5 * world));
+			a->set((string("robot1-omega") + suffix).c_str(), 0.2 * world);
+			a->set((string("robot2-v") + suffix).c_str(), -sign * 0.25 * world);
+			a->set((string("robot2-omega") + suffix).c_str(), -0.3);
+		}
+
+		void checkSameState(BulletWorldBatch& batch, const State* batchState, int world, const State* worldState
+			, const wchar_t* message)
+		{
+			for (size_t var = 0; var < worldState->getNumVars(); var++)
+			{
+				string batchVarName = string(worldState->getProperties(var)->getName()) + "-" + to_string(world);
+				Assert::AreEqual(worldState->get(var), batchState->get(batchVarName.c_str()), 0.0000001, message);
+			}
+		}
+	public:
+
+		TEST_METHOD(BulletWorldBatch_SameAsSingleWorlds)
+		{
+			ConfigFile configFile;
+			configFile.Parse("<Model><Num-Worlds>3</Num-Worlds><Num-Threads>2</Num-Threads>"
+				"<Bullet-World><Pull-Box-2/></Bullet-World></Model>");
+			BulletWorldBatch batch((ConfigNode*)configFile.FirstChildElement());
+			Assert::AreEqual((size_t)numWorlds, batch.getNumWorlds(), L"Wrong number of worlds in the batch");
+
+			State* s = batch.getStateInstance();
+			State* s_p = batch.getStateInstance();
+			Action* a = batch.getActionInstance();
+
+			vector<PullBox2*> worlds;
+			vector<State*> worldS, worldS_p;
+			vector<Action*> worldA;
+			for (int i = 0; i < numWorlds; i++)
+			{
+				worlds.push_back(new PullBox2(nullptr));
+				worldS.push_back(worlds[i]->getStateInstance());
+				worldS_p.push_back(worlds[i]->getStateInstance());
+				worldA.push_back(worlds[i]->getActionInstance());
+			}
+
+			//a second episode checks that the instances are also reset like independent worlds
+			for (int episode = 0; episode < 2; episode++)
+			{
+				batch.reset(s);
+				for (int i = 0; i < numWorlds; i++)
+				{
+					worlds[i]->reset(worldS[i]);
+					checkSameState(batch, s, i, worldS[i], L"The instances of the batch weren't reset like single worlds");
+				}
+
+				for (int step = 0; step < numSteps; step++)
+				{
+					for (int i = 0; i < numWorlds; i++)
+					{
+						setAction(a, ("-" + to_string(i)).c_str(), i, step);
+						setAction(worldA[i], "", i, step);
+					}
+
+					s_p->copy(s);
+					batch.executeAction(s_p, a, 0.05);
+					for (int i = 0; i < numWorlds; i++)
+					{
+						worldS_p[i]->copy(worldS[i]);
+						worlds[i]->executeAction(worldS_p[i], worldA[i], 0.05);
+						checkSameState(batch, s_p, i, worldS_p[i], L"The instances of the batch weren't stepped like single worlds");
+						Assert::AreEqual(worlds[i]->getReward(worldS[i], worldA[i], worldS_p[i])
+							, batch.getWorldReward(i, s, a, s_p), 0.0000001, L"The reward of an instance doesn't match the single world's");
+						worldS[i]->copy(worldS_p[i]);
+					}
+					s->copy(s_p);
+				}
+			}
+
+			for (int i = 0; i < numWorlds; i++)
+			{
+				delete worldS[i];
+				delete worldS_p[i];
+				delete worldA[i];
+				delete worlds[i];
+			}
+			delete s;
+			delete s_p;
+			delete a;
+		}
+	};
+}
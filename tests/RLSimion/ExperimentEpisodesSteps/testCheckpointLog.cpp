@@ -0,0 +1,172 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../RLSimion/Lib/logger.h"
+#include "../../../RLSimion/Lib/checkpoint.h"
+#include "../../../RLSimion/Lib/simgod.h"
+#include "../../../RLSimion/Lib/worlds/world.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ExperimentEpisodesSteps
+{
+	TEST_CLASS(CheckpointLogTest)
+	{
+		//These tests check that an experiment resumed from a checkpoint keeps logging to the same log file, as if it
+		//hadn't been interrupted
+
+		//evaluation and training episodes: E T T E T T E. A checkpoint is saved after the third episode and another one after
+		//the sixth
+		const char* config = "<RLSimion FileVersion=\"1.0.0.0\"><RLSimion>"
+			"<Log><Log-Freq>0.0</Log-Freq><Log-Eval-Episodes>true</Log-Eval-Episodes>"
+			"<Log-Training-Episodes>true</Log-Training-Episodes><Log-Functions>false</Log-Functions></Log>"
+			"<World><Num-Integration-Steps>1</Num-Integration-Steps><Delta-T>1.0</Delta-T>"
+			"<Dynamic-Model><Model><Mountain-car/></Model></Dynamic-Model></World>"
+			"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>4</Num-Episodes><Eval-Freq>2</Eval-Freq>"
+			"<Episode-Length>20.0</Episode-Length></Experiment>"
+			"<SimGod><Gamma>0.9</Gamma></SimGod>"
+			"<Checkpoints><Freq>3</Freq><Restore>true</Restore></Checkpoints>"
+			"</RLSimion></RLSimion>";
+
+		//runs the episodes that remain in the experiment. The initial state of each episode only depends on its index, so
+		//every run takes the same actions from the same states. If interruptedEpisode isn't 0, the app stops in the middle
+		//of that episode, as if it had crashed
+		void runExperiment(SimionApp* pApp, unsigned int interruptedEpisode)
+		{
+			State* s = pApp->pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+			State* s_p = pApp->pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionDescriptor().getInstance();
+			Reward* r = pApp->pWorld->getRewardVector();
+			Experiment* pExperiment = pApp->pExperiment.ptr();
+
+			bool bInterrupted = false;
+			for (pExperiment->nextEpisode(); pExperiment->isValidEpisode() && !bInterrupted; pExperiment->nextEpisode())
+			{
+				srand(pExperiment->getEpisodeIndex());
+				pApp->pWorld->reset(s);
+				for (pExperiment->nextStep(); pExperiment->isValidStep(); pExperiment->nextStep())
+				{
+					if (pExperiment->getEpisodeIndex() == interruptedEpisode && pExperiment->getStep() > pExperiment->getNumSteps() / 2)
+					{
+						bInterrupted = true;
+						break;
+					}
+					a->set("pedal", (pExperiment->getStep() + pExperiment->getEpisodeIndex()) % 3 - 1.0);
+					pApp->pWorld->executeAction(s, a, s_p);
+					pExperiment->timestep(s, a, s_p, r);
+					s->copy(s_p);
+				}
+				if (!bInterrupted)
+					pApp->pCheckpoints->episodeFinished();
+			}
+			if (!bInterrupted)
+				pApp->pCheckpoints->experimentFinished();
+
+			delete s;
+			delete s_p;
+			delete a;
+		}
+
+		//reads the episodes in a binary log file: the type and index of each episode followed by the index, the simulation
+		//time and the values of each step. The real time of the steps is left out, because it changes from run to run
+		vector<vector<double>> readLog(const char* filename)
+		{
+			vector<vector<double>> episodes;
+			FILE* pFile = fopen(filename, "rb");
+			Assert::IsTrue(pFile != nullptr, L"The log file wasn't found");
+
+			ExperimentHeader experimentHeader;
+			Assert::AreEqual((size_t)1, fread(&experimentHeader, sizeof(ExperimentHeader), 1, pFile), L"The log file has no header");
+			Assert::AreEqual((long long)EXPERIMENT_HEADER, experimentHeader.magicNumber, L"Wrong experiment header");
+			Assert::AreEqual(7LL, experimentHeader.numEpisodes, L"Wrong number of episodes in the experiment header");
+
+			EpisodeHeader episodeHeader;
+			while (fread(&episodeHeader, sizeof(EpisodeHeader), 1, pFile) == 1)
+			{
+				Assert::AreEqual((long long)EPISODE_HEADER, episodeHeader.magicNumber, L"Wrong episode header");
+				episodes.push_back({ (double)episodeHeader.episodeType, (double)episodeHeader.episodeIndex });
+
+				StepHeader stepHeader;
+				vector<double> values((size_t)episodeHeader.numVariablesLogged);
+				while (fread(&stepHeader, sizeof(StepHeader), 1, pFile) == 1 && stepHeader.magicNumber == STEP_HEADER)
+				{
+					Assert::AreEqual(values.size(), fread(values.data(), sizeof(double), values.size(), pFile), L"Incomplete step in the log file");
+					episodes.back().push_back((double)stepHeader.stepIndex);
+					episodes.back().push_back(stepHeader.episodeSimTime);
+					episodes.back().insert(episodes.back().end(), values.begin(), values.end());
+				}
+				Assert::AreEqual((long long)EPISODE_END_HEADER, stepHeader.magicNumber, L"An episode wasn't finished in the log file");
+			}
+			Assert::IsTrue(feof(pFile) != 0, L"Unexpected data at the end of the log file");
+			fclose(pFile);
+			return episodes;
+		}
+
+	public:
+
+		TEST_METHOD(Checkpoint_ResumedLog)
+		{
+			//checkpoints left by a previous run of this test would be restored
+			remove("./checkpoint-log-test.checkpoint.0");
+			remove("./checkpoint-log-test.checkpoint.1");
+
+			//the log of the experiment run without interruptions
+			ConfigFile referenceConfigFile;
+			referenceConfigFile.Parse(config);
+			SimionApp* pApp = new SimionApp((ConfigNode*)referenceConfigFile.FirstChildElement());
+			pApp->setConfigFile("./checkpoint-log-reference.simion");
+			pApp->pSimGod->deferredLoad();
+			Assert::IsFalse(pApp->pCheckpoints->restore(), L"A checkpoint was restored in a new experiment");
+			runExperiment(pApp, 0);
+			delete pApp;
+
+			//the experiment crashes in the fifth episode, after the checkpoint saved at the end of the third one
+			ConfigFile configFile;
+			configFile.Parse(config);
+			pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+			pApp->setConfigFile("./checkpoint-log-test.simion");
+			pApp->pSimGod->deferredLoad();
+			Assert::IsFalse(pApp->pCheckpoints->restore(), L"A checkpoint was restored in a new experiment");
+			runExperiment(pApp, 5);
+			delete pApp;
+
+			//and it is resumed by a new app
+			ConfigFile resumedConfigFile;
+			resumedConfigFile.Parse(config);
+			pApp = new SimionApp((ConfigNode*)resumedConfigFile.FirstChildElement());
+			pApp->setConfigFile("./checkpoint-log-test.simion");
+			pApp->pSimGod->deferredLoad();
+			Assert::IsTrue(pApp->pCheckpoints->restore(), L"The checkpoint wasn't restored");
+			Assert::AreEqual(3u, pApp->pExperiment->getEpisodeIndex(), L"The experiment wasn't resumed after the checkpoint");
+			runExperiment(pApp, 0);
+			delete pApp;
+
+			//the episode interrupted is replaced in the log by the one run after resuming the experiment
+			vector<vector<double>> referenceEpisodes = readLog("./checkpoint-log-reference.log.bin");
+			vector<vector<double>> episodes = readLog("./checkpoint-log-test.log.bin");
+			Assert::AreEqual((size_t)7, referenceEpisodes.size(), L"Wrong number of episodes logged");
+			Assert::AreEqual(referenceEpisodes.size(), episodes.size(), L"Wrong number of episodes logged by the resumed experiment");
+			for (size_t episode = 0; episode < episodes.size(); episode++)
+			{
+				Assert::IsTrue(referenceEpisodes[episode] == episodes[episode]
+					, L"The episodes logged by the resumed experiment don't match the experiment run without interruptions");
+			}
+
+			//the descriptor of the log file is still there
+			FILE* pDescriptor = fopen("./checkpoint-log-test.log", "r");
+			Assert::IsTrue(pDescriptor != nullptr, L"The log descriptor of the resumed experiment wasn't found");
+			if (pDescriptor) fclose(pDescriptor);
+
+			remove("./checkpoint-log-reference.log");
+			remove("./checkpoint-log-reference.log.bin");
+			remove("./checkpoint-log-test.log");
+			remove("./checkpoint-log-test.log.bin");
+		}
+	};
+}
@@ -0,0 +1,222 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../RLSimion/Lib/logger.h"
+#include "../../../RLSimion/Lib/evaluation-workers.h"
+#include "../../../RLSimion/Lib/worlds/world.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ExperimentEpisodesSteps
+{
+	TEST_CLASS(EvaluationWorkersTest)
+	{
+		//These tests check that the episodes run by evaluation workers are logged as if they had been run serially and
+		//that the errors of the workers reach the experiment
+
+		//type, index and sub-index of an episode
+		struct LoggedEpisode
+		{
+			long long type, index, subIndex;
+			size_t numSteps;
+		};
+
+		SimionApp* createApp(int numWorkers)
+		{
+			char config[2048];
+			sprintf(config, "<RLSimion FileVersion=\"1.0.0.0\"><RLSimion>"
+				"<Log><Log-Freq>0.0</Log-Freq><Log-Eval-Episodes>true</Log-Eval-Episodes>"
+				"<Log-Training-Episodes>true</Log-Training-Episodes><Log-Functions>false</Log-Functions></Log>"
+				"<World><Num-Integration-Steps>1</Num-Integration-Steps><Delta-T>0.01</Delta-T>"
+				"<Dynamic-Model><Model><Mountain-car/></Model></Dynamic-Model></World>"
+				"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>4</Num-Episodes><Eval-Freq>2</Eval-Freq>"
+				"<Episode-Length>0.1</Episode-Length></Experiment>"
+				"<SimGod><Gamma>0.9</Gamma></SimGod>"
+				"<Evaluation-Workers><Num-Workers>%d</Num-Workers></Evaluation-Workers>"
+				"</RLSimion></RLSimion>", numWorkers);
+			m_configFile.Parse(config);
+			SimionApp* pApp = new SimionApp((ConfigNode*)m_configFile.FirstChildElement());
+			pApp->setConfigFile("./evaluation-workers-test.simion");
+			return pApp;
+		}
+
+		//the main loop of SimionApp::run(). Evaluation episodes are run by the workers
+		void runExperiment(SimionApp* pApp, const function<void()>& beforeEpisode, vector<LoggedEpisode>& outEpisodes)
+		{
+			State* s = pApp->pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+			State* s_p = pApp->pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionDescriptor().getInstance();
+			Experiment* pExperiment = pApp->pExperiment.ptr();
+
+			auto runEpisode = [&]()
+			{
+				beforeEpisode();
+				pApp->pWorld->reset(s);
+				for (pExperiment->nextStep(); pExperiment->isValidStep(); pExperiment->nextStep())
+				{
+					pApp->pWorld->executeAction(s, a, s_p);
+					pExperiment->timestep(s, a, s_p, pApp->pWorld->getRewardVector());
+					s->copy(s_p);
+				}
+			};
+
+			try
+			{
+				for (pExperiment->nextEpisode(); pExperiment->isValidEpisode(); pExperiment->nextEpisode())
+				{
+					outEpisodes.push_back({ pExperiment->isEvaluationEpisode() ? 0 : 1, (long long)pExperiment->getRelativeEpisodeIndex()
+						, pExperiment->isEvaluationEpisode() ? (long long)pExperiment->getEpisodeInEvaluationIndex() : 1, 0 });
+					if (pExperiment->isEvaluationEpisode())
+						pApp->pEvaluationWorkers->runEpisode(runEpisode);
+					else
+						runEpisode();
+					pApp->pEvaluationWorkers->update();
+				}
+				pApp->pEvaluationWorkers->waitAll();
+			}
+			catch (...)
+			{
+				delete s;
+				delete s_p;
+				delete a;
+				throw;
+			}
+			delete s;
+			delete s_p;
+			delete a;
+		}
+
+		vector<LoggedEpisode> readLoggedEpisodes(const char* filename)
+		{
+			vector<LoggedEpisode> episodes;
+			FILE* pFile = fopen(filename, "rb");
+			Assert::IsTrue(pFile != nullptr, L"The log file wasn't written");
+
+			ExperimentHeader experimentHeader;
+			Assert::AreEqual((size_t)1, fread(&experimentHeader, sizeof(ExperimentHeader), 1, pFile), L"The log is empty");
+			EpisodeHeader episodeHeader;
+			while (fread(&episodeHeader, sizeof(EpisodeHeader), 1, pFile) == 1)
+			{
+				Assert::AreEqual((long long)EPISODE_HEADER, episodeHeader.magicNumber, L"Wrong episode header");
+				LoggedEpisode episode = { episodeHeader.episodeType, episodeHeader.episodeIndex, episodeHeader.episodeSubIndex, 0 };
+				vector<double> values((size_t)episodeHeader.numVariablesLogged);
+				StepHeader stepHeader;
+				while (fread(&stepHeader, sizeof(StepHeader), 1, pFile) == 1 && stepHeader.magicNumber == STEP_HEADER)
+				{
+					Assert::AreEqual(values.size(), fread(values.data(), sizeof(double), values.size(), pFile), L"Truncated step");
+					episode.numSteps++;
+				}
+				Assert::AreEqual((long long)EPISODE_END_HEADER, stepHeader.magicNumber, L"Episode not ended");
+				episodes.push_back(episode);
+			}
+			fclose(pFile);
+			return episodes;
+		}
+
+		void removeLogFiles()
+		{
+			remove("./evaluation-workers-test.log");
+			remove("./evaluation-workers-test.log.bin");
+		}
+
+		ConfigFile m_configFile;
+	public:
+
+		TEST_METHOD(EvaluationWorkers_EpisodeOrder)
+		{
+			SimionApp* pApp = createApp(2);
+			Experiment* pExperiment = pApp->pExperiment.ptr();
+
+			//the first evaluation takes longer, so the next one finishes first
+			vector<LoggedEpisode> expectedEpisodes;
+			runExperiment(pApp, [pExperiment]()
+			{
+				if (pExperiment->isEvaluationEpisode() && pExperiment->getEvaluationIndex() == 1)
+					std::this_thread::sleep_for(std::chrono::milliseconds(500));
+			}, expectedEpisodes);
+			size_t numSteps = pExperiment->getNumSteps();
+			//the log file is closed
+			delete pApp;
+
+			vector<LoggedEpisode> loggedEpisodes = readLoggedEpisodes("./evaluation-workers-test.log.bin");
+			Assert::AreEqual((size_t)7, expectedEpisodes.size(), L"Unexpected number of episodes run");
+			Assert::AreEqual(expectedEpisodes.size(), loggedEpisodes.size(), L"Every episode must be logged once");
+			for (size_t i = 0; i < loggedEpisodes.size(); i++)
+			{
+				Assert::AreEqual(expectedEpisodes[i].type, loggedEpisodes[i].type, L"Episodes weren't logged in order");
+				Assert::AreEqual(expectedEpisodes[i].index, loggedEpisodes[i].index, L"Episodes weren't logged in order");
+				Assert::AreEqual(expectedEpisodes[i].subIndex, loggedEpisodes[i].subIndex, L"Episodes weren't logged in order");
+				Assert::AreEqual(numSteps, loggedEpisodes[i].numSteps, L"Not all the steps of the episode were logged");
+			}
+			removeLogFiles();
+		}
+
+		TEST_METHOD(EvaluationWorkers_WorkerError)
+		{
+			SimionApp* pApp = createApp(2);
+			Experiment* pExperiment = pApp->pExperiment.ptr();
+			vector<LoggedEpisode> episodes;
+
+			//errors thrown while a worker runs an episode are thrown again by the experiment
+			bool bThrown = false;
+			try
+			{
+				runExperiment(pApp, [pExperiment]()
+				{
+					if (pExperiment->isEvaluationEpisode() && pExperiment->getEvaluationIndex() == 2)
+						throw std::runtime_error("Evaluation episode failed");
+				}, episodes);
+			}
+			catch (std::exception& e)
+			{
+				bThrown = true;
+				Assert::AreEqual(string("Evaluation episode failed"), string(e.what()), L"The error of the worker wasn't propagated");
+			}
+			Assert::IsTrue(bThrown, L"The error of the worker wasn't propagated");
+			//the remaining workers are stopped
+			delete pApp;
+			removeLogFiles();
+		}
+
+#ifdef __linux__
+		TEST_METHOD(EvaluationWorkers_WorkerCrash)
+		{
+			SimionApp* pApp = createApp(2);
+			Experiment* pExperiment = pApp->pExperiment.ptr();
+			vector<LoggedEpisode> episodes;
+
+			//a worker that exits without saving its results
+			bool bThrown = false;
+			try
+			{
+				runExperiment(pApp, [pExperiment]()
+				{
+					if (pExperiment->isEvaluationEpisode() && pExperiment->getEvaluationIndex() == 2)
+						_exit(EXIT_FAILURE);
+				}, episodes);
+			}
+			catch (std::exception& e)
+			{
+				bThrown = true;
+				Assert::AreEqual(string("Evaluation worker: the process running the episode failed"), string(e.what())
+					, L"The failure of the worker wasn't reported");
+			}
+			Assert::IsTrue(bThrown, L"The failure of the worker wasn't reported");
+			delete pApp;
+			removeLogFiles();
+		}
+#endif
+	};
+}
@@ -0,0 +1,135 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../RLSimion/Lib/log-replay.h"
+#include "../../../RLSimion/Lib/worlds/world.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include <vector>
+#include <cstdio>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ExperimentEpisodesSteps
+{
+	TEST_CLASS(LogReplayTest)
+	{
+		//These tests check that the tuples logged by Logger are replayed by LogReplay
+		void appendValues(const NamedVarSet* pVarSet, vector<double>& values)
+		{
+			for (size_t i = 0; i < pVarSet->getNumVars(); i++)
+				values.push_back(pVarSet->get(i));
+		}
+
+		void checkValues(const vector<double>& expected, size_t& next, const NamedVarSet* pVarSet, const wchar_t* message)
+		{
+			for (size_t i = 0; i < pVarSet->getNumVars(); i++)
+				Assert::AreEqual(expected[next++], pVarSet->get(i), 0.0000001, message);
+		}
+	public:
+
+		TEST_METHOD(LogReplay_LoggedEpisodes)
+		{
+			//run a short experiment logging every step
+			ConfigFile logConfigFile;
+			logConfigFile.Parse("<RLSimion FileVersion=\"1.0.0.0\"><RLSimion>"
+				"<Log><Log-Freq>0.0</Log-Freq><Log-Eval-Episodes>true</Log-Eval-Episodes>"
+				"<Log-Training-Episodes>true</Log-Training-Episodes><Log-Functions>false</Log-Functions></Log>"
+				"<World><Num-Integration-Steps>1</Num-Integration-Steps><Delta-T>0.01</Delta-T>"
+				"<Dynamic-Model><Model><Mountain-car/></Model></Dynamic-Model></World>"
+				"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>2</Num-Episodes><Eval-Freq>0</Eval-Freq>"
+				"<Episode-Length>0.1</Episode-Length></Experiment>"
+				"<SimGod><Gamma>0.9</Gamma></SimGod>"
+				"</RLSimion></RLSimion>");
+			SimionApp* pApp = new SimionApp((ConfigNode*)logConfigFile.FirstChildElement());
+			pApp->setConfigFile("./log-replay-test.simion");
+
+			State* s = pApp->pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+			State* s_p = pApp->pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionDescriptor().getInstance();
+			Reward* r = pApp->pWorld->getRewardVector();
+
+			//<a, s', r> of every step of each episode
+			vector<vector<double>> loggedTuples;
+			for (pApp->pExperiment->nextEpisode(); pApp->pExperiment->isValidEpisode(); pApp->pExperiment->nextEpisode())
+			{
+				loggedTuples.push_back(vector<double>());
+				pApp->pWorld->reset(s);
+				for (pApp->pExperiment->nextStep(); pApp->pExperiment->isValidStep(); pApp->pExperiment->nextStep())
+				{
+					//a different action each step
+					a->set((size_t)0, a->getProperties((size_t)0)->getMin()
+						+ a->getProperties((size_t)0)->getRangeWidth() * (double)(pApp->pExperiment->getStep() % 7) / 6.0);
+					pApp->pWorld->executeAction(s, a, s_p);
+					pApp->pExperiment->timestep(s, a, s_p, r);
+
+					appendValues(a, loggedTuples.back());
+					appendValues(s_p, loggedTuples.back());
+					appendValues(r, loggedTuples.back());
+					s->copy(s_p);
+				}
+			}
+			size_t numEpisodes = loggedTuples.size();
+			Assert::IsTrue(numEpisodes > 1, L"Fewer episodes than expected were run");
+			size_t tupleSize = a->getNumVars() + s_p->getNumVars() + r->getNumVars();
+			delete s;
+			delete s_p;
+			delete a;
+			//the log file is closed
+			delete pApp;
+
+			//replay the log
+			ConfigFile replayConfigFile;
+			replayConfigFile.Parse("<RLSimion FileVersion=\"1.0.0.0\"><RLSimion>"
+				"<Log><Log-Freq>0.0</Log-Freq><Log-Eval-Episodes>false</Log-Eval-Episodes>"
+				"<Log-Training-Episodes>false</Log-Training-Episodes><Log-Functions>false</Log-Functions></Log>"
+				"<World><Num-Integration-Steps>1</Num-Integration-Steps><Delta-T>0.01</Delta-T>"
+				"<Dynamic-Model><Model><Mountain-car/></Model></Dynamic-Model></World>"
+				"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>2</Num-Episodes><Eval-Freq>0</Eval-Freq>"
+				"<Episode-Length>0.1</Episode-Length></Experiment>"
+				"<SimGod><Gamma>0.9</Gamma></SimGod>"
+				"<Log-Replay><Log-File><Log-File>./log-replay-test.log</Log-File></Log-File></Log-Replay>"
+				"</RLSimion></RLSimion>");
+			pApp = new SimionApp((ConfigNode*)replayConfigFile.FirstChildElement());
+			Assert::IsTrue(pApp->pLogReplay->bUsing(), L"Log-Replay wasn't configured");
+			pApp->pLogReplay->init(pApp->pWorld->getDynamicModel()->getStateDescriptor()
+				, pApp->pWorld->getDynamicModel()->getActionDescriptor(), pApp->pWorld->getRewardVector()->getDescriptor());
+
+			s = pApp->pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+			s_p = pApp->pWorld->getDynamicModel()->getStateDescriptor().getInstance();
+			a = pApp->pWorld->getDynamicModel()->getActionDescriptor().getInstance();
+			r = pApp->pWorld->getRewardVector();
+
+			//the episodes are replayed in order, and started over once all of them have been replayed
+			for (size_t replayedEpisode = 0; replayedEpisode < 2 * numEpisodes; replayedEpisode++)
+			{
+				const vector<double>& tuples = loggedTuples[replayedEpisode % numEpisodes];
+				size_t numSteps = tuples.size() / tupleSize;
+
+				//the episode begins in the first state logged. The initial state isn't logged
+				pApp->pLogReplay->nextEpisode(s);
+				size_t next = a->getNumVars();
+				checkValues(tuples, next, s, L"The first state of the episode wasn't replayed");
+
+				for (size_t step = 1; step < numSteps; step++)
+				{
+					Assert::IsTrue(pApp->pLogReplay->nextStep(a, s_p, r), L"The episode ended before all its steps were replayed");
+					next = step * tupleSize;
+					checkValues(tuples, next, a, L"The logged action wasn't replayed");
+					checkValues(tuples, next, s_p, L"The logged state wasn't replayed");
+					checkValues(tuples, next, r, L"The logged reward wasn't replayed");
+				}
+				Assert::IsFalse(pApp->pLogReplay->nextStep(a, s_p, r), L"More steps than logged were replayed");
+			}
+
+			delete s;
+			delete s_p;
+			delete a;
+			delete pApp;
+
+			remove("./log-replay-test.log");
+			remove("./log-replay-test.log.bin");
+		}
+	};
+}
@@ -0,0 +1,124 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/noise.h"
+#include "../../../RLSimion/Lib/parameters-numeric.h"
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ExperimentEpisodesSteps
+{
+	TEST_CLASS(NoiseTest)
+	{
+		//These tests check the normal samples generated in blocks by NormalSampleBuffer and the noise sources using them
+
+		//more than one block of samples, drawn in calls that don't match the size of the blocks
+		static const size_t numSamples = 1000;
+
+		vector<double> getSamples(NormalSampleBuffer& buffer, size_t numSamples)
+		{
+			vector<double> samples(numSamples);
+			for (size_t i = 0; i < numSamples; i++)
+				samples[i] = buffer.get();
+			return samples;
+		}
+
+		void checkSamplesMatchSample(Noise& batchedNoise, Noise& noise, const wchar_t* message)
+		{
+			vector<double> batchedSamples(numSamples);
+			size_t numDrawn = 0;
+			for (size_t callSize : { 1, 100, 7, 300, 592 })
+			{
+				batchedNoise.getSamples(batchedSamples.data() + numDrawn, callSize);
+				numDrawn += callSize;
+			}
+			Assert::AreEqual(numSamples, numDrawn, L"Wrong number of samples drawn in the test");
+
+			for (size_t i = 0; i < numSamples; i++)
+				Assert::AreEqual(noise.getSample(), batchedSamples[i], 0.000000000001, message);
+		}
+	public:
+
+		TEST_METHOD(NormalSampleBuffer_Seed)
+		{
+			NormalSampleBuffer buffer1(1234), buffer2(1234), buffer3(4321);
+			vector<double> samples1 = getSamples(buffer1, numSamples);
+			Assert::IsTrue(samples1 == getSamples(buffer2, numSamples), L"The samples don't depend only on the seed");
+			Assert::IsFalse(samples1 == getSamples(buffer3, numSamples), L"Different seeds give the same samples");
+
+			//seeding again restarts the sequence, even in the middle of a block
+			buffer1.seed(1234);
+			Assert::IsTrue(samples1 == getSamples(buffer1, numSamples), L"Seeding again doesn't restart the sequence");
+
+			//the block version of get() returns the same sequence
+			vector<double> samples2(numSamples);
+			buffer2.seed(1234);
+			buffer2.get(samples2.data(), 10);
+			buffer2.get(samples2.data() + 10, numSamples - 10);
+			Assert::IsTrue(samples1 == samples2, L"get(pOutput, numSamples) doesn't return the same samples as get()");
+		}
+
+		TEST_METHOD(NormalSampleBuffer_Distribution)
+		{
+			NormalSampleBuffer buffer(1);
+			const size_t numDistributionSamples = 200000;
+			double sum = 0.0, squaredSum = 0.0;
+			for (size_t i = 0; i < numDistributionSamples; i++)
+			{
+				double sample = buffer.get();
+				Assert::IsTrue(std::isfinite(sample), L"Non-finite normal sample");
+				sum += sample;
+				squaredSum += sample * sample;
+			}
+			double mean = sum / numDistributionSamples;
+			Assert::AreEqual(0.0, mean, 0.01, L"The mean of the samples isn't 0");
+			Assert::AreEqual(1.0, squaredSum / numDistributionSamples - mean * mean, 0.02, L"The variance of the samples isn't 1");
+		}
+
+		TEST_METHOD(Noise_GetSamples)
+		{
+			//both sources are seeded with the same value from rand(), so they generate the same samples
+			srand(1);
+			GaussianNoise gaussian1(0.5, 1.0, new ConstantValue(2.0));
+			srand(1);
+			GaussianNoise gaussian2(0.5, 1.0, new ConstantValue(2.0));
+			checkSamplesMatchSample(gaussian1, gaussian2, L"GaussianNoise::getSamples() doesn't match getSample()");
+
+			//the low-pass filter is applied across calls
+			srand(1);
+			GaussianNoise filtered1(0.5, 0.3, new ConstantValue(1.0));
+			srand(1);
+			GaussianNoise filtered2(0.5, 0.3, new ConstantValue(1.0));
+			checkSamplesMatchSample(filtered1, filtered2, L"GaussianNoise::getSamples() doesn't match getSample() with Alpha<1");
+
+			srand(1);
+			OrnsteinUhlenbeckNoise ou1(0.15, 0.2, 0.0, 0.01);
+			srand(1);
+			OrnsteinUhlenbeckNoise ou2(0.15, 0.2, 0.0, 0.01);
+			checkSamplesMatchSample(ou1, ou2, L"OrnsteinUhlenbeckNoise::getSamples() doesn't match getSample()");
+		}
+
+		TEST_METHOD(Noise_PerSourceSeed)
+		{
+			vector<double> samples1(numSamples), samples2(numSamples);
+			srand(7);
+			GaussianNoise noise1(1.0, 1.0, new ConstantValue(1.0));
+			GaussianNoise noise2(1.0, 1.0, new ConstantValue(1.0));
+			noise1.getSamples(samples1.data(), numSamples);
+			noise2.getSamples(samples2.data(), numSamples);
+			Assert::IsFalse(samples1 == samples2, L"Two noise sources generate the same samples");
+
+			//sources created after the same seed is given to rand() repeat their samples, no matter the order they're used in
+			vector<double> repeatedSamples1(numSamples), repeatedSamples2(numSamples);
+			srand(7);
+			GaussianNoise repeatedNoise1(1.0, 1.0, new ConstantValue(1.0));
+			GaussianNoise repeatedNoise2(1.0, 1.0, new ConstantValue(1.0));
+			repeatedNoise2.getSamples(repeatedSamples2.data(), numSamples);
+			repeatedNoise1.getSamples(repeatedSamples1.data(), numSamples);
+			Assert::IsTrue(samples1 == repeatedSamples1, L"The samples of the first source aren't reproducible");
+			Assert::IsTrue(samples2 == repeatedSamples2, L"The samples of the second source aren't reproducible");
+		}
+	};
+}
@@ -196,5 +196,78 @@ namespace VariableCircularity
 				}
 			}
 		}
+
+		TEST_METHOD(FeatureMap_CachedFeatures)
+		{
+			Descriptor stateDescriptor;
+			size_t hX = stateDescriptor.addVariable("x", "m", 0.0, 10.0);
+			size_t hY = stateDescriptor.addVariable("y", "m", 0.0, 10.0);
+
+			State* s = stateDescriptor.getInstance();
+			State* s_p = stateDescriptor.getInstance();
+			const int numFeatures = 10;
+
+			StateFeatureMap rbfGrid = StateFeatureMap(new GaussianRBFGridFeatureMap(), stateDescriptor, { hX, hY }, numFeatures);
+
+			FeatureList* expectedFeatures = new FeatureList("expected");
+			FeatureList* outFeatures = new FeatureList("test");
+
+			s->set(hX, 2.5);
+			s->set(hY, 7.3);
+			rbfGrid.getFeatures(s, nullptr, expectedFeatures);
+			Assert::AreEqual((size_t)0, rbfGrid.getNumCacheHits(), L"A state mapped for the first time can't be cached");
+
+			rbfGrid.getFeatures(s, nullptr, outFeatures);
+			Assert::AreEqual((size_t)1, rbfGrid.getNumCacheHits(), L"A state mapped twice must hit the cache");
+
+			//fill the rest of the cache (4 entries) with other states. The first one must still be cached
+			for (int i = 1; i <= 3; i++)
+			{
+				s_p->set(hX, (double)i);
+				s_p->set(hY, (double)i);
+				rbfGrid.getFeatures(s_p, nullptr, outFeatures);
+			}
+			Assert::AreEqual((size_t)1, rbfGrid.getNumCacheHits(), L"New states can't hit the cache");
+			Assert::AreEqual((size_t)0, rbfGrid.getNumCacheEvictions(), L"No entry should be replaced until the cache is full");
+			rbfGrid.getFeatures(s, nullptr, outFeatures);
+			Assert::AreEqual((size_t)2, rbfGrid.getNumCacheHits(), L"The first state should still be cached");
+
+			//the next new state replaces the oldest entry: the first state
+			s_p->set(hX, 4.0);
+			s_p->set(hY, 4.0);
+			rbfGrid.getFeatures(s_p, nullptr, outFeatures);
+			Assert::AreEqual((size_t)1, rbfGrid.getNumCacheEvictions(), L"The oldest entry should have been replaced");
+			rbfGrid.getFeatures(s, nullptr, outFeatures);
+			Assert::AreEqual((size_t)2, rbfGrid.getNumCacheHits(), L"An evicted state can't hit the cache");
+			Assert::AreEqual((size_t)2, rbfGrid.getNumCacheEvictions(), L"Mapping an evicted state again should replace another entry");
+
+			//map enough different states to replace all the entries of the cache, checking the first state in between
+			for (int i = 0; i < 10; i++)
+			{
+				s_p->set(hX, 0.5 * (double)i);
+				s_p->set(hY, 10.0 - 0.5 * (double)i);
+				rbfGrid.getFeatures(s_p, nullptr, outFeatures);
+
+				rbfGrid.getFeatures(s, nullptr, outFeatures);
+				Assert::AreEqual(expectedFeatures->m_numFeatures, outFeatures->m_numFeatures, L"Cached features don't match");
+				for (size_t f = 0; f < outFeatures->m_numFeatures; f++)
+				{
+					Assert::AreEqual(expectedFeatures->m_pFeatures[f].m_index, outFeatures->m_pFeatures[f].m_index, L"Cached features don't match");
+					Assert::AreEqual(expectedFeatures->m_pFeatures[f].m_factor, outFeatures->m_pFeatures[f].m_factor, 0.0000001, L"Cached features don't match");
+				}
+			}
+
+			//a copy of a state must be mapped to the same features
+			s_p->copy(s);
+			rbfGrid.getFeatures(s_p, nullptr, outFeatures);
+			Assert::AreEqual(expectedFeatures->m_numFeatures, outFeatures->m_numFeatures, L"Features of a copied state don't match");
+			Assert::AreEqual(expectedFeatures->innerProduct(outFeatures), expectedFeatures->innerProduct(expectedFeatures), 0.0000001
+				, L"Features of a copied state don't match");
+
+			delete expectedFeatures;
+			delete outFeatures;
+			delete s;
+			delete s_p;
+		}
 	};
 }
\ No newline at end of file
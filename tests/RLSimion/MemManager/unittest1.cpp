@@ -215,5 +215,147 @@ namespace MemManagerTest
 
 			delete pMemManager;
 		}
+		TEST_METHOD(MemManager_BlockRecycling)
+		{
+			MemManager<SimionMemPool>* pMemManager = new MemManager<SimionMemPool>();
+			IMemBuffer* pBuffer1 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pBuffer1->setInitValue(1.0);
+			IMemBuffer* pBuffer2 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pBuffer2->setInitValue(2.0);
+
+			//only three blocks fit in memory, so blocks are recycled and restored from disk all the time
+			pMemManager->setMaxAllocatedMem(3 * SMALL_BLOCK_SIZE * sizeof(double));
+			pMemManager->init(SMALL_BLOCK_SIZE);
+
+			for (int i = 0; i < SMALL_BUFER_SIZE; i += 2)
+			{
+				(*pBuffer1)[i] = i;
+				(*pBuffer2)[SMALL_BUFER_SIZE - 1 - i] = -i;
+			}
+			for (int pass = 0; pass < 2; ++pass)
+			{
+				for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+				{
+					int j = (i * 37) % SMALL_BUFER_SIZE;
+					Assert::AreEqual(j % 2 == 0 ? (double)j : 1.0, (*pBuffer1)[j]);
+					Assert::AreEqual((SMALL_BUFER_SIZE - 1 - j) % 2 == 0 ? (double)-(SMALL_BUFER_SIZE - 1 - j) : 2.0, (*pBuffer2)[j]);
+				}
+			}
+			Assert::IsTrue(3 * SMALL_BLOCK_SIZE * sizeof(double) >= pMemManager->getTotalAllocatedMem());
+
+			delete pMemManager;
+		}
+		TEST_METHOD(MemManager_Preload)
+		{
+			MemManager<SimionMemPool>* pMemManager = new MemManager<SimionMemPool>();
+			IMemBuffer* pBuffer1 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pBuffer1->setInitValue(1.0);
+			IMemBuffer* pBuffer2 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pBuffer2->setInitValue(2.0);
+			IMemBuffer* pBuffer3 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pMemManager->init(SMALL_BLOCK_SIZE);
+
+			//write some values before preloading: their blocks are already in memory and must not be initialized again
+			(*pBuffer1)[0] = -1.0;
+			(*pBuffer3)[0] = -3.0;
+			pMemManager->preload();
+
+			//all the blocks are in memory, so reading the buffers doesn't allocate anything else
+			size_t preloadedMem = pMemManager->getTotalAllocatedMem();
+			Assert::IsTrue(3 * SMALL_BUFER_SIZE * sizeof(double) <= preloadedMem);
+
+			Assert::AreEqual(-1.0, (*pBuffer1)[0]);
+			Assert::AreEqual(-3.0, (*pBuffer3)[0]);
+			for (int i = 1; i < SMALL_BUFER_SIZE; ++i)
+			{
+				Assert::AreEqual(1.0, (*pBuffer1)[i]);
+				Assert::AreEqual(2.0, (*pBuffer2)[i]);
+			}
+			Assert::AreEqual(preloadedMem, pMemManager->getTotalAllocatedMem());
+
+			delete pMemManager;
+		}
+		TEST_METHOD(MemManager_ReducedPrecision)
+		{
+			MemManager<SimionMemPool>* pMemManager = new MemManager<SimionMemPool>();
+			IMemBuffer* pDoubleBuffer = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pDoubleBuffer->setInitValue(0.5);
+			IMemBuffer* pFloatBuffer = pMemManager->getMemBuffer(SMALL_BUFER_SIZE, WeightPrecision::float32);
+			pFloatBuffer->setInitValue(0.5);
+			IMemBuffer* pHalfBuffer = pMemManager->getMemBuffer(SMALL_BUFER_SIZE, WeightPrecision::float16);
+			pHalfBuffer->setInitValue(0.5);
+			pMemManager->init(SMALL_BLOCK_SIZE);
+
+			//buffers with different precisions can't share a pool
+			Assert::IsTrue(pDoubleBuffer->getMemPool() != pFloatBuffer->getMemPool());
+			Assert::IsTrue(pFloatBuffer->getMemPool() != pHalfBuffer->getMemPool());
+
+			Assert::AreEqual(0.5, pFloatBuffer->get(0));
+			Assert::AreEqual(0.5, pHalfBuffer->get(SMALL_BUFER_SIZE - 1));
+
+			//these values can be represented exactly with 16 bits
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+			{
+				pDoubleBuffer->set(i, -i * 0.25);
+				pFloatBuffer->set(i, -i * 0.25);
+				pHalfBuffer->set(i, -i * 0.25);
+			}
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+			{
+				Assert::AreEqual(-i * 0.25, (*pDoubleBuffer)[i]);
+				Assert::AreEqual(-i * 0.25, pFloatBuffer->get(i));
+				Assert::AreEqual(-i * 0.25, pHalfBuffer->get(i));
+			}
+			//values that can't be represented exactly are rounded
+			pHalfBuffer->set(0, 0.1);
+			Assert::AreEqual(0.1, pHalfBuffer->get(0), 0.0001);
+
+			size_t doubleMem = pDoubleBuffer->getMemPool()->getTotalAllocatedMem();
+			Assert::AreEqual(doubleMem / 2, pFloatBuffer->getMemPool()->getTotalAllocatedMem());
+			Assert::AreEqual(doubleMem / 4, pHalfBuffer->getMemPool()->getTotalAllocatedMem());
+
+			//reduced precision values can't be accessed by reference
+			Assert::ExpectException<std::runtime_error>([&]() { (*pHalfBuffer)[0]; });
+
+			delete pMemManager;
+		}
+		TEST_METHOD(MemManager_Checkpoint)
+		{
+			MemManager<SimionMemPool>* pMemManager = new MemManager<SimionMemPool>();
+			IMemBuffer* pBuffer1 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pBuffer1->setInitValue(1.0);
+			IMemBuffer* pBuffer2 = pMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pBuffer2->setInitValue(2.0);
+			pMemManager->setMaxAllocatedMem(MAX_MEMORY);
+			pMemManager->init(SMALL_BLOCK_SIZE);
+
+			//only the first half is accessed: the rest must be initialized as usual after restoring
+			for (int i = 0; i < SMALL_BUFER_SIZE / 2; ++i)
+			{
+				(*pBuffer1)[i] = i;
+				(*pBuffer2)[i] = -i;
+			}
+			CheckpointWriter writer;
+			pMemManager->saveCheckpoint(writer);
+
+			MemManager<SimionMemPool>* pRestoredMemManager = new MemManager<SimionMemPool>();
+			IMemBuffer* pRestoredBuffer1 = pRestoredMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pRestoredBuffer1->setInitValue(1.0);
+			IMemBuffer* pRestoredBuffer2 = pRestoredMemManager->getMemBuffer(SMALL_BUFER_SIZE);
+			pRestoredBuffer2->setInitValue(2.0);
+			pRestoredMemManager->init(SMALL_BLOCK_SIZE);
+
+			CheckpointReader reader(writer.getBuffer());
+			pRestoredMemManager->loadCheckpoint(reader);
+
+			for (int i = 0; i < SMALL_BUFER_SIZE; ++i)
+			{
+				Assert::AreEqual(i < SMALL_BUFER_SIZE / 2 ? (double)i : 1.0, (*pRestoredBuffer1)[i]);
+				Assert::AreEqual(i < SMALL_BUFER_SIZE / 2 ? (double)-i : 2.0, (*pRestoredBuffer2)[i]);
+			}
+
+			delete pMemManager;
+			delete pRestoredMemManager;
+		}
 	};
 }
\ No newline at end of file
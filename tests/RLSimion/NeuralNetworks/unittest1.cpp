@@ -0,0 +1,557 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "../../../RLSimion/Lib/native-network.h"
+#include "../../../RLSimion/Lib/native-network-kernels.h"
+#include "../../../RLSimion/Lib/async-learner.h"
+#include "../../../RLSimion/Lib/experience-replay.h"
+#include "../../../RLSimion/Lib/app.h"
+#include "../../../RLSimion/Lib/config.h"
+#include "../../../RLSimion/Lib/logger.h"
+#include "../../../RLSimion/Lib/worlds/world.h"
+#include "../../../RLSimion/Common/named-var-set.h"
+#include "../../../3rd-party/tinyxml2/tinyxml2.h"
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <stdio.h>
+#include <math.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+//f(s,a): state -> dense(4, tanh), merged with the action -> dense(3, sigmoid) -> dense(1, linear)
+static const char* networkDefinition =
+"<Problem>"
+"<NetworkArchitecture><Chains>"
+"<Chain><ChainLinks>"
+"<LinkBase xsi:type=\"InputLayer\" ID=\"state\"><Parameters>"
+"<ParameterBase xsi:type=\"InputDataParameter\" Name=\"Input Data\"><Value>state-input</Value></ParameterBase>"
+"</Parameters></LinkBase>"
+"<LinkBase xsi:type=\"DenseLayer\" ID=\"dense1\"><Parameters>"
+"<ParameterBase xsi:type=\"IntParameter\" Name=\"Units\"><Value>4</Value></ParameterBase>"
+"<ParameterBase xsi:type=\"ActivationFunctionParameter\" Name=\"Activation\"><Value>tanh</Value></ParameterBase>"
+"</Parameters></LinkBase>"
+"</ChainLinks></Chain>"
+"<Chain><ChainLinks>"
+"<LinkBase xsi:type=\"InputLayer\" ID=\"action\"><Parameters>"
+"<ParameterBase xsi:type=\"InputDataParameter\" Name=\"Input Data\"><Value>action-input</Value></ParameterBase>"
+"</Parameters></LinkBase>"
+"</ChainLinks></Chain>"
+"<Chain><ChainLinks>"
+"<LinkBase xsi:type=\"MergeLayer\" ID=\"merge\"><Parameters>"
+"<ParameterBase xsi:type=\"LinkConnectionListParameter\" Name=\"Links\"><Value>"
+"<LinkConnection TargetID=\"dense1\"/><LinkConnection TargetID=\"action\"/>"
+"</Value></ParameterBase>"
+"</Parameters></LinkBase>"
+"<LinkBase xsi:type=\"DenseLayer\" ID=\"dense2\"><Parameters>"
+"<ParameterBase xsi:type=\"IntParameter\" Name=\"Units\"><Value>3</Value></ParameterBase>"
+"<ParameterBase xsi:type=\"ActivationFunctionParameter\" Name=\"Activation\"><Value>sigmoid</Value></ParameterBase>"
+"</Parameters></LinkBase>"
+"<LinkBase xsi:type=\"DenseLayer\" ID=\"output\"><Parameters>"
+"<ParameterBase xsi:type=\"IntParameter\" Name=\"Units\"><Value>1</Value></ParameterBase>"
+"<ParameterBase xsi:type=\"ActivationFunctionParameter\" Name=\"Activation\"><Value>linear</Value></ParameterBase>"
+"</Parameters></LinkBase>"
+"</ChainLinks></Chain>"
+"</Chains></NetworkArchitecture>"
+"<Output><LinkConnection TargetID=\"output\"/></Output>"
+"<OptimizerSetting><Optimizer xsi:type=\"OptimizerSGD\"/></OptimizerSetting>"
+"</Problem>";
+
+static NativeNetworkDefinition* createNetworkDefinition()
+{
+	tinyxml2::XMLDocument doc;
+	doc.Parse(networkDefinition);
+	NativeNetworkDefinition* pDefinition = new NativeNetworkDefinition(doc.FirstChildElement("Problem"));
+	pDefinition->addInputStateVar("x");
+	pDefinition->addInputStateVar("y");
+	pDefinition->addInputActionVar("u");
+	pDefinition->setScalarOutput();
+	return pDefinition;
+}
+
+static vector<double> loadParameters(const char* fileName)
+{
+	FILE* pFile = fopen(fileName, "rb");
+	size_t numParameters = 0;
+	fread(&numParameters, sizeof(size_t), 1, pFile);
+	vector<double> parameters(numParameters);
+	fread(parameters.data(), sizeof(double), numParameters, pFile);
+	fclose(pFile);
+	remove(fileName);
+	return parameters;
+}
+
+//experience tuples are created with the state and action of the world, so a SimionApp must exist
+static const char* appConfig =
+"<RLSimion FileVersion=\"1.0.0.0\"><RLSimion>"
+"<Log><Log-Freq>0.0</Log-Freq><Log-Eval-Episodes>false</Log-Eval-Episodes>"
+"<Log-Training-Episodes>false</Log-Training-Episodes><Log-Functions>false</Log-Functions></Log>"
+"<World><Num-Integration-Steps>4</Num-Integration-Steps><Delta-T>0.01</Delta-T>"
+"<Dynamic-Model><Model><Mountain-car/></Model></Dynamic-Model></World>"
+"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>1</Num-Episodes><Eval-Freq>0</Eval-Freq>"
+"<Episode-Length>1.0</Episode-Length></Experiment>"
+"<SimGod><Gamma>0.9</Gamma></SimGod>"
+"</RLSimion></RLSimion>";
+
+//waits until the condition holds or a few seconds have passed
+static bool waitUntil(function<bool()> condition)
+{
+	for (int i = 0; i < 5000 && !condition(); i++)
+		this_thread::sleep_for(chrono::milliseconds(1));
+	return condition();
+}
+
+namespace NeuralNetworks
+{
+	TEST_CLASS(UnitTest1)
+	{
+	public:
+
+		TEST_METHOD(NativeNetwork_GEMM)
+		{
+			//sizes chosen to leave remainders in every blocked/unrolled loop of the kernel
+			const size_t sizes[][3] = { { 1, 1, 1 }, { 3, 5, 2 }, { 7, 131, 130 }, { 9, 2, 257 } };
+			for (const auto& size : sizes)
+			{
+				size_t M = size[0], N = size[1], K = size[2];
+				vector<double> A(M * K), B(K * N), C(M * N), expected(M * N);
+				for (size_t i = 0; i < A.size(); i++) A[i] = sin((double)i);
+				for (size_t i = 0; i < B.size(); i++) B[i] = cos((double)i * 0.7);
+				for (size_t i = 0; i < C.size(); i++) C[i] = expected[i] = (double)i;
+
+				for (int accumulate = 0; accumulate < 2; accumulate++)
+				{
+					for (size_t i = 0; i < M; i++)
+					{
+						for (size_t j = 0; j < N; j++)
+						{
+							double sum = accumulate ? expected[i * N + j] : 0.0;
+							for (size_t k = 0; k < K; k++)
+								sum += A[i * K + k] * B[k * N + j];
+							expected[i * N + j] = sum;
+						}
+					}
+					NativeKernels::gemm(M, N, K, A.data(), B.data(), C.data(), accumulate != 0);
+
+					for (size_t i = 0; i < C.size(); i++)
+						Assert::AreEqual(expected[i], C[i], 1e-9, L"NativeKernels::gemm() doesn't match the naive product");
+				}
+			}
+		}
+
+		TEST_METHOD(NativeNetwork_GradientWrtAction)
+		{
+			NativeNetworkDefinition* pDefinition = createNetworkDefinition();
+			INetwork* pNetwork = pDefinition->createNetwork(0.01, true);
+
+			//3 tuples
+			vector<double> s = { 0.1, 0.9, 0.5, 0.3, 0.8, 0.2 };
+			vector<double> a = { 0.7, 0.2, 0.45 };
+			vector<double> gradient(a.size()), yPlus, yMinus;
+			pNetwork->gradientWrtAction(s, a, gradient);
+
+			const double h = 1e-6;
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				vector<double> aPlus = a, aMinus = a;
+				aPlus[i] += h;
+				aMinus[i] -= h;
+				pNetwork->evaluate(s, aPlus, yPlus);
+				pNetwork->evaluate(s, aMinus, yMinus);
+				double numericalGradient = (yPlus[i] - yMinus[i]) / (2.0 * h);
+				Assert::AreEqual(numericalGradient, gradient[i], 1e-6, L"The gradient with respect to the action doesn't match finite differences");
+			}
+
+			//networks created without gradients with respect to the inputs can't calculate them
+			INetwork* pNetworkWithoutGradients = pDefinition->createNetwork(0.01);
+			bool bThrown = false;
+			try
+			{
+				pNetworkWithoutGradients->gradientWrtAction(s, a, gradient);
+			}
+			catch (std::exception&)
+			{
+				bThrown = true;
+			}
+			Assert::IsTrue(bThrown, L"The gradient with respect to the action was calculated although it wasn't requested");
+
+			pNetworkWithoutGradients->destroy();
+			pNetwork->destroy();
+			pDefinition->destroy();
+		}
+
+		TEST_METHOD(NativeNetwork_ParameterGradients)
+		{
+			Descriptor stateDescriptor;
+			size_t hX = stateDescriptor.addVariable("x", "m", -1.0, 1.0);
+			size_t hY = stateDescriptor.addVariable("y", "m", -1.0, 1.0);
+			Descriptor actionDescriptor;
+			size_t hU = actionDescriptor.addVariable("u", "N", -1.0, 1.0);
+			State* s = stateDescriptor.getInstance();
+			Action* a = actionDescriptor.getInstance();
+
+			NativeNetworkDefinition* pDefinition = createNetworkDefinition();
+			const double learningRate = 1e-6;
+			INetwork* pNetwork = pDefinition->createNetwork(learningRate);
+
+			//the minibatch is only partially filled: the unused tuple must not contribute to the gradient
+			IMinibatch* pMinibatch = pDefinition->createMinibatch(4);
+			const double tuples[3][4] = { { 0.2, -0.5, 0.3, 1.0 }, { -0.8, 0.1, -0.6, -0.5 }, { 0.4, 0.7, 0.9, 2.0 } };
+			for (const auto& tuple : tuples)
+			{
+				s->set(hX, tuple[0]);
+				s->set(hY, tuple[1]);
+				a->set(hU, tuple[2]);
+				pMinibatch->addTuple(s, a, tuple[3]);
+			}
+			vector<double> inputState(pMinibatch->getInputState().begin(), pMinibatch->getInputState().begin() + 3 * 2);
+			vector<double> inputAction(pMinibatch->getInputAction().begin(), pMinibatch->getInputAction().begin() + 3);
+			vector<double> target(pMinibatch->getOutput().begin(), pMinibatch->getOutput().begin() + 3);
+
+			//one SGD step: p1= p0 - learningRate * dL/dp, with L= sum (y - target)^2
+			vector<double> y;
+			pNetwork->evaluate(inputState, inputAction, y);
+			double lossBefore = 0.0;
+			for (size_t i = 0; i < target.size(); i++)
+				lossBefore += (y[i] - target[i]) * (y[i] - target[i]);
+
+			pNetwork->save("native-network-test-p0.bin");
+			pNetwork->train(pMinibatch);
+			pNetwork->save("native-network-test-p1.bin");
+			vector<double> p0 = loadParameters("native-network-test-p0.bin");
+			vector<double> p1 = loadParameters("native-network-test-p1.bin");
+
+			pNetwork->evaluate(inputState, inputAction, y);
+			double lossAfter = 0.0;
+			for (size_t i = 0; i < target.size(); i++)
+				lossAfter += (y[i] - target[i]) * (y[i] - target[i]);
+
+			//first-order finite difference along the step: L(p1) - L(p0) ~= dL/dp . (p1 - p0)= -learningRate * |dL/dp|^2
+			double squaredGradientNorm = 0.0;
+			for (size_t i = 0; i < p0.size(); i++)
+			{
+				double gradient = (p0[i] - p1[i]) / learningRate;
+				squaredGradientNorm += gradient * gradient;
+			}
+			double expectedLossChange = -learningRate * squaredGradientNorm;
+			Assert::IsTrue(squaredGradientNorm > 0.0, L"NativeNetwork::train() didn't update the weights");
+			Assert::AreEqual(expectedLossChange, lossAfter - lossBefore, 1e-3 * fabs(expectedLossChange)
+				, L"The gradient of the loss with respect to the weights doesn't match finite differences");
+
+			pMinibatch->destroy();
+			pNetwork->destroy();
+			pDefinition->destroy();
+			delete s;
+			delete a;
+		}
+
+		TEST_METHOD(NativeNetwork_RandomSeed)
+		{
+			NativeNetworkDefinition* pDefinition = createNetworkDefinition();
+
+			srand(1);
+			INetwork* pNetwork1 = pDefinition->createNetwork(0.01);
+			srand(1);
+			INetwork* pNetwork2 = pDefinition->createNetwork(0.01);
+			INetwork* pNetwork3 = pDefinition->createNetwork(0.01);
+
+			pNetwork1->save("native-network-test-1.bin");
+			pNetwork2->save("native-network-test-2.bin");
+			pNetwork3->save("native-network-test-3.bin");
+			vector<double> p1 = loadParameters("native-network-test-1.bin");
+			vector<double> p2 = loadParameters("native-network-test-2.bin");
+			vector<double> p3 = loadParameters("native-network-test-3.bin");
+
+			Assert::IsTrue(p1 == p2, L"The initial weights don't depend only on the random seed");
+			Assert::IsFalse(p1 == p3, L"Networks created one after another share their initial weights");
+
+			pNetwork1->destroy();
+			pNetwork2->destroy();
+			pNetwork3->destroy();
+			pDefinition->destroy();
+		}
+	};
+
+	TEST_CLASS(AsyncLearnerTest)
+	{
+	public:
+
+		TEST_METHOD(AsyncLearner_ExperienceQueue)
+		{
+			ConfigFile configFile;
+			configFile.Parse(appConfig);
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+			State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+
+			ExperienceQueue queue(3);
+			Assert::IsTrue(queue.front() == nullptr, L"A new queue isn't empty");
+
+			//tuples are identified by their reward. The queue wraps around several times
+			double nextPushed = 0.0, nextPopped = 0.0;
+			for (int round = 0; round < 5; round++)
+			{
+				while (queue.push(s, a, s, nextPushed, 1.0))
+					nextPushed += 1.0;
+				Assert::AreEqual(3.0, nextPushed - nextPopped, L"The queue doesn't hold as many tuples as its capacity");
+
+				//pop only some of them, so that the head and the tail move to different positions
+				for (int i = 0; i <= round % 3; i++)
+				{
+					ExperienceTuple* pTuple = queue.front();
+					Assert::IsTrue(pTuple != nullptr, L"A queue with tuples returned none");
+					Assert::AreEqual(nextPopped, pTuple->r, L"The queue doesn't return the tuples in the order they were pushed");
+					queue.pop();
+					nextPopped += 1.0;
+				}
+			}
+			while (ExperienceTuple* pTuple = queue.front())
+			{
+				Assert::AreEqual(nextPopped, pTuple->r, L"The queue doesn't return the tuples in the order they were pushed");
+				queue.pop();
+				nextPopped += 1.0;
+			}
+			Assert::AreEqual(nextPushed, nextPopped, L"Tuples were lost by the queue");
+
+			delete s;
+			delete a;
+			delete pApp;
+		}
+
+		TEST_METHOD(AsyncLearner_TrainingRate)
+		{
+			ConfigFile configFile;
+			configFile.Parse(appConfig);
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+			State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+
+			//with a minibatch of 2 tuples, training starts once the buffer holds 8 tuples and then there is one step per tuple
+			const size_t bufferSize = 8, minibatchSize = 2;
+			const size_t numTuples = 20;
+			atomic<size_t> numAddedTuples(0), numTrainingCalls(0);
+			atomic<bool> bInvalidTuple(false);
+			AsyncLearner* pLearner = new AsyncLearner(bufferSize, minibatchSize
+				, [&](const ExperienceTuple* pTuple)
+			{
+				if (pTuple->r < 0.0 || pTuple->r >= (double)numTuples) bInvalidTuple = true;
+				++numAddedTuples;
+			}
+				, [&]() { ++numTrainingCalls; });
+			pLearner->start();
+
+			for (size_t i = 0; i < numTuples; i++)
+			{
+				pLearner->push(s, a, s, (double)i, 1.0);
+				size_t expectedSteps = (i + 1 >= bufferSize) ? i + 2 - bufferSize : 0;
+				Assert::IsTrue(waitUntil([&]() { return numTrainingCalls.load() >= expectedSteps; })
+					, L"The learner didn't train after receiving new tuples");
+			}
+			//give the learner some time to do any extra (wrong) training steps
+			this_thread::sleep_for(chrono::milliseconds(50));
+
+			size_t expectedSteps = numTuples + 1 - bufferSize;
+			Assert::AreEqual(expectedSteps, numTrainingCalls.load(), L"The learner didn't do one training step per tuple");
+			Assert::AreEqual(expectedSteps, pLearner->getNumTrainingSteps(), L"Wrong number of training steps");
+			Assert::AreEqual(expectedSteps * minibatchSize, numAddedTuples.load(), L"Minibatches weren't filled with the right number of tuples");
+			Assert::IsFalse(bInvalidTuple.load(), L"The learner sampled a tuple that wasn't pushed");
+			Assert::AreEqual((size_t)0, pLearner->getNumDroppedTuples(), L"Tuples were dropped");
+
+			delete pLearner;
+			delete s;
+			delete a;
+			delete pApp;
+		}
+
+		TEST_METHOD(AsyncLearner_DroppedTuples)
+		{
+			ConfigFile configFile;
+			configFile.Parse(appConfig);
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+			State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+
+			//the learner thread isn't started, so nobody empties the queue
+			AsyncLearner* pLearner = new AsyncLearner(4, 1, [](const ExperienceTuple*) {}, []() {});
+			for (int i = 0; i < 10; i++)
+				pLearner->push(s, a, s, (double)i, 1.0);
+			Assert::AreEqual((size_t)6, pLearner->getNumDroppedTuples(), L"Dropped tuples weren't counted");
+
+			delete pLearner;
+			delete s;
+			delete a;
+			delete pApp;
+		}
+
+		TEST_METHOD(AsyncLearner_Exception)
+		{
+			ConfigFile configFile;
+			configFile.Parse(appConfig);
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+			State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+
+			//exceptions thrown in the learner thread are rethrown in the simulation thread by the next push()
+			AsyncLearner* pLearner = new AsyncLearner(4, 1, [](const ExperienceTuple*) {}
+				, []() { throw std::runtime_error("training failed"); });
+			pLearner->start();
+			bool bRethrown = waitUntil([&]()
+			{
+				try
+				{
+					pLearner->push(s, a, s, 0.0, 1.0);
+				}
+				catch (std::runtime_error&)
+				{
+					return true;
+				}
+				return false;
+			});
+			Assert::IsTrue(bRethrown, L"The exception thrown by the learner thread wasn't rethrown");
+
+			delete pLearner;
+			delete s;
+			delete a;
+			delete pApp;
+		}
+
+		TEST_METHOD(AsyncLearner_SnapshotHandOff)
+		{
+			ConfigFile configFile;
+			configFile.Parse(appConfig);
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+			State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+
+			//the input of the network, the same for every tuple. The target value is taken from the reward of the tuples
+			Descriptor stateDescriptor;
+			stateDescriptor.addVariable("x", "m", -1.0, 1.0);
+			stateDescriptor.addVariable("y", "m", -1.0, 1.0);
+			Descriptor actionDescriptor;
+			actionDescriptor.addVariable("u", "N", -1.0, 1.0);
+			State* networkS = stateDescriptor.getInstance();
+			Action* networkA = actionDescriptor.getInstance();
+			networkS->set("x", 0.3);
+			networkS->set("y", -0.2);
+			networkA->set("u", 0.5);
+
+			NativeNetworkDefinition* pDefinition = createNetworkDefinition();
+			INetwork* pNetwork = pDefinition->createNetwork(0.1);
+			IMinibatch* pMinibatch = pDefinition->createMinibatch(2);
+
+			//the simulation thread only uses the copies of the network published by the learner thread after each step
+			NetworkSnapshot* pSnapshot = new NetworkSnapshot();
+			pSnapshot->publish(pNetwork->clone());
+			shared_ptr<INetwork> pFirstSnapshot = pSnapshot->get();
+			double initialOutput = pSnapshot->evaluate(networkS, networkA)[0];
+
+			const size_t bufferSize = 8, numTuples = 20;
+			AsyncLearner* pLearner = new AsyncLearner(bufferSize, 2
+				, [&](const ExperienceTuple* pTuple) { pMinibatch->addTuple(networkS, networkA, 10.0 + pTuple->r); }
+				, [&]()
+			{
+				pNetwork->train(pMinibatch);
+				pSnapshot->publish(pNetwork->clone());
+			});
+			pLearner->start();
+
+			for (size_t i = 0; i < numTuples; i++)
+			{
+				pLearner->push(s, a, s, (double)i, 1.0);
+				//the snapshot is used while the learner replaces it
+				size_t expectedSteps = (i + 1 >= bufferSize) ? i + 2 - bufferSize : 0;
+				Assert::IsTrue(waitUntil([&]()
+				{
+					pSnapshot->evaluate(networkS, networkA);
+					return pLearner->getNumTrainingSteps() >= expectedSteps;
+				}), L"The learner didn't train after receiving new tuples");
+			}
+			//no more snapshots are published once the learner thread has been joined
+			delete pLearner;
+
+			Assert::IsTrue(pSnapshot->get() != pFirstSnapshot, L"The learner didn't publish new snapshots");
+			Assert::AreEqual(initialOutput, pFirstSnapshot->evaluate(networkS, networkA)[0]
+				, L"A snapshot still in use was modified by the learner");
+			double snapshotOutput = pSnapshot->evaluate(networkS, networkA)[0];
+			Assert::AreEqual(pNetwork->evaluate(networkS, networkA)[0], snapshotOutput, 0.000000000001
+				, L"The last snapshot isn't a copy of the trained network");
+			Assert::IsTrue(fabs(snapshotOutput - initialOutput) > 0.000001, L"The snapshots published weren't trained");
+
+			pFirstSnapshot.reset();
+			delete pSnapshot;
+			pMinibatch->destroy();
+			pNetwork->destroy();
+			pDefinition->destroy();
+			delete networkS;
+			delete networkA;
+			delete s;
+			delete a;
+			delete pApp;
+		}
+
+		TEST_METHOD(AsyncLearner_JoinOnShutdown)
+		{
+			ConfigFile configFile;
+			configFile.Parse(appConfig);
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+			State* s = pApp->pWorld->getDynamicModel()->getStateInstance();
+			Action* a = pApp->pWorld->getDynamicModel()->getActionInstance();
+
+			//training steps take long enough for the learner to be destroyed in the middle of one
+			atomic<bool> bTraining(false);
+			atomic<size_t> numTrainingCalls(0);
+			AsyncLearner* pLearner = new AsyncLearner(4, 1, [](const ExperienceTuple*) {}
+				, [&]()
+			{
+				bTraining = true;
+				this_thread::sleep_for(chrono::milliseconds(20));
+				++numTrainingCalls;
+				bTraining = false;
+			});
+			pLearner->start();
+			for (int i = 0; i < 10; i++)
+				pLearner->push(s, a, s, (double)i, 1.0);
+			Assert::IsTrue(waitUntil([&]() { return bTraining.load(); }), L"The learner didn't start training");
+
+			//the destructor waits for the training step in progress and the learner doesn't start any other
+			delete pLearner;
+			Assert::IsFalse(bTraining.load(), L"The learner was destroyed in the middle of a training step");
+			size_t numTrainingCallsOnShutdown = numTrainingCalls.load();
+			Assert::IsTrue(numTrainingCallsOnShutdown < 7, L"The learner didn't stop on shutdown");
+			this_thread::sleep_for(chrono::milliseconds(50));
+			Assert::AreEqual(numTrainingCallsOnShutdown, numTrainingCalls.load(), L"The learner kept training after being destroyed");
+
+			delete s;
+			delete a;
+			delete pApp;
+		}
+
+#ifdef __linux__
+		TEST_METHOD(AsyncLearner_EvaluationWorkers)
+		{
+			string config = appConfig;
+			config.insert(config.rfind("</RLSimion></RLSimion>")
+				, "<Evaluation-Workers><Num-Workers>2</Num-Workers></Evaluation-Workers>");
+			ConfigFile configFile;
+			configFile.Parse(config.c_str());
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+
+			//workers can't be forked while the learner thread runs
+			AsyncLearner* pLearner = new AsyncLearner(4, 1, [](const ExperienceTuple*) {}, []() {});
+			bool bRefused = false;
+			try
+			{
+				pLearner->start();
+			}
+			catch (std::runtime_error&)
+			{
+				bRefused = true;
+			}
+			Assert::IsTrue(bRefused, L"The learner thread was started with evaluation workers");
+
+			delete pLearner;
+			delete pApp;
+		}
+#endif
+	};
+}
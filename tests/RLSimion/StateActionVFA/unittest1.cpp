@@ -6,13 +6,29 @@
 #include "../../../RLSimion/Lib/simgod.h"
 #include "../../../RLSimion/Lib/worlds/world.h"
 #include "../../../RLSimion/Lib/featuremap.h"
+#include "../../../RLSimion/Lib/single-dimension-grid.h"
+#include "../../../RLSimion/Lib/etraces.h"
+#include "../../../RLSimion/Lib/experiment.h"
+#include "../../../RLSimion/Lib/config.h"
 #include "../../../RLSimion/Common/named-var-set.h"
 #include <iostream>
+#include <map>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace StateActionVFA
-{		
+{
+	//a minimal experiment. Some classes (i.e., LinearVFA::add(), ETraces) need the SimGod and the Experiment of the app
+	const char* appConfig = "<RLSimion FileVersion=\"1.0.0.0\"><RLSimion>"
+		"<Log><Log-Freq>0.0</Log-Freq><Log-Eval-Episodes>false</Log-Eval-Episodes>"
+		"<Log-Training-Episodes>false</Log-Training-Episodes><Log-Functions>false</Log-Functions></Log>"
+		"<World><Num-Integration-Steps>4</Num-Integration-Steps><Delta-T>0.01</Delta-T>"
+		"<Dynamic-Model><Model><Mountain-car/></Model></Dynamic-Model></World>"
+		"<Experiment><Random-Seed>1</Random-Seed><Num-Episodes>1</Num-Episodes><Eval-Freq>0</Eval-Freq>"
+		"<Episode-Length>100.0</Episode-Length></Experiment>"
+		"<SimGod><Gamma>0.9</Gamma></SimGod>"
+		"</RLSimion></RLSimion>";
+
 	TEST_CLASS(UnitTest1)
 	{
 	public:
@@ -71,6 +87,151 @@ namespace StateActionVFA
 			delete pVFA;
 			delete pMemManager;
 		}
+		TEST_METHOD(LinearStateActionVFA_ArgMaxSearch)
+		{
+			Descriptor stateDescriptor;
+			size_t hX = stateDescriptor.addVariable("x", "m", 0.0, 10.0);
+			Descriptor actionDescriptor;
+			size_t hForce = actionDescriptor.addVariable("force", "N", -1.0, 1.0);
+			size_t hTorque = actionDescriptor.addVariable("torque", "Nm", -1.0, 1.0);
+
+			State* s = stateDescriptor.getInstance();
+			Action* a = actionDescriptor.getInstance();
+			const int numFeatures = 11;
+
+			StateFeatureMap* stateFeatureMap = new StateFeatureMap(new GaussianRBFGridFeatureMap(), stateDescriptor, { hX }, numFeatures);
+			ActionFeatureMap* actionFeatureMap = new ActionFeatureMap(new DiscreteFeatureMap(), actionDescriptor, { hForce, hTorque }, numFeatures);
+
+			MemManager<SimionMemPool> *pMemManager = new MemManager<SimionMemPool>();
+			LinearStateActionVFA *pVFA
+				= new LinearStateActionVFA(pMemManager, std::shared_ptr<StateFeatureMap>((StateFeatureMap*)stateFeatureMap)
+					, std::shared_ptr<ActionFeatureMap>((ActionFeatureMap*)actionFeatureMap));
+
+			pVFA->setInitValue(0.0);
+			pVFA->deferredLoadStep();
+			pMemManager->deferredLoadStep();
+
+			//Q(s,a) is a concave function of the indices of the two action variables with its maximum at (7,3)
+			for (size_t action = 0; action < pVFA->getNumActionWeights(); action++)
+			{
+				double forceIndex = (double)(action % numFeatures), torqueIndex = (double)(action / numFeatures);
+				double value = -(forceIndex - 7.0)*(forceIndex - 7.0) - 2.0*(torqueIndex - 3.0)*(torqueIndex - 3.0);
+				for (size_t stateFeature = 0; stateFeature < pVFA->getNumStateWeights(); stateFeature++)
+					pVFA->set(stateFeature + action * pVFA->getNumStateWeights(), value);
+			}
+			s->set(hX, 4.2);
+
+			pVFA->argMax(s, a);
+			double expectedForce = a->get(hForce), expectedTorque = a->get(hTorque);
+			double expectedMax = pVFA->max(s);
+			Assert::AreEqual(actionFeatureMap->getGrids()[0]->getFeatureValue(7), expectedForce, 0.0001, L"Exhaustive argMax() doesn't find the maximum");
+			Assert::AreEqual(actionFeatureMap->getGrids()[1]->getFeatureValue(3), expectedTorque, 0.0001, L"Exhaustive argMax() doesn't find the maximum");
+
+			for (ArgMaxSearch search : { ArgMaxSearch::coarseToFine, ArgMaxSearch::coordinateAscent })
+			{
+				pVFA->setArgMaxSearch(search);
+				pVFA->argMax(s, a);
+				Assert::AreEqual(expectedForce, a->get(hForce), 0.0001, L"argMax() with a structured search doesn't find the maximum");
+				Assert::AreEqual(expectedTorque, a->get(hTorque), 0.0001, L"argMax() with a structured search doesn't find the maximum");
+				Assert::AreEqual(expectedMax, pVFA->max(s), 0.0001, L"max() with a structured search doesn't find the maximum");
+			}
+
+			delete s;
+			delete a;
+
+			delete pVFA;
+			delete pMemManager;
+		}
+		TEST_METHOD(LinearStateActionVFA_ActionValueCache)
+		{
+			ConfigFile configFile;
+			configFile.Parse(appConfig);
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+
+			Descriptor stateDescriptor;
+			size_t hX = stateDescriptor.addVariable("x", "m", 0.0, 10.0);
+			Descriptor actionDescriptor;
+			size_t hForce = actionDescriptor.addVariable("force", "N", -1.0, 1.0);
+			size_t hTorque = actionDescriptor.addVariable("torque", "Nm", -1.0, 1.0);
+
+			State* s = stateDescriptor.getInstance();
+			State* s_p = stateDescriptor.getInstance();
+			Action* a = actionDescriptor.getInstance();
+			const int numFeatures = 11;
+
+			StateFeatureMap* stateFeatureMap = new StateFeatureMap(new GaussianRBFGridFeatureMap(), stateDescriptor, { hX }, numFeatures);
+			ActionFeatureMap* actionFeatureMap = new ActionFeatureMap(new DiscreteFeatureMap(), actionDescriptor, { hForce, hTorque }, numFeatures);
+
+			MemManager<SimionMemPool> *pMemManager = new MemManager<SimionMemPool>();
+			LinearStateActionVFA *pVFA
+				= new LinearStateActionVFA(pMemManager, std::shared_ptr<StateFeatureMap>((StateFeatureMap*)stateFeatureMap)
+					, std::shared_ptr<ActionFeatureMap>((ActionFeatureMap*)actionFeatureMap));
+			FeatureList* pFeatures = new FeatureList("features");
+			vector<double> actionValues(pVFA->getNumActionWeights());
+
+			pVFA->setInitValue(0.0);
+			pVFA->deferredLoadStep();
+			pMemManager->deferredLoadStep();
+
+			//Q(s,a) is a concave function of the indices of the two action variables with its maximum at (7,3)
+			for (size_t action = 0; action < pVFA->getNumActionWeights(); action++)
+			{
+				double forceIndex = (double)(action % numFeatures), torqueIndex = (double)(action / numFeatures);
+				double value = -(forceIndex - 7.0)*(forceIndex - 7.0) - 2.0*(torqueIndex - 3.0)*(torqueIndex - 3.0);
+				for (size_t stateFeature = 0; stateFeature < pVFA->getNumStateWeights(); stateFeature++)
+					pVFA->set(stateFeature + action * pVFA->getNumStateWeights(), value);
+			}
+			s->set(hX, 4.2);
+			s_p->set(hX, 8.9);
+
+			//the action values of s are cached by the first lookup
+			pVFA->argMax(s, a);
+			Assert::AreEqual(actionFeatureMap->getGrids()[0]->getFeatureValue(7), a->get(hForce), 0.0001, L"argMax() doesn't find the maximum");
+			Assert::AreEqual(actionFeatureMap->getGrids()[1]->getFeatureValue(3), a->get(hTorque), 0.0001, L"argMax() doesn't find the maximum");
+			Assert::AreEqual(0.0, pVFA->max(s), 0.0001, L"max() doesn't find the maximum");
+
+			//an update of another action must invalidate the cached action values
+			a->set(hForce, actionFeatureMap->getGrids()[0]->getFeatureValue(2));
+			a->set(hTorque, actionFeatureMap->getGrids()[1]->getFeatureValue(8));
+			double oldValue = pVFA->get(s, a);
+			pVFA->getFeatures(s, a, pFeatures);
+			pVFA->add(pFeatures, 100.0);
+			double newValue = pVFA->get(s, a);
+			Assert::IsTrue(newValue > 0.0, L"The update should make (2,8) the best action");
+
+			pVFA->argMax(s, a);
+			Assert::AreEqual(actionFeatureMap->getGrids()[0]->getFeatureValue(2), a->get(hForce), 0.0001, L"argMax() uses stale action values after add()");
+			Assert::AreEqual(actionFeatureMap->getGrids()[1]->getFeatureValue(8), a->get(hTorque), 0.0001, L"argMax() uses stale action values after add()");
+			Assert::AreEqual(newValue, pVFA->max(s), 0.0001, L"max() uses stale action values after add()");
+			pVFA->getActionValues(s, actionValues.data());
+			Assert::AreEqual(newValue, actionValues[2 + 8 * numFeatures], 0.0001, L"getActionValues() returns stale values after add()");
+
+			//a lookup of another state in between and another update, undoing the previous one
+			pVFA->max(s_p);
+			pVFA->add(pFeatures, -100.0);
+			Assert::AreEqual(oldValue, pVFA->get(s, a), 0.0001, L"add() didn't undo the previous update");
+			pVFA->argMax(s, a);
+			Assert::AreEqual(actionFeatureMap->getGrids()[0]->getFeatureValue(7), a->get(hForce), 0.0001, L"argMax() uses stale action values after add()");
+			Assert::AreEqual(actionFeatureMap->getGrids()[1]->getFeatureValue(3), a->get(hTorque), 0.0001, L"argMax() uses stale action values after add()");
+			Assert::AreEqual(0.0, pVFA->max(s), 0.0001, L"max() uses stale action values after add()");
+
+			//if no action value can be compared, the coarse-to-fine search returns the first action it evaluates
+			for (size_t feature = 0; feature < pVFA->getNumStateWeights() * pVFA->getNumActionWeights(); feature++)
+				pVFA->set(feature, std::numeric_limits<double>::quiet_NaN());
+			pVFA->setArgMaxSearch(ArgMaxSearch::coarseToFine);
+			pVFA->argMax(s, a);
+			Assert::AreEqual(actionFeatureMap->getGrids()[0]->getFeatureValue(0), a->get(hForce), 0.0001, L"argMax() with NaN values doesn't return the first action");
+			Assert::AreEqual(actionFeatureMap->getGrids()[1]->getFeatureValue(0), a->get(hTorque), 0.0001, L"argMax() with NaN values doesn't return the first action");
+
+			delete s;
+			delete s_p;
+			delete a;
+			delete pFeatures;
+
+			delete pVFA;
+			delete pMemManager;
+			delete pApp;
+		}
 		TEST_METHOD(LinearStateActionVFA_FeatureMap)
 		{
 			double minX = 0.0, maxX = 10.0;
@@ -136,5 +297,114 @@ namespace StateActionVFA
 			delete pVFA;
 			delete pMemManager;
 		}
+		//ETraces decays the traces lazily through a common scale. Their values must match those of traces decayed eagerly
+		//(multiplying every trace each step and then removing those under the threshold) except for the traces under the
+		//threshold, which may be kept a little longer
+		void checkLazyDecay(bool bReplace)
+		{
+			const double threshold = 0.000001, lambda = 0.9, gamma = 0.95;
+			const size_t numIndices = 40, numSteps = 2000;
+
+			ConfigFile configFile;
+			configFile.Parse(appConfig);
+			SimionApp* pApp = new SimionApp((ConfigNode*)configFile.FirstChildElement());
+			//traces are cleared in the first step of an episode
+			pApp->pExperiment->nextEpisode();
+			pApp->pExperiment->nextStep();
+			pApp->pExperiment->nextStep();
+
+			ConfigFile tracesConfigFile;
+			tracesConfigFile.Parse(bReplace
+				? "<E-Traces><Threshold>0.000001</Threshold><Lambda>0.9</Lambda><Replace>true</Replace></E-Traces>"
+				: "<E-Traces><Threshold>0.000001</Threshold><Lambda>0.9</Lambda><Replace>false</Replace></E-Traces>");
+			ETraces* pTraces = new ETraces((ConfigNode*)tracesConfigFile.FirstChildElement());
+
+			map<size_t, double> eagerTraces;
+			FeatureList* pFeatures = new FeatureList("features");
+			FeatureList* pProbe = new FeatureList("probe");
+			srand(1);
+			for (size_t step = 0; step < numSteps; step++)
+			{
+				pTraces->update(gamma);
+				for (auto it = eagerTraces.begin(); it != eagerTraces.end();)
+				{
+					it->second *= gamma * lambda;
+					if (fabs(it->second) < threshold) it = eagerTraces.erase(it);
+					else ++it;
+				}
+
+				//a few features every step. Long pauses let the traces decay below the threshold
+				pFeatures->clear();
+				if (step % 200 < 150)
+				{
+					for (int i = 0; i < 3; i++)
+						pFeatures->add(rand() % numIndices, (double)(rand() % 100 + 1) / 100.0);
+				}
+				//half the steps the features are added one by one
+				if (step % 2 == 0)
+					pTraces->addFeatureList(pFeatures, 1.0);
+				else
+				{
+					for (size_t i = 0; i < pFeatures->m_numFeatures; i++)
+						pTraces->add(pFeatures->m_pFeatures[i].m_index, pFeatures->m_pFeatures[i].m_factor);
+				}
+				for (size_t i = 0; i < pFeatures->m_numFeatures; i++)
+				{
+					if (bReplace) eagerTraces[pFeatures->m_pFeatures[i].m_index] = pFeatures->m_pFeatures[i].m_factor;
+					else eagerTraces[pFeatures->m_pFeatures[i].m_index] += pFeatures->m_pFeatures[i].m_factor;
+				}
+
+				for (size_t index = 0; index < numIndices; index++)
+				{
+					pProbe->clear();
+					pProbe->add(index, 1.0);
+					auto eagerTrace = eagerTraces.find(index);
+					double expected = (eagerTrace != eagerTraces.end()) ? eagerTrace->second : 0.0;
+					Assert::AreEqual(expected, pTraces->innerProduct(pProbe), threshold
+						, L"Lazy decay of the traces doesn't match eager decay");
+					Assert::AreEqual(expected, pTraces->getFactor(index), threshold
+						, L"getFactor() doesn't match eager decay");
+				}
+
+				//the list returned by getFeatures() holds the actual values of the traces, and the traces can keep
+				//decaying after it
+				if (step % 7 == 0)
+				{
+					const FeatureList* pTraceList = pTraces->getFeatures();
+					for (size_t index = 0; index < numIndices; index++)
+					{
+						auto eagerTrace = eagerTraces.find(index);
+						double expected = (eagerTrace != eagerTraces.end()) ? eagerTrace->second : 0.0;
+						Assert::AreEqual(expected, pTraceList->getFactor(index), threshold
+							, L"The features returned by getFeatures() don't match eager decay");
+					}
+				}
+			}
+
+			pTraces->applyThreshold(threshold);
+			for (auto eagerTrace : eagerTraces)
+				Assert::AreEqual(eagerTrace.second, pTraces->getFactor(eagerTrace.first), threshold, L"Wrong traces after renormalization");
+			pTraces->clear();
+			pTraces->update(gamma);
+			pFeatures->clear();
+			pFeatures->add(0, 1.0);
+			pTraces->addFeatureList(pFeatures, 1.0);
+			Assert::AreEqual(1.0, pTraces->innerProduct(pFeatures), 0.0000001, L"The scale of the traces wasn't reset by clear()");
+
+			delete pProbe;
+			delete pFeatures;
+			delete pTraces;
+			delete pApp;
+		}
+
+		TEST_METHOD(ETraces_LazyDecay_Replacing)
+		{
+			checkLazyDecay(true);
+		}
+
+		TEST_METHOD(ETraces_LazyDecay_Accumulating)
+		{
+			checkLazyDecay(false);
+		}
 	};
-}
\ No newline at end of file
+}
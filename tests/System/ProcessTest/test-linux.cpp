@@ -1,4 +1,9 @@
 #include "../../../tools/System/Process.h"
+#include "../../../tools/System/ForkServer.h"
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <chrono>
 #include <thread>
 #include <iostream>
@@ -38,6 +43,45 @@ int main(int argc, char** argv)
 
 	process2.isRunning();
 
+
+
+	cout << "\n\n#### 3rd test: Fork server -> request\n\n";
+
+	const char* socketPath = "/tmp/ProcessTest-fork-server";
+	pid_t serverPid = fork();
+	if (serverPid == 0)
+	{
+		ForkServer server;
+		server.setVerbose(true);
+		server.serve(socketPath, [](int argc, char** argv) { return argc; });
+		return 1;
+	}
+
+	this_thread::sleep_for(chrono::milliseconds(500));
+
+	//only the owner can connect to the server
+	struct stat socketStat;
+	bool bSocketPrivate = stat(socketPath, &socketStat) == 0 && (socketStat.st_mode & 0777) == 0600;
+
+	ForkServer client;
+	const char* args[] = { argv[0], "arg1", "arg2" };
+	int exitCode = client.request(socketPath, 3, args);
+	cout << "Request served. Exit code: " << exitCode << "\n";
+
+	kill(serverPid, SIGTERM);
+	waitpid(serverPid, nullptr, 0);
+
+	if (!bSocketPrivate)
+	{
+		cout << "FAILED: the permissions of the socket aren't 0600\n";
+		return 1;
+	}
+	if (exitCode != 3)
+	{
+		cout << "FAILED: the exit code of the request should be the number of arguments (3)\n";
+		return 1;
+	}
+
 	cout << "Parent process finished\n";
 	return 0;
 }
\ No newline at end of file
@@ -8,6 +8,7 @@ BoundingBox3D::BoundingBox3D()
 
 BoundingBox3D::BoundingBox3D(Point3D min, Point3D max)
 {
+	m_bSet = true;
 	m_min = min;
 	m_max = max;
 }
@@ -17,9 +18,10 @@ void BoundingBox3D::reset()
 	m_min.setX(std::numeric_limits<double>::max());
 	m_min.setY(std::numeric_limits<double>::max());
 	m_min.setZ(std::numeric_limits<double>::max());
-	m_max.setX(std::numeric_limits<double>::min());
-	m_max.setY(std::numeric_limits<double>::min());
-	m_max.setZ(std::numeric_limits<double>::min());
+	m_max.setX(std::numeric_limits<double>::lowest());
+	m_max.setY(std::numeric_limits<double>::lowest());
+	m_max.setZ(std::numeric_limits<double>::lowest());
+	m_bSet = false;
 }
 
 BoundingBox3D::~BoundingBox3D()
@@ -39,6 +41,20 @@ void BoundingBox3D::addPoint(Point3D p)
 	if (p.z() < m_min.z()) m_min.setZ(p.z());
 }
 
+void BoundingBox3D::addBox(const BoundingBox3D& box)
+{
+	if (!box.bSet())
+		return;
+	addPoint(box.min());
+	addPoint(box.max());
+}
+
+bool BoundingBox3D::operator==(const BoundingBox3D& box) const
+{
+	return m_bSet == box.m_bSet
+		&& m_min.x() == box.m_min.x() && m_min.y() == box.m_min.y() && m_min.z() == box.m_min.z()
+		&& m_max.x() == box.m_max.x() && m_max.y() == box.m_max.y() && m_max.z() == box.m_max.z();
+}
 
 const Point3D& BoundingBox3D::min() const { return m_min; }
 const Point3D& BoundingBox3D::max() const { return m_max; }
@@ -14,6 +14,7 @@ public:
 	BoundingBox3D(Point3D min, Point3D max);
 	virtual ~BoundingBox3D();
 	void addPoint(Point3D p);
+	void addBox(const BoundingBox3D& box);
 	void reset();
 
 	const Point3D& min() const;
@@ -27,6 +28,8 @@ public:
 	Point3D getMinMax(unsigned int index) const;
 
 	bool bSet() const { return m_bSet; }
+	bool operator==(const BoundingBox3D& box) const;
+	bool operator!=(const BoundingBox3D& box) const { return !(*this == box); }
 };
 
 class BoundingBox2D
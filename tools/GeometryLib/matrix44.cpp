@@ -120,9 +120,15 @@ void Matrix44::setPerspective(double halfWidth, double halfHeight, double nearPl
 
 BoundingBox3D Matrix44::operator*(const BoundingBox3D& box) const
 {
+	//the eight corners are transformed so that the result still contains the box if the matrix has some rotation
+	if (!box.bSet())
+		return box;
 	BoundingBox3D result;
-	result.setMin((*this)*box.min());
-	result.setMax((*this)*box.max());
+	for (unsigned int corner = 0; corner < 8; corner++)
+	{
+		result.addPoint((*this)*Point3D(box.getMinMax(corner & 1).x(), box.getMinMax((corner >> 1) & 1).y()
+			, box.getMinMax((corner >> 2) & 1).z()));
+	}
 	return result;
 }
 
@@ -12,6 +12,7 @@ void Transform3D::setIdentity()
 	m_translation = Vector3D(0.0, 0.0, 0.0);
 	m_scale = Vector3D(1.0, 1.0, 1.0);
 	m_matrix.setIdentity();
+	++m_version;
 }
 
 double* Transform3D::getOpenGLMatrix()
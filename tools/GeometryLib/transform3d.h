@@ -10,6 +10,7 @@ protected:
 	Quaternion m_rotation;
 	Vector3D m_scale;
 	Matrix44 m_matrix;
+	unsigned int m_version = 0;
 
 	void updateMatrix();
 public:
@@ -29,9 +30,14 @@ public:
 	Vector3D& scale() { return m_scale; }
 	Matrix44 transformMatrix() { updateMatrix(); return m_matrix; }
 
-	void setTranslation(const Vector3D& translation) { m_translation = translation; }
-	void setRotation(const Quaternion& rotation) { m_rotation = rotation; }
-	void setScale(const Vector3D scale) { m_scale = scale; }
+	void setTranslation(const Vector3D& translation) { m_translation = translation; ++m_version; }
+	void setRotation(const Quaternion& rotation) { m_rotation = rotation; ++m_version; }
+	void setScale(const Vector3D scale) { m_scale = scale; ++m_version; }
+
+	//incremented every time the transform is changed by the setters or by a binding (which is given the counter).
+	//Changes made through the non-const accessors aren't counted
+	unsigned int getVersion() const { return m_version; }
+	unsigned int* getVersionCounter() { return &m_version; }
 
 	double* getOpenGLMatrix();
 };
\ No newline at end of file
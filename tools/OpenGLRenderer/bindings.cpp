@@ -73,6 +73,8 @@ template <typename T>
 void BoundObject<T>::update(double value)
 {
 	update(m_obj, value);
+	if (m_pVersion)
+		++(*m_pVersion);
 }
 
 template void BoundObject<Vector3D>::update(double);
@@ -23,6 +23,7 @@ template <typename T>
 class BoundObject: public Bindable
 {
 	T& m_obj;
+	unsigned int* m_pVersion; //if set, it is incremented every time the object is updated
 
 	void update(Vector3D& v, double value);
 	void update(Point3D& p, double value);
@@ -34,8 +35,8 @@ public:
 
 	string internalName;
 
-	BoundObject(T& object, string& name)
-		: m_obj(object), internalName(name) {}
+	BoundObject(T& object, string& name, unsigned int* pVersion = nullptr)
+		: m_obj(object), m_pVersion(pVersion), internalName(name) {}
 	
 	void update(double value);
 };
@@ -49,10 +50,11 @@ public:
 	string externalName;
 
 	template <typename T>
-	Binding(std::string& _externalName, T& obj, std::string& _internalName, double offset= 0.0, double multiplier= 0.0)
+	Binding(std::string& _externalName, T& obj, std::string& _internalName, double offset= 0.0, double multiplier= 0.0
+		, unsigned int* pVersion = nullptr)
 		: m_offset(offset), m_multiplier(multiplier), externalName(_externalName)
 	{
-		boundObjects.push_back(new BoundObject<T>(obj, _internalName));
+		boundObjects.push_back(new BoundObject<T>(obj, _internalName, pVersion));
 	}
 	~Binding();
 	void update(double value);
@@ -5,6 +5,7 @@
 #include "renderer.h"
 #include "texture-manager.h"
 #include "mesh.h"
+#include "mesh-cache.h"
 #include "../GeometryLib/bounding-cylinder.h"
 #include <algorithm>
 #include "../System/FileUtils.h"
@@ -453,7 +454,16 @@ ColladaModel::ColladaModel(tinyxml2::XMLElement* pNode): GraphicObject3D(pNode)
 	string previousTextureFolder= Renderer::get()->getTextureManager()->getFolder();
 	Renderer::get()->getTextureManager()->setFolder(dataFolder + pDir);
 
-	loadFromFile(m_path.c_str());
+	//the meshes are cached the first time the model is loaded
+	string sourceFile = dataFolder + m_path;
+	if (MeshCache::load(sourceFile, m_meshes))
+		Renderer::get()->logMessage("Meshes loaded from the cache of " + sourceFile);
+	else
+	{
+		//a file that couldn't be parsed isn't cached, so that it is parsed again (and the error shown) next time
+		if (loadFromFile(m_path.c_str()) && !m_meshes.empty())
+			MeshCache::save(sourceFile, m_meshes, m_textureFiles);
+	}
 
 	Renderer::get()->getTextureManager()->setFolder(previousTextureFolder);
 
@@ -582,7 +592,7 @@ void ColladaModel::loadSkin(tinyxml2::XMLElement* pRootNode)
 }
 
 
-void ColladaModel::loadFromFile(const char* file)
+bool ColladaModel::loadFromFile(const char* file)
 {
 	tinyxml2::XMLDocument doc;
 
@@ -594,14 +604,21 @@ void ColladaModel::loadFromFile(const char* file)
 	{
 		Renderer::get()->logMessage("File found. Parsing");
 		tinyxml2::XMLElement *pColladaRoot = doc.FirstChildElement(XML_TAG_COLLADA_ROOT);
+		if (!pColladaRoot)
+		{
+			Renderer::get()->logMessage("ERROR: Not a Collada file");
+			return false;
+		}
 
 		loadVisualScenes(pColladaRoot);
 
 		//some collada files link the geometry only via the controller's skin
 		//this is yet one more shortcut to get the geometry loaded
 		loadSkin(pColladaRoot);
+		return true;
 	}
-	else Renderer::get()->logMessage("ERROR: Cound not open Collada file");
+	Renderer::get()->logMessage("ERROR: Cound not open Collada file");
+	return false;
 }
 
 const char* ColladaModel::findTexture(tinyxml2::XMLElement* pRootNode, string textureName)
@@ -677,6 +694,7 @@ int ColladaModel::loadTexture(tinyxml2::XMLElement* pRootNode, tinyxml2::XMLElem
 	if (imageFile != nullptr)
 	{
 		textureId = Renderer::get()->getTextureManager()->loadTexture(imageFile);
+		m_textureFiles[(int)textureId] = imageFile;
 		return (int)textureId;
 	}
 
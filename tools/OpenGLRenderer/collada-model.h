@@ -88,8 +88,11 @@ public:
 class ColladaModel: public GraphicObject3D
 {
 	string m_path;
+	//texture id -> image file, saved in the mesh cache
+	map<int, string> m_textureFiles;
 
-	void loadFromFile(const char* file);
+	//returns false if the file couldn't be opened or parsed
+	bool loadFromFile(const char* file);
 
 	const char* findMaterialFxName(tinyxml2::XMLElement* pRootNode, string fxMaterial);
 	int loadTexture(tinyxml2::XMLElement* pRootNode, tinyxml2::XMLElement* pFxProfile, string textureName);
@@ -0,0 +1,174 @@
+#include "stdafx.h"
+#include "frame-capture.h"
+#include "renderer.h"
+#include <stdexcept>
+
+FrameCapture::FrameCapture(unsigned int width, unsigned int height)
+{
+	m_width = width;
+	m_height = height;
+
+	if (!GLEW_VERSION_2_1 || !GLEW_ARB_framebuffer_object)
+		throw std::runtime_error("Offscreen rendering requires OpenGL 2.1 and ARB_framebuffer_object");
+
+	//render target: color and depth renderbuffers attached to a framebuffer object
+	glGenRenderbuffers(1, &m_colorBufferId);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBufferId);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+	glGenRenderbuffers(1, &m_depthBufferId);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBufferId);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_width, m_height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_frameBufferId);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_frameBufferId);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBufferId);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBufferId);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		throw std::runtime_error("Couldn't create the offscreen framebuffer");
+
+	//pixel buffers used to read frames back asynchronously
+	size_t frameSize = (size_t)m_width * m_height * NUM_CHANNELS;
+	glGenBuffers(NUM_PIXEL_BUFFERS, m_pixelBufferIds);
+	for (unsigned int i = 0; i < NUM_PIXEL_BUFFERS; i++)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBufferIds[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, frameSize, nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_lastFrame = vector<unsigned char>(frameSize, 0);
+
+	m_writerThread = thread(&FrameCapture::writerLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+	flush();
+
+	//the writer saves the frames still in the queue before exiting
+	{
+		lock_guard<mutex> lock(m_queueMutex);
+		m_bExitWriter = true;
+	}
+	m_frameQueued.notify_one();
+	m_writerThread.join();
+
+	glDeleteBuffers(NUM_PIXEL_BUFFERS, m_pixelBufferIds);
+	glDeleteFramebuffers(1, &m_frameBufferId);
+	glDeleteRenderbuffers(1, &m_colorBufferId);
+	glDeleteRenderbuffers(1, &m_depthBufferId);
+}
+
+void FrameCapture::bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_frameBufferId);
+}
+
+void FrameCapture::unbind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void FrameCapture::capture()
+{
+	//start copying the current frame to a pixel buffer. glReadPixels() returns immediately when a PBO is bound
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameBufferId);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBufferIds[m_currentPixelBuffer]);
+	glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	m_bReadPending[m_currentPixelBuffer] = true;
+
+	//meanwhile, the frame requested in the previous call is retrieved from the other pixel buffer, which will be used
+	//in the next call
+	m_currentPixelBuffer = (m_currentPixelBuffer + 1) % NUM_PIXEL_BUFFERS;
+	retrieveFrame(m_currentPixelBuffer);
+}
+
+void FrameCapture::flush()
+{
+	retrieveFrame((m_currentPixelBuffer + 1) % NUM_PIXEL_BUFFERS);
+}
+
+void FrameCapture::retrieveFrame(unsigned int pixelBuffer)
+{
+	if (!m_bReadPending[pixelBuffer])
+		return;
+	m_bReadPending[pixelBuffer] = false;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBufferIds[pixelBuffer]);
+	const unsigned char* pPixels = (const unsigned char*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (!pPixels)
+	{
+		//the frame is skipped: the last frame isn't overwritten and the frame isn't counted, so no frame is saved twice
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		Renderer::get()->logMessage("Warning: couldn't map the pixel buffer of a captured frame. The frame is skipped");
+		return;
+	}
+	//OpenGL returns the bottom row first
+	size_t rowSize = (size_t)m_width * NUM_CHANNELS;
+	for (unsigned int row = 0; row < m_height; row++)
+		memcpy(&m_lastFrame[row * rowSize], pPixels + (m_height - 1 - row) * rowSize, rowSize);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_numFramesCaptured++;
+
+	if (!m_outputPrefix.empty())
+		queueLastFrame();
+}
+
+void FrameCapture::queueLastFrame()
+{
+	char frameIndex[16];
+	snprintf(frameIndex, 16, "%06u", m_numFramesCaptured);
+
+	QueuedFrame frame;
+	frame.filename = m_outputPrefix + "-" + string(frameIndex) + ".bmp";
+	{
+		//take a free buffer, allocate a new one if none is free and the limit hasn't been reached, or wait until the writer
+		//frees one
+		unique_lock<mutex> lock(m_queueMutex);
+		if (m_freeFrameBuffers.empty() && m_numFrameBuffers < MAX_QUEUED_FRAMES)
+		{
+			m_freeFrameBuffers.push_back(vector<unsigned char>(m_lastFrame.size()));
+			m_numFrameBuffers++;
+		}
+		m_frameBufferFreed.wait(lock, [this]() { return !m_freeFrameBuffers.empty(); });
+		frame.pixels.swap(m_freeFrameBuffers.back());
+		m_freeFrameBuffers.pop_back();
+	}
+	memcpy(frame.pixels.data(), m_lastFrame.data(), m_lastFrame.size());
+	{
+		lock_guard<mutex> lock(m_queueMutex);
+		m_queuedFrames.push_back(std::move(frame));
+	}
+	m_frameQueued.notify_one();
+}
+
+void FrameCapture::writerLoop()
+{
+	unique_lock<mutex> lock(m_queueMutex);
+	while (true)
+	{
+		m_frameQueued.wait(lock, [this]() { return m_bExitWriter || !m_queuedFrames.empty(); });
+		if (m_queuedFrames.empty())
+			return; //exit requested and nothing left to save
+
+		QueuedFrame frame = std::move(m_queuedFrames.front());
+		m_queuedFrames.pop_front();
+
+		lock.unlock();
+		if (!SOIL_save_image(frame.filename.c_str(), SOIL_SAVE_TYPE_BMP, m_width, m_height, NUM_CHANNELS, frame.pixels.data()))
+			Renderer::get()->logMessage("Warning: couldn't save captured frame " + frame.filename);
+		lock.lock();
+
+		m_freeFrameBuffers.push_back(std::move(frame.pixels));
+		m_frameBufferFreed.notify_one();
+	}
+}
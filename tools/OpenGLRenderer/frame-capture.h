@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+//Offscreen render target with asynchronous readback. Frames are drawn to a framebuffer object and copied to one of
+//two pixel buffer objects, so that reading a frame back doesn't stall the pipeline: the pixels of frame i are only
+//mapped to main memory once frame i+1 has been requested. Captured frames can be saved as an image sequence. Saving
+//is done by a background thread, so that encoding and writing the images doesn't slow down the simulation
+class FrameCapture
+{
+	unsigned int m_width, m_height;
+
+	unsigned int m_frameBufferId = 0;
+	unsigned int m_colorBufferId = 0;
+	unsigned int m_depthBufferId = 0;
+
+	static const unsigned int NUM_PIXEL_BUFFERS = 2;
+	unsigned int m_pixelBufferIds[NUM_PIXEL_BUFFERS] = { 0, 0 };
+	bool m_bReadPending[NUM_PIXEL_BUFFERS] = { false, false };
+	unsigned int m_currentPixelBuffer = 0;
+
+	static const unsigned int NUM_CHANNELS = 3;
+	vector<unsigned char> m_lastFrame;
+	unsigned int m_numFramesCaptured = 0;
+
+	string m_outputPrefix;
+
+	//frames waiting to be saved by the writer thread. Their pixel buffers are recycled, and no more than
+	//MAX_QUEUED_FRAMES are kept: if the writer falls behind, queueing a frame waits until one has been saved
+	struct QueuedFrame
+	{
+		vector<unsigned char> pixels;
+		string filename;
+	};
+	static const size_t MAX_QUEUED_FRAMES = 8;
+	deque<QueuedFrame> m_queuedFrames;
+	vector<vector<unsigned char>> m_freeFrameBuffers;
+	size_t m_numFrameBuffers = 0;
+	mutex m_queueMutex;
+	condition_variable m_frameQueued;
+	condition_variable m_frameBufferFreed;
+	bool m_bExitWriter = false;
+	thread m_writerThread;
+
+	void retrieveFrame(unsigned int pixelBuffer);
+	void queueLastFrame();
+	void writerLoop();
+public:
+	FrameCapture(unsigned int width, unsigned int height);
+	virtual ~FrameCapture();
+
+	unsigned int getWidth() const { return m_width; }
+	unsigned int getHeight() const { return m_height; }
+
+	//draw calls issued between bind() and unbind() are rendered to the offscreen buffer
+	void bind();
+	void unbind();
+
+	//requests the contents of the offscreen buffer. The frame requested in the previous call is retrieved (and saved if an
+	//output prefix has been set) at this point, while the current one is being copied
+	void capture();
+	//retrieves the last requested frame
+	void flush();
+
+	//if set, every captured frame is saved as <prefix>-<frame-index>.bmp
+	void setOutputPrefix(string prefix) { m_outputPrefix = prefix; }
+
+	//RGB pixels of the last retrieved frame, top row first
+	const vector<unsigned char>& getLastFrame() const { return m_lastFrame; }
+	unsigned int getNumFramesCaptured() const { return m_numFramesCaptured; }
+};
@@ -72,6 +72,25 @@ BoundingBox3D GraphicObject3D::boundingBox()
 	return m_transform.transformMatrix()*m_bb;
 }
 
+BoundingBox3D GraphicObject3D::hierarchyBoundingBox()
+{
+	//children are drawn relative to this object, so their boxes are merged before applying our own transform
+	BoundingBox3D box = m_bb;
+	for (GraphicObject3D* pChild : m_children)
+		box.addBox(pChild->hierarchyBoundingBox());
+
+	return m_transform.transformMatrix()*box;
+}
+
+unsigned int GraphicObject3D::hierarchyVersion() const
+{
+	//all the versions only increase, so the sum changes if any of them does
+	unsigned int version = m_transform.getVersion() + m_boundingBoxVersion;
+	for (GraphicObject3D* pChild : m_children)
+		version += pChild->hierarchyVersion();
+	return version;
+}
+
 
 void GraphicObject3D::draw()
 {
@@ -91,6 +110,7 @@ void GraphicObject3D::updateBoundingBox()
 	m_bb.reset();
 	for (auto it = m_meshes.begin(); it != m_meshes.end(); ++it)
 		(*it)->updateBoundingBox(m_bb);
+	++m_boundingBoxVersion;
 }
 
 void GraphicObject3D::fitToBoundingBox(BoundingBox3D* newBB)
@@ -16,6 +16,7 @@ protected:
 	string m_name;
 	vector<Mesh*> m_meshes;
 	BoundingBox3D m_bb;
+	unsigned int m_boundingBoxVersion = 0;
 
 	vector<GraphicObject3D*> m_children;
 
@@ -38,6 +39,11 @@ public:
 	void draw();
 
 	BoundingBox3D boundingBox();
+	//bounding box of the object and all its children in the parent's coordinates
+	BoundingBox3D hierarchyBoundingBox();
+	//changes whenever the transform or the bounding box of the object or any of its children changes. It is much cheaper
+	//to calculate than the bounding box of the hierarchy
+	unsigned int hierarchyVersion() const;
 
 	void fitToBoundingBox(BoundingBox3D* newBB);
 	void fitToBoundingCylinder(BoundingCylinder* newBC);
@@ -0,0 +1,286 @@
+#include "stdafx.h"
+#include "mesh-cache.h"
+#include "mesh.h"
+#include "material.h"
+#include "renderer.h"
+#include "texture-manager.h"
+#include "../System/MemoryMappedFile.h"
+#include "../System/FileUtils.h"
+#include "../System/CrossPlatform.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#define MESH_CACHE_EXTENSION ".cache"
+#define MESH_CACHE_MAGIC 0x484341434853454DULL //"MESHCACH"
+#define MESH_CACHE_VERSION 1
+
+namespace
+{
+	struct MeshCacheHeader
+	{
+		uint64_t magicNumber = MESH_CACHE_MAGIC;
+		uint64_t version = MESH_CACHE_VERSION;
+		uint64_t sourceSize = 0;
+		int64_t sourceModificationTime = 0;
+		uint64_t sourceHash = 0;
+		uint64_t numMeshes = 0;
+	};
+
+	struct MeshCacheEntry
+	{
+		uint32_t primitiveType;
+		uint32_t numIndicesPerVertex;
+		uint32_t posOffset, normalOffset, texCoordOffset;
+		uint32_t numPositions, numNormals, numTexCoords, numIndices;
+		uint32_t bMaterial;
+		float ambient[4], diffuse[4], specular[4], emission[4];
+		double shininess;
+		uint32_t textureFileLength;
+		uint32_t padding;
+		//followed by the texture file name, the positions and normals (3 doubles each), the texture coordinates
+		//(2 doubles each) and the indices
+	};
+
+	//reads the mapped cache checking that there is enough data left
+	class CacheReader
+	{
+		const char* m_pData;
+		size_t m_size;
+		size_t m_position = 0;
+	public:
+		CacheReader(const char* pData, size_t size) : m_pData(pData), m_size(size) {}
+		const char* read(size_t numBytes)
+		{
+			if (numBytes > m_size - m_position)
+				return nullptr;
+			const char* pData = m_pData + m_position;
+			m_position += numBytes;
+			return pData;
+		}
+	};
+
+	void writeColor(float* pValues, const Color& color)
+	{
+		pValues[0] = color.r(); pValues[1] = color.g(); pValues[2] = color.b(); pValues[3] = color.a();
+	}
+}
+
+string MeshCache::getCacheFile(const string& sourceFile)
+{
+	return sourceFile + MESH_CACHE_EXTENSION;
+}
+
+bool MeshCache::getSourceKey(const string& sourceFile, unsigned long long& size, unsigned long long& hash)
+{
+	MemoryMappedFile source;
+	if (!source.open(sourceFile.c_str()))
+		return false;
+
+	//FNV-1a
+	hash = 14695981039346656037ULL;
+	const unsigned char* pBytes = (const unsigned char*)source.data();
+	for (size_t i = 0; i < source.size(); ++i)
+	{
+		hash ^= pBytes[i];
+		hash *= 1099511628211ULL;
+	}
+	size = source.size();
+	return true;
+}
+
+bool MeshCache::load(const string& sourceFile, vector<Mesh*>& meshes)
+{
+	string cacheFile = getCacheFile(sourceFile);
+	MemoryMappedFile cache;
+	if (!cache.open(cacheFile.c_str()))
+		return false;
+	CacheReader reader(cache.data(), cache.size());
+
+	const MeshCacheHeader* pHeader = (const MeshCacheHeader*)reader.read(sizeof(MeshCacheHeader));
+	if (!pHeader || pHeader->magicNumber != MESH_CACHE_MAGIC || pHeader->version != MESH_CACHE_VERSION)
+		return false;
+
+	//the source file is only hashed if its size is the same but it was modified (or copied) after the cache was saved
+	if ((unsigned long long)getFileSize(sourceFile) != pHeader->sourceSize)
+	{
+		Renderer::get()->logMessage("Mesh cache is outdated: " + cacheFile);
+		return false;
+	}
+	long long modificationTime = getFileModificationTime(sourceFile);
+	bool bModificationTimeChanged = modificationTime != pHeader->sourceModificationTime;
+	if (bModificationTimeChanged)
+	{
+		unsigned long long size, hash;
+		if (!getSourceKey(sourceFile, size, hash) || size != pHeader->sourceSize || hash != pHeader->sourceHash)
+		{
+			Renderer::get()->logMessage("Mesh cache is outdated: " + cacheFile);
+			return false;
+		}
+	}
+
+	vector<Mesh*> cachedMeshes;
+	bool bValid = true;
+	for (uint64_t meshIndex = 0; bValid && meshIndex < pHeader->numMeshes; ++meshIndex)
+	{
+		const MeshCacheEntry* pEntry = (const MeshCacheEntry*)reader.read(sizeof(MeshCacheEntry));
+		const char* pTextureFile = pEntry ? reader.read((pEntry->textureFileLength + 7) & ~7u) : nullptr;
+		const double* pPositions = pEntry ? (const double*)reader.read(pEntry->numPositions * 3 * sizeof(double)) : nullptr;
+		const double* pNormals = pEntry ? (const double*)reader.read(pEntry->numNormals * 3 * sizeof(double)) : nullptr;
+		const double* pTexCoords = pEntry ? (const double*)reader.read(pEntry->numTexCoords * 2 * sizeof(double)) : nullptr;
+		const uint32_t* pIndices = pEntry ? (const uint32_t*)reader.read(((pEntry->numIndices + 1) & ~1u) * sizeof(uint32_t))
+			: nullptr;
+		bValid = pEntry && pTextureFile && pPositions && pNormals && pTexCoords && pIndices;
+		if (!bValid) break;
+
+		Mesh* pMesh = new Mesh();
+		pMesh->setPrimitiveType(pEntry->primitiveType);
+		pMesh->setNumIndicesPerVertex(pEntry->numIndicesPerVertex);
+		pMesh->setPosOffset(pEntry->posOffset);
+		pMesh->setNormalOffset(pEntry->normalOffset);
+		pMesh->setTexCoordOffset(pEntry->texCoordOffset);
+
+		if (pEntry->numPositions > 0) pMesh->allocPositions(pEntry->numPositions);
+		for (unsigned int i = 0; i < pEntry->numPositions; ++i)
+			pMesh->getPosition(i) = Point3D(pPositions[3 * i], pPositions[3 * i + 1], pPositions[3 * i + 2]);
+		if (pEntry->numNormals > 0) pMesh->allocNormals(pEntry->numNormals);
+		for (unsigned int i = 0; i < pEntry->numNormals; ++i)
+			pMesh->getNormal(i) = Vector3D(pNormals[3 * i], pNormals[3 * i + 1], pNormals[3 * i + 2]);
+		if (pEntry->numTexCoords > 0) pMesh->allocTexCoords(pEntry->numTexCoords);
+		for (unsigned int i = 0; i < pEntry->numTexCoords; ++i)
+			pMesh->getTexCoord(i) = Vector2D(pTexCoords[2 * i], pTexCoords[2 * i + 1]);
+		if (pEntry->numIndices > 0)
+		{
+			pMesh->allocIndices(pEntry->numIndices);
+			memcpy(pMesh->getIndexArray(), pIndices, pEntry->numIndices * sizeof(uint32_t));
+		}
+
+		if (pEntry->bMaterial)
+		{
+			SimpleTLMaterial* pMaterial = new SimpleTLMaterial();
+			pMaterial->setAmbient(Color(pEntry->ambient[0], pEntry->ambient[1], pEntry->ambient[2], pEntry->ambient[3]));
+			pMaterial->setDiffuse(Color(pEntry->diffuse[0], pEntry->diffuse[1], pEntry->diffuse[2], pEntry->diffuse[3]));
+			pMaterial->setSpecular(Color(pEntry->specular[0], pEntry->specular[1], pEntry->specular[2], pEntry->specular[3]));
+			pMaterial->setEmission(Color(pEntry->emission[0], pEntry->emission[1], pEntry->emission[2], pEntry->emission[3]));
+			pMaterial->setShininess(pEntry->shininess);
+			if (pEntry->textureFileLength > 0)
+				pMaterial->setTexture((int)Renderer::get()->getTextureManager()
+					->loadTexture(string(pTextureFile, pEntry->textureFileLength)));
+			pMesh->setMaterial(pMaterial);
+		}
+		cachedMeshes.push_back(pMesh);
+	}
+
+	if (!bValid)
+	{
+		for (Mesh* pMesh : cachedMeshes) delete pMesh;
+		Renderer::get()->logMessage("Mesh cache is corrupt: " + cacheFile);
+		return false;
+	}
+	meshes.insert(meshes.end(), cachedMeshes.begin(), cachedMeshes.end());
+
+	//same contents: the new modification time is saved to avoid hashing the source file again
+	if (bModificationTimeChanged)
+	{
+		MeshCacheHeader updatedHeader = *pHeader;
+		updatedHeader.sourceModificationTime = modificationTime;
+		cache.close();
+
+		FILE* pFile = nullptr;
+		CrossPlatform::Fopen_s(&pFile, cacheFile.c_str(), "r+b");
+		if (pFile)
+		{
+			fwrite(&updatedHeader, sizeof(updatedHeader), 1, pFile);
+			fclose(pFile);
+		}
+	}
+	return true;
+}
+
+bool MeshCache::save(const string& sourceFile, const vector<Mesh*>& meshes, const map<int, string>& textureFiles)
+{
+	MeshCacheHeader header;
+	unsigned long long size, hash;
+	if (!getSourceKey(sourceFile, size, hash))
+		return false;
+	header.sourceSize = size;
+	header.sourceHash = hash;
+	header.sourceModificationTime = getFileModificationTime(sourceFile);
+	header.numMeshes = meshes.size();
+
+	//the cache is written to a temporary file first, so that an interrupted write never leaves a corrupt cache
+	string cacheFile = getCacheFile(sourceFile);
+	string tempFile = cacheFile + ".tmp";
+	FILE* pFile = nullptr;
+	CrossPlatform::Fopen_s(&pFile, tempFile.c_str(), "wb");
+	if (!pFile)
+		return false;
+
+	const char zeros[8] = { 0 };
+	fwrite(&header, sizeof(header), 1, pFile);
+	for (Mesh* pMesh : meshes)
+	{
+		MeshCacheEntry entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.primitiveType = pMesh->getPrimitiveType();
+		entry.numIndicesPerVertex = pMesh->getNumIndicesPerVertex();
+		entry.posOffset = pMesh->getPosOffset();
+		entry.normalOffset = pMesh->getNormalOffset();
+		entry.texCoordOffset = pMesh->getTexCoordOffset();
+		entry.numPositions = pMesh->getNumPositions();
+		entry.numNormals = pMesh->getNumNormals();
+		entry.numTexCoords = pMesh->getNumTexCoords();
+		entry.numIndices = (uint32_t)pMesh->getNumIndices();
+
+		string textureFile;
+		SimpleTLMaterial* pMaterial = dynamic_cast<SimpleTLMaterial*>(pMesh->getMaterial());
+		if (pMaterial)
+		{
+			entry.bMaterial = 1;
+			writeColor(entry.ambient, pMaterial->getAmbient());
+			writeColor(entry.diffuse, pMaterial->getDiffuse());
+			writeColor(entry.specular, pMaterial->getSpecular());
+			writeColor(entry.emission, pMaterial->getEmission());
+			entry.shininess = pMaterial->getShininess();
+			auto texture = textureFiles.find(pMaterial->getTexture());
+			if (texture != textureFiles.end())
+				textureFile = texture->second;
+		}
+		else if (pMesh->getMaterial() != nullptr)
+		{
+			//only the materials loaded from Collada files can be cached
+			fclose(pFile);
+			remove(tempFile.c_str());
+			return false;
+		}
+		entry.textureFileLength = (uint32_t)textureFile.size();
+		fwrite(&entry, sizeof(entry), 1, pFile);
+		fwrite(textureFile.data(), 1, textureFile.size(), pFile);
+		fwrite(zeros, 1, ((textureFile.size() + 7) & ~7u) - textureFile.size(), pFile);
+
+		vector<double> values;
+		for (unsigned int i = 0; i < pMesh->getNumPositions(); ++i)
+			values.insert(values.end(), { pMesh->getPosition(i).x(), pMesh->getPosition(i).y(), pMesh->getPosition(i).z() });
+		for (unsigned int i = 0; i < pMesh->getNumNormals(); ++i)
+			values.insert(values.end(), { pMesh->getNormal(i).x(), pMesh->getNormal(i).y(), pMesh->getNormal(i).z() });
+		for (unsigned int i = 0; i < pMesh->getNumTexCoords(); ++i)
+			values.insert(values.end(), { pMesh->getTexCoord(i).x(), pMesh->getTexCoord(i).y() });
+		fwrite(values.data(), sizeof(double), values.size(), pFile);
+
+		//indices are padded to keep the next mesh aligned
+		fwrite(pMesh->getIndexArray(), sizeof(uint32_t), entry.numIndices, pFile);
+		if (entry.numIndices % 2 != 0)
+			fwrite(zeros, sizeof(uint32_t), 1, pFile);
+	}
+	bool bWritten = !ferror(pFile);
+	bWritten = (fclose(pFile) == 0) && bWritten;
+
+	remove(cacheFile.c_str());
+	if (!bWritten || rename(tempFile.c_str(), cacheFile.c_str()) != 0)
+	{
+		remove(tempFile.c_str());
+		return false;
+	}
+	Renderer::get()->logMessage("Mesh cache saved: " + cacheFile);
+	return true;
+}
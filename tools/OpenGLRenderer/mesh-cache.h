@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+using namespace std;
+class Mesh;
+
+//Binary cache of the meshes (geometry and materials) loaded from a model file, saved next to it. Parsing large Collada
+//files is slow, so the meshes are saved once they have been loaded and the cache is memory-mapped the next time the
+//model is loaded. The cache is only used if it was saved from the same version of the source file: same size and either
+//the same modification time or the same hash of its contents
+class MeshCache
+{
+	static string getCacheFile(const string& sourceFile);
+	static bool getSourceKey(const string& sourceFile, unsigned long long& size, unsigned long long& hash);
+public:
+	//returns false if there is no valid cache of the source file. Textures are loaded from the texture manager's folder
+	static bool load(const string& sourceFile, vector<Mesh*>& meshes);
+
+	//textureFiles: texture id -> file name passed to the texture manager
+	static bool save(const string& sourceFile, const vector<Mesh*>& meshes, const map<int, string>& textureFiles);
+};
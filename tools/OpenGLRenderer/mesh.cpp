@@ -4,6 +4,146 @@
 #include "xml-load.h"
 #include "material.h"
 #include <algorithm>
+#include <map>
+#include <array>
+#include <tuple>
+
+namespace
+{
+	//FNV-1a hash of the geometry, used to find meshes that can share their buffers
+	unsigned long long hashGeometry(const vector<float>& vertices, const vector<unsigned int>& indices)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		auto hashBytes = [&hash](const unsigned char* pBytes, size_t numBytes)
+		{
+			for (size_t i = 0; i < numBytes; ++i)
+			{
+				hash ^= pBytes[i];
+				hash *= 1099511628211ULL;
+			}
+		};
+		hashBytes((const unsigned char*)vertices.data(), vertices.size() * sizeof(float));
+		hashBytes((const unsigned char*)indices.data(), indices.size() * sizeof(unsigned int));
+		return hash;
+	}
+
+	//hash of the geometry, number of vertex components, number of indices, normals and texture coordinates. Different
+	//geometries with the same key are kept in the same list
+	using GeometryKey = tuple<unsigned long long, size_t, size_t, bool, bool>;
+	map<GeometryKey, vector<weak_ptr<MeshBuffers>>> sharedMeshBuffers;
+
+	//removes the buffers no mesh uses anymore
+	void removeExpiredMeshBuffers()
+	{
+		for (auto it = sharedMeshBuffers.begin(); it != sharedMeshBuffers.end();)
+		{
+			vector<weak_ptr<MeshBuffers>>& buffers = it->second;
+			buffers.erase(remove_if(buffers.begin(), buffers.end()
+				, [](const weak_ptr<MeshBuffers>& pBuffers) { return pBuffers.expired(); }), buffers.end());
+			if (buffers.empty())
+				it = sharedMeshBuffers.erase(it);
+			else
+				++it;
+		}
+	}
+}
+
+MeshBuffers::MeshBuffers(const vector<float>& vertices, const vector<unsigned int>& indices, bool bNormals, bool bTexCoords)
+{
+	m_bNormals = bNormals;
+	m_bTexCoords = bTexCoords;
+	m_numVertexComponents = (unsigned int)vertices.size();
+	m_numIndices = (unsigned int)indices.size();
+
+	glGenBuffers(1, &m_vertexBufferId);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenBuffers(1, &m_indexBufferId);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferId);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+MeshBuffers::~MeshBuffers()
+{
+	glDeleteBuffers(1, &m_vertexBufferId);
+	glDeleteBuffers(1, &m_indexBufferId);
+}
+
+bool MeshBuffers::hasGeometry(const vector<float>& vertices, const vector<unsigned int>& indices) const
+{
+	if (vertices.size() != m_numVertexComponents || indices.size() != m_numIndices)
+		return false;
+
+	vector<float> bufferVertices(vertices.size());
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(float), bufferVertices.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	if (bufferVertices != vertices)
+		return false;
+
+	vector<unsigned int> bufferIndices(indices.size());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferId);
+	glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(unsigned int), bufferIndices.data());
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	return bufferIndices == indices;
+}
+
+shared_ptr<MeshBuffers> MeshBuffers::getInstance(const vector<float>& vertices, const vector<unsigned int>& indices
+	, bool bNormals, bool bTexCoords)
+{
+	GeometryKey key(hashGeometry(vertices, indices), vertices.size(), indices.size(), bNormals, bTexCoords);
+	auto it = sharedMeshBuffers.find(key);
+	if (it != sharedMeshBuffers.end())
+	{
+		for (const weak_ptr<MeshBuffers>& sharedBuffers : it->second)
+		{
+			shared_ptr<MeshBuffers> pBuffers = sharedBuffers.lock();
+			if (pBuffers && pBuffers->hasGeometry(vertices, indices))
+				return pBuffers;
+		}
+	}
+
+	//new buffers are only created while the scene is loaded, so the whole map can be cleaned up now
+	removeExpiredMeshBuffers();
+
+	shared_ptr<MeshBuffers> pBuffers = shared_ptr<MeshBuffers>(new MeshBuffers(vertices, indices, bNormals, bTexCoords));
+	sharedMeshBuffers[key].push_back(pBuffers);
+	return pBuffers;
+}
+
+void MeshBuffers::draw(unsigned int primitiveType)
+{
+	GLsizei stride = (GLsizei)((3 + (m_bNormals ? 3 : 0) + (m_bTexCoords ? 2 : 0)) * sizeof(float));
+	size_t offset = 3 * sizeof(float);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferId);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, stride, (const void*)0);
+	if (m_bNormals)
+	{
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glNormalPointer(GL_FLOAT, stride, (const void*)offset);
+		offset += 3 * sizeof(float);
+	}
+	if (m_bTexCoords)
+	{
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, stride, (const void*)offset);
+	}
+
+	glDrawElements(primitiveType, m_numIndices, GL_UNSIGNED_INT, (const void*)0);
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
 
 Mesh::Mesh()
 {
@@ -34,6 +174,15 @@ void Mesh::draw()
 	if (m_pMaterial)
 		m_pMaterial->set();
 
+	if (!m_bBuffersUploaded)
+		uploadBuffers();
+	if (m_pBuffers)
+	{
+		m_pBuffers->draw(m_primitiveType);
+		return;
+	}
+
+	//immediate mode if vertex buffer objects are not available
 	glBegin(m_primitiveType);
 
 	for (unsigned int i = 0; i<m_numIndices; i+=m_numIndicesPerVertex)
@@ -54,6 +203,54 @@ void Mesh::draw()
 	glEnd();
 }
 
+void Mesh::uploadBuffers()
+{
+	m_bBuffersUploaded = true;
+	if (!GLEW_VERSION_1_5 || m_numIndices == 0)
+		return;
+
+	bool bNormals = m_pNormals != nullptr;
+	bool bTexCoords = m_pTexCoords != nullptr;
+
+	//vertices may use different indices for each attribute, so each distinct combination becomes a vertex of the
+	//interleaved buffer
+	map<array<unsigned int, 3>, unsigned int> vertexIds;
+	vector<float> vertices;
+	vector<unsigned int> indices;
+	indices.reserve(m_numIndices / m_numIndicesPerVertex);
+	for (unsigned int i = 0; i < m_numIndices; i += m_numIndicesPerVertex)
+	{
+		array<unsigned int, 3> vertex = { m_pIndices[i + m_posOffset]
+			, bNormals ? m_pIndices[i + m_normalOffset] : 0
+			, bTexCoords ? m_pIndices[i + m_texCoordOffset] : 0 };
+
+		auto it = vertexIds.find(vertex);
+		if (it != vertexIds.end())
+		{
+			indices.push_back(it->second);
+			continue;
+		}
+		unsigned int vertexId = (unsigned int)vertexIds.size();
+		vertexIds[vertex] = vertexId;
+		indices.push_back(vertexId);
+
+		const Point3D& position = m_pPositions[vertex[0]];
+		vertices.insert(vertices.end(), { (float)position.x(), (float)position.y(), (float)position.z() });
+		if (bNormals)
+		{
+			const Vector3D& normal = m_pNormals[vertex[1]];
+			vertices.insert(vertices.end(), { (float)normal.x(), (float)normal.y(), (float)normal.z() });
+		}
+		if (bTexCoords)
+		{
+			const Vector2D& texCoord = m_pTexCoords[vertex[2]];
+			vertices.insert(vertices.end(), { (float)texCoord.s(), (float)texCoord.t() });
+		}
+	}
+
+	m_pBuffers = MeshBuffers::getInstance(vertices, indices, bNormals, bTexCoords);
+}
+
 void Mesh::updateBoundingBox(BoundingBox3D& bb)
 {
 	for (unsigned int i = 0; i < m_numPositions; ++i)
@@ -62,6 +259,7 @@ void Mesh::updateBoundingBox(BoundingBox3D& bb)
 
 void Mesh::transformVertices(Vector3D& translation, Vector3D& scale)
 {
+	invalidateBuffers();
 	// transform vertices
 	for (unsigned int i= 0; i<m_numPositions; ++i)
 	{
@@ -72,6 +270,7 @@ void Mesh::transformVertices(Vector3D& translation, Vector3D& scale)
 
 void Mesh::flipYZAxis()
 {
+	invalidateBuffers();
 	double tmp;
 	// transform vertices
 	for (unsigned int i = 0; i<m_numPositions; ++i)
@@ -91,12 +290,14 @@ void Mesh::flipYZAxis()
 
 void Mesh::flipVTexCoord()
 {
+	invalidateBuffers();
 	for (unsigned int i = 0; i < m_numTexCoords; ++i)
 		m_pTexCoords[i].setY(1.0 - m_pTexCoords[i].t());
 }
 
 void Mesh::reorderIndices()
 {
+	invalidateBuffers();
 	int tmp;
 	for (unsigned int i = 0; i < m_numIndices/(3*m_numIndicesPerVertex); i+=3*m_numIndicesPerVertex)
 	{
@@ -9,8 +9,33 @@ class ColladaModel;
 class Geometry;
 namespace tinyxml2 { class XMLElement; }
 #include <string>
+#include <vector>
+#include <memory>
 using namespace std;
 
+//Interleaved vertex buffer and index buffer objects holding the geometry of a mesh in GPU memory. Meshes with
+//identical geometry (i.e., several instances of the same model or shape) share the same buffers. Candidates are found
+//by a 64-bit hash of the data and its sizes, and then compared with the contents of the buffers, read back from the GPU,
+//so no copy of the data is kept in main memory and a collision of the hashes never makes two meshes share their buffers
+class MeshBuffers
+{
+	unsigned int m_vertexBufferId = 0;
+	unsigned int m_indexBufferId = 0;
+	unsigned int m_numVertexComponents = 0;
+	unsigned int m_numIndices = 0;
+	bool m_bNormals, m_bTexCoords;
+
+	MeshBuffers(const vector<float>& vertices, const vector<unsigned int>& indices, bool bNormals, bool bTexCoords);
+	bool hasGeometry(const vector<float>& vertices, const vector<unsigned int>& indices) const;
+public:
+	virtual ~MeshBuffers();
+
+	static shared_ptr<MeshBuffers> getInstance(const vector<float>& vertices, const vector<unsigned int>& indices
+		, bool bNormals, bool bTexCoords);
+
+	void draw(unsigned int primitiveType);
+};
+
 
 class Mesh
 {
@@ -35,6 +60,12 @@ class Mesh
 	//material
 	Material* m_pMaterial = 0;
 
+	//GPU copy of the geometry, uploaded the first time the mesh is drawn. Modifying the vertices afterwards requires
+	//calling invalidateBuffers()
+	shared_ptr<MeshBuffers> m_pBuffers;
+	bool m_bBuffersUploaded = false;
+	void uploadBuffers();
+
 public:
 	Mesh();
 	~Mesh();
@@ -42,6 +73,7 @@ public:
 	void draw();
 
 	void setMaterial(Material* pMaterial) { m_pMaterial = pMaterial; }
+	Material* getMaterial() { return m_pMaterial; }
 	void updateBoundingBox(BoundingBox3D& bb);
 	void transformVertices(Vector3D& translation, Vector3D& scale);
 
@@ -65,13 +97,20 @@ public:
 	void setNormalOffset(unsigned int offset) { m_normalOffset = offset; }
 	void setTexCoordOffset(unsigned int offset) { m_texCoordOffset = offset; }
 	void setNumIndicesPerVertex(unsigned int numIndices) { m_numIndicesPerVertex = numIndices; }
+	unsigned int getPosOffset() const { return m_posOffset; }
+	unsigned int getNormalOffset() const { return m_normalOffset; }
+	unsigned int getTexCoordOffset() const { return m_texCoordOffset; }
+	unsigned int getNumIndicesPerVertex() const { return m_numIndicesPerVertex; }
 	unsigned int* getIndexArray() { return m_pIndices; }
 	void setNumIndices(unsigned int actualNum) { if (actualNum < m_numIndices) m_numIndices = actualNum; }
 	int getNumIndices() const { return m_numIndices; }
 
+	void invalidateBuffers() { m_pBuffers.reset(); m_bBuffersUploaded = false; }
+
 	void flipYZAxis();
 	void flipVTexCoord();
 	void reorderIndices();
 
 	void setPrimitiveType(unsigned int type) { m_primitiveType = type; }
+	unsigned int getPrimitiveType() const { return m_primitiveType; }
 };
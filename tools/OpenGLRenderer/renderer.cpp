@@ -7,9 +7,12 @@
 #include "camera.h"
 #include "light.h"
 #include "xml-load.h"
+#include "frame-capture.h"
+#include "text-renderer.h"
 #include "../GeometryLib/bounding-box.h"
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 using namespace tinyxml2;
 using namespace std;
@@ -22,6 +25,7 @@ Renderer::Renderer()
 	m_timer.start();
 
 	m_pTextureManager = new TextureManager();
+	m_pTextRenderer = new TextRenderer();
 	m_pActiveCamera = 0;
 }
 
@@ -41,6 +45,13 @@ Renderer::~Renderer()
 	for (auto viewport : m_viewPorts) delete viewport;
 	logMessage("Renderer::~Renderer(): texture manager");
 	delete m_pTextureManager;
+	logMessage("Renderer::~Renderer(): text renderer");
+	delete m_pTextRenderer;
+	if (m_pFrameCapture)
+	{
+		logMessage("Renderer::~Renderer(): frame capture");
+		delete m_pFrameCapture;
+	}
 	m_pInstance = nullptr;
 }
 
@@ -65,7 +76,7 @@ void Renderer::_reshapeWindow(int width, int height)
 	Renderer::get()->reshapeWindow(width, height);
 }
 
-void Renderer::init(int argc, char** argv, int screenWidth, int screenHeight)
+void Renderer::init(int argc, char** argv, int screenWidth, int screenHeight, bool bOffscreen)
 {
 	//init window and OpenGL context
 	glutInit(&argc, argv);
@@ -73,6 +84,20 @@ void Renderer::init(int argc, char** argv, int screenWidth, int screenHeight)
 	glutInitWindowSize(screenWidth, screenHeight);
 	glutCreateWindow(argv[0]);
 
+	//GLEW gives access to vertex buffer objects (if they are not available, meshes are drawn in immediate mode)
+	glewExperimental = GL_TRUE;
+	bool bGlewInitialized = (glewInit() == GLEW_OK);
+
+	m_bOffscreen = bOffscreen;
+	if (m_bOffscreen)
+	{
+		//the window is only needed to own the OpenGL context: everything is drawn to an offscreen framebuffer
+		glutHideWindow();
+		if (!bGlewInitialized)
+			throw std::runtime_error("Couldn't initialize GLEW, required for offscreen rendering");
+		m_pFrameCapture = new FrameCapture(screenWidth, screenHeight);
+	}
+
 	//set the size of the window before creating the viewport
 	m_windowWidth = screenWidth;
 	m_windowHeight = screenHeight;
@@ -285,10 +310,32 @@ void Renderer::loadSceneObjects(tinyxml2::XMLElement* pNode)
 	m_pDefaultViewPort->addLights(m_lights);
 }
 
+void Renderer::setFrameCaptureOutputPrefix(string prefix)
+{
+	if (m_pFrameCapture)
+		m_pFrameCapture->setOutputPrefix(prefix);
+	else
+		logMessage("Warning: frames can only be captured in offscreen mode");
+}
+
 void Renderer::draw()
 {
-	glutPostRedisplay();
-	glutSwapBuffers();
+	if ((m_numDrawRequests++) % m_frameDecimation != 0)
+		return;
+
+	if (m_bOffscreen)
+	{
+		//no need to wait for the window: draw straight to the framebuffer and request an asynchronous readback
+		m_pFrameCapture->bind();
+		drawViewPorts();
+		m_pFrameCapture->unbind();
+		m_pFrameCapture->capture();
+	}
+	else
+	{
+		glutPostRedisplay();
+		glutSwapBuffers();
+	}
 	updateFPS();
 }
 
@@ -322,6 +369,7 @@ void Renderer::drawViewPorts()
 	{
 		m_num3DObjectsDrawn+= pViewPort->draw();
 	}
+	m_pTextRenderer->draw(m_windowWidth, m_windowHeight);
 }
 
 void Renderer::reshapeWindow(int w,int h)
@@ -16,6 +16,8 @@ class Camera;
 class Light;
 class BoundingBox3D;
 class BoundingBox2D;
+class FrameCapture;
+class TextRenderer;
 
 
 class Renderer
@@ -54,6 +56,15 @@ class Renderer
 	vector<ViewPort*> m_viewPorts;
 
 	bool m_bVerbose = false;
+
+	//offscreen mode: the window is hidden and frames are drawn to m_pFrameCapture's framebuffer
+	bool m_bOffscreen = false;
+	FrameCapture* m_pFrameCapture = nullptr;
+	unsigned int m_frameDecimation = 1;
+	unsigned int m_numDrawRequests = 0;
+
+	//text drawn in a frame is batched and drawn after all the viewports
+	TextRenderer* m_pTextRenderer;
 	
 public:
 	Renderer();
@@ -74,12 +85,25 @@ public:
 
 	void draw();
 
-	void init(int argc, char** argv, int sizeX, int sizeY);
+	void init(int argc, char** argv, int sizeX, int sizeY, bool bOffscreen = false);
+
+	//Offscreen rendering/frame capture
+	bool isOffscreen() const { return m_bOffscreen; }
+	//only one of every frameDecimation calls to draw() will actually render a frame
+	void setFrameDecimation(unsigned int frameDecimation) { m_frameDecimation = frameDecimation > 0 ? frameDecimation : 1; }
+	//whether the next call to draw() will render a frame. Frames that won't be rendered can be skipped with skipFrame()
+	//instead, without updating the scene
+	bool isFrameDue() const { return m_numDrawRequests % m_frameDecimation == 0; }
+	void skipFrame() { ++m_numDrawRequests; }
+	//rendered frames are saved as <prefix>-<frame-index>.bmp. Requires offscreen mode
+	void setFrameCaptureOutputPrefix(string prefix);
+	FrameCapture* getFrameCapture() { return m_pFrameCapture; }
 
 	//Access to the renderer instance
 	static Renderer* get();
 
 	TextureManager* getTextureManager();
+	TextRenderer* getTextRenderer() { return m_pTextRenderer; }
 
 	//View ports
 	ViewPort* getDefaultViewPort() { return m_pDefaultViewPort; }
@@ -105,21 +129,23 @@ public:
 	void drawBoundingBoxes(bool enable, ViewPort* pViewPort = nullptr);
 
 	//Bindings
-	//this is called by Bindable objects at initialization time
+	//this is called by Bindable objects at initialization time. If pVersion is given, it is incremented every time the
+	//binding updates the object
 	template <typename T>
-	void registerBinding(string externalName, T& obj, string internalName, double offset = 0.0, double multiplier = 1.0)
+	void registerBinding(string externalName, T& obj, string internalName, double offset = 0.0, double multiplier = 1.0
+		, unsigned int* pVersion = nullptr)
 	{
 		Binding* pBinding = getBinding(externalName);
 		if (pBinding == nullptr)
 		{
 			//No binding registered yet for the external name (i.e, the state variable's name)
 			//For now, only the first bound object is allowed to set the offset/multiplier
-			pBinding = new Binding(externalName, obj, internalName, offset, multiplier);
+			pBinding = new Binding(externalName, obj, internalName, offset, multiplier, pVersion);
 		}
 		else
 		{
 			//we simply add the new bound object
-			pBinding->addBoundObject(new BoundObject<T>(obj, internalName));
+			pBinding->addBoundObject(new BoundObject<T>(obj, internalName, pVersion));
 		}
 		m_bindings.push_back(pBinding);
 	}
@@ -0,0 +1,167 @@
+#include "stdafx.h"
+#include "scene-bvh.h"
+#include "graphic-object-3d.h"
+#include "../GeometryLib/frustum.h"
+#include <algorithm>
+
+namespace
+{
+	double coordinate(const Point3D& p, int axis)
+	{
+		if (axis == 0) return p.x();
+		if (axis == 1) return p.y();
+		return p.z();
+	}
+}
+
+void SceneBVH::add(GraphicObject3D* pObject)
+{
+	m_objects.push_back(pObject);
+	m_objectBoxes.push_back(BoundingBox3D());
+	m_objectVersions.push_back(0);
+	m_objectLeaves.push_back(-1);
+	m_bRebuild = true;
+}
+
+void SceneBVH::rebuild()
+{
+	m_nodes.clear();
+	m_unboundedObjects.clear();
+	m_root = -1;
+
+	vector<int> boundedObjects;
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		m_objectBoxes[i] = m_objects[i]->hierarchyBoundingBox();
+		m_objectVersions[i] = m_objects[i]->hierarchyVersion();
+		m_objectLeaves[i] = -1;
+		if (m_objectBoxes[i].bSet())
+			boundedObjects.push_back((int)i);
+		else
+			m_unboundedObjects.push_back((int)i);
+	}
+
+	if (!boundedObjects.empty())
+	{
+		m_nodes.reserve(2 * boundedObjects.size() - 1);
+		m_root = build(boundedObjects, 0, boundedObjects.size(), -1);
+	}
+	m_bRebuild = false;
+}
+
+int SceneBVH::build(vector<int>& objects, size_t first, size_t last, int parent)
+{
+	int nodeIndex = (int)m_nodes.size();
+	m_nodes.push_back(Node());
+	m_nodes[nodeIndex].parent = parent;
+
+	if (last - first == 1)
+	{
+		m_nodes[nodeIndex].object = objects[first];
+		m_nodes[nodeIndex].box = m_objectBoxes[objects[first]];
+		m_objectLeaves[objects[first]] = nodeIndex;
+		return nodeIndex;
+	}
+
+	//split along the longest axis of the box containing the centers of the objects
+	BoundingBox3D centers;
+	for (size_t i = first; i < last; i++)
+		centers.addPoint(m_objectBoxes[objects[i]].center());
+	Point3D extent = centers.size();
+	int axis = 0;
+	if (extent.y() > coordinate(extent, axis)) axis = 1;
+	if (extent.z() > coordinate(extent, axis)) axis = 2;
+
+	size_t middle = first + (last - first) / 2;
+	nth_element(objects.begin() + first, objects.begin() + middle, objects.begin() + last
+		, [this, axis](int a, int b)
+	{
+		return coordinate(m_objectBoxes[a].center(), axis) < coordinate(m_objectBoxes[b].center(), axis);
+	});
+
+	//m_nodes may be reallocated by the recursive calls, so the node is accessed by index
+	int left = build(objects, first, middle, nodeIndex);
+	int right = build(objects, middle, last, nodeIndex);
+	m_nodes[nodeIndex].left = left;
+	m_nodes[nodeIndex].right = right;
+	m_nodes[nodeIndex].box = m_nodes[left].box;
+	m_nodes[nodeIndex].box.addBox(m_nodes[right].box);
+	return nodeIndex;
+}
+
+void SceneBVH::refit(int node)
+{
+	while (node >= 0)
+	{
+		Node& current = m_nodes[node];
+		BoundingBox3D box = m_nodes[current.left].box;
+		box.addBox(m_nodes[current.right].box);
+		if (box == current.box)
+			return; //the ancestors already contain the new box
+		current.box = box;
+		node = current.parent;
+	}
+}
+
+size_t SceneBVH::update()
+{
+	if (m_bRebuild)
+	{
+		rebuild();
+		return m_objects.size();
+	}
+
+	size_t numUpdatedObjects = 0;
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		//only the boxes of the objects that have been moved are calculated
+		unsigned int version = m_objects[i]->hierarchyVersion();
+		if (version == m_objectVersions[i])
+			continue;
+		m_objectVersions[i] = version;
+		++numUpdatedObjects;
+
+		BoundingBox3D box = m_objects[i]->hierarchyBoundingBox();
+		if (box == m_objectBoxes[i])
+			continue;
+
+		//objects that gain or lose their bounding box change the structure of the tree
+		if (box.bSet() != m_objectBoxes[i].bSet())
+		{
+			rebuild();
+			return m_objects.size();
+		}
+
+		m_objectBoxes[i] = box;
+		int leaf = m_objectLeaves[i];
+		m_nodes[leaf].box = box;
+		refit(m_nodes[leaf].parent);
+	}
+	return numUpdatedObjects;
+}
+
+void SceneBVH::cull(int node, const Frustum& frustum, vector<bool>& visible) const
+{
+	const Node& current = m_nodes[node];
+	if (!frustum.isVisible(current.box))
+		return;
+
+	if (current.object >= 0)
+	{
+		visible[current.object] = true;
+		return;
+	}
+	cull(current.left, frustum, visible);
+	cull(current.right, frustum, visible);
+}
+
+void SceneBVH::getVisibleObjects(const Frustum& frustum, vector<bool>& visible) const
+{
+	visible.assign(m_objects.size(), false);
+
+	for (int object : m_unboundedObjects)
+		visible[object] = true;
+
+	if (m_root >= 0)
+		cull(m_root, frustum, visible);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include "../GeometryLib/bounding-box.h"
+using namespace std;
+
+class GraphicObject3D;
+class Frustum;
+
+//Bounding volume hierarchy over the 3D objects of a viewport, used to discard whole groups of objects that lie outside
+//the view frustum. The tree is built top-down splitting objects by the median of their centers along the longest axis.
+//Objects moved by bindings or by the transform setters are detected in update() through the version of their
+//hierarchy, and only the boxes on the path from their leaf to the root are refitted: the tree is only rebuilt when
+//objects are added
+class SceneBVH
+{
+	struct Node
+	{
+		BoundingBox3D box;
+		int parent = -1;
+		int left = -1;
+		int right = -1;
+		int object = -1; //index of the object in m_objects if this is a leaf, -1 otherwise
+	};
+
+	vector<GraphicObject3D*> m_objects;
+	vector<BoundingBox3D> m_objectBoxes;
+	vector<unsigned int> m_objectVersions;
+	vector<int> m_objectLeaves;
+	//objects without a bounding box can't be culled, so they are always considered visible
+	vector<int> m_unboundedObjects;
+
+	vector<Node> m_nodes;
+	int m_root = -1;
+	bool m_bRebuild = false;
+
+	void rebuild();
+	int build(vector<int>& objects, size_t first, size_t last, int parent);
+	void refit(int node);
+	void cull(int node, const Frustum& frustum, vector<bool>& visible) const;
+public:
+	SceneBVH() = default;
+	virtual ~SceneBVH() = default;
+
+	void add(GraphicObject3D* pObject);
+	size_t size() const { return m_objects.size(); }
+
+	//refits the boxes of the objects that moved since the last call (or rebuilds the tree if objects were added).
+	//Returns the number of objects whose bounding boxes had to be calculated
+	size_t update();
+
+	//visible[i] is set to true if the i-th added object may be visible
+	void getVisibleObjects(const Frustum& frustum, vector<bool>& visible) const;
+};
@@ -0,0 +1,243 @@
+#include "stdafx.h"
+#include "text-renderer.h"
+#include "color.h"
+#include "renderer.h"
+#include <cmath>
+
+//GLUT's Helvetica 10: glyphs are drawn 3 pixels below the raster position
+#define FONT GLUT_BITMAP_HELVETICA_10
+#define FONT_DESCENT 3
+
+#define NUM_FLOATS_PER_VERTEX 7
+
+TextRenderer::TextRenderer()
+{
+	for (int i = 0; i < NUM_GLYPHS; i++)
+		m_glyphWidths[i] = 0;
+}
+
+TextRenderer::~TextRenderer()
+{
+	if (m_atlasTextureId)
+		glDeleteTextures(1, &m_atlasTextureId);
+	if (m_vertexBufferId)
+		glDeleteBuffers(1, &m_vertexBufferId);
+}
+
+bool TextRenderer::isAvailable()
+{
+	if (!m_bInitialized)
+		init();
+	return m_bAvailable;
+}
+
+void TextRenderer::init()
+{
+	m_bInitialized = true;
+	if (!GLEW_VERSION_2_1 || !GLEW_ARB_framebuffer_object)
+	{
+		Renderer::get()->logMessage("Warning: text will be drawn with glutBitmapString(). Batched text rendering requires OpenGL 2.1 and ARB_framebuffer_object");
+		return;
+	}
+
+	//every glyph gets a cell of the same size in the atlas
+	m_fontHeight = glutBitmapHeight(FONT);
+	int maxGlyphWidth = 0;
+	for (int i = 0; i < NUM_GLYPHS; i++)
+	{
+		m_glyphWidths[i] = glutBitmapWidth(FONT, i);
+		if (m_glyphWidths[i] > maxGlyphWidth) maxGlyphWidth = m_glyphWidths[i];
+	}
+	m_cellWidth = maxGlyphWidth + 1;
+	m_cellHeight = m_fontHeight + 1;
+	m_atlasWidth = 1;
+	while (m_atlasWidth < ATLAS_COLUMNS * m_cellWidth) m_atlasWidth *= 2;
+	m_atlasHeight = 1;
+	while (m_atlasHeight < (NUM_GLYPHS / ATLAS_COLUMNS) * m_cellHeight) m_atlasHeight *= 2;
+
+	if (!buildAtlas())
+	{
+		Renderer::get()->logMessage("Warning: couldn't build the glyph atlas. Text will be drawn with glutBitmapString()");
+		return;
+	}
+	glGenBuffers(1, &m_vertexBufferId);
+	m_bAvailable = true;
+}
+
+bool TextRenderer::buildAtlas()
+{
+	glGenTextures(1, &m_atlasTextureId);
+	glBindTexture(GL_TEXTURE_2D, m_atlasTextureId);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_atlasWidth, m_atlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	//the glyphs are drawn with GLUT to a framebuffer object with the atlas attached. The framebuffer bound (i.e, the
+	//offscreen frame capture) is restored afterwards
+	GLint previousFrameBufferId;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFrameBufferId);
+	GLuint frameBufferId;
+	glGenFramebuffers(1, &frameBufferId);
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBufferId);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_atlasTextureId, 0);
+	bool bComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+	if (bComplete)
+	{
+		glPushAttrib(GL_ALL_ATTRIB_BITS);
+		glMatrixMode(GL_PROJECTION);
+		glPushMatrix();
+		glLoadIdentity();
+		glOrtho(0.0, m_atlasWidth, 0.0, m_atlasHeight, -1.0, 1.0);
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glLoadIdentity();
+		glViewport(0, 0, m_atlasWidth, m_atlasHeight);
+
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_LIGHTING);
+		glDisable(GL_TEXTURE_2D);
+		glDisable(GL_BLEND);
+		//white glyphs on a transparent background: the color of the text is set per vertex
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+		for (int i = 0; i < NUM_GLYPHS; i++)
+		{
+			glRasterPos2i((i % ATLAS_COLUMNS) * m_cellWidth, (i / ATLAS_COLUMNS) * m_cellHeight + FONT_DESCENT);
+			glutBitmapCharacter(FONT, i);
+		}
+
+		glMatrixMode(GL_PROJECTION);
+		glPopMatrix();
+		glMatrixMode(GL_MODELVIEW);
+		glPopMatrix();
+		glPopAttrib();
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFrameBufferId);
+	glDeleteFramebuffers(1, &frameBufferId);
+	if (!bComplete)
+	{
+		glDeleteTextures(1, &m_atlasTextureId);
+		m_atlasTextureId = 0;
+	}
+	return bComplete;
+}
+
+void TextRenderer::layout(const string& text, TextLayout& layout)
+{
+	layout.m_text = text;
+	layout.m_bBuilt = true;
+	layout.m_glyphs.clear();
+
+	//same layout as glutBitmapString(): the pen moves right by the width of each glyph and a new line starts below
+	int x = 0, y = 0;
+	for (unsigned char c : text)
+	{
+		if (c == '\n')
+		{
+			x = 0;
+			y -= m_fontHeight;
+			continue;
+		}
+		int width = m_glyphWidths[c];
+		float u0 = (float)((c % ATLAS_COLUMNS) * m_cellWidth);
+		float v0 = (float)((c / ATLAS_COLUMNS) * m_cellHeight);
+		float glyph[8] = { (float)x, (float)(y - FONT_DESCENT), (float)(x + width), (float)(y - FONT_DESCENT + m_fontHeight)
+			, u0 / m_atlasWidth, v0 / m_atlasHeight, (u0 + width) / m_atlasWidth, (v0 + m_fontHeight) / m_atlasHeight };
+		layout.m_glyphs.insert(layout.m_glyphs.end(), glyph, glyph + 8);
+		x += width;
+	}
+}
+
+void TextRenderer::add(const TextLayout& layout, const Color& color)
+{
+	GLdouble modelview[16], projection[16];
+	GLint viewport[4];
+	glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+	glGetDoublev(GL_PROJECTION_MATRIX, projection);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	GLdouble winX, winY, winZ;
+	if (gluProject(0.0, 0.0, 0.0, modelview, projection, viewport, &winX, &winY, &winZ) == GL_FALSE)
+		return;
+	if (winX < viewport[0] || winX > viewport[0] + viewport[2] || winY < viewport[1] || winY > viewport[1] + viewport[3]
+		|| winZ < 0.0 || winZ > 1.0)
+		return;
+
+	//glyphs are aligned to pixels so that each texel of the atlas is mapped to one pixel
+	float originX = (float)floor(winX + 0.5), originY = (float)floor(winY + 0.5);
+	for (size_t i = 0; i < layout.m_glyphs.size(); i += 8)
+	{
+		const float* glyph = &layout.m_glyphs[i];
+		float x0 = originX + glyph[0], y0 = originY + glyph[1], x1 = originX + glyph[2], y1 = originY + glyph[3];
+		float corners[6][4] = { { x0, y0, glyph[4], glyph[5] }, { x1, y0, glyph[6], glyph[5] }, { x1, y1, glyph[6], glyph[7] }
+			, { x0, y0, glyph[4], glyph[5] }, { x1, y1, glyph[6], glyph[7] }, { x0, y1, glyph[4], glyph[7] } };
+		for (int j = 0; j < 6; j++)
+		{
+			m_vertices.insert(m_vertices.end(), corners[j], corners[j] + 4);
+			m_vertices.push_back(color.r());
+			m_vertices.push_back(color.g());
+			m_vertices.push_back(color.b());
+		}
+	}
+}
+
+void TextRenderer::draw(int windowWidth, int windowHeight)
+{
+	if (m_vertices.empty())
+		return;
+
+	//the whole batch is uploaded at once. A new data store is allocated every frame, so the driver doesn't have to wait
+	//until the previous frame has been drawn
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferId);
+	glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(float), m_vertices.data(), GL_STREAM_DRAW);
+
+	glPushAttrib(GL_ENABLE_BIT | GL_VIEWPORT_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT);
+	glViewport(0, 0, windowWidth, windowHeight);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0.0, windowWidth, 0.0, windowHeight, -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	//text is drawn on top of everything else, without blending (as glutBitmapString() does)
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_BLEND);
+	glEnable(GL_ALPHA_TEST);
+	glAlphaFunc(GL_GREATER, 0.5f);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, m_atlasTextureId);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	GLsizei stride = NUM_FLOATS_PER_VERTEX * sizeof(float);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, stride, (const void*)0);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, stride, (const void*)(2 * sizeof(float)));
+	glEnableClientState(GL_COLOR_ARRAY);
+	glColorPointer(3, GL_FLOAT, stride, (const void*)(4 * sizeof(float)));
+
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(m_vertices.size() / NUM_FLOATS_PER_VERTEX));
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	glPopAttrib();
+
+	m_vertices.clear();
+}
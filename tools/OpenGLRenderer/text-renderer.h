@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <string>
+using namespace std;
+
+class Color;
+
+//Position of the glyphs of a string relative to the origin of the text, in pixels. It is only rebuilt when the string
+//changes
+class TextLayout
+{
+	friend class TextRenderer;
+
+	string m_text;
+	bool m_bBuilt = false;
+	vector<float> m_glyphs; //x0, y0, x1, y1, u0, v0, u1, v1 of each glyph
+public:
+	bool isUpToDate(const string& text) const { return m_bBuilt && m_text == text; }
+};
+
+//Batched text rendering: the glyphs of GLUT's bitmap font are drawn once to a texture atlas and every string drawn during
+//a frame is added as textured quads to a single vertex buffer, drawn at the end of the frame. Requires OpenGL 2.1 and
+//ARB_framebuffer_object (the atlas is rendered to a texture). Otherwise, text is drawn with glutBitmapString()
+class TextRenderer
+{
+	static const int NUM_GLYPHS = 256;
+	static const int ATLAS_COLUMNS = 16;
+
+	bool m_bInitialized = false;
+	bool m_bAvailable = false;
+
+	unsigned int m_atlasTextureId = 0;
+	int m_atlasWidth = 0, m_atlasHeight = 0;
+	int m_cellWidth = 0, m_cellHeight = 0;
+	int m_glyphWidths[NUM_GLYPHS];
+	int m_fontHeight = 0;
+
+	unsigned int m_vertexBufferId = 0;
+	vector<float> m_vertices; //x, y, u, v, r, g, b of each vertex (window coordinates)
+
+	void init();
+	bool buildAtlas();
+public:
+	TextRenderer();
+	virtual ~TextRenderer();
+
+	//the atlas is built the first time this is called (an OpenGL context is needed)
+	bool isAvailable();
+
+	void layout(const string& text, TextLayout& layout);
+
+	//adds the text to this frame's batch. As with glRasterPos(), the origin of the text is transformed by the current
+	//modelview and projection matrices and the text isn't drawn if it falls outside the viewport
+	void add(const TextLayout& layout, const Color& color);
+
+	//draws all the text added since the last call
+	void draw(int windowWidth, int windowHeight);
+};
@@ -24,6 +24,16 @@ Text2D::~Text2D()
 
 void Text2D::draw()
 {
+	//the text is added to the frame's batch. Its layout is only rebuilt if the text has changed
+	TextRenderer* pTextRenderer = Renderer::get()->getTextRenderer();
+	if (pTextRenderer->isAvailable())
+	{
+		if (!m_layout.isUpToDate(m_text))
+			pTextRenderer->layout(m_text, m_layout);
+		pTextRenderer->add(m_layout, m_color);
+		return;
+	}
+
 	glDisable(GL_TEXTURE_2D);
 	glDisable(GL_LIGHTING);
 	glDisable(GL_BLEND);
@@ -2,6 +2,7 @@
 
 #include "color.h"
 #include "graphic-object-2d.h"
+#include "text-renderer.h"
 
 #include <string>
 using namespace std;
@@ -10,6 +11,7 @@ class Text2D: public GraphicObject2D
 {
 	Color m_color;
 	string m_text;
+	TextLayout m_layout;
 public:
 	Text2D(tinyxml2::XMLElement* pNode);
 
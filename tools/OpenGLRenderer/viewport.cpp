@@ -71,9 +71,14 @@ int ViewPort::draw()
 		drawAxes();
 #endif
 
-	for (auto object : m_3DgraphicObjects)
+	//objects are drawn in the order they were added, skipping those outside the frustum
+	m_sceneBVH.update();
+	m_sceneBVH.getVisibleObjects(frustum, m_visible3DgraphicObjects);
+
+	for (size_t i = 0; i < m_3DgraphicObjects.size(); ++i)
 	{
-		if (frustum.isVisible(object->boundingBox()))
+		GraphicObject3D* object = m_3DgraphicObjects[i];
+		if (m_visible3DgraphicObjects[i])
 		{
 			object->draw();
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include "scene-bvh.h"
 using namespace std;
 class Camera;
 class Light;
@@ -21,6 +22,10 @@ class ViewPort
 	vector<GraphicObject3D*> m_3DgraphicObjects;
 	vector<GraphicObject2D*> m_2DgraphicObjects;
 
+	//hierarchy over m_3DgraphicObjects used for frustum culling
+	SceneBVH m_sceneBVH;
+	vector<bool> m_visible3DgraphicObjects;
+
 	void drawAxes();
 	bool m_bDrawBoundingBoxes = false;
 public:
@@ -31,7 +36,7 @@ public:
 
 	void resize(double minNormScreenX, double minNormScreenY, double maxNormScreenX, double maxNormScreenY);
 protected:
-	void addGraphicObject3D(GraphicObject3D* pObj) { m_3DgraphicObjects.push_back(pObj); }
+	void addGraphicObject3D(GraphicObject3D* pObj) { m_3DgraphicObjects.push_back(pObj); m_sceneBVH.add(pObj); }
 	void addGraphicObject2D(GraphicObject2D* pObj) { m_2DgraphicObjects.push_back(pObj); }
 	void addLight(Light* pLight) { m_lights.push_back(pLight); }
 	void addLights(vector<Light*>& pLights) { m_lights.insert(m_lights.end(), pLights.begin(), pLights.end()); }
@@ -71,14 +71,14 @@ namespace XML
 		while ((size_t)(p - pText) < charCount && *p != ' ') ++p;
 	}
 
-	void load(tinyxml2::XMLElement* pNode, Vector3D& vector)
+	void load(tinyxml2::XMLElement* pNode, Vector3D& vector, unsigned int* pVersion)
 	{
 		if (childExists(pNode, XML_TAG_X))
-			vector.setX(loadBindableValue(pNode, XML_TAG_X, vector));
+			vector.setX(loadBindableValue(pNode, XML_TAG_X, vector, pVersion));
 		if (childExists(pNode, XML_TAG_Y))
-			vector.setY(loadBindableValue(pNode, XML_TAG_Y, vector));
+			vector.setY(loadBindableValue(pNode, XML_TAG_Y, vector, pVersion));
 		if (childExists(pNode, XML_TAG_Z))
-			vector.setZ(loadBindableValue(pNode, XML_TAG_Z, vector));
+			vector.setZ(loadBindableValue(pNode, XML_TAG_Z, vector, pVersion));
 	}
 	void load(tinyxml2::XMLElement* pNode, Point3D& point)
 	{
@@ -106,23 +106,23 @@ namespace XML
 	}
 
 
-	void load(tinyxml2::XMLElement* pNode, Quaternion& quat)
+	void load(tinyxml2::XMLElement* pNode, Quaternion& quat, unsigned int* pVersion)
 	{
 		if (childExists(pNode, XML_TAG_X))
-			quat.setX(loadBindableValue(pNode, XML_TAG_X, quat));
+			quat.setX(loadBindableValue(pNode, XML_TAG_X, quat, pVersion));
 		if (childExists(pNode, XML_TAG_Y))
-			quat.setY(loadBindableValue(pNode, XML_TAG_Y, quat));
+			quat.setY(loadBindableValue(pNode, XML_TAG_Y, quat, pVersion));
 		if (childExists(pNode, XML_TAG_Z))
-			quat.setZ(loadBindableValue(pNode, XML_TAG_Z, quat));
+			quat.setZ(loadBindableValue(pNode, XML_TAG_Z, quat, pVersion));
 		if (childExists(pNode, XML_TAG_W))
-			quat.setW(loadBindableValue(pNode, XML_TAG_W, quat));
+			quat.setW(loadBindableValue(pNode, XML_TAG_W, quat, pVersion));
 
 		if (childExists(pNode, XML_TAG_YAW))
-			quat.setYaw(loadBindableValue(pNode, XML_TAG_YAW, quat));
+			quat.setYaw(loadBindableValue(pNode, XML_TAG_YAW, quat, pVersion));
 		if (childExists(pNode, XML_TAG_PITCH))
-			quat.setPitch(loadBindableValue(pNode, XML_TAG_PITCH, quat));
+			quat.setPitch(loadBindableValue(pNode, XML_TAG_PITCH, quat, pVersion));
 		if (childExists(pNode, XML_TAG_ROLL))
-			quat.setRoll(loadBindableValue(pNode, XML_TAG_ROLL, quat));
+			quat.setRoll(loadBindableValue(pNode, XML_TAG_ROLL, quat, pVersion));
 	}
 
 
@@ -130,17 +130,18 @@ namespace XML
 	{
 		tinyxml2::XMLElement *pChild;
 
+		//bindings update the transform's version, so that moved objects can be detected
 		pChild = pNode->FirstChildElement(XML_TAG_TRANSLATION);
 		if (pChild)
-			load(pChild, transform.translation());
+			load(pChild, transform.translation(), transform.getVersionCounter());
 
 		pChild = pNode->FirstChildElement(XML_TAG_ROTATION);
 		if (pChild)
-			load(pChild, transform.rotation());
+			load(pChild, transform.rotation(), transform.getVersionCounter());
 
 		pChild = pNode->FirstChildElement(XML_TAG_SCALE);
 		if (pChild)
-			load(pChild, transform.scale());
+			load(pChild, transform.scale(), transform.getVersionCounter());
 	}
 
 	void load(tinyxml2::XMLElement* pNode, Transform2D& transform)
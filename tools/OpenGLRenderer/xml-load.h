@@ -17,7 +17,7 @@ class BoundingCylinder;
 namespace XML
 {
 	template <typename T>
-	double loadBindableValue(tinyxml2::XMLElement* pNode, const char* xmlTag, T& obj)
+	double loadBindableValue(tinyxml2::XMLElement* pNode, const char* xmlTag, T& obj, unsigned int* pVersion = nullptr)
 	{
 		double value= 0.0;
 		const char* pBindingName;
@@ -35,7 +35,7 @@ namespace XML
 					offset = atof(pChild->Attribute(XML_ATTR_OFFSET));
 				if (pChild->Attribute(XML_ATTR_MULTIPLIER))
 					multiplier = atof(pChild->Attribute(XML_ATTR_MULTIPLIER));
-				Renderer::get()->registerBinding<T>(pBindingName, obj, xmlTag, offset, multiplier);
+				Renderer::get()->registerBinding<T>(pBindingName, obj, xmlTag, offset, multiplier, pVersion);
 			}
 			return value;
 		}
@@ -44,9 +44,10 @@ namespace XML
 	void loadColladaMatrix(const char* pText, Matrix44& outMatrix);
 	void loadVector3D(const char* pText, Vector3D& outVec);
 
-	void load(tinyxml2::XMLElement* pNode, Vector3D& outVec);
+	//pVersion: counter incremented every time a binding loaded for the value updates it
+	void load(tinyxml2::XMLElement* pNode, Vector3D& outVec, unsigned int* pVersion = nullptr);
 	void load(tinyxml2::XMLElement* pNode, Point3D& outVec);
-	void load(tinyxml2::XMLElement* pNode, Quaternion& outVec);
+	void load(tinyxml2::XMLElement* pNode, Quaternion& outVec, unsigned int* pVersion = nullptr);
 	void load(tinyxml2::XMLElement* pNode, Vector2D& outVec);
 	void load(tinyxml2::XMLElement* pNode, Point2D& outVec);
 	void load(tinyxml2::XMLElement* pNode, Transform3D& transform);
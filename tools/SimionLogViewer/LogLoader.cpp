@@ -2,25 +2,13 @@
 #include "LogLoader.h"
 #include "../System/FileUtils.h"
 #include <algorithm>
+#include <future>
 
-Step::Step(int numVariables)
+Step::Step(const char* pData, int numVariables)
 {
+	m_pHeader = (const StepHeader*)pData;
+	m_pValues = (const double*)(pData + sizeof(StepHeader));
 	m_numValues = numVariables;
-	m_pValues = new double[numVariables];
-}
-
-Step::~Step()
-{
-	if (m_pValues) delete [] m_pValues;
-}
-
-void Step::load(FILE* pFile)
-{
-	size_t elementsRead = fread_s((void*)&m_header, sizeof(StepHeader), sizeof(StepHeader), 1, pFile);
-	if (elementsRead == 1 && !bEnd())
-	{
-		elementsRead = fread_s(m_pValues, sizeof(double)*m_numValues, sizeof(double), m_numValues, pFile);
-	}
 }
 
 double Step::getValue(int i) const
@@ -30,57 +18,57 @@ double Step::getValue(int i) const
 	return 0.0;
 }
 
-void Step::setValue(int i, double value)
-{
-	if (i >= 0 && i<m_numValues)
-		m_pValues[i]= value;
-}
-
 double Step::getExperimentRealTime() const
 {
-	return m_header.experimentRealTime;
+	return m_pHeader->experimentRealTime;
 }
 double Step::getEpisodeSimTime() const
 {
-	return m_header.m_episodeSimTime;
+	return m_pHeader->m_episodeSimTime;
 }
 double Step::getEpisodeRealTime() const
 {
-	return m_header.episodeRealTime;
-}
-
-bool Step::bEnd()
-{
-	return m_header.magicNumber == EPISODE_END_HEADER;
+	return m_pHeader->episodeRealTime;
 }
 
-void Episode::load(FILE* pFile)
+const char* Episode::index(const char* pData, const char* pEnd)
 {
-	size_t elementsRead = fread_s((void*)&m_header, sizeof(EpisodeHeader), sizeof(EpisodeHeader), 1, pFile);
-	if (elementsRead == 1)
+	if (pData == nullptr || pEnd - pData < (ptrdiff_t)sizeof(EpisodeHeader))
+		return nullptr;
+	m_pHeader = (const EpisodeHeader*)pData;
+	m_pFirstStep = pData + sizeof(EpisodeHeader);
+
+	//all the steps of an episode have the same size, so only their magic numbers need to be read
+	size_t stepSize = sizeof(StepHeader) + sizeof(double) * (size_t)m_pHeader->numVariablesLogged;
+	const char* pStep = m_pFirstStep;
+	while (pEnd - pStep >= (ptrdiff_t)sizeof(StepHeader))
 	{
-		Step *pStep= new Step((int)m_header.numVariablesLogged);
-		pStep->load(pFile);
-		while (!pStep->bEnd())
-		{
-			m_pSteps.push_back(pStep);
-
-			pStep = new Step((int)m_header.numVariablesLogged);
-			pStep->load(pFile);
-		}
+		__int64 magicNumber = ((const StepHeader*)pStep)->magicNumber;
+		if (magicNumber == EPISODE_END_HEADER)
+			return pStep + sizeof(StepHeader);
+		if (magicNumber != STEP_HEADER || pEnd - pStep < (ptrdiff_t)stepSize)
+			break;
+		pStep += stepSize;
+		++m_numSteps;
 	}
+	//the log is truncated (i.e., the experiment is still running): we keep the steps read so far
+	return nullptr;
 }
 
-Episode::~Episode()
+void Episode::load()
 {
-	for (auto it = m_pSteps.begin(); it != m_pSteps.end(); ++it)
-		delete (*it);
+	if (m_pHeader == nullptr) return;
+
+	size_t stepSize = sizeof(StepHeader) + sizeof(double) * (size_t)m_pHeader->numVariablesLogged;
+	m_steps.reserve(m_numSteps);
+	for (size_t i = 0; i < m_numSteps; ++i)
+		m_steps.push_back(Step(m_pFirstStep + i * stepSize, (int)m_pHeader->numVariablesLogged));
 }
 
 Step* Episode::getStep(int i)
 {
-	if (i>=0 && i<m_pSteps.size())
-		return m_pSteps[i];
+	if (i>=0 && i<m_steps.size())
+		return &m_steps[i];
 	return nullptr;
 }
 
@@ -134,31 +122,36 @@ bool ExperimentLog::load(string descriptorFile, string& outSceneFile)
 	}
 	else return false;
 
-	//Load the binary file from the same directory
-	FILE* pFile;
-
 	string logDirectory = getDirectory(descriptorFile);
-	fopen_s(&pFile, (logDirectory + binaryFile).c_str(), "rb");
-	if (pFile)
+
+	//the function log is a separate file, so it is loaded in parallel with the experiment log
+	future<void> functionLogLoad;
+	if (!functionLogFile.empty())
+		functionLogLoad = async(launch::async, [this, logDirectory, functionLogFile]()
+			{ m_functionLog.load((logDirectory + functionLogFile).c_str()); });
+
+	//Map the binary file from the same directory: steps are read directly from the mapped file
+	bool bLogLoaded = false;
+	if (m_logFile.open((logDirectory + binaryFile).c_str()) && m_logFile.size() >= sizeof(ExperimentHeader))
 	{
-		size_t elementsRead = fread_s((void*)&m_header, sizeof(ExperimentHeader), sizeof(ExperimentHeader), 1, pFile);
-		if (elementsRead == 1)
+		memcpy(&m_header, m_logFile.data(), sizeof(ExperimentHeader));
+		m_pEpisodes = new Episode[getNumEpisodes()];
+
+		//a single scan finds where each episode begins. Steps aren't decoded: they are only pointers into the mapped file
+		const char* pData = m_logFile.data() + sizeof(ExperimentHeader);
+		const char* pEnd = m_logFile.data() + m_logFile.size();
+		for (int i = 0; i < getNumEpisodes() && pData != nullptr; ++i)
 		{
-			m_pEpisodes = new Episode[getNumEpisodes()];
-			for (int i = 0; i < getNumEpisodes(); ++i)
-			{
-				m_pEpisodes[i].load(pFile);
-			}
+			pData = m_pEpisodes[i].index(pData, pEnd);
+			m_pEpisodes[i].load();
 		}
-		fclose(pFile);
+		bLogLoaded = true;
 	}
-	else return false;
 
-	//Load the function log file from the same directory
-	if (!functionLogFile.empty())
-		m_functionLog.load((logDirectory + functionLogFile).c_str());
+	if (functionLogLoad.valid())
+		functionLogLoad.get();
 
-	return true;
+	return bLogLoaded;
 }
 
 ExperimentLog::~ExperimentLog()
@@ -1,5 +1,6 @@
 #pragma once
 #include "../../RLSimion/Common/named-var-set.h"
+#include "../System/MemoryMappedFile.h"
 #include <vector>
 #include <string>
 using namespace std;
@@ -26,25 +27,21 @@ struct StepHeader
 	}
 };
 
+//A logged step. Steps are views of the memory-mapped log file, so they are only valid while the ExperimentLog exists
 class Step
 {
-	StepHeader m_header;
+	const StepHeader* m_pHeader;
+	const double *m_pValues;
 	int m_numValues;
-	double *m_pValues;
 public:
-	Step(int numVars);
-	~Step();
+	Step(const char* pData, int numVars);
 
-	int getNumValues() { return m_numValues; }
+	int getNumValues() const { return m_numValues; }
 	double getValue(int i) const;
-	void setValue(int i, double value);
 
 	double getExperimentRealTime() const;
 	double getEpisodeSimTime() const;
 	double getEpisodeRealTime() const;
-
-	void load(FILE* pFile);
-	bool bEnd();
 };
 
 struct EpisodeHeader
@@ -67,17 +64,23 @@ struct EpisodeHeader
 
 class Episode
 {
-	EpisodeHeader m_header;
-	vector<Step*> m_pSteps;
+	const EpisodeHeader* m_pHeader = nullptr;
+	const char* m_pFirstStep = nullptr;
+	size_t m_numSteps = 0;
+	vector<Step> m_steps;
 public:
 	Episode() { }
-	~Episode();
 
-	size_t getNumSteps() const { return m_pSteps.size(); }
+	size_t getNumSteps() const { return m_steps.size(); }
 	Step* getStep(int i);
-	int getNumValuesPerStep() const { if (m_pSteps.size() == 0) return 0; return m_pSteps[0]->getNumValues(); }
-	double getSimTimeLength()const { if (m_pSteps.size() == 0) return 0.0; return m_pSteps[m_pSteps.size() - 1]->getEpisodeSimTime(); }
-	void load(FILE* pFile);
+	int getNumValuesPerStep() const { if (m_steps.size() == 0) return 0; return m_steps[0].getNumValues(); }
+	double getSimTimeLength()const { if (m_steps.size() == 0) return 0.0; return m_steps[m_steps.size() - 1].getEpisodeSimTime(); }
+
+	//finds the steps of the episode beginning at pData without decoding them and returns the beginning of the next
+	//episode (or nullptr if the log ends before the end of the episode)
+	const char* index(const char* pData, const char* pEnd);
+	//creates the views of the steps found by index()
+	void load();
 };
 
 
@@ -184,6 +187,9 @@ class ExperimentLog
 	ExperimentHeader m_header;
 	Episode *m_pEpisodes = 0;
 
+	//the episodes and steps point to the mapped log file
+	MemoryMappedFile m_logFile;
+
 	Descriptor m_descriptor;
 
 	FunctionLog m_functionLog;
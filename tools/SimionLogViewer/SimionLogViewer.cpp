@@ -179,11 +179,11 @@ bool SimionLogViewer::loadLogFile(string filename)
 		m_pRenderer->setDataFolder("../config/scenes/");
 		m_pRenderer->loadScene(sceneFile.c_str());
 
-		//allocate a step object to store the interpolated data
+		//allocate a buffer to store the interpolated data
 		Episode* pFirstEpisode = m_pExperimentLog->getEpisode(0);
 		if (pFirstEpisode)
 		{
-			m_pInterpolatedStep = new Step(pFirstEpisode->getNumValuesPerStep());
+			m_interpolatedValues = vector<double>(pFirstEpisode->getNumValuesPerStep());
 			m_numEpisodes = m_pExperimentLog->getNumEpisodes();
 		}
 		else return false;
@@ -251,7 +251,7 @@ bool SimionLogViewer::loadLogFile(string filename)
 }
 
 
-void SimionLogViewer::interpolateStepData(double t, Episode* pInEpisode, Step* pOutInterpolatedData) const
+void SimionLogViewer::interpolateStepData(double t, Episode* pInEpisode, vector<double>& outInterpolatedValues) const
 {
 	int step = 0;
 
@@ -285,7 +285,7 @@ void SimionLogViewer::interpolateStepData(double t, Episode* pInEpisode, Step* p
 				printf("jump");
 		}
 		interpolatedValue = (1 - u)*v0 + (u)*v1;
-		pOutInterpolatedData->setValue(i, interpolatedValue);
+		outInterpolatedValues[i] = interpolatedValue;
 	}
 }
 
@@ -314,19 +314,19 @@ void SimionLogViewer::draw()
 	m_pPlaybackRateText->set(string("Rate: ") + to_string_with_precision(playbackRate, 2));
 
 	//interpolate logged data between saved points
-	interpolateStepData(m_episodeSimTime, m_pCurrentEpisode, m_pInterpolatedStep);
+	interpolateStepData(m_episodeSimTime, m_pCurrentEpisode, m_interpolatedValues);
 
 	//update variable meters
 	Descriptor& logDescriptor = m_pExperimentLog->getDescriptor();
 	for (int i = 0; i < logDescriptor.size(); i++)
-		m_variableMeters[i]->setValue(m_pInterpolatedStep->getValue(i));
+		m_variableMeters[i]->setValue(i < (int)m_interpolatedValues.size() ? m_interpolatedValues[i] : 0.0);
 
 	//update bindings
 	for (int b = 0; b < m_pRenderer->getNumBindings(); ++b)
 	{
 		string varName = m_pRenderer->getBindingExternalName(b);
 		int variableIndex = m_pExperimentLog->getVariableIndex(varName);
-		value = m_pInterpolatedStep->getValue(variableIndex);
+		value = (variableIndex >= 0 && variableIndex < (int)m_interpolatedValues.size()) ? m_interpolatedValues[variableIndex] : 0.0;
 
 		m_pRenderer->updateBinding(varName, value);
 	}
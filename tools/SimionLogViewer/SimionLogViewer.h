@@ -10,7 +10,6 @@ class Renderer;
 class ExperimentLog;
 class Text2D;
 class Episode;
-class Step;
 class Meter2D;
 class ViewPort;
 class Function;
@@ -27,7 +26,7 @@ class SimionLogViewer: public IInputHandler
 
 	PlaybackMode m_playbackMode= PlaybackMode::Normal;
 
-	Step* 	m_pInterpolatedStep;
+	vector<double> m_interpolatedValues;
 	Episode* m_pCurrentEpisode;
 
 	ExperimentLog* m_pExperimentLog= nullptr;
@@ -63,7 +62,7 @@ class SimionLogViewer: public IInputHandler
 	void slower();
 	double getPlaybackRate();
 
-	void interpolateStepData(double t, Episode* pInEpisode, Step* pOutInterpolatedData) const;
+	void interpolateStepData(double t, Episode* pInEpisode, vector<double>& outInterpolatedValues) const;
 public:
 	SimionLogViewer();
 	virtual ~SimionLogViewer();
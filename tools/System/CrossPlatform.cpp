@@ -1,5 +1,10 @@
 #include "CrossPlatform.h"
 #include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace CrossPlatform
 {
@@ -31,6 +36,34 @@ namespace CrossPlatform
 #endif
 	}
 
+	long long Ftell64(FILE *stream)
+	{
+#ifdef _WIN32
+		return _ftelli64(stream);
+#else
+		return (long long)ftello(stream);
+#endif
+	}
+
+	int Fseek64(FILE *stream, long long offset, int origin)
+	{
+#ifdef _WIN32
+		return _fseeki64(stream, offset, origin);
+#else
+		return fseeko(stream, (off_t)offset, origin);
+#endif
+	}
+
+	int Ftruncate(FILE *stream, long long size)
+	{
+		fflush(stream);
+#ifdef _WIN32
+		return (int)_chsize_s(_fileno(stream), size);
+#else
+		return ftruncate(fileno(stream), (off_t)size);
+#endif
+	}
+
 
 
 	char* Strcpy_s(char* dst, size_t dstSize, const char *src)
@@ -45,6 +45,12 @@ namespace CrossPlatform
 
 	size_t Fread_s(void *buffer, size_t bufferSize, size_t elementSize, size_t count, FILE *stream);
 
+	//64-bit file offsets, so that files bigger than 2GB can be used in every platform
+	long long Ftell64(FILE *stream);
+	int Fseek64(FILE *stream, long long offset, int origin);
+	//truncates the file to the given size. Returns 0 on success
+	int Ftruncate(FILE *stream, long long size);
+
 	char* Strcpy_s(char* dst, size_t dstSize, const char *src);
 
 	void Strcat_s(char* dst, size_t dstSize, const char* src);
@@ -61,6 +61,22 @@ bool bFileExists(const string& filename)
 	return (stat(filename.c_str(), &buffer) == 0);
 }
 
+long long getFileModificationTime(const string& filename)
+{
+	struct stat buffer;
+	if (stat(filename.c_str(), &buffer) != 0)
+		return -1;
+	return (long long)buffer.st_mtime;
+}
+
+long long getFileSize(const string& filename)
+{
+	struct stat buffer;
+	if (stat(filename.c_str(), &buffer) != 0)
+		return -1;
+	return (long long)buffer.st_size;
+}
+
 #if defined(_WIN32) || defined(_WIN64)
 #include <direct.h>
 #else
@@ -8,5 +8,9 @@ string getDirectory(const string& filename);
 string removeExtension(const string& filename, unsigned int numExtensions = 1);
 string getFilename(const string& filepath);
 bool bFileExists(const string& filename);
+//returns -1 if the file doesn't exist
+long long getFileModificationTime(const string& filename);
+//returns -1 if the file doesn't exist
+long long getFileSize(const string& filename);
 
 bool changeWorkingDirectory(const string& directory);
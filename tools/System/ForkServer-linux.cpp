@@ -0,0 +1,314 @@
+#include "ForkServer.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include <string>
+#include <iostream>
+using namespace std;
+
+//Protocol: the client sends the number of arguments (uint32) along with its standard output/error descriptors
+//(SCM_RIGHTS), followed by every argument (uint32 length + characters). When the child exits, the server sends its
+//exit code (int32) and closes the connection
+
+namespace
+{
+	//SIGCHLD is turned into an event the server can poll writing to this pipe
+	int childExitPipe[2] = { -1, -1 };
+
+	void onChildExit(int)
+	{
+		int savedErrno = errno;
+		char signaled = 1;
+		if (write(childExitPipe[1], &signaled, 1) < 0) {}
+		errno = savedErrno;
+	}
+
+	bool sendAll(int socket, const void* pBuffer, size_t numBytes)
+	{
+		const char* pBytes = (const char*)pBuffer;
+		while (numBytes > 0)
+		{
+			ssize_t numBytesSent = send(socket, pBytes, numBytes, MSG_NOSIGNAL);
+			if (numBytesSent < 0 && errno == EINTR) continue;
+			if (numBytesSent <= 0) return false;
+			pBytes += numBytesSent;
+			numBytes -= (size_t)numBytesSent;
+		}
+		return true;
+	}
+
+	bool receiveAll(int socket, void* pBuffer, size_t numBytes)
+	{
+		char* pBytes = (char*)pBuffer;
+		while (numBytes > 0)
+		{
+			ssize_t numBytesRead = recv(socket, pBytes, numBytes, 0);
+			if (numBytesRead < 0 && errno == EINTR) continue;
+			if (numBytesRead <= 0) return false;
+			pBytes += numBytesRead;
+			numBytes -= (size_t)numBytesRead;
+		}
+		return true;
+	}
+
+	bool setSocketAddress(sockaddr_un& address, const char* socketPath)
+	{
+		if (strlen(socketPath) >= sizeof(address.sun_path))
+			return false;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		strcpy(address.sun_path, socketPath);
+		return true;
+	}
+
+	bool sendHeader(int socket, uint32_t numArgs)
+	{
+		int outputDescriptors[2] = { STDOUT_FILENO, STDERR_FILENO };
+		char control[CMSG_SPACE(sizeof(outputDescriptors))];
+		memset(control, 0, sizeof(control));
+
+		iovec data = { &numArgs, sizeof(numArgs) };
+		msghdr message;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = &data;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+		cmsghdr* pControlMessage = CMSG_FIRSTHDR(&message);
+		pControlMessage->cmsg_level = SOL_SOCKET;
+		pControlMessage->cmsg_type = SCM_RIGHTS;
+		pControlMessage->cmsg_len = CMSG_LEN(sizeof(outputDescriptors));
+		memcpy(CMSG_DATA(pControlMessage), outputDescriptors, sizeof(outputDescriptors));
+
+		ssize_t numBytesSent;
+		do numBytesSent = sendmsg(socket, &message, MSG_NOSIGNAL);
+		while (numBytesSent < 0 && errno == EINTR);
+		return numBytesSent == (ssize_t)sizeof(numArgs);
+	}
+
+	bool receiveHeader(int socket, uint32_t& numArgs, int* outputDescriptors)
+	{
+		char control[CMSG_SPACE(2 * sizeof(int))];
+		iovec data = { &numArgs, sizeof(numArgs) };
+		msghdr message;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = &data;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+		ssize_t numBytesRead;
+		do numBytesRead = recvmsg(socket, &message, MSG_WAITALL);
+		while (numBytesRead < 0 && errno == EINTR);
+		if (numBytesRead != (ssize_t)sizeof(numArgs))
+			return false;
+
+		cmsghdr* pControlMessage = CMSG_FIRSTHDR(&message);
+		if (!pControlMessage || pControlMessage->cmsg_type != SCM_RIGHTS
+			|| pControlMessage->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+			return false;
+		memcpy(outputDescriptors, CMSG_DATA(pControlMessage), 2 * sizeof(int));
+		return true;
+	}
+
+	//runs in the forked child: reads the request, redirects the output to the client's and calls the handler
+	int serveRequest(int connection, const ForkServer::RequestHandler& handler)
+	{
+		uint32_t numArgs;
+		int outputDescriptors[2];
+		if (!receiveHeader(connection, numArgs, outputDescriptors))
+			return EXIT_FAILURE;
+
+		vector<string> args(numArgs);
+		for (uint32_t i = 0; i < numArgs; ++i)
+		{
+			uint32_t length;
+			if (!receiveAll(connection, &length, sizeof(length)))
+				return EXIT_FAILURE;
+			args[i].resize(length);
+			if (length > 0 && !receiveAll(connection, &args[i][0], length))
+				return EXIT_FAILURE;
+		}
+		close(connection);
+
+		dup2(outputDescriptors[0], STDOUT_FILENO);
+		dup2(outputDescriptors[1], STDERR_FILENO);
+		close(outputDescriptors[0]);
+		close(outputDescriptors[1]);
+
+		vector<char*> argv;
+		for (string& arg : args)
+			argv.push_back(&arg[0]);
+		argv.push_back(nullptr);
+		return handler((int)numArgs, argv.data());
+	}
+}
+
+bool ForkServer::serve(const char* socketPath, const RequestHandler& handler)
+{
+	sockaddr_un address;
+	if (!setSocketAddress(address, socketPath))
+		return false;
+
+	int listeningSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (listeningSocket < 0)
+		return false;
+
+	//remove the socket left by a previous server that wasn't stopped cleanly
+	unlink(socketPath);
+	//any process that can connect to the socket can run experiments as this user, so only the owner may use it. The
+	//permissions are set before listen(): until then, no client can connect
+	if (bind(listeningSocket, (sockaddr*)&address, sizeof(address)) < 0 || chmod(socketPath, S_IRUSR | S_IWUSR) < 0
+		|| listen(listeningSocket, SOMAXCONN) < 0
+		|| pipe2(childExitPipe, O_CLOEXEC | O_NONBLOCK) < 0)
+	{
+		close(listeningSocket);
+		return false;
+	}
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = onChildExit;
+	action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+	sigaction(SIGCHLD, &action, nullptr);
+
+	if (m_bVerbose) cout << "Fork server listening on " << socketPath << "\n";
+
+	//connection to the client of every child still running (-1 if the client is gone)
+	map<pid_t, int> children;
+	vector<pollfd> descriptors;
+	vector<pid_t> polledChildren;
+	while (true)
+	{
+		descriptors = { { listeningSocket, POLLIN, 0 }, { childExitPipe[0], POLLIN, 0 } };
+		polledChildren.clear();
+		for (auto& child : children)
+		{
+			if (child.second < 0) continue;
+			//only hang-ups are polled: the request sent by the client is read by the child
+			descriptors.push_back({ child.second, POLLRDHUP, 0 });
+			polledChildren.push_back(child.first);
+		}
+
+		if (poll(descriptors.data(), descriptors.size(), -1) < 0)
+		{
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		//a client that disconnects before its request has been served was stopped, so its child is stopped too
+		for (size_t i = 2; i < descriptors.size(); ++i)
+		{
+			if (descriptors[i].revents == 0) continue;
+			pid_t pid = polledChildren[i - 2];
+			if (m_bVerbose) cout << "Client of process " << pid << " disconnected. Stopping it\n";
+			kill(pid, SIGTERM);
+			close(children[pid]);
+			children[pid] = -1;
+		}
+
+		if (descriptors[1].revents & POLLIN)
+		{
+			char buffer[64];
+			while (read(childExitPipe[0], buffer, sizeof(buffer)) > 0) {}
+
+			int status;
+			pid_t pid;
+			while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+			{
+				auto child = children.find(pid);
+				if (child == children.end()) continue;
+
+				int32_t exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+				if (m_bVerbose) cout << "Process " << pid << " finished. Exit code: " << exitCode << "\n";
+				if (child->second >= 0)
+				{
+					sendAll(child->second, &exitCode, sizeof(exitCode));
+					close(child->second);
+				}
+				children.erase(child);
+			}
+		}
+
+		if (descriptors[0].revents & POLLIN)
+		{
+			int connection = accept4(listeningSocket, nullptr, nullptr, SOCK_CLOEXEC);
+			if (connection < 0) continue;
+
+			//whatever is buffered would otherwise be written by the child too
+			fflush(nullptr);
+			pid_t pid = fork();
+			if (pid == 0)
+			{
+				//the child only keeps its own connection
+				signal(SIGCHLD, SIG_DFL);
+				close(listeningSocket);
+				close(childExitPipe[0]);
+				close(childExitPipe[1]);
+				for (auto& child : children)
+					if (child.second >= 0) close(child.second);
+
+				exit(serveRequest(connection, handler));
+			}
+			else if (pid > 0)
+			{
+				if (m_bVerbose) cout << "Forked process " << pid << "\n";
+				children[pid] = connection;
+			}
+			else
+			{
+				int32_t exitCode = -1;
+				sendAll(connection, &exitCode, sizeof(exitCode));
+				close(connection);
+			}
+		}
+	}
+
+	close(listeningSocket);
+	unlink(socketPath);
+	return false;
+}
+
+int ForkServer::request(const char* socketPath, int argc, const char* const* argv)
+{
+	sockaddr_un address;
+	if (!setSocketAddress(address, socketPath))
+		return -1;
+
+	int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (connection < 0)
+		return -1;
+	if (connect(connection, (sockaddr*)&address, sizeof(address)) < 0)
+	{
+		if (m_bVerbose) cout << "Failed to connect to the fork server: " << socketPath << "\n";
+		close(connection);
+		return -1;
+	}
+
+	bool bSent = sendHeader(connection, (uint32_t)argc);
+	for (int i = 0; bSent && i < argc; ++i)
+	{
+		uint32_t length = (uint32_t)strlen(argv[i]);
+		bSent = sendAll(connection, &length, sizeof(length)) && sendAll(connection, argv[i], length);
+	}
+
+	int32_t exitCode;
+	if (!bSent || !receiveAll(connection, &exitCode, sizeof(exitCode)))
+		exitCode = -1;
+	close(connection);
+	return exitCode;
+}
@@ -0,0 +1,13 @@
+#include "ForkServer.h"
+
+//There is no fork() under Windows: experiments are always run as new processes
+
+bool ForkServer::serve(const char* socketPath, const RequestHandler& handler)
+{
+	return false;
+}
+
+int ForkServer::request(const char* socketPath, int argc, const char* const* argv)
+{
+	return -1;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <functional>
+
+//A resident launcher ("zygote"): the initialization shared by all the requests is done once in the server process,
+//which then forks a pre-initialized child to serve each request received through a local socket. The child runs the
+//command line sent by the client with the client's standard output/error, and its exit code is sent back to the client.
+//Only implemented under Linux: under Windows, serve() and request() always fail
+class ForkServer
+{
+	bool m_bVerbose = false;
+public:
+	//runs a request in the forked child. The value returned is the exit code of the child
+	using RequestHandler = std::function<int(int argc, char** argv)>;
+
+	//serves requests until the process is stopped. Returns false if the socket couldn't be opened
+	bool serve(const char* socketPath, const RequestHandler& handler);
+
+	//sends the command line to the server listening on socketPath and waits until the request has been served. If the
+	//client is stopped before, the child serving the request is stopped too.
+	//Returns the exit code of the child, or -1 if the server couldn't be reached
+	int request(const char* socketPath, int argc, const char* const* argv);
+
+	void setVerbose(bool set) { m_bVerbose = set; }
+};
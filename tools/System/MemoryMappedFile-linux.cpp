@@ -0,0 +1,70 @@
+#include "MemoryMappedFile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <algorithm>
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	close();
+}
+
+bool MemoryMappedFile::open(const char* filename)
+{
+	close();
+
+	int fileDescriptor = ::open(filename, O_RDONLY);
+	if (fileDescriptor < 0)
+		return false;
+
+	struct stat fileStats;
+	if (fstat(fileDescriptor, &fileStats) != 0)
+	{
+		::close(fileDescriptor);
+		return false;
+	}
+	//the descriptor is stored offset by one, so that descriptor 0 is not taken for a closed file
+	m_fileHandle = (void*)(intptr_t)(fileDescriptor + 1);
+	m_size = (size_t)fileStats.st_size;
+
+	//empty files can't be mapped
+	if (m_size == 0)
+		return true;
+
+	void* pData = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+	if (pData == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	//logs are read from beginning to end
+	madvise(pData, m_size, MADV_SEQUENTIAL);
+	m_pData = (const char*)pData;
+	return true;
+}
+
+void MemoryMappedFile::close()
+{
+	if (m_pData)
+		munmap((void*)m_pData, m_size);
+	if (m_fileHandle)
+		::close((int)(intptr_t)m_fileHandle - 1);
+
+	m_pData = nullptr;
+	m_size = 0;
+	m_fileHandle = nullptr;
+}
+
+void MemoryMappedFile::prefetch(size_t offset, size_t size) const
+{
+	if (m_pData == nullptr || offset >= m_size)
+		return;
+	size = std::min(size, m_size - offset);
+
+	//the range must begin at a page boundary
+	size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	size_t pageOffset = offset % pageSize;
+	madvise((void*)(m_pData + offset - pageOffset), size + pageOffset, MADV_WILLNEED);
+}
@@ -0,0 +1,80 @@
+#include "MemoryMappedFile.h"
+
+#define WINDOWS_MEAN_AND_LEAN
+#include <windows.h>
+#undef min
+#undef max
+#include <algorithm>
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	close();
+}
+
+bool MemoryMappedFile::open(const char* filename)
+{
+	close();
+
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING
+		, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	m_fileHandle = (void*)file;
+	m_size = (size_t)fileSize.QuadPart;
+
+	//empty files can't be mapped
+	if (m_size == 0)
+		return true;
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		close();
+		return false;
+	}
+	m_mappingHandle = (void*)mapping;
+
+	m_pData = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_pData == nullptr)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MemoryMappedFile::close()
+{
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_mappingHandle)
+		CloseHandle((HANDLE)m_mappingHandle);
+	if (m_fileHandle)
+		CloseHandle((HANDLE)m_fileHandle);
+
+	m_pData = nullptr;
+	m_size = 0;
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+}
+
+void MemoryMappedFile::prefetch(size_t offset, size_t size) const
+{
+	if (m_pData == nullptr || offset >= m_size)
+		return;
+	size = std::min(size, m_size - offset);
+
+#if _WIN32_WINNT >= _WIN32_WINNT_WIN8
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = (PVOID)(m_pData + offset);
+	range.NumberOfBytes = size;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+}
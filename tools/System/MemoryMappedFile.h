@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+
+//Read-only view of a whole file mapped in memory. The data is only valid while the file is open
+class MemoryMappedFile
+{
+	const char* m_pData = nullptr;
+	size_t m_size = 0;
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+
+public:
+	MemoryMappedFile() = default;
+	virtual ~MemoryMappedFile();
+
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	//returns false if the file couldn't be opened or mapped. Empty files can be opened, but data() returns nullptr
+	bool open(const char* filename);
+	void close();
+
+	//asks the system to read a range of the file in the background, so that it is already in memory when accessed.
+	//The part of the range beyond the end of the file is ignored
+	void prefetch(size_t offset, size_t size) const;
+
+	bool isOpen() const { return m_fileHandle != nullptr; }
+	const char* data() const { return m_pData; }
+	size_t size() const { return m_size; }
+};
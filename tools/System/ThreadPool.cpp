@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+	if (numThreads == 0)
+	{
+		unsigned int numHardwareThreads = std::thread::hardware_concurrency();
+		numThreads = numHardwareThreads > 1 ? numHardwareThreads - 1 : 0;
+	}
+
+	for (unsigned int i = 0; i < numThreads; i++)
+		m_threads.push_back(std::thread(&ThreadPool::workerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bExit = true;
+	}
+	m_tasksAvailable.notify_all();
+
+	for (std::thread& thread : m_threads)
+		thread.join();
+}
+
+void ThreadPool::runTasks(std::unique_lock<std::mutex>& lock)
+{
+	//must be called with the lock acquired
+	while (m_nextTask < m_numTasks)
+	{
+		size_t taskIndex = m_nextTask++;
+
+		lock.unlock();
+		try
+		{
+			m_task(taskIndex);
+		}
+		catch (...)
+		{
+			lock.lock();
+			if (!m_pException)
+				m_pException = std::current_exception();
+			lock.unlock();
+		}
+		lock.lock();
+
+		m_numFinishedTasks++;
+		if (m_numFinishedTasks == m_numTasks)
+			m_tasksFinished.notify_all();
+	}
+}
+
+void ThreadPool::workerLoop()
+{
+	unsigned int lastBatchId = 0;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_tasksAvailable.wait(lock, [&]() { return m_bExit || m_batchId != lastBatchId; });
+		if (m_bExit)
+			return;
+
+		lastBatchId = m_batchId;
+		runTasks(lock);
+	}
+}
+
+void ThreadPool::parallelFor(size_t numTasks, const std::function<void(size_t)>& task)
+{
+	if (m_threads.empty() || numTasks <= 1)
+	{
+		for (size_t i = 0; i < numTasks; i++)
+			task(i);
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_task = task;
+	m_numTasks = numTasks;
+	m_nextTask = 0;
+	m_numFinishedTasks = 0;
+	m_pException = nullptr;
+	m_batchId++;
+	m_tasksAvailable.notify_all();
+
+	//the calling thread works too instead of just waiting
+	runTasks(lock);
+	m_tasksFinished.wait(lock, [&]() { return m_numFinishedTasks == m_numTasks; });
+
+	m_task = nullptr;
+	std::exception_ptr pException = m_pException;
+	m_pException = nullptr;
+	lock.unlock();
+
+	if (pException)
+		std::rethrow_exception(pException);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+//A fixed set of worker threads used to run independent tasks in parallel. The calling thread also runs tasks
+//while it waits for parallelFor() to finish, so a pool created with n threads uses n+1 cores.
+//parallelFor() is not reentrant: it must only be called from one thread at a time
+class ThreadPool
+{
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_tasksAvailable;
+	std::condition_variable m_tasksFinished;
+
+	std::function<void(size_t)> m_task;
+	size_t m_numTasks = 0;
+	size_t m_nextTask = 0;
+	size_t m_numFinishedTasks = 0;
+	unsigned int m_batchId = 0;
+	bool m_bExit = false;
+	std::exception_ptr m_pException;
+
+	void workerLoop();
+	void runTasks(std::unique_lock<std::mutex>& lock);
+public:
+	//numThreads= 0 creates as many worker threads as hardware threads are available minus one (the calling thread)
+	ThreadPool(unsigned int numThreads = 0);
+	virtual ~ThreadPool();
+
+	unsigned int getNumThreads() const { return (unsigned int)m_threads.size(); }
+
+	//runs task(i) for i in [0,numTasks) and returns once all of them have finished. If any task throws an exception,
+	//it is rethrown in the calling thread
+	void parallelFor(size_t numTasks, const std::function<void(size_t)>& task);
+};
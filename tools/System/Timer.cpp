@@ -4,17 +4,17 @@
 
 Timer::Timer()
 {
-	m_startTimePoint = std::chrono::system_clock::now();
+	m_startTimePoint = std::chrono::steady_clock::now();
 }
 
 void Timer::start()
 {
-	m_startTimePoint= std::chrono::system_clock::now();
+	m_startTimePoint= std::chrono::steady_clock::now();
 }
 
 double Timer::getElapsedTime(bool resetTimer)
 {
-	std::chrono::system_clock::time_point timePointNow = std::chrono::system_clock::now();
+	std::chrono::steady_clock::time_point timePointNow = std::chrono::steady_clock::now();
 
 	auto timeDiff = timePointNow - m_startTimePoint;
 
@@ -3,7 +3,7 @@
 
 class Timer
 {
-	std::chrono::system_clock::time_point m_startTimePoint;
+	std::chrono::steady_clock::time_point m_startTimePoint;
 public:
 	Timer();
 